@@ -35,4 +35,8 @@
 #include <drivers/drv_sensor.h>
 
 constexpr px4_spi_bus_t px4_spi_buses[SPI_BUS_MAX_BUS_ITEMS] = {
+	initSPIBus(1, {
+		// emulated devices (see bus_sim)
+		initSPIDevice(DRV_IMU_DEVTYPE_ICM42688P, 0),
+	}),
 };
@@ -1,3 +1,7 @@
+# drivers for the emulated SPI devices of bus_sim, which need the Linux SPI backend
+if(CMAKE_HOST_SYSTEM_NAME STREQUAL "Linux")
+	set(sitl_bus_sim_drivers imu/invensense/icm42688p)
+endif()
 
 px4_add_board(
 	PLATFORM posix
@@ -16,6 +20,7 @@ px4_add_board(
 		#distance_sensor # all available distance sensor drivers
 		gps
 		#imu # all available imu drivers
+		${sitl_bus_sim_drivers}
 		#magnetometer # all available magnetometer drivers
 		pwm_out_sim
 		rpm/rpm_simulator
@@ -55,6 +60,7 @@ px4_add_board(
 		vmount
 		vtol_att_control
 	SYSTEMCMDS
+		bus_sim
 		#dumpfile
 		dyn
 		esc_calib
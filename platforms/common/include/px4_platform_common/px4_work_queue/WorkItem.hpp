@@ -39,9 +39,11 @@
 #include <containers/IntrusiveQueue.hpp>
 #include <containers/IntrusiveSortedList.hpp>
 #include <px4_platform_common/defines.h>
+#include <px4_platform_common/vehicle_context.h>
 #include <drivers/drv_hrt.h>
 #include <lib/mathlib/mathlib.h>
 #include <lib/perf/perf_counter.h>
+#include <lib/perf/perf_trace.h>
 
 #include <string.h>
 
@@ -83,6 +85,12 @@ public:
 
 	const char *ItemName() const { return _item_name; }
 
+	/** id of the item name for tracing (see lib/perf/perf_trace.h) */
+	uint16_t TraceId() const { return _trace_id; }
+
+	/** vehicle context the item was constructed in, the work queue switches to it before Run() */
+	uint8_t VehicleContext() const { return _vehicle_context; }
+
 protected:
 
 	explicit WorkItem(const char *name, const wq_config_t &config);
@@ -129,6 +137,8 @@ protected:
 	hrt_abstime	_time_first_run{0};
 	const char 	*_item_name;
 	uint32_t	_run_count{0};
+	const uint16_t	_trace_id;
+	const uint8_t	_vehicle_context{px4::vehicle_context()};
 
 private:
 
@@ -69,6 +69,17 @@ public:
 
 	void Run();
 
+	/**
+	 * @return true if no work item is queued or running
+	 */
+	bool Idle();
+
+	/**
+	 * Number of work items added to any work queue so far. Used to detect work moving between queues
+	 * while they are checked one after another.
+	 */
+	static uint32_t num_added() { return _num_added.load(); }
+
 	void request_stop() { _should_exit.store(true); }
 
 	void print_status(bool last = false);
@@ -99,6 +110,9 @@ private:
 	const wq_config_t		&_config;
 	BlockingList<WorkItem *>	_work_items;
 	px4::atomic_bool		_should_exit{false};
+	bool				_running{false}; ///< true while processing work items (protected by the work lock)
+
+	static px4::atomic<uint32_t>	_num_added;
 
 };
 
@@ -109,6 +109,11 @@ int WorkQueueManagerStop();
  */
 int WorkQueueManagerStatus();
 
+/**
+ * Check if all work queues are idle (no work item queued or running).
+ */
+bool WorkQueueManagerIdle();
+
 /**
  * Create (or find) a work queue with a particular configuration.
  *
@@ -0,0 +1,118 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file vehicle_context.h
+ *
+ * Vehicle context of the calling thread. Several simulated vehicles can run in
+ * one posix process: each context has its own uORB topic namespace and its own
+ * parameter values, while all contexts share the work queue threads.
+ *
+ * A task inherits the context of the thread that spawns it, a work item runs in
+ * the context it was constructed in. uORB subscriptions and publications bind to
+ * the topic of the context they first subscribe or advertise in. Context 0 is the
+ * default and the only one on targets other than posix.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT) && !defined(CONFIG_SHMEM)
+#define PX4_VEHICLE_CONTEXTS_MAX 64
+#else
+#define PX4_VEHICLE_CONTEXTS_MAX 1
+#endif
+
+#ifdef __cplusplus
+
+namespace px4
+{
+
+#if PX4_VEHICLE_CONTEXTS_MAX > 1
+
+namespace internal
+{
+inline uint8_t &vehicle_context_storage()
+{
+	static thread_local uint8_t context{0};
+	return context;
+}
+} // namespace internal
+
+/**
+ * Get the vehicle context of the calling thread
+ */
+inline uint8_t vehicle_context() { return internal::vehicle_context_storage(); }
+
+/**
+ * Set the vehicle context of the calling thread
+ * @param context [0, PX4_VEHICLE_CONTEXTS_MAX)
+ * @return false if the context is out of range (the current context is kept)
+ */
+inline bool set_vehicle_context(uint8_t context)
+{
+	if (context >= PX4_VEHICLE_CONTEXTS_MAX) {
+		return false;
+	}
+
+	internal::vehicle_context_storage() = context;
+	return true;
+}
+
+#else
+
+inline uint8_t vehicle_context() { return 0; }
+inline bool set_vehicle_context(uint8_t context) { return context == 0; }
+
+#endif // PX4_VEHICLE_CONTEXTS_MAX > 1
+
+/**
+ * Switch the calling thread to a vehicle context for the lifetime of the object
+ */
+class VehicleContextGuard
+{
+public:
+	explicit VehicleContextGuard(uint8_t context) : _previous(vehicle_context()) { set_vehicle_context(context); }
+	~VehicleContextGuard() { set_vehicle_context(_previous); }
+
+	VehicleContextGuard(const VehicleContextGuard &) = delete;
+	VehicleContextGuard &operator=(const VehicleContextGuard &) = delete;
+
+private:
+	const uint8_t _previous;
+};
+
+} // namespace px4
+
+#endif // __cplusplus
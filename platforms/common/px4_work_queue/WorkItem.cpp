@@ -43,7 +43,8 @@ namespace px4
 {
 
 WorkItem::WorkItem(const char *name, const wq_config_t &config) :
-	_item_name(name)
+	_item_name(name),
+	_trace_id(perf_trace_register(name))
 {
 	if (!Init(config)) {
 		PX4_ERR("init failed");
@@ -51,7 +52,9 @@ WorkItem::WorkItem(const char *name, const wq_config_t &config) :
 }
 
 WorkItem::WorkItem(const char *name, const WorkItem &work_item) :
-	_item_name(name)
+	_item_name(name),
+	_trace_id(perf_trace_register(name)),
+	_vehicle_context(work_item._vehicle_context)
 {
 	px4::WorkQueue *wq = work_item._wq;
 
@@ -43,6 +43,8 @@
 namespace px4
 {
 
+px4::atomic<uint32_t> WorkQueue::_num_added{0};
+
 WorkQueue::WorkQueue(const wq_config_t &config) :
 	_config(config)
 {
@@ -107,6 +109,7 @@ void WorkQueue::Add(WorkItem *item)
 {
 	work_lock();
 	_q.push(item);
+	_num_added.fetch_add(1);
 	work_unlock();
 
 	SignalWorkerThread();
@@ -150,20 +153,37 @@ void WorkQueue::Run()
 		// process queued work
 		while (!_q.empty()) {
 			WorkItem *work = _q.pop();
+			_running = true;
 
 			work_unlock(); // unlock work queue to run (item may requeue itself)
+			const uint16_t trace_id = work->TraceId();
+			perf_trace(PERF_TRACE_WORK_ITEM_BEGIN, trace_id, 0);
+			set_vehicle_context(work->VehicleContext());
 			work->RunPreamble();
 			work->Run();
 			// Note: after Run() we cannot access work anymore, as it might have been deleted
+			perf_trace(PERF_TRACE_WORK_ITEM_END, trace_id, 0);
 			work_lock(); // re-lock
 		}
 
+		_running = false;
 		work_unlock();
+
+		px4_lockstep_notify_idle();
 	}
 
 	PX4_DEBUG("%s: exiting", _config.name);
 }
 
+bool WorkQueue::Idle()
+{
+	work_lock();
+	const bool idle = _q.empty() && !_running;
+	work_unlock();
+
+	return idle;
+}
+
 void WorkQueue::print_status(bool last)
 {
 	const size_t num_items = _work_items.size();
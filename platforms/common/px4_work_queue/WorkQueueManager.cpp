@@ -434,4 +434,27 @@ WorkQueueManagerStatus()
 	return PX4_OK;
 }
 
+bool
+WorkQueueManagerIdle()
+{
+	if (_wq_manager_wqs_list == nullptr) {
+		return true;
+	}
+
+	const uint32_t num_added = WorkQueue::num_added();
+
+	{
+		LockGuard lg{_wq_manager_wqs_list->mutex()};
+
+		for (WorkQueue *wq : *_wq_manager_wqs_list) {
+			if (!wq->Idle()) {
+				return false;
+			}
+		}
+	}
+
+	// a work item that was added while checking could have moved to an already checked queue
+	return num_added == WorkQueue::num_added();
+}
+
 } // namespace px4
@@ -74,6 +74,9 @@ struct wqueue_s g_hrt_work;
  ****************************************************************************/
 px4_sem_t _hrt_work_lock;
 
+/* true while a worker is being executed (protected by _hrt_work_lock) */
+static bool _hrt_work_running = false;
+
 /****************************************************************************
  * Private Functions
  ****************************************************************************/
@@ -173,6 +176,7 @@ static void hrt_work_process()
 			 * performed... we don't have any idea how long that will take!
 			 */
 
+			_hrt_work_running = true;
 			hrt_work_unlock();
 
 			if (!worker) {
@@ -188,6 +192,7 @@ static void hrt_work_process()
 			 */
 
 			hrt_work_lock();
+			_hrt_work_running = false;
 			work  = (struct work_s *)wqueue->q.head;
 
 		} else {
@@ -217,6 +222,8 @@ static void hrt_work_process()
 	 */
 	hrt_work_unlock();
 
+	px4_lockstep_notify_idle();
+
 	/* might sleep less if a signal received and new item was queued */
 	//PX4_INFO("Sleeping for %u usec", next);
 	px4_usleep(next);
@@ -273,6 +280,50 @@ static int work_hrtthread(int argc, char *argv[])
  * Public Functions
  ****************************************************************************/
 
+/****************************************************************************
+ * Name: hrt_work_idle
+ *
+ * Description:
+ *   Check if the HRT work queue is idle, i.e. no work is being performed and
+ *   none of the queued work is due. If there is due work, the worker thread
+ *   is woken up, in case it went to sleep just before the work was queued.
+ *
+ * Returned Value:
+ *   true if idle
+ *
+ ****************************************************************************/
+
+bool hrt_work_idle(void)
+{
+	struct wqueue_s *wqueue = &g_hrt_work;
+	volatile struct work_s *work;
+	bool idle = true;
+
+	hrt_work_lock();
+
+	if (_hrt_work_running) {
+		idle = false;
+
+	} else {
+		const uint64_t now = hrt_absolute_time();
+
+		for (work = (struct work_s *)wqueue->q.head; work; work = (struct work_s *)work->dq.flink) {
+			if (now - work->qtime >= work->delay) {
+				idle = false;
+#ifdef __PX4_QURT
+				px4_task_kill(wqueue->pid, SIGALRM);
+#else
+				px4_task_kill(wqueue->pid, SIGCONT);
+#endif
+				break;
+			}
+		}
+	}
+
+	hrt_work_unlock();
+	return idle;
+}
+
 void hrt_work_queue_init(void)
 {
 	px4_sem_init(&_hrt_work_lock, 0, 1);
@@ -34,6 +34,7 @@
 #include <px4_platform_common/log.h>
 #include <px4_platform_common/posix.h>
 #include <semaphore.h>
+#include <stdbool.h>
 #include <px4_platform_common/workqueue.h>
 
 #pragma once
@@ -46,6 +47,7 @@ extern struct wqueue_s g_hrt_work;
 void hrt_work_queue_init(void);
 int hrt_work_queue(struct work_s *work, worker_t worker, void *arg, uint32_t usdelay);
 void hrt_work_cancel(struct work_s *work);
+bool hrt_work_idle(void);
 
 static inline void hrt_work_lock(void);
 static inline void hrt_work_lock()
@@ -0,0 +1,394 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file VehicleContextTest.cpp
+ *
+ * Several vehicles in one process: checks that topics, parameters and work items
+ * stay within their vehicle context, and measures memory and wall time per vehicle.
+ */
+
+#include <gtest/gtest.h>
+
+#include <dirent.h>
+#include <malloc.h>
+#include <sched.h>
+
+#include <drivers/drv_hrt.h>
+#include <lib/parameters/param.h>
+#include <px4_platform_common/atomic.h>
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/px4_work_queue/WorkItem.hpp>
+#include <px4_platform_common/px4_work_queue/WorkQueueManager.hpp>
+#include <px4_platform_common/time.h>
+#include <px4_platform_common/vehicle_context.h>
+#include <uORB/Publication.hpp>
+#include <uORB/Subscription.hpp>
+#include <uORB/SubscriptionCallback.hpp>
+#include <uORB/topics/orb_test.h>
+#include <uORB/topics/orb_test_large.h>
+#include <uORB/topics/orb_test_medium.h>
+
+using namespace time_literals;
+
+static size_t heap_in_use()
+{
+#if defined(__GLIBC__) && __GLIBC_PREREQ(2, 33)
+	return mallinfo2().uordblks;
+#else
+	return 0; // not available
+#endif
+}
+
+static int thread_count()
+{
+	int count = 0;
+#ifdef __PX4_LINUX
+	DIR *dir = opendir("/proc/self/task");
+
+	if (dir != nullptr) {
+		struct dirent *entry;
+
+		while ((entry = readdir(dir)) != nullptr) {
+			if (entry->d_name[0] != '.') {
+				count++;
+			}
+		}
+
+		closedir(dir);
+	}
+
+#endif
+	return count;
+}
+
+// first stage of a benchmark vehicle: orb_test -> orb_test_medium
+class MediumStage : public px4::WorkItem
+{
+public:
+	MediumStage() : px4::WorkItem("vehicle_medium", px4::wq_configurations::test1) {}
+	~MediumStage() override { _sub.unregisterCallback(); }
+
+	bool Start() { return _sub.registerCallback(); }
+
+private:
+	void Run() override
+	{
+		orb_test_s in;
+
+		if (_sub.update(&in)) {
+			orb_test_medium_s out{};
+			out.val = in.val;
+			out.timestamp = hrt_absolute_time();
+			_pub.publish(out);
+		}
+	}
+
+	uORB::SubscriptionCallbackWorkItem _sub{this, ORB_ID(orb_test)};
+	uORB::Publication<orb_test_medium_s> _pub{ORB_ID(orb_test_medium)};
+};
+
+// second stage of a benchmark vehicle: orb_test_medium -> orb_test_large, counts the completed steps
+class LargeStage : public px4::WorkItem
+{
+public:
+	explicit LargeStage(px4::atomic_int &completed) :
+		px4::WorkItem("vehicle_large", px4::wq_configurations::test1),
+		_completed(completed)
+	{}
+	~LargeStage() override { _sub.unregisterCallback(); }
+
+	bool Start() { return _sub.registerCallback(); }
+
+	int last_val{-1};
+
+private:
+	void Run() override
+	{
+		orb_test_medium_s in;
+
+		if (_sub.update(&in)) {
+			orb_test_large_s out{};
+			out.val = in.val;
+			out.timestamp = hrt_absolute_time();
+			_pub.publish(out);
+
+			last_val = in.val;
+			_completed.fetch_add(1);
+		}
+	}
+
+	uORB::SubscriptionCallbackWorkItem _sub{this, ORB_ID(orb_test_medium)};
+	uORB::Publication<orb_test_large_s> _pub{ORB_ID(orb_test_large)};
+	px4::atomic_int &_completed;
+};
+
+struct Vehicle {
+	explicit Vehicle(px4::atomic_int &completed) : large(completed) {}
+
+	MediumStage medium;
+	LargeStage large;
+	uORB::Publication<orb_test_s> input{ORB_ID(orb_test)};
+};
+
+class VehicleContextTest : public ::testing::Test
+{
+public:
+	static void SetUpTestCase() { ASSERT_EQ(px4::WorkQueueManagerStart(), PX4_OK); }
+	static void TearDownTestCase() { px4::WorkQueueManagerStop(); }
+
+	void SetUp() override
+	{
+		param_control_autosave(false);
+	}
+
+	// all vehicles publish one input, returns false if not all of them processed it in time
+	static bool step(Vehicle **vehicles, uint8_t first_context, int num_vehicles, int val, px4::atomic_int &completed)
+	{
+		const int expected = completed.load() + num_vehicles;
+
+		for (int i = 0; i < num_vehicles; i++) {
+			px4::VehicleContextGuard guard(first_context + i);
+			orb_test_s input{};
+			input.val = val;
+			input.timestamp = hrt_absolute_time();
+			vehicles[i]->input.publish(input);
+		}
+
+		const hrt_abstime timeout = hrt_absolute_time() + 1_s;
+
+		while (completed.load() < expected) {
+			if (hrt_absolute_time() > timeout) {
+				return false;
+			}
+
+			sched_yield();
+		}
+
+		return true;
+	}
+
+	// N vehicles with a two stage pipeline each, all on the same work queue thread
+	static void benchmark(uint8_t first_context, int num_vehicles)
+	{
+		static constexpr int STEPS = 200;
+		px4::atomic_int completed{0};
+		Vehicle *vehicles[PX4_VEHICLE_CONTEXTS_MAX] {};
+
+		ASSERT_LE(first_context + num_vehicles, PX4_VEHICLE_CONTEXTS_MAX);
+
+		const int threads_before = thread_count();
+		const size_t heap_before = heap_in_use();
+
+		for (int i = 0; i < num_vehicles; i++) {
+			px4::VehicleContextGuard guard(first_context + i);
+			vehicles[i] = new Vehicle(completed);
+			ASSERT_TRUE(vehicles[i]->medium.Start());
+			ASSERT_TRUE(vehicles[i]->large.Start());
+		}
+
+		// the first step advertises the output topics of every vehicle
+		ASSERT_TRUE(step(vehicles, first_context, num_vehicles, 0, completed));
+
+		const size_t heap_after = heap_in_use();
+		const int threads_after = thread_count();
+
+		const hrt_abstime start = hrt_absolute_time();
+
+		for (int n = 1; n <= STEPS; n++) {
+			ASSERT_TRUE(step(vehicles, first_context, num_vehicles, n, completed));
+		}
+
+		const hrt_abstime elapsed = hrt_elapsed_time(&start);
+
+		for (int i = 0; i < num_vehicles; i++) {
+			EXPECT_EQ(vehicles[i]->large.last_val, STEPS);
+			delete vehicles[i];
+		}
+
+		const double bytes_per_vehicle = (double)(heap_after - heap_before) / num_vehicles;
+		const double us_per_vehicle_step = (double)elapsed / (STEPS * num_vehicles);
+
+		PX4_INFO("%2d vehicles: %6.0f bytes/vehicle (heap), %5.1f us/vehicle/step, %d threads",
+			 num_vehicles, (heap_before > 0) ? bytes_per_vehicle : -1., us_per_vehicle_step, threads_after);
+
+		// vehicles share the work queue thread
+		EXPECT_EQ(threads_after, threads_before);
+
+		// uORB nodes, queue buffers and work items only, the modules of a vehicle come on top
+		if (heap_before > 0) {
+			EXPECT_LT(bytes_per_vehicle, 32 * 1024);
+		}
+	}
+};
+
+TEST_F(VehicleContextTest, DefaultContext)
+{
+	EXPECT_EQ(px4::vehicle_context(), 0);
+
+	{
+		px4::VehicleContextGuard guard(5);
+		EXPECT_EQ(px4::vehicle_context(), 5);
+	}
+
+	EXPECT_EQ(px4::vehicle_context(), 0);
+
+	// out of range: the context is kept
+	EXPECT_FALSE(px4::set_vehicle_context(PX4_VEHICLE_CONTEXTS_MAX));
+	EXPECT_EQ(px4::vehicle_context(), 0);
+}
+
+TEST_F(VehicleContextTest, TopicsIsolated)
+{
+	// GIVEN: the same topic advertised in vehicle context 1 and 2, not in 0
+	uORB::Publication<orb_test_s> *pub[3] {};
+	uORB::Subscription *sub[3] {};
+
+	for (uint8_t context = 0; context < 3; context++) {
+		px4::VehicleContextGuard guard(context);
+		sub[context] = new uORB::Subscription{ORB_ID(orb_multitest)};
+
+		if (context > 0) {
+			orb_test_s data{};
+			data.val = context * 10;
+			pub[context] = new uORB::Publication<orb_test_s> {ORB_ID(orb_multitest)};
+			EXPECT_TRUE(pub[context]->publish(data));
+		}
+	}
+
+	// THEN: every vehicle only sees its own publication
+	for (uint8_t context = 0; context < 3; context++) {
+		px4::VehicleContextGuard guard(context);
+		orb_test_s data{};
+
+		if (context == 0) {
+			EXPECT_FALSE(sub[context]->update(&data));
+			EXPECT_FALSE(sub[context]->advertised());
+
+		} else {
+			EXPECT_TRUE(sub[context]->update(&data));
+			EXPECT_EQ(data.val, context * 10);
+			EXPECT_EQ(orb_exists(ORB_ID(orb_multitest), 0), PX4_OK);
+		}
+	}
+
+	EXPECT_NE(orb_exists(ORB_ID(orb_multitest), 0), PX4_OK);
+
+	for (uint8_t context = 0; context < 3; context++) {
+		px4::VehicleContextGuard guard(context);
+		delete sub[context];
+		delete pub[context];
+	}
+}
+
+TEST_F(VehicleContextTest, ParametersIsolated)
+{
+	const param_t param = param_find("CP_DIST");
+	ASSERT_NE(param, PARAM_INVALID);
+
+	float default_value = 0.f;
+	ASSERT_EQ(param_get(param, &default_value), PX4_OK);
+
+	// WHEN: vehicle 1 changes the parameter
+	{
+		px4::VehicleContextGuard guard(1);
+		const float value = default_value + 3.f;
+		EXPECT_EQ(param_set(param, &value), PX4_OK);
+	}
+
+	// THEN: only vehicle 1 sees the new value
+	float value = 0.f;
+	EXPECT_EQ(param_get(param, &value), PX4_OK);
+	EXPECT_FLOAT_EQ(value, default_value);
+
+	{
+		px4::VehicleContextGuard guard(2);
+		EXPECT_EQ(param_get(param, &value), PX4_OK);
+		EXPECT_FLOAT_EQ(value, default_value);
+	}
+
+	{
+		px4::VehicleContextGuard guard(1);
+		EXPECT_EQ(param_get(param, &value), PX4_OK);
+		EXPECT_FLOAT_EQ(value, default_value + 3.f);
+
+		param_reset_all();
+		EXPECT_EQ(param_get(param, &value), PX4_OK);
+		EXPECT_FLOAT_EQ(value, default_value);
+	}
+}
+
+class ContextItem : public px4::WorkItem
+{
+public:
+	explicit ContextItem(const px4::wq_config_t &config) : px4::WorkItem("context_item", config) {}
+
+	void Run() override { context.store(px4::vehicle_context()); }
+
+	px4::atomic_int context{-1};
+};
+
+TEST_F(VehicleContextTest, WorkItemRunsInItsContext)
+{
+	ContextItem *item = nullptr;
+
+	{
+		px4::VehicleContextGuard guard(7);
+		item = new ContextItem(px4::wq_configurations::test2);
+	}
+
+	// WHEN: scheduled from vehicle context 0
+	EXPECT_EQ(item->VehicleContext(), 7);
+	item->ScheduleNow();
+
+	const hrt_abstime timeout = hrt_absolute_time() + 1_s;
+
+	while (item->context.load() < 0 && hrt_absolute_time() < timeout) {
+		px4_usleep(1000);
+	}
+
+	// THEN: the work queue runs it in vehicle context 7
+	EXPECT_EQ(item->context.load(), 7);
+	delete item;
+}
+
+TEST_F(VehicleContextTest, Benchmark)
+{
+	// keeps the work queue thread of the vehicles running between the runs
+	ContextItem work_queue_user(px4::wq_configurations::test1);
+
+	// a separate range of contexts per run, so every run creates its topics
+	benchmark(1, 1);
+	benchmark(2, 10);
+	benchmark(12, 50);
+}
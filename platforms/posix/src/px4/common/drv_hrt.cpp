@@ -52,6 +52,8 @@
 
 #if defined(ENABLE_LOCKSTEP_SCHEDULER)
 #include <lockstep_scheduler/lockstep_scheduler.h>
+#include <px4_platform_common/px4_work_queue/WorkQueueManager.hpp>
+#include <px4_platform_common/atomic.h>
 #endif
 
 // Intervals in usec
@@ -601,4 +603,60 @@ void px4_lockstep_wait_for_components()
 {
 	lockstep_scheduler->components().wait_for_components();
 }
+
+static pthread_mutex_t lockstep_idle_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t lockstep_idle_cond = PTHREAD_COND_INITIALIZER;
+static px4::atomic<int> lockstep_idle_waiters{0};
+
+void px4_lockstep_notify_idle()
+{
+	// the work queues go idle all the time, only take the lock if someone is waiting
+	if (lockstep_idle_waiters.load() > 0) {
+		pthread_mutex_lock(&lockstep_idle_mutex);
+		pthread_cond_broadcast(&lockstep_idle_cond);
+		pthread_mutex_unlock(&lockstep_idle_mutex);
+	}
+}
+
+int px4_lockstep_wait_for_idle()
+{
+	// HRT work only becomes due when the time advances (work items schedule at least HRT_INTERVAL_MIN
+	// ahead), so once the HRT queue is idle, it's enough to let the work queues settle.
+	// bound the wait in wall clock time (lockstep time doesn't advance while waiting), so that a work item
+	// that keeps rescheduling itself cannot stall the caller forever
+	static constexpr uint64_t TIMEOUT_US = 1000000;
+
+	// the idle checks are repeated at least this often, as hrt_work_idle() also wakes up the HRT thread
+	// if it overslept due work
+	static constexpr uint64_t RECHECK_US = 1000;
+
+	struct timespec ts;
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	const uint64_t start_us = ts_to_abstime(&ts);
+	int ret = PX4_OK;
+
+	// register before checking, so that an idle transition after the check cannot be missed
+	lockstep_idle_waiters.fetch_add(1);
+	pthread_mutex_lock(&lockstep_idle_mutex);
+
+	while (!hrt_work_idle() || !px4::WorkQueueManagerIdle()) {
+		system_clock_gettime(CLOCK_MONOTONIC, &ts);
+
+		if (ts_to_abstime(&ts) - start_us > TIMEOUT_US) {
+			PX4_ERR("lockstep wait for idle timed out");
+			ret = PX4_ERROR;
+			break;
+		}
+
+		// pthread_cond_timedwait() uses CLOCK_REALTIME
+		system_clock_gettime(CLOCK_REALTIME, &ts);
+		abstime_to_ts(&ts, ts_to_abstime(&ts) + RECHECK_US);
+		pthread_cond_timedwait(&lockstep_idle_cond, &lockstep_idle_mutex, &ts);
+	}
+
+	pthread_mutex_unlock(&lockstep_idle_mutex);
+	lockstep_idle_waiters.fetch_sub(1);
+
+	return ret;
+}
 #endif
@@ -73,11 +73,10 @@ private:
 				done = true;
 			}
 
-			// If a thread quickly exits after a cond_timedwait(), the
-			// thread_local object can still be in the linked list. In that case
-			// we need to wait until it's removed.
-			while (!removed) {
-				system_usleep(5000);
+			// If a thread exits after a cond_timedwait() that did not time out, the thread_local object
+			// is still in the heap (it is only removed lazily when the deadline passes), so remove it here.
+			if (!removed && scheduler) {
+				scheduler->remove_timed_wait(this);
 			}
 		}
 
@@ -88,14 +87,25 @@ private:
 		std::atomic<bool> done{false};
 		std::atomic<bool> removed{true};
 
-		TimedWait *next{nullptr}; ///< linked list
+		LockstepScheduler *scheduler{nullptr};
+		size_t heap_index{0}; ///< position in _timed_waits (valid if !removed)
 	};
 
+	// min-heap on TimedWait::time_us, all protected by _timed_waits_mutex
+	bool heap_less(size_t a, size_t b) const { return _timed_waits[a]->time_us < _timed_waits[b]->time_us; }
+	void heap_swap(size_t a, size_t b);
+	void heap_sift_up(size_t index);
+	void heap_sift_down(size_t index);
+	void heap_push(TimedWait *timed_wait);
+	void heap_remove(size_t index);
+
+	void remove_timed_wait(TimedWait *timed_wait);
+
 	LockstepComponents _components;
 
 	std::atomic<uint64_t> _time_us{0};
 
-	TimedWait *_timed_waits{nullptr}; ///< head of linked list
+	std::vector<TimedWait *> _timed_waits; ///< min-heap ordered by deadline
 	std::mutex _timed_waits_mutex;
 	std::atomic<bool> _setting_time{false}; ///< true if set_absolute_time() is currently being executed
 };
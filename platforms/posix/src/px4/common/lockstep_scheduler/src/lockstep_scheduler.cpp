@@ -35,13 +35,100 @@
 
 LockstepScheduler::~LockstepScheduler()
 {
-	// cleanup the linked list
+	// cleanup the heap
 	std::unique_lock<std::mutex> lock_timed_waits(_timed_waits_mutex);
 
-	while (_timed_waits) {
-		TimedWait *tmp = _timed_waits;
-		_timed_waits = _timed_waits->next;
-		tmp->removed = true;
+	for (TimedWait *timed_wait : _timed_waits) {
+		timed_wait->removed = true;
+	}
+
+	_timed_waits.clear();
+}
+
+void LockstepScheduler::heap_swap(size_t a, size_t b)
+{
+	TimedWait *tmp = _timed_waits[a];
+	_timed_waits[a] = _timed_waits[b];
+	_timed_waits[b] = tmp;
+	_timed_waits[a]->heap_index = a;
+	_timed_waits[b]->heap_index = b;
+}
+
+void LockstepScheduler::heap_sift_up(size_t index)
+{
+	while (index > 0) {
+		const size_t parent = (index - 1) / 2;
+
+		if (!heap_less(index, parent)) {
+			break;
+		}
+
+		heap_swap(index, parent);
+		index = parent;
+	}
+}
+
+void LockstepScheduler::heap_sift_down(size_t index)
+{
+	const size_t size = _timed_waits.size();
+
+	while (true) {
+		const size_t left = 2 * index + 1;
+		const size_t right = left + 1;
+		size_t smallest = index;
+
+		if (left < size && heap_less(left, smallest)) {
+			smallest = left;
+		}
+
+		if (right < size && heap_less(right, smallest)) {
+			smallest = right;
+		}
+
+		if (smallest == index) {
+			break;
+		}
+
+		heap_swap(index, smallest);
+		index = smallest;
+	}
+}
+
+void LockstepScheduler::heap_push(TimedWait *timed_wait)
+{
+	timed_wait->heap_index = _timed_waits.size();
+	timed_wait->removed = false;
+	_timed_waits.push_back(timed_wait);
+	heap_sift_up(timed_wait->heap_index);
+}
+
+void LockstepScheduler::heap_remove(size_t index)
+{
+	TimedWait *timed_wait = _timed_waits[index];
+	const size_t last = _timed_waits.size() - 1;
+
+	if (index != last) {
+		heap_swap(index, last);
+	}
+
+	_timed_waits.pop_back();
+
+	if (index != last) {
+		// the element moved into the gap can go either way
+		TimedWait *moved = _timed_waits[index];
+		heap_sift_up(index);
+		heap_sift_down(moved->heap_index);
+	}
+
+	timed_wait->removed = true;
+}
+
+void LockstepScheduler::remove_timed_wait(TimedWait *timed_wait)
+{
+	std::lock_guard<std::mutex> lock_timed_waits(_timed_waits_mutex);
+
+	if (!timed_wait->removed) {
+		heap_remove(timed_wait->heap_index);
 	}
 }
 
@@ -53,28 +140,12 @@ void LockstepScheduler::set_absolute_time(uint64_t time_us)
 		std::unique_lock<std::mutex> lock_timed_waits(_timed_waits_mutex);
 		_setting_time = true;
 
-		TimedWait *timed_wait = _timed_waits;
-		TimedWait *timed_wait_prev = nullptr;
-
-		while (timed_wait) {
-			// Clean up the ones that are already done from last iteration.
-			if (timed_wait->done) {
-				// Erase from the linked list
-				if (timed_wait_prev) {
-					timed_wait_prev->next = timed_wait->next;
-
-				} else {
-					_timed_waits = timed_wait->next;
-				}
+		// Only the waits that passed their deadline are touched. Waits that already returned
+		// (the condition was signalled before the timeout) are removed here lazily as well.
+		while (!_timed_waits.empty() && _timed_waits[0]->time_us <= time_us) {
+			TimedWait *timed_wait = _timed_waits[0];
 
-				TimedWait *tmp = timed_wait;
-				timed_wait = timed_wait->next;
-				tmp->removed = true;
-				continue;
-			}
-
-			if (timed_wait->time_us <= time_us &&
-			    !timed_wait->timeout) {
+			if (!timed_wait->done) {
 				// We are abusing the condition here to signal that the time
 				// has passed.
 				pthread_mutex_lock(timed_wait->passed_lock);
@@ -83,8 +154,7 @@ void LockstepScheduler::set_absolute_time(uint64_t time_us)
 				pthread_mutex_unlock(timed_wait->passed_lock);
 			}
 
-			timed_wait_prev = timed_wait;
-			timed_wait = timed_wait->next;
+			heap_remove(0);
 		}
 
 		_setting_time = false;
@@ -93,7 +163,7 @@ void LockstepScheduler::set_absolute_time(uint64_t time_us)
 
 int LockstepScheduler::cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *lock, uint64_t time_us)
 {
-	// A TimedWait object might still be in timed_waits_ after we return, so its lifetime needs to be
+	// A TimedWait object might still be in _timed_waits after we return, so its lifetime needs to be
 	// longer. And using thread_local is more efficient than malloc.
 	static thread_local TimedWait timed_wait;
 	{
@@ -104,17 +174,27 @@ int LockstepScheduler::cond_timedwait(pthread_cond_t *cond, pthread_mutex_t *loc
 			return ETIMEDOUT;
 		}
 
-		timed_wait.time_us = time_us;
 		timed_wait.passed_cond = cond;
 		timed_wait.passed_lock = lock;
 		timed_wait.timeout = false;
 		timed_wait.done = false;
+		timed_wait.scheduler = this;
 
-		// Add to linked list if not removed yet (otherwise just re-use the object)
+		// Add to the heap if not removed yet (otherwise just re-use the object and update its position)
 		if (timed_wait.removed) {
-			timed_wait.removed = false;
-			timed_wait.next = _timed_waits;
-			_timed_waits = &timed_wait;
+			timed_wait.time_us = time_us;
+			heap_push(&timed_wait);
+
+		} else {
+			const uint64_t previous_time_us = timed_wait.time_us;
+			timed_wait.time_us = time_us;
+
+			if (time_us < previous_time_us) {
+				heap_sift_up(timed_wait.heap_index);
+
+			} else {
+				heap_sift_down(timed_wait.heap_index);
+			}
 		}
 	}
 
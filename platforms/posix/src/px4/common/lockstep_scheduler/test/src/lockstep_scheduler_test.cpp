@@ -318,3 +318,89 @@ TEST(LockstepScheduler, All)
 		test_multiple_semaphores_waiting();
 	}
 }
+
+// Cost of set_absolute_time() with many threads waiting for a deadline far in the future (e.g. tasks with long
+// timeouts) and a few periodic ones, as in SITL with a 4 ms simulation step.
+struct ScalingResult {
+	double step_us; ///< wall time per set_absolute_time() call
+	int early_wakeups; ///< idle waiters that returned before their deadline
+};
+
+ScalingResult benchmark_set_absolute_time(int num_idle_waiters)
+{
+	static constexpr int num_periodic_waiters = 4;
+	static constexpr uint64_t step_us = 4000;
+	static constexpr int num_steps = 2000;
+	const uint64_t far_future_us = some_time_us + 1000000000;
+
+	LockstepScheduler ls;
+	ls.set_absolute_time(some_time_us);
+
+	std::atomic<int> num_started{0};
+	std::atomic<int> early_wakeups{0};
+	std::atomic<bool> should_exit{false};
+	std::vector<std::shared_ptr<TestThread>> threads;
+
+	for (int i = 0; i < num_idle_waiters; ++i) {
+		threads.push_back(std::make_shared<TestThread>([&]() {
+			++num_started;
+			ls.usleep_until(far_future_us);
+
+			if (ls.get_absolute_time() < far_future_us) {
+				++early_wakeups;
+			}
+		}));
+	}
+
+	for (int i = 0; i < num_periodic_waiters; ++i) {
+		const uint64_t period_us = 1000 * (i + 1);
+
+		threads.push_back(std::make_shared<TestThread>([&, period_us]() {
+			++num_started;
+			uint64_t next_us = some_time_us + period_us;
+
+			while (!should_exit) {
+				ls.usleep_until(next_us);
+				next_us += period_us;
+			}
+		}));
+	}
+
+	WAIT_FOR(num_started == num_idle_waiters + num_periodic_waiters);
+	std::this_thread::sleep_for(std::chrono::milliseconds(20)); // let all threads get into their wait
+
+	const auto start = std::chrono::steady_clock::now();
+
+	for (int step = 1; step <= num_steps; ++step) {
+		ls.set_absolute_time(some_time_us + step * step_us);
+	}
+
+	const auto elapsed = std::chrono::steady_clock::now() - start;
+
+	should_exit = true;
+	ls.set_absolute_time(far_future_us);
+
+	for (auto &thread : threads) {
+		thread->join(ls);
+	}
+
+	return ScalingResult{std::chrono::duration<double, std::micro>(elapsed).count() / num_steps, early_wakeups};
+}
+
+TEST(LockstepScheduler, Scaling)
+{
+	const ScalingResult baseline = benchmark_set_absolute_time(0);
+	std::cout << "set_absolute_time() with 0 idle waiters: " << baseline.step_us << " us/step\n";
+
+	for (int num_idle_waiters : {10, 100, 500}) {
+		const ScalingResult result = benchmark_set_absolute_time(num_idle_waiters);
+		std::cout << "set_absolute_time() with " << num_idle_waiters << " idle waiters: "
+			  << result.step_us << " us/step\n";
+
+		EXPECT_EQ(result.early_wakeups, 0);
+
+		// idle waiters stay in the heap and are not touched by a step, the periodic ones dominate.
+		// The absolute slack covers scheduling noise when the baseline is only a few us.
+		EXPECT_LT(result.step_us, 5. * baseline.step_us + 2.);
+	}
+}
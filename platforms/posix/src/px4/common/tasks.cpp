@@ -58,6 +58,7 @@
 
 #include <px4_platform_common/tasks.h>
 #include <px4_platform_common/posix.h>
+#include <px4_platform_common/vehicle_context.h>
 #include <systemlib/err.h>
 
 #define MAX_CMD_LEN 100
@@ -80,6 +81,7 @@ static task_entry taskmap[PX4_MAX_TASKS] = {};
 typedef struct {
 	px4_main_t entry;
 	char name[16]; //pthread_setname_np is restricted to 16 chars
+	uint8_t vehicle_context; // inherited from the spawning thread
 	int argc;
 	char *argv[];
 	// strings are allocated after the struct data
@@ -102,6 +104,8 @@ static void *entry_adapter(void *ptr)
 		PX4_ERR("px4_task_spawn_cmd: failed to set name of thread %d %d\n", rv, errno);
 	}
 
+	px4::set_vehicle_context(data->vehicle_context);
+
 	data->entry(data->argc, data->argv);
 	free(ptr);
 	PX4_DEBUG("Before px4_task_exit");
@@ -148,6 +152,7 @@ px4_task_t px4_task_spawn_cmd(const char *name, int scheduler, int priority, int
 	strncpy(taskdata->name, name, 16);
 	taskdata->name[15] = 0;
 	taskdata->entry = entry;
+	taskdata->vehicle_context = px4::vehicle_context();
 	taskdata->argc = argc;
 
 	for (i = 0; i < argc; i++) {
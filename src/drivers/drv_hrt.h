@@ -201,11 +201,25 @@ __EXPORT extern void px4_lockstep_unregister_component(int component);
 __EXPORT extern void px4_lockstep_progress(int component);
 __EXPORT extern void px4_lockstep_wait_for_components(void);
 
+/**
+ * Wait until the HRT and all work queues are idle, i.e. all work triggered up to the current
+ * (lockstep) time has been processed. Modules running in their own tasks are not covered.
+ * @return PX4_OK, or PX4_ERROR if the work did not settle within 1 s (wall clock)
+ */
+__EXPORT extern int px4_lockstep_wait_for_idle(void);
+
+/**
+ * Wake up px4_lockstep_wait_for_idle(). Called by the HRT and the work queue threads when they run out of work.
+ */
+__EXPORT extern void px4_lockstep_notify_idle(void);
+
 #else
 static inline int px4_lockstep_register_component(void) { return 0; }
 static inline void px4_lockstep_unregister_component(int component) { }
 static inline void px4_lockstep_progress(int component) { }
 static inline void px4_lockstep_wait_for_components(void) { }
+static inline int px4_lockstep_wait_for_idle(void) { return 0; }
+static inline void px4_lockstep_notify_idle(void) { }
 #endif /* defined(ENABLE_LOCKSTEP_SCHEDULER) */
 
 __END_DECLS
@@ -491,17 +491,11 @@ bool BMI088_Accelerometer::FIFORead(const hrt_abstime &timestamp_sample, uint8_t
 				// Acceleration sensor data frame
 				// Frame length: 7 bytes (1 byte header + 6 bytes payload)
 
-				FIFO::DATA *fifo_sample = (FIFO::DATA *)&data_buffer[fifo_buffer_index];
-				const int16_t accel_x = combine(fifo_sample->ACC_X_MSB, fifo_sample->ACC_X_LSB);
-				const int16_t accel_y = combine(fifo_sample->ACC_Y_MSB, fifo_sample->ACC_Y_LSB);
-				const int16_t accel_z = combine(fifo_sample->ACC_Z_MSB, fifo_sample->ACC_Z_LSB);
-
-				// sensor's frame is +x forward, +y left, +z up
-				//  flip y & z to publish right handed with z down (x forward, y right, z down)
-				accel.x[accel.samples] = accel_x;
-				accel.y[accel.samples] = (accel_y == INT16_MIN) ? INT16_MAX : -accel_y;
-				accel.z[accel.samples] = (accel_z == INT16_MIN) ? INT16_MAX : -accel_z;
-				accel.samples++;
+				const FIFO::DATA *fifo_sample = (const FIFO::DATA *)&data_buffer[fifo_buffer_index];
+
+				// sensor's frame is +x forward, +y left, +z up, published as x forward, y right, z down
+				accel.samples += imu_fifo::decode<FIFOAccel>(fifo_sample, 1, &accel.x[accel.samples], &accel.y[accel.samples],
+						 &accel.z[accel.samples]);
 
 				fifo_buffer_index += 7; // move forward to next record
 			}
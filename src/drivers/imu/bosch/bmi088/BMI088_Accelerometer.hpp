@@ -36,6 +36,7 @@
 #include "BMI088.hpp"
 
 #include <lib/drivers/accelerometer/PX4Accelerometer.hpp>
+#include <lib/drivers/imu_fifo/FIFODecoder.hpp>
 
 #include "Bosch_BMI088_Accelerometer_Registers.hpp"
 
@@ -61,6 +62,9 @@ private:
 
 	static constexpr uint32_t FIFO_MAX_SAMPLES{math::min(FIFO::SIZE / sizeof(FIFO::DATA), sizeof(sensor_accel_fifo_s::x) / sizeof(sensor_accel_fifo_s::x[0]))};
 
+	// FIFO sample layout
+	using FIFOAccel = imu_fifo::Vector3<FIFO::DATA, offsetof(FIFO::DATA, ACC_X_LSB), imu_fifo::ByteOrder::LittleEndian>;
+
 	// Transfer data
 	struct FIFOTransferBuffer {
 		uint8_t cmd{static_cast<uint8_t>(Register::FIFO_LENGTH_0) | DIR_READ};
@@ -583,18 +583,9 @@ bool ICM20602::ProcessAccel(const hrt_abstime &timestamp_sample, const FIFO::DAT
 		}
 	}
 
-	for (int i = accel_first_sample; i < samples; i = i + SAMPLES_PER_TRANSFER) {
-		int16_t accel_x = combine(fifo[i].ACCEL_XOUT_H, fifo[i].ACCEL_XOUT_L);
-		int16_t accel_y = combine(fifo[i].ACCEL_YOUT_H, fifo[i].ACCEL_YOUT_L);
-		int16_t accel_z = combine(fifo[i].ACCEL_ZOUT_H, fifo[i].ACCEL_ZOUT_L);
-
-		// sensor's frame is +x forward, +y left, +z up
-		//  flip y & z to publish right handed with z down (x forward, y right, z down)
-		accel.x[accel.samples] = accel_x;
-		accel.y[accel.samples] = (accel_y == INT16_MIN) ? INT16_MAX : -accel_y;
-		accel.z[accel.samples] = (accel_z == INT16_MIN) ? INT16_MAX : -accel_z;
-		accel.samples++;
-	}
+	// sensor's frame is +x forward, +y left, +z up, published as x forward, y right, z down
+	accel.samples = imu_fifo::decode<FIFOAccel>(fifo, samples, accel.x, accel.y, accel.z,
+			accel_first_sample, SAMPLES_PER_TRANSFER);
 
 	_px4_accel.set_error_count(perf_event_count(_bad_register_perf) + perf_event_count(_bad_transfer_perf) +
 				   perf_event_count(_fifo_empty_perf) + perf_event_count(_fifo_overflow_perf));
@@ -613,17 +604,8 @@ void ICM20602::ProcessGyro(const hrt_abstime &timestamp_sample, const FIFO::DATA
 	gyro.samples = samples;
 	gyro.dt = FIFO_SAMPLE_DT;
 
-	for (int i = 0; i < samples; i++) {
-		const int16_t gyro_x = combine(fifo[i].GYRO_XOUT_H, fifo[i].GYRO_XOUT_L);
-		const int16_t gyro_y = combine(fifo[i].GYRO_YOUT_H, fifo[i].GYRO_YOUT_L);
-		const int16_t gyro_z = combine(fifo[i].GYRO_ZOUT_H, fifo[i].GYRO_ZOUT_L);
-
-		// sensor's frame is +x forward, +y left, +z up
-		//  flip y & z to publish right handed with z down (x forward, y right, z down)
-		gyro.x[i] = gyro_x;
-		gyro.y[i] = (gyro_y == INT16_MIN) ? INT16_MAX : -gyro_y;
-		gyro.z[i] = (gyro_z == INT16_MIN) ? INT16_MAX : -gyro_z;
-	}
+	// sensor's frame is +x forward, +y left, +z up, published as x forward, y right, z down
+	imu_fifo::decode<FIFOGyro>(fifo, samples, gyro.x, gyro.y, gyro.z);
 
 	_px4_gyro.set_error_count(perf_event_count(_bad_register_perf) + perf_event_count(_bad_transfer_perf) +
 				  perf_event_count(_fifo_empty_perf) + perf_event_count(_fifo_overflow_perf));
@@ -633,23 +615,12 @@ void ICM20602::ProcessGyro(const hrt_abstime &timestamp_sample, const FIFO::DATA
 
 bool ICM20602::ProcessTemperature(const FIFO::DATA fifo[], const uint8_t samples)
 {
-	int16_t temperature[FIFO_MAX_SAMPLES];
-	float temperature_sum{0};
-
-	for (int i = 0; i < samples; i++) {
-		const int16_t t = combine(fifo[i].TEMP_OUT_H, fifo[i].TEMP_OUT_L);
-		temperature_sum += t;
-		temperature[i] = t;
-	}
+	float temperature_avg = 0.f;
 
-	const float temperature_avg = temperature_sum / samples;
-
-	for (int i = 0; i < samples; i++) {
-		// temperature changing wildly is an indication of a transfer error
-		if (fabsf(temperature[i] - temperature_avg) > 1000) {
-			perf_count(_bad_transfer_perf);
-			return false;
-		}
+	// temperature changing wildly is an indication of a transfer error
+	if (!imu_fifo::mean<FIFOTemperature>(fifo, samples, 1000.f, temperature_avg)) {
+		perf_count(_bad_transfer_perf);
+		return false;
 	}
 
 	// use average temperature reading
@@ -46,6 +46,7 @@
 #include <lib/drivers/accelerometer/PX4Accelerometer.hpp>
 #include <lib/drivers/device/spi.h>
 #include <lib/drivers/gyroscope/PX4Gyroscope.hpp>
+#include <lib/drivers/imu_fifo/FIFODecoder.hpp>
 #include <lib/ecl/geo/geo.h>
 #include <lib/perf/perf_counter.h>
 #include <px4_platform_common/atomic.h>
@@ -81,6 +82,11 @@ private:
 	// maximum FIFO samples per transfer is limited to the size of sensor_accel_fifo/sensor_gyro_fifo
 	static constexpr uint32_t FIFO_MAX_SAMPLES{math::min(math::min(FIFO::SIZE / sizeof(FIFO::DATA), sizeof(sensor_gyro_fifo_s::x) / sizeof(sensor_gyro_fifo_s::x[0])), sizeof(sensor_accel_fifo_s::x) / sizeof(sensor_accel_fifo_s::x[0]) * (int)(GYRO_RATE / ACCEL_RATE))};
 
+	// FIFO sample layout
+	using FIFOAccel = imu_fifo::Vector3<FIFO::DATA, offsetof(FIFO::DATA, ACCEL_XOUT_H)>;
+	using FIFOGyro = imu_fifo::Vector3<FIFO::DATA, offsetof(FIFO::DATA, GYRO_XOUT_H)>;
+	using FIFOTemperature = imu_fifo::Scalar<FIFO::DATA, offsetof(FIFO::DATA, TEMP_OUT_H)>;
+
 	// Transfer data
 	struct FIFOTransferBuffer {
 		uint8_t cmd{static_cast<uint8_t>(Register::FIFO_COUNTH) | DIR_READ};
@@ -528,16 +528,8 @@ bool MPU6000::ProcessAccel(const hrt_abstime &timestamp_sample, const FIFO::DATA
 
 		// process every 8th sample
 		if (_fifo_accel_samples_count == SAMPLES_PER_TRANSFER) {
-			int16_t accel_x = combine(fifo[i].ACCEL_XOUT_H, fifo[i].ACCEL_XOUT_L);
-			int16_t accel_y = combine(fifo[i].ACCEL_YOUT_H, fifo[i].ACCEL_YOUT_L);
-			int16_t accel_z = combine(fifo[i].ACCEL_ZOUT_H, fifo[i].ACCEL_ZOUT_L);
-
-			// sensor's frame is +x forward, +y left, +z up
-			//  flip y & z to publish right handed with z down (x forward, y right, z down)
-			accel.x[accel.samples] = accel_x;
-			accel.y[accel.samples] = (accel_y == INT16_MIN) ? INT16_MAX : -accel_y;
-			accel.z[accel.samples] = (accel_z == INT16_MIN) ? INT16_MAX : -accel_z;
-			accel.samples++;
+			accel.samples += imu_fifo::decode<FIFOAccel>(&fifo[i], 1,
+						&accel.x[accel.samples], &accel.y[accel.samples], &accel.z[accel.samples]);
 
 		} else if (new_sample && (_fifo_accel_samples_count > 1)) {
 			// a new unique sample after fewer than 8 samples is an error
@@ -569,17 +561,8 @@ void MPU6000::ProcessGyro(const hrt_abstime &timestamp_sample, const FIFO::DATA
 	gyro.samples = samples;
 	gyro.dt = FIFO_SAMPLE_DT;
 
-	for (int i = 0; i < samples; i++) {
-		const int16_t gyro_x = combine(fifo[i].GYRO_XOUT_H, fifo[i].GYRO_XOUT_L);
-		const int16_t gyro_y = combine(fifo[i].GYRO_YOUT_H, fifo[i].GYRO_YOUT_L);
-		const int16_t gyro_z = combine(fifo[i].GYRO_ZOUT_H, fifo[i].GYRO_ZOUT_L);
-
-		// sensor's frame is +x forward, +y left, +z up
-		//  flip y & z to publish right handed with z down (x forward, y right, z down)
-		gyro.x[i] = gyro_x;
-		gyro.y[i] = (gyro_y == INT16_MIN) ? INT16_MAX : -gyro_y;
-		gyro.z[i] = (gyro_z == INT16_MIN) ? INT16_MAX : -gyro_z;
-	}
+	// sensor's frame is +x forward, +y left, +z up, published as x forward, y right, z down
+	imu_fifo::decode<FIFOGyro>(fifo, samples, gyro.x, gyro.y, gyro.z);
 
 	_px4_gyro.set_error_count(perf_event_count(_bad_register_perf) + perf_event_count(_bad_transfer_perf) +
 				  perf_event_count(_fifo_empty_perf) + perf_event_count(_fifo_overflow_perf));
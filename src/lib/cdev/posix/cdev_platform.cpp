@@ -39,6 +39,7 @@
 #include <px4_platform_common/log.h>
 #include <px4_platform_common/posix.h>
 #include <px4_platform_common/time.h>
+#include <px4_platform_common/vehicle_context.h>
 
 const cdev::px4_file_operations_t cdev::CDev::fops = {};
 
@@ -62,7 +63,8 @@ private:
 	px4_dev_t() = default;
 };
 
-static px4_dev_t *devmap[256] {};
+// every vehicle context registers its own set of uORB topic nodes
+static px4_dev_t *devmap[256 * PX4_VEHICLE_CONTEXTS_MAX] {};
 
 #define PX4_MAX_FD 256
 static cdev::file_t filemap[PX4_MAX_FD] {};
@@ -43,6 +43,7 @@
 #include "I2C.hpp"
 
 #include <nuttx/i2c/i2c_master.h>
+#include <lib/perf/perf_trace.h>
 
 namespace device
 {
@@ -205,7 +206,9 @@ I2C::transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const
 			return -EINVAL;
 		}
 
+		perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_I2C, get_device_id());
 		int ret_transfer = I2C_TRANSFER(_dev, &msgv[0], msgs);
+		perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_I2C, get_device_id());
 
 		if (ret_transfer != 0) {
 			DEVICE_DEBUG("I2C transfer failed, result %d", ret_transfer);
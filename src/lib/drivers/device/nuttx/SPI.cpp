@@ -49,6 +49,7 @@
 
 #include <px4_platform_common/px4_config.h>
 #include <nuttx/arch.h>
+#include <lib/perf/perf_trace.h>
 
 #ifndef CONFIG_SPI_EXCHANGE
 # error This driver requires CONFIG_SPI_EXCHANGE
@@ -169,7 +170,9 @@ SPI::_transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	SPI_SELECT(_dev, _device, true);
 
 	/* do the transfer */
+	perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_SPI, get_device_id());
 	SPI_EXCHANGE(_dev, send, recv, len);
+	perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_SPI, get_device_id());
 
 	/* and clean up */
 	SPI_SELECT(_dev, _device, false);
@@ -221,7 +224,9 @@ SPI::_transferhword(uint16_t *send, uint16_t *recv, unsigned len)
 	SPI_SELECT(_dev, _device, true);
 
 	/* do the transfer */
+	perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_SPI, get_device_id());
 	SPI_EXCHANGE(_dev, send, recv, len);
+	perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_SPI, get_device_id());
 
 	/* and clean up */
 	SPI_SELECT(_dev, _device, false);
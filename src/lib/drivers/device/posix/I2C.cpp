@@ -41,12 +41,15 @@
  */
 
 #include "I2C.hpp"
+#include "SimulatedDevice.hpp"
 
 #ifdef __PX4_LINUX
 
 #include <linux/i2c.h>
 #include <linux/i2c-dev.h>
 
+#include <lib/perf/perf_trace.h>
+
 namespace device
 {
 
@@ -73,15 +76,19 @@ I2C::init()
 {
 	int ret = PX4_ERROR;
 
-	// Open the actual I2C device
-	char dev_path[16] {};
-	snprintf(dev_path, sizeof(dev_path), "/dev/i2c-%i", get_device_bus());
-	_fd = ::open(dev_path, O_RDWR);
+	_simulated_device = SimulatedDevice::find(DeviceBusType_I2C, get_device_bus(), get_device_address());
 
-	if (_fd < 0) {
-		DEVICE_DEBUG("failed to init I2C");
-		ret = -ENOENT;
-		goto out;
+	if (_simulated_device == nullptr) {
+		// Open the actual I2C device
+		char dev_path[16] {};
+		snprintf(dev_path, sizeof(dev_path), "/dev/i2c-%i", get_device_bus());
+		_fd = ::open(dev_path, O_RDWR);
+
+		if (_fd < 0) {
+			DEVICE_DEBUG("failed to init I2C");
+			ret = -ENOENT;
+			goto out;
+		}
 	}
 
 	// call the probe function to check whether the device is present
@@ -119,6 +126,17 @@ I2C::transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const
 	int ret = PX4_ERROR;
 	unsigned retry_count = 0;
 
+	if (_simulated_device) {
+		if ((send_len == 0) && (recv_len == 0)) {
+			return -EINVAL;
+		}
+
+		perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_I2C, get_device_id());
+		ret = _simulated_device->transfer(send, send_len, recv, recv_len);
+		perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_I2C, get_device_id());
+		return ret;
+	}
+
 	if (_fd < 0) {
 		PX4_ERR("I2C device not opened");
 		return PX4_ERROR;
@@ -154,7 +172,9 @@ I2C::transfer(const uint8_t *send, const unsigned send_len, uint8_t *recv, const
 		packets.msgs  = msgv;
 		packets.nmsgs = msgs;
 
+		perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_I2C, get_device_id());
 		int ret_ioctl = ::ioctl(_fd, I2C_RDWR, (unsigned long)&packets);
+		perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_I2C, get_device_id());
 
 		if (ret_ioctl == -1) {
 			DEVICE_DEBUG("I2C transfer failed");
@@ -46,6 +46,8 @@
 namespace device __EXPORT
 {
 
+class SimulatedDevice;
+
 /**
  * Abstract class for character device on I2C
  */
@@ -105,6 +107,8 @@ protected:
 private:
 	int			_fd{-1};
 
+	SimulatedDevice		*_simulated_device{nullptr};	///< emulated device handling the transfers instead of i2c-dev
+
 };
 
 } // namespace device
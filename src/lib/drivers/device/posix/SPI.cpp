@@ -39,6 +39,7 @@
  */
 
 #include "SPI.hpp"
+#include "SimulatedDevice.hpp"
 
 #ifdef __PX4_LINUX
 
@@ -49,6 +50,7 @@
 #include <linux/spi/spidev.h>
 
 #include <px4_platform_common/px4_config.h>
+#include <lib/perf/perf_trace.h>
 
 namespace device
 {
@@ -77,15 +79,19 @@ SPI::~SPI()
 int
 SPI::init()
 {
-	// Open the actual SPI device
-	char dev_path[16];
-	snprintf(dev_path, sizeof(dev_path), "/dev/spidev%i.%i", get_device_bus(), PX4_SPI_DEV_ID(_device));
-	DEVICE_DEBUG("%s", dev_path);
-	_fd = ::open(dev_path, O_RDWR);
-
-	if (_fd < 0) {
-		PX4_ERR("could not open %s", dev_path);
-		return PX4_ERROR;
+	_simulated_device = SimulatedDevice::find(DeviceBusType_SPI, get_device_bus(), PX4_SPI_DEV_ID(_device));
+
+	if (_simulated_device == nullptr) {
+		// Open the actual SPI device
+		char dev_path[16];
+		snprintf(dev_path, sizeof(dev_path), "/dev/spidev%i.%i", get_device_bus(), PX4_SPI_DEV_ID(_device));
+		DEVICE_DEBUG("%s", dev_path);
+		_fd = ::open(dev_path, O_RDWR);
+
+		if (_fd < 0) {
+			PX4_ERR("could not open %s", dev_path);
+			return PX4_ERROR;
+		}
 	}
 
 	/* call the probe function to check whether the device is present */
@@ -117,6 +123,13 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 		return -EINVAL;
 	}
 
+	if (_simulated_device) {
+		perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_SPI, get_device_id());
+		const int ret = _simulated_device->transfer(send, recv, len);
+		perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_SPI, get_device_id());
+		return ret;
+	}
+
 	// set write mode of SPI
 	int result = ::ioctl(_fd, SPI_IOC_WR_MODE, &_mode);
 
@@ -133,7 +146,9 @@ SPI::transfer(uint8_t *send, uint8_t *recv, unsigned len)
 	spi_transfer.speed_hz = _frequency;
 	spi_transfer.bits_per_word = 8;
 
+	perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_SPI, get_device_id());
 	result = ::ioctl(_fd, SPI_IOC_MESSAGE(1), &spi_transfer);
+	perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_SPI, get_device_id());
 
 	if (result != (int)len) {
 		PX4_ERR("write failed. Reported %d bytes written (%s)", result, strerror(errno));
@@ -150,6 +165,11 @@ SPI::transferhword(uint16_t *send, uint16_t *recv, unsigned len)
 		return -EINVAL;
 	}
 
+	if (_simulated_device) {
+		// 16 bit transfers are not emulated
+		return -ENOTSUP;
+	}
+
 	// set write mode of SPI
 	int result = ::ioctl(_fd, SPI_IOC_WR_MODE, &_mode);
 
@@ -176,7 +196,9 @@ SPI::transferhword(uint16_t *send, uint16_t *recv, unsigned len)
 	//spi_transfer[0].delay_usecs = 10;
 	spi_transfer[0].cs_change = true;
 
+	perf_trace(PERF_TRACE_TRANSFER_BEGIN, DeviceBusType_SPI, get_device_id());
 	result = ::ioctl(_fd, SPI_IOC_MESSAGE(1), &spi_transfer);
+	perf_trace(PERF_TRACE_TRANSFER_END, DeviceBusType_SPI, get_device_id());
 
 	if (result != (int)(len * 2)) {
 		PX4_ERR("write failed. Reported %d bytes written (%s)", result, strerror(errno));
@@ -61,6 +61,8 @@ enum spi_mode_e {
 namespace device __EXPORT
 {
 
+class SimulatedDevice;
+
 /**
  * Abstract class for character device on SPI
  */
@@ -173,6 +175,8 @@ private:
 	uint32_t		_frequency;
 	int 			_fd{-1};
 
+	SimulatedDevice		*_simulated_device{nullptr};	/**< emulated device handling the transfers instead of spidev */
+
 	LockMode		_locking_mode{LOCK_THREADS};	/**< selected locking mode */
 
 protected:
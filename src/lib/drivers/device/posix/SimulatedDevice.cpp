@@ -0,0 +1,175 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SimulatedDevice.cpp
+ */
+
+#include "SimulatedDevice.hpp"
+
+#ifdef __PX4_LINUX
+
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/time.h>
+
+namespace device
+{
+
+SimulatedDevice *SimulatedDevice::_devices[MAX_DEVICES] {};
+pthread_mutex_t SimulatedDevice::_devices_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+SimulatedDevice::SimulatedDevice(Device::DeviceBusType bus_type, int bus, uint8_t address) :
+	_bus_type(bus_type),
+	_bus(bus),
+	_address(address)
+{
+}
+
+int SimulatedDevice::register_device()
+{
+	int ret = -ENOMEM;
+
+	pthread_mutex_lock(&_devices_mutex);
+
+	for (int i = 0; i < MAX_DEVICES; i++) {
+		if (_devices[i] == nullptr) {
+			_devices[i] = this;
+			ret = PX4_OK;
+			break;
+		}
+
+		if ((_devices[i]->_bus_type == _bus_type) && (_devices[i]->_bus == _bus) && (_devices[i]->_address == _address)) {
+			ret = -EEXIST;
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&_devices_mutex);
+
+	return ret;
+}
+
+SimulatedDevice *SimulatedDevice::find(Device::DeviceBusType bus_type, int bus, uint8_t address)
+{
+	SimulatedDevice *device = nullptr;
+
+	pthread_mutex_lock(&_devices_mutex);
+
+	for (int i = 0; i < MAX_DEVICES && _devices[i]; i++) {
+		if ((_devices[i]->_bus_type == bus_type) && (_devices[i]->_bus == bus) && (_devices[i]->_address == address)) {
+			device = _devices[i];
+			break;
+		}
+	}
+
+	pthread_mutex_unlock(&_devices_mutex);
+
+	return device;
+}
+
+int SimulatedDevice::transfer(const uint8_t *send, uint8_t *recv, unsigned len)
+{
+	lock();
+	const int ret = spi_transfer(send, recv, len);
+	_transfers++;
+	_transfer_bytes += len;
+
+	if (ret != PX4_OK) {
+		_transfer_errors++;
+	}
+
+	unlock();
+
+	simulate_latency(len);
+
+	return ret;
+}
+
+int SimulatedDevice::transfer(const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned recv_len)
+{
+	lock();
+	const int ret = i2c_transfer(send, send_len, recv, recv_len);
+	_transfers++;
+	_transfer_bytes += send_len + recv_len;
+
+	if (ret != PX4_OK) {
+		_transfer_errors++;
+	}
+
+	unlock();
+
+	// address byte for the write and the read part
+	simulate_latency(send_len + recv_len + ((send_len > 0) ? 1 : 0) + ((recv_len > 0) ? 1 : 0));
+
+	return ret;
+}
+
+void SimulatedDevice::set_transfer_latency(uint32_t overhead_us, uint32_t frequency)
+{
+	lock();
+	_overhead_us = overhead_us;
+	_frequency = frequency;
+	unlock();
+}
+
+void SimulatedDevice::simulate_latency(unsigned bytes)
+{
+	uint64_t latency_us = _overhead_us;
+
+	if (_frequency > 0) {
+		latency_us += (uint64_t)bytes * 8 * 1000000 / _frequency;
+	}
+
+	if (latency_us > 0) {
+		px4_usleep(latency_us);
+	}
+}
+
+void SimulatedDevice::print_status()
+{
+	lock();
+	PX4_INFO("%s bus %d, address 0x%02x: %u transfers (%u errors), %llu bytes",
+		 (_bus_type == Device::DeviceBusType_SPI) ? "SPI" : "I2C", _bus, _address,
+		 _transfers, _transfer_errors, (unsigned long long)_transfer_bytes);
+
+	if (_overhead_us > 0 || _frequency > 0) {
+		PX4_INFO("latency: %u us + %u Hz bus clock", _overhead_us, _frequency);
+	}
+
+	unlock();
+}
+
+} // namespace device
+
+#endif // __PX4_LINUX
@@ -0,0 +1,145 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SimulatedDevice.hpp
+ *
+ * Emulated SPI/I2C devices for the Linux bus backend.
+ *
+ * A simulated device registers itself for a bus and chip-select (SPI) or address (I2C).
+ * SPI::init() and I2C::init() check the registry first, and if a device is found, all transfers
+ * of the driver are handled by it instead of spidev/i2c-dev. This allows running unmodified
+ * drivers against an emulated register map (see the bus_sim command).
+ */
+
+#pragma once
+
+#include "../Device.hpp"
+
+#ifdef __PX4_LINUX
+
+#include <pthread.h>
+
+namespace device __EXPORT
+{
+
+class __EXPORT SimulatedDevice
+{
+public:
+	SimulatedDevice(Device::DeviceBusType bus_type, int bus, uint8_t address);
+	virtual ~SimulatedDevice() = default;
+
+	// no copy, assignment, move, move assignment
+	SimulatedDevice(const SimulatedDevice &) = delete;
+	SimulatedDevice &operator=(const SimulatedDevice &) = delete;
+	SimulatedDevice(SimulatedDevice &&) = delete;
+	SimulatedDevice &operator=(SimulatedDevice &&) = delete;
+
+	/**
+	 * Add the device to the registry. Drivers keep a reference once initialized,
+	 * so a registered device must not be deleted.
+	 *
+	 * @return PX4_OK, or -EEXIST/-ENOMEM if the slot is already taken or the registry is full
+	 */
+	int register_device();
+
+	/**
+	 * Find a registered device.
+	 *
+	 * @param address chip-select index (SPI) or bus address (I2C)
+	 * @return the device or nullptr
+	 */
+	static SimulatedDevice *find(Device::DeviceBusType bus_type, int bus, uint8_t address);
+
+	/**
+	 * Handle a full-duplex SPI transfer (called with the device lock held).
+	 * send and recv may point to the same buffer.
+	 */
+	virtual int spi_transfer(const uint8_t *send, uint8_t *recv, unsigned len) { return -ENODEV; }
+
+	/**
+	 * Handle an I2C write followed by a read (called with the device lock held).
+	 */
+	virtual int i2c_transfer(const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned recv_len) { return -ENODEV; }
+
+	/**
+	 * Entry points for the bus backend: serialize against other users and emulate the transfer time.
+	 */
+	int transfer(const uint8_t *send, uint8_t *recv, unsigned len);
+	int transfer(const uint8_t *send, unsigned send_len, uint8_t *recv, unsigned recv_len);
+
+	/**
+	 * Configure the emulated transfer latency: a fixed overhead per transfer (e.g. DMA setup and
+	 * chip-select timing) plus the time to clock all bytes out at the given bus frequency.
+	 * The calling thread sleeps for this time, as it would block on a real bus.
+	 *
+	 * @param overhead_us fixed time per transfer
+	 * @param frequency bus clock in Hz, 0 to disable the per-byte time
+	 */
+	void set_transfer_latency(uint32_t overhead_us, uint32_t frequency);
+
+	virtual void print_status();
+
+	Device::DeviceBusType bus_type() const { return _bus_type; }
+	int bus() const { return _bus; }
+	uint8_t address() const { return _address; }
+
+protected:
+	void lock() { pthread_mutex_lock(&_mutex); }
+	void unlock() { pthread_mutex_unlock(&_mutex); }
+
+private:
+	void simulate_latency(unsigned bytes);
+
+	static constexpr int MAX_DEVICES = 8;
+	static SimulatedDevice *_devices[MAX_DEVICES];
+	static pthread_mutex_t _devices_mutex;
+
+	const Device::DeviceBusType _bus_type;
+	const int _bus;
+	const uint8_t _address;
+
+	pthread_mutex_t _mutex = PTHREAD_MUTEX_INITIALIZER;
+
+	uint32_t _overhead_us{0};
+	uint32_t _frequency{0};
+
+	uint32_t _transfers{0};
+	uint64_t _transfer_bytes{0};
+	uint32_t _transfer_errors{0};
+};
+
+} // namespace device
+
+#endif // __PX4_LINUX
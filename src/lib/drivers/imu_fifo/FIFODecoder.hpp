@@ -0,0 +1,180 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file FIFODecoder.hpp
+ *
+ * Decoding of raw IMU FIFO samples into sensor_accel_fifo/sensor_gyro_fifo data.
+ *
+ * The layout of a FIFO sample is described at compile time (sample struct, byte offset of the
+ * x axis, byte order and alignment), so every driver gets a fully specialized loop without
+ * per-sample branches on the layout.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace imu_fifo
+{
+
+enum class ByteOrder : uint8_t {
+	BigEndian,	///< MSB first (InvenSense)
+	LittleEndian,	///< LSB first (Bosch, ST)
+};
+
+/**
+ * Read a 16 bit value from an unaligned address. Compilers turn this into a single halfword load
+ * plus byte swap (REV16 on ARM), which is why the layout is fixed at compile time.
+ */
+template <ByteOrder ORDER>
+static inline int16_t read16(const uint8_t *data)
+{
+	if (ORDER == ByteOrder::BigEndian) {
+		return (int16_t)((data[0] << 8) | data[1]);
+	}
+
+	return (int16_t)((data[1] << 8) | data[0]);
+}
+
+/**
+ * Location of a 3 axis vector (3 consecutive 16 bit values) in a FIFO sample.
+ *
+ * @tparam SAMPLE	FIFO sample struct (packed bytes)
+ * @tparam OFFSET	byte offset of the x axis within SAMPLE, e.g. offsetof(FIFO::DATA, GYRO_XOUT_H)
+ * @tparam ORDER	byte order of the values
+ * @tparam SHIFT	right shift for left aligned data with less than 16 bits (e.g. 4 for 12 bit data)
+ */
+template <typename SAMPLE, size_t OFFSET, ByteOrder ORDER = ByteOrder::BigEndian, uint8_t SHIFT = 0>
+struct Vector3 {
+	static_assert(OFFSET + 6 <= sizeof(SAMPLE), "vector exceeds FIFO sample");
+	static_assert(SHIFT < 16, "invalid shift");
+
+	using Sample = SAMPLE;
+
+	static inline void read(const SAMPLE &sample, int16_t &x, int16_t &y, int16_t &z)
+	{
+		const uint8_t *data = reinterpret_cast<const uint8_t *>(&sample) + OFFSET;
+
+		x = read16<ORDER>(data) >> SHIFT;
+		y = read16<ORDER>(data + 2) >> SHIFT;
+		z = read16<ORDER>(data + 4) >> SHIFT;
+	}
+};
+
+/**
+ * Location of a single 16 bit value (e.g. temperature) in a FIFO sample.
+ */
+template <typename SAMPLE, size_t OFFSET, ByteOrder ORDER = ByteOrder::BigEndian>
+struct Scalar {
+	static_assert(OFFSET + 2 <= sizeof(SAMPLE), "value exceeds FIFO sample");
+
+	using Sample = SAMPLE;
+
+	static inline int16_t read(const SAMPLE &sample)
+	{
+		return read16<ORDER>(reinterpret_cast<const uint8_t *>(&sample) + OFFSET);
+	}
+};
+
+/**
+ * Negate, saturating INT16_MIN to INT16_MAX.
+ */
+static inline constexpr int16_t negate(int16_t value)
+{
+	return (value == INT16_MIN) ? INT16_MAX : -value;
+}
+
+/**
+ * Decode FIFO samples from the sensor frame (+x forward, +y left, +z up) into the
+ * right handed frame with z down (x forward, y right, z down) by flipping y & z.
+ *
+ * @param fifo		FIFO samples
+ * @param samples	number of FIFO samples
+ * @param x, y, z	output arrays (sensor_accel_fifo_s/sensor_gyro_fifo_s x, y, z)
+ * @param first		first FIFO sample to decode
+ * @param stride	decode every stride-th FIFO sample (e.g. accel at half the gyro rate)
+ * @return		number of decoded samples
+ */
+template <typename VECTOR3>
+static inline int decode(const typename VECTOR3::Sample fifo[], int samples, int16_t x[], int16_t y[], int16_t z[],
+			 int first = 0, int stride = 1)
+{
+	int n = 0;
+
+	for (int i = first; i < samples; i += stride) {
+		int16_t sx, sy, sz;
+		VECTOR3::read(fifo[i], sx, sy, sz);
+
+		x[n] = sx;
+		y[n] = negate(sy);
+		z[n] = negate(sz);
+		n++;
+	}
+
+	return n;
+}
+
+/**
+ * Mean of a value over all FIFO samples, e.g. the temperature.
+ *
+ * @param max_deviation	maximum deviation of a single sample from the mean
+ * @return		false if a sample deviates more than max_deviation, which indicates a transfer error
+ */
+template <typename SCALAR>
+static inline bool mean(const typename SCALAR::Sample fifo[], int samples, float max_deviation, float &mean_out)
+{
+	if (samples <= 0) {
+		return false;
+	}
+
+	int32_t sum = 0;
+	int16_t min = INT16_MAX;
+	int16_t max = INT16_MIN;
+
+	for (int i = 0; i < samples; i++) {
+		const int16_t value = SCALAR::read(fifo[i]);
+		sum += value;
+		min = (value < min) ? value : min;
+		max = (value > max) ? value : max;
+	}
+
+	mean_out = (float)sum / samples;
+
+	// the sample furthest from the mean is either the minimum or the maximum
+	return (mean_out - min <= max_deviation) && (max - mean_out <= max_deviation);
+}
+
+} // namespace imu_fifo
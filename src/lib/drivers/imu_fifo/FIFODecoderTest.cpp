@@ -0,0 +1,187 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include "FIFODecoder.hpp"
+
+#include <stdlib.h>
+
+using namespace imu_fifo;
+
+namespace
+{
+
+// InvenSense ICM-20602 style: big endian accel, temperature, gyro
+struct SampleBE {
+	uint8_t ACCEL_XOUT_H;
+	uint8_t ACCEL_XOUT_L;
+	uint8_t ACCEL_YOUT_H;
+	uint8_t ACCEL_YOUT_L;
+	uint8_t ACCEL_ZOUT_H;
+	uint8_t ACCEL_ZOUT_L;
+	uint8_t TEMP_OUT_H;
+	uint8_t TEMP_OUT_L;
+	uint8_t GYRO_XOUT_H;
+	uint8_t GYRO_XOUT_L;
+	uint8_t GYRO_YOUT_H;
+	uint8_t GYRO_YOUT_L;
+	uint8_t GYRO_ZOUT_H;
+	uint8_t GYRO_ZOUT_L;
+};
+
+// Bosch style: little endian with a header byte
+struct SampleLE {
+	uint8_t header;
+	uint8_t X_LSB;
+	uint8_t X_MSB;
+	uint8_t Y_LSB;
+	uint8_t Y_MSB;
+	uint8_t Z_LSB;
+	uint8_t Z_MSB;
+};
+
+using AccelBE = Vector3<SampleBE, offsetof(SampleBE, ACCEL_XOUT_H)>;
+using GyroBE = Vector3<SampleBE, offsetof(SampleBE, GYRO_XOUT_H)>;
+using TempBE = Scalar<SampleBE, offsetof(SampleBE, TEMP_OUT_H)>;
+using VectorLE = Vector3<SampleLE, offsetof(SampleLE, X_LSB), ByteOrder::LittleEndian>;
+using VectorLE12 = Vector3<SampleLE, offsetof(SampleLE, X_LSB), ByteOrder::LittleEndian, 4>;
+
+int16_t combine(uint8_t msb, uint8_t lsb) { return (msb << 8u) | lsb; }
+
+// reference implementation as in the drivers
+int16_t flip(int16_t v) { return (v == INT16_MIN) ? INT16_MAX : -v; }
+
+template <typename T>
+void randomize(T samples[], int n)
+{
+	uint8_t *data = reinterpret_cast<uint8_t *>(samples);
+
+	for (size_t i = 0; i < n * sizeof(T); i++) {
+		data[i] = rand() & 0xFF;
+	}
+}
+
+} // namespace
+
+TEST(FIFODecoderTest, BigEndian)
+{
+	static constexpr int N = 32;
+	SampleBE fifo[N];
+	randomize(fifo, N);
+
+	// INT16_MIN and INT16_MAX
+	fifo[0].GYRO_YOUT_H = 0x80;
+	fifo[0].GYRO_YOUT_L = 0x00;
+	fifo[1].GYRO_ZOUT_H = 0x7F;
+	fifo[1].GYRO_ZOUT_L = 0xFF;
+
+	int16_t x[N], y[N], z[N];
+	EXPECT_EQ(decode<GyroBE>(fifo, N, x, y, z), N);
+
+	for (int i = 0; i < N; i++) {
+		EXPECT_EQ(x[i], combine(fifo[i].GYRO_XOUT_H, fifo[i].GYRO_XOUT_L));
+		EXPECT_EQ(y[i], flip(combine(fifo[i].GYRO_YOUT_H, fifo[i].GYRO_YOUT_L)));
+		EXPECT_EQ(z[i], flip(combine(fifo[i].GYRO_ZOUT_H, fifo[i].GYRO_ZOUT_L)));
+	}
+
+	EXPECT_EQ(y[0], INT16_MAX);
+	EXPECT_EQ(z[1], -INT16_MAX);
+}
+
+TEST(FIFODecoderTest, FirstAndStride)
+{
+	static constexpr int N = 31;
+	SampleBE fifo[N];
+	randomize(fifo, N);
+
+	int16_t x[N], y[N], z[N];
+	EXPECT_EQ(decode<AccelBE>(fifo, N, x, y, z, 1, 2), 15);
+
+	for (int i = 0; i < 15; i++) {
+		const SampleBE &f = fifo[1 + 2 * i];
+		EXPECT_EQ(x[i], combine(f.ACCEL_XOUT_H, f.ACCEL_XOUT_L));
+		EXPECT_EQ(y[i], flip(combine(f.ACCEL_YOUT_H, f.ACCEL_YOUT_L)));
+		EXPECT_EQ(z[i], flip(combine(f.ACCEL_ZOUT_H, f.ACCEL_ZOUT_L)));
+	}
+
+	EXPECT_EQ(decode<AccelBE>(fifo, N, x, y, z, 0, 2), 16);
+	EXPECT_EQ(decode<AccelBE>(fifo, 0, x, y, z), 0);
+}
+
+TEST(FIFODecoderTest, LittleEndian)
+{
+	static constexpr int N = 16;
+	SampleLE fifo[N];
+	randomize(fifo, N);
+
+	int16_t x[N], y[N], z[N];
+	EXPECT_EQ(decode<VectorLE>(fifo, N, x, y, z), N);
+
+	for (int i = 0; i < N; i++) {
+		EXPECT_EQ(x[i], combine(fifo[i].X_MSB, fifo[i].X_LSB));
+		EXPECT_EQ(y[i], flip(combine(fifo[i].Y_MSB, fifo[i].Y_LSB)));
+		EXPECT_EQ(z[i], flip(combine(fifo[i].Z_MSB, fifo[i].Z_LSB)));
+	}
+
+	// 12 bit left aligned
+	EXPECT_EQ(decode<VectorLE12>(fifo, N, x, y, z), N);
+
+	for (int i = 0; i < N; i++) {
+		EXPECT_EQ(x[i], combine(fifo[i].X_MSB, fifo[i].X_LSB) >> 4);
+		EXPECT_EQ(y[i], flip(combine(fifo[i].Y_MSB, fifo[i].Y_LSB) >> 4));
+		EXPECT_EQ(z[i], flip(combine(fifo[i].Z_MSB, fifo[i].Z_LSB) >> 4));
+	}
+}
+
+TEST(FIFODecoderTest, Mean)
+{
+	static constexpr int N = 8;
+	SampleBE fifo[N] {};
+
+	for (int i = 0; i < N; i++) {
+		const int16_t t = -1000 + i * 10;
+		fifo[i].TEMP_OUT_H = (uint16_t)t >> 8;
+		fifo[i].TEMP_OUT_L = (uint16_t)t & 0xFF;
+	}
+
+	float temperature = 0.f;
+	EXPECT_TRUE(mean<TempBE>(fifo, N, 1000.f, temperature));
+	EXPECT_FLOAT_EQ(temperature, -965.f);
+
+	// single corrupted sample
+	fifo[3].TEMP_OUT_H = 0x7F;
+	EXPECT_FALSE(mean<TempBE>(fifo, N, 1000.f, temperature));
+
+	EXPECT_FALSE(mean<TempBE>(fifo, 0, 1000.f, temperature));
+}
@@ -0,0 +1,365 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file BiquadFilterBank.hpp
+ *
+ * @brief Cascade of second order (biquad) filters applied to up to 4 axes at once
+ *
+ * The state and coefficients of all axes of a stage are stored next to each other, and the axes
+ * are processed together: as a 4 element SIMD vector where SSE or NEON is available, otherwise
+ * (e.g. Cortex-M) as independent scalar FPU instructions for the used axes. A block of samples
+ * is processed through all stages with the state kept in registers.
+ *
+ * Every stage is a Transposed Direct Form II biquad, the coefficients of an axis can be set
+ * individually (e.g. a different notch frequency per axis).
+ */
+
+#pragma once
+
+#include <float.h>
+#include <math.h>
+#include <string.h>
+
+#include <px4_platform_common/defines.h>
+
+namespace math
+{
+
+template<int AXES, int STAGES>
+class BiquadFilterBank
+{
+public:
+	static_assert((AXES >= 1) && (AXES <= 4), "1 to 4 axes supported");
+	static_assert(STAGES >= 1, "at least one stage required");
+
+	BiquadFilterBank()
+	{
+		for (int stage = 0; stage < STAGES; stage++) {
+			setPassThrough(stage);
+		}
+	}
+
+	~BiquadFilterBank() = default;
+
+	/**
+	 * Disable filtering for a stage (on all axes).
+	 */
+	void setPassThrough(int stage)
+	{
+		for (int axis = 0; axis < AXES; axis++) {
+			setCoefficients(stage, axis, 1.f, 0.f, 0.f, 0.f, 0.f);
+		}
+	}
+
+	/**
+	 * Set a stage (on all axes) to a 2nd order Butterworth low-pass, like LowPassFilter2p.
+	 * A cutoff frequency of 0 or above the Nyquist frequency disables the stage.
+	 */
+	void setLowPass(int stage, float sample_freq, float cutoff_freq)
+	{
+		for (int axis = 0; axis < AXES; axis++) {
+			setLowPass(stage, axis, sample_freq, cutoff_freq);
+		}
+	}
+
+	void setLowPass(int stage, int axis, float sample_freq, float cutoff_freq)
+	{
+		if ((cutoff_freq <= 0.f) || (cutoff_freq >= sample_freq / 2.f)) {
+			// no filtering
+			setCoefficients(stage, axis, 1.f, 0.f, 0.f, 0.f, 0.f);
+			return;
+		}
+
+		const float ohm = tanf(M_PI_F * cutoff_freq / sample_freq);
+		const float c = 1.f + 2.f * cosf(M_PI_F / 4.f) * ohm + ohm * ohm;
+
+		const float b0 = ohm * ohm / c;
+		const float a1 = 2.f * (ohm * ohm - 1.f) / c;
+		const float a2 = (1.f - 2.f * cosf(M_PI_F / 4.f) * ohm + ohm * ohm) / c;
+
+		setCoefficients(stage, axis, b0, 2.f * b0, b0, a1, a2);
+	}
+
+	/**
+	 * Set a stage (on all axes) to a notch filter, like NotchFilter.
+	 * A notch frequency of 0 or above the Nyquist frequency disables the stage, as does an invalid bandwidth
+	 * (not positive, not finite or above the Nyquist frequency).
+	 */
+	void setNotch(int stage, float sample_freq, float notch_freq, float bandwidth)
+	{
+		for (int axis = 0; axis < AXES; axis++) {
+			setNotch(stage, axis, sample_freq, notch_freq, bandwidth);
+		}
+	}
+
+	void setNotch(int stage, int axis, float sample_freq, float notch_freq, float bandwidth)
+	{
+		if ((notch_freq <= 0.f) || (notch_freq >= sample_freq / 2.f)
+		    || !(bandwidth > 0.f) || (bandwidth >= sample_freq / 2.f) || !PX4_ISFINITE(bandwidth)) {
+			// no filtering
+			setCoefficients(stage, axis, 1.f, 0.f, 0.f, 0.f, 0.f);
+			return;
+		}
+
+		const float alpha = tanf(M_PI_F * bandwidth / sample_freq);
+		const float beta = -cosf(2.f * M_PI_F * notch_freq / sample_freq);
+		const float a0_inv = 1.f / (alpha + 1.f);
+
+		const float b0 = a0_inv;
+		const float b1 = 2.f * beta * a0_inv;
+		const float a2 = (1.f - alpha) * a0_inv;
+
+		setCoefficients(stage, axis, b0, b1, b0, b1, a2);
+	}
+
+	/**
+	 * Set the (normalized, a0 = 1) coefficients of a stage for one axis. The filter state is kept.
+	 */
+	void setCoefficients(int stage, int axis, float b0, float b1, float b2, float a1, float a2)
+	{
+		if ((stage >= 0) && (stage < STAGES) && (axis >= 0) && (axis < AXES)) {
+			Stage &s = _stages[stage];
+			s.b0[axis] = b0;
+			s.b1[axis] = b1;
+			s.b2[axis] = b2;
+			s.a1[axis] = a1;
+			s.a2[axis] = a2;
+		}
+	}
+
+	/**
+	 * Reset the filter state to the steady state of a constant input.
+	 */
+	void reset(const float sample[AXES])
+	{
+		for (int axis = 0; axis < AXES; axis++) {
+			float x = sample[axis];
+
+			for (int stage = 0; stage < STAGES; stage++) {
+				Stage &s = _stages[stage];
+
+				// DC gain of the stage
+				const float den = 1.f + s.a1[axis] + s.a2[axis];
+				const float gain = (fabsf(den) > FLT_EPSILON) ? (s.b0[axis] + s.b1[axis] + s.b2[axis]) / den : 1.f;
+				const float y = PX4_ISFINITE(gain) ? x * gain : x;
+
+				s.z1[axis] = y - s.b0[axis] * x;
+				s.z2[axis] = s.b2[axis] * x - s.a2[axis] * y;
+
+				x = y;
+			}
+		}
+	}
+
+	/**
+	 * Filter a single sample (in place).
+	 */
+	void apply(float sample[AXES])
+	{
+		apply(reinterpret_cast<float(*)[AXES]>(sample), 1);
+	}
+
+	/**
+	 * Filter a block of interleaved samples (in place) through all stages.
+	 */
+	void apply(float samples[][AXES], int num_samples)
+	{
+		if (num_samples < 1) {
+			return;
+		}
+
+		// Transposed Direct Form II, state and coefficients stay in registers for the whole block
+		Vec b0[STAGES], b1[STAGES], b2[STAGES], a1[STAGES], a2[STAGES];
+		Vec z1[STAGES], z2[STAGES];
+
+		for (int stage = 0; stage < STAGES; stage++) {
+			const Stage &s = _stages[stage];
+			b0[stage] = load(s.b0);
+			b1[stage] = load(s.b1);
+			b2[stage] = load(s.b2);
+			a1[stage] = load(s.a1);
+			a2[stage] = load(s.a2);
+			z1[stage] = load(s.z1);
+			z2[stage] = load(s.z2);
+		}
+
+		Vec input{};
+		Vec x{};
+
+		for (int n = 0; n < num_samples; n++) {
+			input = loadSample(samples[n]);
+			x = input;
+
+			// unrolled to keep the state of all stages in registers
+#pragma GCC unroll 16
+			for (int stage = 0; stage < STAGES; stage++) {
+				const Vec y = b0[stage] * x + z1[stage];
+				z1[stage] = b1[stage] * x - a1[stage] * y + z2[stage];
+				z2[stage] = b2[stage] * x - a2[stage] * y;
+				x = y;
+			}
+
+			storeSample(samples[n], x);
+		}
+
+		for (int stage = 0; stage < STAGES; stage++) {
+			store(_stages[stage].z1, z1[stage]);
+			store(_stages[stage].z2, z2[stage]);
+		}
+
+		// don't allow bad values to propagate via the filter
+		bool finite = true;
+
+		for (int axis = 0; axis < AXES; axis++) {
+			finite = finite && PX4_ISFINITE(x[axis]);
+		}
+
+		if (!finite) {
+			// restart from the last input (or 0 if the input itself is invalid)
+			for (int axis = 0; axis < AXES; axis++) {
+				samples[num_samples - 1][axis] = PX4_ISFINITE(input[axis]) ? input[axis] : 0.f;
+			}
+
+			reset(samples[num_samples - 1]);
+		}
+	}
+
+private:
+#if defined(__SSE__) || defined(__ARM_NEON)
+	// 4 lanes (axes) in a SIMD register, a 3 axis filter leaves the last lane unused
+	static constexpr int LANES = 4;
+	typedef float Vec __attribute__((vector_size(LANES * sizeof(float))));
+
+	// lane of an axis, clamped to a valid index for unused lanes
+	static constexpr int lane(int axis) { return (axis < AXES) ? axis : (AXES - 1); }
+
+	// build the vector directly from the elements (a partial copy through memory stalls the store forwarding)
+	static inline Vec loadSample(const float sample[AXES])
+	{
+		return Vec{sample[0],
+			   (AXES > 1) ? sample[lane(1)] : 0.f,
+			   (AXES > 2) ? sample[lane(2)] : 0.f,
+			   (AXES > 3) ? sample[lane(3)] : 0.f};
+	}
+#else
+	// no SIMD (e.g. Cortex-M): only compute the used lanes, interleaved as independent FPU instructions
+	static constexpr int LANES = AXES;
+
+	struct Vec {
+		float v[LANES];
+
+		float &operator[](int i) { return v[i]; }
+		float operator[](int i) const { return v[i]; }
+
+		friend Vec operator+(const Vec &a, const Vec &b)
+		{
+			Vec r;
+
+			for (int i = 0; i < LANES; i++) {
+				r.v[i] = a.v[i] + b.v[i];
+			}
+
+			return r;
+		}
+
+		friend Vec operator-(const Vec &a, const Vec &b)
+		{
+			Vec r;
+
+			for (int i = 0; i < LANES; i++) {
+				r.v[i] = a.v[i] - b.v[i];
+			}
+
+			return r;
+		}
+
+		friend Vec operator*(const Vec &a, const Vec &b)
+		{
+			Vec r;
+
+			for (int i = 0; i < LANES; i++) {
+				r.v[i] = a.v[i] * b.v[i];
+			}
+
+			return r;
+		}
+	};
+
+	static inline Vec loadSample(const float sample[AXES])
+	{
+		Vec v;
+
+		for (int axis = 0; axis < AXES; axis++) {
+			v[axis] = sample[axis];
+		}
+
+		return v;
+	}
+#endif
+
+	struct Stage {
+		float b0[LANES];
+		float b1[LANES];
+		float b2[LANES];
+		float a1[LANES];
+		float a2[LANES];
+
+		float z1[LANES];
+		float z2[LANES];
+	};
+
+	static inline void storeSample(float sample[AXES], const Vec &v)
+	{
+		for (int axis = 0; axis < AXES; axis++) {
+			sample[axis] = v[axis];
+		}
+	}
+
+	// memcpy instead of a cast, as the arrays are only float aligned
+	static inline Vec load(const float src[LANES])
+	{
+		Vec v;
+		memcpy(&v, src, sizeof(v));
+		return v;
+	}
+
+	static inline void store(float dst[LANES], const Vec &v)
+	{
+		memcpy(dst, &v, sizeof(v));
+	}
+
+	Stage _stages[STAGES] {};
+};
+
+} // namespace math
@@ -0,0 +1,207 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * Test code for the biquad filter bank
+ * Run this test only using make tests TESTFILTER=BiquadFilterBank
+ */
+
+#include <gtest/gtest.h>
+
+#include "BiquadFilterBank.hpp"
+#include "LowPassFilter2p.hpp"
+#include "NotchFilter.hpp"
+
+using namespace math;
+
+class BiquadFilterBankTest : public ::testing::Test
+{
+public:
+	static constexpr int AXES = 3;
+	const float _sample_freq = 1000.f;
+	const float _notch_freq = 50.f;
+	const float _bandwidth = 15.f;
+	const float _cutoff_freq = 80.f;
+
+	float signal(int axis, int n) const
+	{
+		// a different sum of sines on every axis
+		const float t = n / _sample_freq;
+		return sinf(2.f * M_PI_F * (10.f + 20.f * axis) * t) + 0.5f * sinf(2.f * M_PI_F * _notch_freq * t) + axis;
+	}
+};
+
+TEST_F(BiquadFilterBankTest, matchesScalarFilters)
+{
+	BiquadFilterBank<AXES, 2> bank;
+	bank.setNotch(0, _sample_freq, _notch_freq, _bandwidth);
+	bank.setLowPass(1, _sample_freq, _cutoff_freq);
+
+	NotchFilter<float> notch[AXES] {};
+	LowPassFilter2p lpf[AXES] {{_sample_freq, _cutoff_freq}, {_sample_freq, _cutoff_freq}, {_sample_freq, _cutoff_freq}};
+
+	for (int axis = 0; axis < AXES; axis++) {
+		notch[axis].setParameters(_sample_freq, _notch_freq, _bandwidth);
+	}
+
+	// process in blocks of varying length
+	static constexpr int BLOCK_SIZE_MAX = 32;
+	float samples[BLOCK_SIZE_MAX][AXES];
+	int n = 0;
+
+	for (int block = 0; block < 50; block++) {
+		const int block_size = 1 + (block * 7) % BLOCK_SIZE_MAX;
+
+		for (int i = 0; i < block_size; i++) {
+			for (int axis = 0; axis < AXES; axis++) {
+				samples[i][axis] = signal(axis, n + i);
+			}
+		}
+
+		bank.apply(samples, block_size);
+
+		for (int i = 0; i < block_size; i++) {
+			for (int axis = 0; axis < AXES; axis++) {
+				const float expected = lpf[axis].apply(notch[axis].apply(signal(axis, n + i)));
+				EXPECT_NEAR(samples[i][axis], expected, 1e-4f);
+			}
+		}
+
+		n += block_size;
+	}
+}
+
+TEST_F(BiquadFilterBankTest, passThrough)
+{
+	BiquadFilterBank<4, 3> bank;
+
+	float sample[4] {1.f, -2.f, 3.f, -4.f};
+	bank.apply(sample);
+
+	EXPECT_EQ(sample[0], 1.f);
+	EXPECT_EQ(sample[1], -2.f);
+	EXPECT_EQ(sample[2], 3.f);
+	EXPECT_EQ(sample[3], -4.f);
+}
+
+TEST_F(BiquadFilterBankTest, resetToSteadyState)
+{
+	BiquadFilterBank<AXES, 2> bank;
+	bank.setNotch(0, _sample_freq, _notch_freq, _bandwidth);
+	bank.setLowPass(1, _sample_freq, _cutoff_freq);
+
+	const float value[AXES] {1.5f, -0.5f, 10.f};
+	bank.reset(value);
+
+	for (int n = 0; n < 100; n++) {
+		float sample[AXES] {value[0], value[1], value[2]};
+		bank.apply(sample);
+
+		for (int axis = 0; axis < AXES; axis++) {
+			EXPECT_NEAR(sample[axis], value[axis], 1e-4f);
+		}
+	}
+}
+
+TEST_F(BiquadFilterBankTest, perAxisNotch)
+{
+	// a different notch frequency per axis, each axis removes its own tone
+	BiquadFilterBank<AXES, 1> bank;
+	const float notch_freq[AXES] {60.f, 120.f, 180.f};
+
+	for (int axis = 0; axis < AXES; axis++) {
+		bank.setNotch(0, axis, _sample_freq, notch_freq[axis], 5.f);
+	}
+
+	float max_output[AXES] {};
+
+	for (int n = 0; n < 2000; n++) {
+		float sample[AXES];
+
+		for (int axis = 0; axis < AXES; axis++) {
+			sample[axis] = sinf(2.f * M_PI_F * notch_freq[axis] * n / _sample_freq);
+		}
+
+		bank.apply(sample);
+
+		// skip the transient
+		if (n > 1000) {
+			for (int axis = 0; axis < AXES; axis++) {
+				max_output[axis] = fmaxf(max_output[axis], fabsf(sample[axis]));
+			}
+		}
+	}
+
+	for (int axis = 0; axis < AXES; axis++) {
+		EXPECT_LT(max_output[axis], 0.01f);
+	}
+}
+
+TEST_F(BiquadFilterBankTest, nonFiniteInput)
+{
+	BiquadFilterBank<AXES, 1> bank;
+	bank.setLowPass(0, _sample_freq, _cutoff_freq);
+
+	float sample[AXES] {1.f, NAN, 1.f};
+	bank.apply(sample);
+
+	// recovers with the next finite input
+	for (int n = 0; n < 100; n++) {
+		float next[AXES] {1.f, 1.f, 1.f};
+		bank.apply(next);
+
+		for (int axis = 0; axis < AXES; axis++) {
+			EXPECT_TRUE(PX4_ISFINITE(next[axis]));
+		}
+	}
+}
+
+TEST_F(BiquadFilterBankTest, invalidNotchBandwidth)
+{
+	// an invalid bandwidth disables the notch instead of producing NAN coefficients
+	const float bandwidth[] {0.f, -5.f, NAN, INFINITY, _sample_freq / 2.f};
+
+	for (float bw : bandwidth) {
+		BiquadFilterBank<AXES, 1> bank;
+		bank.setNotch(0, _sample_freq, _notch_freq, bw);
+
+		for (int n = 0; n < 10; n++) {
+			float sample[AXES] {signal(0, n), signal(1, n), signal(2, n)};
+			bank.apply(sample);
+
+			for (int axis = 0; axis < AXES; axis++) {
+				EXPECT_FLOAT_EQ(sample[axis], signal(axis, n)) << "bandwidth " << bw;
+			}
+		}
+	}
+}
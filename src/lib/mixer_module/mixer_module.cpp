@@ -417,7 +417,7 @@ bool MixingOutput::update()
 		setAndPublishActuatorOutputs(mixed_num_outputs, actuator_outputs);
 
 		publishMixerStatus(actuator_outputs);
-		updateLatencyPerfCounter(actuator_outputs);
+		updateLatency(actuator_outputs);
 	}
 
 	handleCommands();
@@ -434,6 +434,16 @@ MixingOutput::setAndPublishActuatorOutputs(unsigned num_outputs, actuator_output
 		actuator_outputs.output[i] = _current_output_value[i];
 	}
 
+	// use first valid timestamp_sample for latency tracking
+	for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
+		const bool required = _groups_required & (1 << i);
+
+		if (required && (_controls[i].timestamp_sample > 0)) {
+			actuator_outputs.timestamp_sample = _controls[i].timestamp_sample;
+			break;
+		}
+	}
+
 	actuator_outputs.timestamp = hrt_absolute_time();
 	_outputs_pub.publish(actuator_outputs);
 }
@@ -454,18 +464,87 @@ MixingOutput::publishMixerStatus(const actuator_outputs_s &actuator_outputs)
 }
 
 void
-MixingOutput::updateLatencyPerfCounter(const actuator_outputs_s &actuator_outputs)
+MixingOutput::updateLatency(const actuator_outputs_s &actuator_outputs)
 {
-	// use first valid timestamp_sample for latency tracking
-	for (int i = 0; i < actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS; i++) {
-		const bool required = _groups_required & (1 << i);
-		const hrt_abstime &timestamp_sample = _controls[i].timestamp_sample;
+	const hrt_abstime &timestamp_sample = actuator_outputs.timestamp_sample;
 
-		if (required && (timestamp_sample > 0)) {
-			perf_set_elapsed(_control_latency_perf, actuator_outputs.timestamp - timestamp_sample);
-			break;
+	if ((timestamp_sample > 0) && (actuator_outputs.timestamp >= timestamp_sample)) {
+		const hrt_abstime latency = actuator_outputs.timestamp - timestamp_sample;
+		perf_set_elapsed(_control_latency_perf, latency);
+		_latency_histogram.add((uint32_t)math::min(latency, (hrt_abstime)UINT32_MAX));
+	}
+
+	// publish the statistics of the last second
+	if (_latency_histogram.window_start == 0) {
+		_latency_histogram.window_start = actuator_outputs.timestamp;
+
+	} else if (actuator_outputs.timestamp >= _latency_histogram.window_start + 1_s) {
+		const LatencyHistogram &histogram = _latency_histogram;
+
+		if (histogram.count > 0) {
+			control_latency_s control_latency{};
+			control_latency.count = histogram.count;
+			control_latency.latency_mean_us = histogram.sum / histogram.count;
+			control_latency.latency_p50_us = histogram.percentile(0.5f);
+			control_latency.latency_p90_us = histogram.percentile(0.9f);
+			control_latency.latency_p99_us = histogram.percentile(0.99f);
+			control_latency.latency_max_us = histogram.max;
+
+			for (int i = 0; i < LatencyHistogram::NUM_BUCKETS; i++) {
+				uint16_t &range_count = control_latency.histogram[i / LatencyHistogram::SUB_BUCKETS];
+				range_count = math::min(range_count + histogram.buckets[i], (int)UINT16_MAX);
+			}
+
+			control_latency.timestamp = hrt_absolute_time();
+			_control_latency_pub.publish(control_latency);
 		}
+
+		_latency_histogram = LatencyHistogram{};
+		_latency_histogram.window_start = actuator_outputs.timestamp;
+	}
+}
+
+void
+MixingOutput::LatencyHistogram::add(uint32_t latency_us)
+{
+	int index;
+
+	if (latency_us < 2 * SUB_BUCKETS) {
+		index = latency_us / 2;
+
+	} else {
+		// the 3 bits following the most significant bit select the bucket within the power of two
+		const int range = (31 - __builtin_clz(latency_us)) - 3;
+		index = math::min(range * SUB_BUCKETS + (int)((latency_us >> range) & (SUB_BUCKETS - 1)), NUM_BUCKETS - 1);
+	}
+
+	if (buckets[index] < UINT16_MAX) {
+		buckets[index]++;
 	}
+
+	count++;
+	sum += latency_us;
+	max = math::max(max, latency_us);
+}
+
+uint32_t
+MixingOutput::LatencyHistogram::percentile(float p) const
+{
+	const uint32_t target = math::max((uint32_t)ceilf(p * count), (uint32_t)1);
+	uint32_t cumulative = 0;
+
+	for (int i = 0; i < NUM_BUCKETS; i++) {
+		cumulative += buckets[i];
+
+		if (cumulative >= target) {
+			const int range = i / SUB_BUCKETS;
+			const int sub_bucket = i % SUB_BUCKETS;
+			const uint32_t upper = (range == 0) ? 2 * (sub_bucket + 1) : (uint32_t)(SUB_BUCKETS + sub_bucket + 1) << range;
+			return math::min(upper, max);
+		}
+	}
+
+	return max;
 }
 
 void
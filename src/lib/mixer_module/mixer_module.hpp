@@ -48,6 +48,7 @@
 #include <uORB/topics/actuator_armed.h>
 #include <uORB/topics/actuator_controls.h>
 #include <uORB/topics/actuator_outputs.h>
+#include <uORB/topics/control_latency.h>
 #include <uORB/topics/multirotor_motor_limits.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/test_motor.h>
@@ -194,7 +195,7 @@ private:
 	void updateOutputSlewrate();
 	void setAndPublishActuatorOutputs(unsigned num_outputs, actuator_outputs_s &actuator_outputs);
 	void publishMixerStatus(const actuator_outputs_s &actuator_outputs);
-	void updateLatencyPerfCounter(const actuator_outputs_s &actuator_outputs);
+	void updateLatency(const actuator_outputs_s &actuator_outputs);
 
 	static int controlCallback(uintptr_t handle, uint8_t control_group, uint8_t control_index, float &input);
 
@@ -240,6 +241,7 @@ private:
 
 	uORB::PublicationMulti<actuator_outputs_s> _outputs_pub{ORB_ID(actuator_outputs)};
 	uORB::PublicationMulti<multirotor_motor_limits_s> _to_mixer_status{ORB_ID(multirotor_motor_limits)}; 	///< mixer status flags
+	uORB::PublicationMulti<control_latency_s> _control_latency_pub{ORB_ID(control_latency)};
 
 	actuator_controls_s _controls[actuator_controls_s::NUM_ACTUATOR_CONTROL_GROUPS] {};
 	actuator_armed_s _armed{};
@@ -268,6 +270,31 @@ private:
 	};
 	MotorTest _motor_test;
 
+	/**
+	 * Histogram of the control latency, with 8 buckets per power of two (the first 8 buckets are 2 us wide)
+	 */
+	struct LatencyHistogram {
+		static constexpr int SUB_BUCKETS = 8;
+		static constexpr int NUM_RANGES = 12;
+		static constexpr int NUM_BUCKETS = SUB_BUCKETS * NUM_RANGES;
+
+		void add(uint32_t latency_us);
+
+		/** @return upper bound of the bucket containing the percentile p (0...1) */
+		uint32_t percentile(float p) const;
+
+		uint16_t buckets[NUM_BUCKETS] {};
+		uint32_t count{0};
+		uint64_t sum{0};
+		uint32_t max{0};
+		hrt_abstime window_start{0};
+	};
+
+	static_assert(LatencyHistogram::NUM_RANGES == sizeof(control_latency_s::histogram) / sizeof(
+			      control_latency_s::histogram[0]), "histogram ranges mismatch");
+
+	LatencyHistogram _latency_histogram;
+
 	OutputModuleInterface &_interface;
 
 	perf_counter_t _control_latency_perf;
@@ -313,6 +313,19 @@ __EXPORT void		param_reset_specific(const char *resets[], int num_resets);
  */
 __EXPORT int		param_export(int fd, bool only_unsaved, param_filter_func filter);
 
+/**
+ * Export all used parameters to a file, including the ones at their default value.
+ * This is used for a bulk transfer of the whole parameter set (e.g. via MAVLink FTP).
+ * Unlike param_export() it does not mark the parameters as saved.
+ *
+ * The first entry is "_HASH_CHECK", which contains the param_hash_check() value of
+ * the exported set, so that a reader can skip the rest if it already has these values.
+ *
+ * @param fd		File descriptor to export to.
+ * @return		Zero on success, nonzero on failure.
+ */
+__EXPORT int		param_export_used(int fd);
+
 /**
  * Import parameters from a file, discarding any unrecognized parameters.
  *
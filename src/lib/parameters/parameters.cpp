@@ -58,6 +58,7 @@
 #include <px4_platform_common/posix.h>
 #include <px4_platform_common/sem.h>
 #include <px4_platform_common/shutdown.h>
+#include <px4_platform_common/vehicle_context.h>
 #include <systemlib/uthash/utarray.h>
 
 using namespace time_literals;
@@ -135,14 +136,37 @@ get_param_info_count()
 	return param_info_count;
 }
 
-/** flexible array holding modified parameter values */
+/** flexible array holding modified parameter values (of vehicle context 0) */
 UT_array *param_values{nullptr};
 
+#if PX4_VEHICLE_CONTEXTS_MAX > 1
+/** modified parameter values of the other vehicle contexts, the defaults are shared */
+static UT_array *param_values_vehicle[PX4_VEHICLE_CONTEXTS_MAX - 1] {};
+#endif
+
+/**
+ * Modified parameter values of the calling thread's vehicle context
+ * (see px4_platform_common/vehicle_context.h).
+ */
+static UT_array *&
+param_values_current()
+{
+#if PX4_VEHICLE_CONTEXTS_MAX > 1
+	const uint8_t context = px4::vehicle_context();
+
+	if (context > 0) {
+		return param_values_vehicle[context - 1];
+	}
+
+#endif
+	return param_values;
+}
+
 /** array info for the modified parameters array */
 const UT_icd param_icd = {sizeof(param_wbuf_s), nullptr, nullptr, nullptr};
 
-/** parameter update topic handle */
-static orb_advert_t param_topic = nullptr;
+/** parameter update topic handle (per vehicle context, each has its own topic) */
+static orb_advert_t param_topic[PX4_VEHICLE_CONTEXTS_MAX] {};
 static unsigned int param_instance = 0;
 
 static void param_set_used_internal(param_t param);
@@ -281,10 +305,12 @@ param_find_changed(param_t param)
 
 	param_assert_locked();
 
-	if (param_values != nullptr) {
+	UT_array *values = param_values_current();
+
+	if (values != nullptr) {
 		param_wbuf_s key{};
 		key.param = param;
-		s = (param_wbuf_s *)utarray_find(param_values, &key, param_compare_values);
+		s = (param_wbuf_s *)utarray_find(values, &key, param_compare_values);
 	}
 
 	return s;
@@ -301,11 +327,13 @@ _param_notify_changes()
 	 * If we don't have a handle to our topic, create one now; otherwise
 	 * just publish.
 	 */
-	if (param_topic == nullptr) {
-		param_topic = orb_advertise(ORB_ID(parameter_update), &pup);
+	orb_advert_t &topic = param_topic[px4::vehicle_context()];
+
+	if (topic == nullptr) {
+		topic = orb_advertise(ORB_ID(parameter_update), &pup);
 
 	} else {
-		orb_publish(ORB_ID(parameter_update), param_topic, &pup);
+		orb_publish(ORB_ID(parameter_update), topic, &pup);
 	}
 }
 
@@ -630,7 +658,8 @@ autosave_worker(void *arg)
 static void
 param_autosave()
 {
-	if (autosave_scheduled || autosave_disabled) {
+	// only vehicle context 0 is backed by the parameter file
+	if (autosave_scheduled || autosave_disabled || (px4::vehicle_context() != 0)) {
 		return;
 	}
 
@@ -670,15 +699,16 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 {
 	int result = -1;
 	bool params_changed = false;
+	UT_array *&values = param_values_current();
 
 	param_lock_writer();
 	perf_begin(param_set_perf);
 
-	if (param_values == nullptr) {
-		utarray_new(param_values, &param_icd);
+	if (values == nullptr) {
+		utarray_new(values, &param_icd);
 	}
 
-	if (param_values == nullptr) {
+	if (values == nullptr) {
 		PX4_ERR("failed to allocate modified values array");
 		goto out;
 	}
@@ -696,8 +726,8 @@ param_set_internal(param_t param, const void *val, bool mark_saved, bool notify_
 			params_changed = true;
 
 			/* add it to the array and sort */
-			utarray_push_back(param_values, &buf);
-			utarray_sort(param_values, param_compare_values);
+			utarray_push_back(values, &buf);
+			utarray_sort(values, param_compare_values);
 
 			/* find it after sorting */
 			s = param_find_changed(param);
@@ -811,8 +841,9 @@ static int param_reset_internal(param_t param, bool notify = true)
 
 		/* if we found one, erase it */
 		if (s != nullptr) {
-			int pos = utarray_eltidx(param_values, s);
-			utarray_erase(param_values, pos, 1);
+			UT_array *values = param_values_current();
+			int pos = utarray_eltidx(values, s);
+			utarray_erase(values, pos, 1);
 		}
 
 		param_found = true;
@@ -835,14 +866,16 @@ int param_reset_no_notification(param_t param) { return param_reset_internal(par
 static void
 param_reset_all_internal(bool auto_save)
 {
+	UT_array *&values = param_values_current();
+
 	param_lock_writer();
 
-	if (param_values != nullptr) {
-		utarray_free(param_values);
+	if (values != nullptr) {
+		utarray_free(values);
 	}
 
 	/* mark as reset / deleted */
-	param_values = nullptr;
+	values = nullptr;
 
 	if (auto_save) {
 		param_autosave();
@@ -946,6 +979,12 @@ int param_save_default()
 {
 	int res = PX4_ERROR;
 
+	if (px4::vehicle_context() != 0) {
+		// the default file holds the parameters of vehicle context 0
+		PX4_ERR("no parameter file for vehicle context %d", px4::vehicle_context());
+		return res;
+	}
+
 	const char *filename = param_get_default_file();
 
 	if (!filename) {
@@ -1037,22 +1076,71 @@ param_load_default()
 	return res;
 }
 
-int
-param_export(int fd, bool only_unsaved, param_filter_func filter)
+static int
+param_export_append(bson_encoder_t encoder, param_t param, const union param_value_u *val)
+{
+	const char *name = param_name(param);
+	const size_t size = param_size(param);
+
+	/* append the appropriate BSON type object */
+	switch (param_type(param)) {
+
+	case PARAM_TYPE_INT32: {
+			const int32_t i = val->i;
+			PX4_DEBUG("exporting: %s (%d) size: %lu val: %d", name, param, (long unsigned int)size, i);
+
+			if (bson_encoder_append_int(encoder, name, i)) {
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	case PARAM_TYPE_FLOAT: {
+			const double f = (double)val->f;
+			PX4_DEBUG("exporting: %s (%d) size: %lu val: %.3f", name, param, (long unsigned int)size, (double)f);
+
+			if (bson_encoder_append_double(encoder, name, f)) {
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	default:
+		PX4_ERR("unrecognized parameter type");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Export parameters to a file.
+ *
+ * @param all_used	Export all used parameters (including defaults) preceded by the parameter hash,
+ *			instead of the changed ones. The saved state is left untouched.
+ */
+static int
+param_export_internal(int fd, bool only_unsaved, param_filter_func filter, bool all_used)
 {
 	int	result = -1;
 	perf_begin(param_export_perf);
 
 	if (fd < 0) {
-		param_lock_writer();
-		// flash_param_save() will take the shutdown lock
-		result = flash_param_save(only_unsaved, filter);
-		param_unlock_writer();
+		if (!all_used) {
+			param_lock_writer();
+			// flash_param_save() will take the shutdown lock
+			result = flash_param_save(only_unsaved, filter);
+			param_unlock_writer();
+		}
+
 		perf_end(param_export_perf);
 		return result;
 	}
 
 	param_wbuf_s *s = nullptr;
+	UT_array *&values = param_values_current();
 	struct bson_encoder_s encoder;
 
 	int shutdown_lock_ret = px4_shutdown_lock();
@@ -1069,13 +1157,36 @@ param_export(int fd, bool only_unsaved, param_filter_func filter)
 	uint8_t bson_buffer[256];
 	bson_encoder_init_buf_file(&encoder, fd, &bson_buffer, sizeof(bson_buffer));
 
+	if (all_used) {
+		// the hash goes first, so that a reader can stop early if it already has this parameter set
+		const uint32_t param_hash = param_hash_check();
+
+		if (bson_encoder_append_int(&encoder, "_HASH_CHECK", (int32_t)param_hash)) {
+			PX4_ERR("BSON append failed for '_HASH_CHECK'");
+			goto out;
+		}
+
+		for (param_t param = 0; handle_in_range(param); param++) {
+			if (!param_used(param) || (filter && !filter(param))) {
+				continue;
+			}
+
+			if (param_export_append(&encoder, param, (const union param_value_u *)param_get_value_ptr(param))) {
+				goto out;
+			}
+		}
+
+		result = 0;
+		goto out;
+	}
+
 	/* no modified parameters -> we are done */
-	if (param_values == nullptr) {
+	if (values == nullptr) {
 		result = 0;
 		goto out;
 	}
 
-	while ((s = (struct param_wbuf_s *)utarray_next(param_values, s)) != nullptr) {
+	while ((s = (struct param_wbuf_s *)utarray_next(values, s)) != nullptr) {
 		/*
 		 * If we are only saving values changed since last save, and this
 		 * one hasn't, then skip it
@@ -1090,36 +1201,7 @@ param_export(int fd, bool only_unsaved, param_filter_func filter)
 
 		s->unsaved = false;
 
-		const char *name = param_name(s->param);
-		const size_t size = param_size(s->param);
-
-		/* append the appropriate BSON type object */
-		switch (param_type(s->param)) {
-
-		case PARAM_TYPE_INT32: {
-				const int32_t i = s->val.i;
-				PX4_DEBUG("exporting: %s (%d) size: %lu val: %d", name, s->param, (long unsigned int)size, i);
-
-				if (bson_encoder_append_int(&encoder, name, i)) {
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		case PARAM_TYPE_FLOAT: {
-				const double f = (double)s->val.f;
-				PX4_DEBUG("exporting: %s (%d) size: %lu val: %.3f", name, s->param, (long unsigned int)size, (double)f);
-
-				if (bson_encoder_append_double(&encoder, name, f)) {
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		default:
-			PX4_ERR("unrecognized parameter type");
+		if (param_export_append(&encoder, s->param, &s->val)) {
 			goto out;
 		}
 	}
@@ -1131,6 +1213,7 @@ out:
 	if (result == 0) {
 		if (bson_encoder_fini(&encoder) != PX4_OK) {
 			PX4_ERR("bson encoder finish failed");
+			result = -1;
 		}
 	}
 
@@ -1147,6 +1230,18 @@ out:
 	return result;
 }
 
+int
+param_export(int fd, bool only_unsaved, param_filter_func filter)
+{
+	return param_export_internal(fd, only_unsaved, filter, false);
+}
+
+int
+param_export_used(int fd)
+{
+	return param_export_internal(fd, false, nullptr, true);
+}
+
 struct param_import_state {
 	bool mark_saved;
 };
@@ -1379,9 +1474,11 @@ void param_print_status()
 
 #endif /* FLASH_BASED_PARAMS */
 
-	if (param_values != nullptr) {
+	UT_array *values = param_values_current();
+
+	if (values != nullptr) {
 		PX4_INFO("storage array: %d/%d elements (%zu bytes total)",
-			 utarray_len(param_values), param_values->n, param_values->n * sizeof(UT_icd));
+			 utarray_len(values), values->n, values->n * sizeof(UT_icd));
 	}
 
 	PX4_INFO("auto save: %s", autosave_disabled ? "off" : "on");
@@ -1087,9 +1087,60 @@ param_load_default_no_notify()
 	return 0;
 }
 
-int
-param_export(int fd, bool only_unsaved, param_filter_func filter)
+static int
+param_export_append(bson_encoder_t encoder, param_t param, const union param_value_u *val)
 {
+	const char *name = param_name(param);
+	const size_t size = param_size(param);
+
+	/* append the appropriate BSON type object */
+	switch (param_type(param)) {
+
+	case PARAM_TYPE_INT32: {
+			const int32_t i = val->i;
+
+			PX4_DEBUG("exporting: %s (%d) size: %d val: %d", name, param, size, i);
+
+			if (bson_encoder_append_int(encoder, name, i)) {
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	case PARAM_TYPE_FLOAT: {
+			const double f = (double)val->f;
+
+			PX4_DEBUG("exporting: %s (%d) size: %d val: %.3f", name, param, size, (double)f);
+
+			if (bson_encoder_append_double(encoder, name, f)) {
+				PX4_ERR("BSON append failed for '%s'", name);
+				return -1;
+			}
+		}
+		break;
+
+	default:
+		PX4_ERR("unrecognized parameter type");
+		return -1;
+	}
+
+	return 0;
+}
+
+/**
+ * Export parameters to a file.
+ *
+ * @param all_used	Export all used parameters (including defaults) preceded by the parameter hash,
+ *			instead of the changed ones. The saved state is left untouched.
+ */
+static int
+param_export_internal(int fd, bool only_unsaved, param_filter_func filter, bool all_used)
+{
+	if (all_used && (fd < 0)) {
+		return -1;
+	}
+
 	perf_begin(param_export_perf);
 
 	param_wbuf_s *s = nullptr;
@@ -1110,6 +1161,29 @@ param_export(int fd, bool only_unsaved, param_filter_func filter)
 
 	bson_encoder_init_file(&encoder, fd);
 
+	if (all_used) {
+		// the hash goes first, so that a reader can stop early if it already has this parameter set
+		const uint32_t param_hash = param_hash_check();
+
+		if (bson_encoder_append_int(&encoder, "_HASH_CHECK", (int32_t)param_hash)) {
+			PX4_ERR("BSON append failed for '_HASH_CHECK'");
+			goto out;
+		}
+
+		for (param_t param = 0; handle_in_range(param); param++) {
+			if (!param_used(param) || (filter && !filter(param))) {
+				continue;
+			}
+
+			if (param_export_append(&encoder, param, (const union param_value_u *)param_get_value_ptr(param))) {
+				goto out;
+			}
+		}
+
+		result = 0;
+		goto out;
+	}
+
 	/* no modified parameters -> we are done */
 	if (param_values == nullptr) {
 		result = 0;
@@ -1138,38 +1212,7 @@ param_export(int fd, bool only_unsaved, param_filter_func filter)
 		/* Make sure to get latest from shmem before saving. */
 		update_from_shmem(s->param, &s->val);
 
-		const char *name = param_name(s->param);
-		const size_t size = param_size(s->param);
-
-		/* append the appropriate BSON type object */
-		switch (param_type(s->param)) {
-
-		case PARAM_TYPE_INT32: {
-				const int32_t i = s->val.i;
-
-				PX4_DEBUG("exporting: %s (%d) size: %d val: %d", name, s->param, size, i);
-
-				if (bson_encoder_append_int(&encoder, name, i)) {
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		case PARAM_TYPE_FLOAT: {
-				const double f = (double)s->val.f;
-
-				PX4_DEBUG("exporting: %s (%d) size: %d val: %.3f", name, s->param, size, (double)f);
-
-				if (bson_encoder_append_double(&encoder, name, f)) {
-					PX4_ERR("BSON append failed for '%s'", name);
-					goto out;
-				}
-			}
-			break;
-
-		default:
-			PX4_ERR("unrecognized parameter type");
+		if (param_export_append(&encoder, s->param, &s->val)) {
 			goto out;
 		}
 	}
@@ -1196,6 +1239,18 @@ out:
 	return result;
 }
 
+int
+param_export(int fd, bool only_unsaved, param_filter_func filter)
+{
+	return param_export_internal(fd, only_unsaved, filter, false);
+}
+
+int
+param_export_used(int fd)
+{
+	return param_export_internal(fd, false, nullptr, true);
+}
+
 struct param_import_state {
 	bool mark_saved;
 };
@@ -0,0 +1,127 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file PerfCounterTest.cpp
+ *
+ * Concurrent updates of shared counters while other threads register and free counters.
+ * Run it with ThreadSanitizer after changing the sharding or the lock-free registration.
+ */
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+#include "perf_counter.h"
+
+static constexpr int NUM_THREADS = 8;
+static constexpr int NUM_UPDATES = 20000;
+
+TEST(PerfCounterTest, ConcurrentUpdatesAndRegistration)
+{
+	perf_counter_t count = perf_alloc(PC_COUNT, "test_count");
+	perf_counter_t elapsed = perf_alloc(PC_ELAPSED, "test_elapsed");
+	perf_counter_t interval = perf_alloc(PC_INTERVAL, "test_interval");
+	ASSERT_NE(count, nullptr);
+	ASSERT_NE(elapsed, nullptr);
+	ASSERT_NE(interval, nullptr);
+
+	// registered once and looked up concurrently, must always be found
+	perf_counter_t shared = perf_alloc_once(PC_COUNT, "test_shared");
+	ASSERT_NE(shared, nullptr);
+
+	std::atomic<bool> stop{false};
+	std::atomic<int> lookup_errors{0};
+	std::vector<std::thread> threads;
+
+	// lookups, registrations and removals racing with each other and with the updates.
+	// Every thread frees only its own counters, as a counter must not be freed while others use it.
+	for (int r = 0; r < 2; r++) {
+		threads.emplace_back([&, r]() {
+			char name[16];
+
+			for (int n = 0; !stop; n++) {
+				snprintf(name, sizeof(name), "test_reg%d_%d", r, n % 8);
+				perf_counter_t handle = perf_alloc_once(PC_COUNT, name);
+
+				if ((handle == nullptr) || (handle != perf_alloc_once(PC_COUNT, name))) {
+					lookup_errors++;
+				}
+
+				if (perf_alloc_once(PC_COUNT, "test_shared") != shared) {
+					lookup_errors++;
+				}
+
+				perf_count(handle);
+				perf_free(handle);
+			}
+		});
+	}
+
+	std::vector<std::thread> updaters;
+
+	for (int t = 0; t < NUM_THREADS; t++) {
+		updaters.emplace_back([&, t]() {
+			for (int n = 0; n < NUM_UPDATES; n++) {
+				perf_count(count);
+				perf_set_elapsed(elapsed, (t + 1) * 10);
+				perf_count_interval(interval, 1000000 + (uint64_t)t * NUM_UPDATES + n);
+			}
+		});
+	}
+
+	for (auto &thread : updaters) {
+		thread.join();
+	}
+
+	stop = true;
+
+	for (auto &thread : threads) {
+		thread.join();
+	}
+
+	// nothing is lost between the shards, and the merged mean is exact
+	EXPECT_EQ(lookup_errors, 0);
+	EXPECT_EQ(perf_event_count(count), (uint64_t)NUM_THREADS * NUM_UPDATES);
+	EXPECT_EQ(perf_event_count(elapsed), (uint64_t)NUM_THREADS * NUM_UPDATES);
+	EXPECT_NEAR(perf_mean(elapsed) * 1e6f, (NUM_THREADS + 1) * 10 / 2.f, 1e-3f);
+	EXPECT_EQ(perf_event_count(interval), (uint64_t)NUM_THREADS * NUM_UPDATES);
+
+	perf_free(count);
+	perf_free(elapsed);
+	perf_free(interval);
+	perf_free(shared);
+}
@@ -35,15 +35,25 @@
  * @file perf_counter.c
  *
  * @brief Performance measuring tools.
+ *
+ * On POSIX, every thread updates its own shard of a counter (a cache line that
+ * no other thread writes), and the shards are combined when the counter is
+ * read. Counters can thus be updated concurrently from different threads
+ * without locks and without contention. On NuttX, a counter has a single shard.
+ *
+ * Counters are registered in a list without taking a lock: new counters are
+ * pushed to the head with a compare-and-swap. Only perf_free() and the
+ * functions iterating over all counters take the mutex.
  */
 
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
-#include <sys/queue.h>
 #include <drivers/drv_hrt.h>
 #include <math.h>
+#include <new>
 #include <pthread.h>
+#include <px4_platform_common/atomic.h>
 #include <systemlib/err.h>
 
 #include "perf_counter.h"
@@ -53,68 +63,356 @@
 #define dprintf(_fd, _text, ...) ((_fd) == 1 ? PX4_INFO((_text), ##__VA_ARGS__) : (void)(_fd))
 #endif
 
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define PERF_SHARDED
+static constexpr int PERF_MAX_SHARDS = 32;	///< threads with their own shard, further threads share one
+static constexpr size_t PERF_CACHE_LINE = 64;
+#else
+static constexpr int PERF_MAX_SHARDS = 1;
+#endif
+
+#if defined(PERF_SHARDED)
+// a shard is written by one thread and read by any: relaxed atomic accesses avoid torn values
+template<typename T>
+static inline T perf_load(const T &value) { T ret; __atomic_load(&value, &ret, __ATOMIC_RELAXED); return ret; }
+
+template<typename T>
+static inline void perf_store(T &value, T new_value) { __atomic_store(&value, &new_value, __ATOMIC_RELAXED); }
+
+template<typename T>
+static inline T perf_exchange(T &value, T new_value) { return __atomic_exchange_n(&value, new_value, __ATOMIC_RELAXED); }
+#else
+// single core: plain accesses (no 64 bit atomics on all targets)
+template<typename T>
+static inline T perf_load(const T &value) { return value; }
+
+template<typename T>
+static inline void perf_store(T &value, T new_value) { value = new_value; }
+
+template<typename T>
+static inline T perf_exchange(T &value, T new_value) { T ret = value; value = new_value; return ret; }
+#endif
+
 /**
  * Header common to all counters.
  */
 struct perf_ctr_header {
-	sq_entry_t		link;	/**< list linkage */
+	perf_ctr_header		*next;	/**< list linkage */
 	enum perf_counter_type	type;	/**< counter type */
 	const char		*name;	/**< counter name */
 };
 
 /**
- * PC_EVENT counter.
+ * Per-thread part of a PC_EVENT counter.
  */
-struct perf_ctr_count : public perf_ctr_header {
+struct perf_shard_count {
 	uint64_t		event_count{0};
 };
 
 /**
- * PC_ELAPSED counter.
+ * Per-thread part of a PC_ELAPSED or PC_INTERVAL counter.
  */
-struct perf_ctr_elapsed : public perf_ctr_header {
+struct perf_shard_time {
 	uint64_t		event_count{0};
-	uint64_t		time_start{0};
-	uint64_t		time_total{0};
+	uint64_t		time_total{0};	/**< PC_ELAPSED only */
 	uint32_t		time_least{0};
 	uint32_t		time_most{0};
 	float			mean{0.0f};
 	float			M2{0.0f};
 };
 
+/**
+ * Counter data split into shards. The first shard is stored inline, further shards are allocated
+ * when a thread first updates the counter.
+ */
+template<typename Shard>
+struct perf_ctr_sharded : public perf_ctr_header {
+	Shard			shard0;
+#if defined(PERF_SHARDED)
+	Shard			*shards[PERF_MAX_SHARDS - 1] {};
+
+	~perf_ctr_sharded()
+	{
+		for (Shard *shard : shards) {
+			free(shard);
+		}
+	}
+#endif
+
+	/** the shard of the calling thread */
+	inline Shard &local();
+
+	/** call f for every shard */
+	template<typename F>
+	void for_each(F f)
+	{
+		f(shard0);
+#if defined(PERF_SHARDED)
+
+		for (Shard *&shard_ptr : shards) {
+			Shard *shard = __atomic_load_n(&shard_ptr, __ATOMIC_ACQUIRE);
+
+			if (shard != nullptr) {
+				f(*shard);
+			}
+		}
+
+#endif
+	}
+};
+
+/**
+ * PC_EVENT counter.
+ */
+struct perf_ctr_count : public perf_ctr_sharded<perf_shard_count> {
+};
+
+/**
+ * PC_ELAPSED counter.
+ */
+struct perf_ctr_elapsed : public perf_ctr_sharded<perf_shard_time> {
+	uint64_t		time_start{0};
+};
+
 /**
  * PC_INTERVAL counter.
  */
-struct perf_ctr_interval : public perf_ctr_header {
-	uint64_t		event_count{0};
-	uint64_t		time_event{0};
+struct perf_ctr_interval : public perf_ctr_sharded<perf_shard_time> {
 	uint64_t		time_first{0};
 	uint64_t		time_last{0};
-	uint32_t		time_least{0};
-	uint32_t		time_most{0};
-	float			mean{0.0f};
-	float			M2{0.0f};
 };
 
+#if defined(PERF_SHARDED)
+/**
+ * Shard index of a thread. Indices are handed out on first use and returned when the thread exits,
+ * so that a new thread continues the shards of an exited one.
+ */
+static px4::atomic<uint32_t> perf_shard_slots{1}; // bit i: index i is used (0 is always taken by the first thread)
+
+struct perf_thread_shard {
+	int index{-1};
+	bool owned{false};
+
+	~perf_thread_shard()
+	{
+		if (owned) {
+			perf_shard_slots.fetch_and(~(1u << index));
+		}
+	}
+};
+
+static thread_local perf_thread_shard perf_thread_shard_index;
+static px4::atomic<bool> perf_shard0_taken{false};
+
+static_assert(PERF_MAX_SHARDS <= 32, "shard slots are a 32 bit mask");
+
+static int perf_shard_index()
+{
+	perf_thread_shard &thread_shard = perf_thread_shard_index;
+
+	if (thread_shard.index >= 0) {
+		return thread_shard.index;
+	}
+
+	// the first thread gets the inline shard, as on NuttX
+	bool taken = false;
+
+	if (perf_shard0_taken.compare_exchange(&taken, true)) {
+		thread_shard.index = 0;
+		return 0;
+	}
+
+	uint32_t used = perf_shard_slots.load();
+
+	while (used != 0xffffffffu) {
+		int index = 0;
+
+		while (used & (1u << index)) {
+			index++;
+		}
+
+		if (index >= PERF_MAX_SHARDS) {
+			break;
+		}
+
+		if (perf_shard_slots.compare_exchange(&used, used | (1u << index))) {
+			thread_shard.index = index;
+			thread_shard.owned = true;
+			return index;
+		}
+	}
+
+	// more threads than shards: share one (updates are then not atomic, as without sharding)
+	thread_shard.index = 1 + ((uintptr_t)&thread_shard / 64) % (PERF_MAX_SHARDS - 1);
+	return thread_shard.index;
+}
+
+template<typename Shard>
+Shard &perf_ctr_sharded<Shard>::local()
+{
+	const int index = perf_shard_index();
+
+	if (index == 0) {
+		return shard0;
+	}
+
+	Shard *shard = __atomic_load_n(&shards[index - 1], __ATOMIC_ACQUIRE);
+
+	if (shard == nullptr) {
+		// a cache line of its own, so that threads do not contend
+		void *mem = nullptr;
+
+		if (posix_memalign(&mem, PERF_CACHE_LINE, (sizeof(Shard) + PERF_CACHE_LINE - 1) / PERF_CACHE_LINE * PERF_CACHE_LINE) != 0) {
+			return shard0;
+		}
+
+		Shard *new_shard = new (mem) Shard();
+
+		if (__atomic_compare_exchange_n(&shards[index - 1], &shard, new_shard, false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+			shard = new_shard;
+
+		} else {
+			// another thread sharing the index was faster
+			free(mem);
+		}
+	}
+
+	return *shard;
+}
+#else
+template<typename Shard>
+Shard &perf_ctr_sharded<Shard>::local()
+{
+	return shard0;
+}
+#endif
+
+/**
+ * Combined view of all shards of a counter.
+ */
+struct perf_snapshot {
+	uint64_t event_count{0};
+	uint64_t time_total{0};
+	uint32_t time_least{0};
+	uint32_t time_most{0};
+	float mean{0.0f};
+	float M2{0.0f};
+};
+
+static void perf_combine(perf_snapshot &snapshot, const perf_shard_time &shard)
+{
+	const uint64_t count = perf_load(shard.event_count);
+
+	if (count == 0) {
+		return;
+	}
+
+	const uint32_t least = perf_load(shard.time_least);
+	const uint32_t most = perf_load(shard.time_most);
+	const float mean = perf_load(shard.mean);
+	const float M2 = perf_load(shard.M2);
+
+	if (snapshot.event_count == 0 || least < snapshot.time_least) {
+		snapshot.time_least = least;
+	}
+
+	if (most > snapshot.time_most) {
+		snapshot.time_most = most;
+	}
+
+	// combined mean and variance of two sets (Chan et al.)
+	const float n_a = snapshot.event_count;
+	const float n_b = count;
+	const float delta = mean - snapshot.mean;
+	snapshot.mean += delta * n_b / (n_a + n_b);
+	snapshot.M2 += M2 + delta * delta * n_a * n_b / (n_a + n_b);
+
+	snapshot.event_count += count;
+	snapshot.time_total += perf_load(shard.time_total);
+}
+
+static perf_snapshot perf_aggregate(perf_counter_t handle)
+{
+	perf_snapshot snapshot{};
+
+	switch (handle->type) {
+	case PC_COUNT:
+		((struct perf_ctr_count *)handle)->for_each([&snapshot](perf_shard_count & shard) {
+			snapshot.event_count += perf_load(shard.event_count);
+		});
+		break;
+
+	case PC_ELAPSED:
+		((struct perf_ctr_elapsed *)handle)->for_each([&snapshot](perf_shard_time & shard) {
+			perf_combine(snapshot, shard);
+		});
+		break;
+
+	case PC_INTERVAL: {
+			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
+			pci->for_each([&snapshot](perf_shard_time & shard) {
+				perf_combine(snapshot, shard);
+			});
+
+			// the shards count the intervals, the first event has none
+			if (perf_load(pci->time_first) != 0) {
+				snapshot.event_count++;
+			}
+		}
+		break;
+	}
+
+	return snapshot;
+}
+
 /**
  * List of all known counters.
  */
-static sq_queue_t	perf_counters = { nullptr, nullptr };
+static perf_counter_t	perf_counters = nullptr;
 
 /**
- * mutex protecting access to the perf_counters linked list (which is read from & written to by different threads)
+ * mutex protecting the removal of counters from perf_counters against iterating over it (registering does not
+ * need the mutex)
  */
 pthread_mutex_t perf_counters_mutex = PTHREAD_MUTEX_INITIALIZER;
-// FIXME: the mutex does **not** protect against access to/from the perf
-// counter's data. It can still happen that a counter is updated while it is
-// printed. This can lead to inconsistent output, or completely bogus values
-// (especially the 64bit values which are in general not atomically updated).
-// The same holds for shared perf counters (perf_alloc_once), that can be updated
-// concurrently (this affects the 'ctrl_latency' counter).
 
+/**
+ * number of lookups walking the list without the mutex, a removed counter can only be freed once there are none
+ */
+static px4::atomic<int> perf_counters_walkers{0};
 
-perf_counter_t
-perf_alloc(enum perf_counter_type type, const char *name)
+/**
+ * number of perf_free() calls waiting for the walkers, and the condition they wait on (with perf_counters_mutex)
+ */
+static px4::atomic<int> perf_counters_freeing{0};
+static pthread_cond_t perf_counters_walkers_done = PTHREAD_COND_INITIALIZER;
+
+static void perf_walk_begin()
+{
+	perf_counters_walkers.fetch_add(1);
+}
+
+static void perf_walk_end()
+{
+	// the last walker wakes up perf_free(), which sets perf_counters_freeing before checking the walkers
+	if (perf_counters_walkers.fetch_sub(1) == 1 && perf_counters_freeing.load() > 0) {
+		pthread_mutex_lock(&perf_counters_mutex);
+		pthread_cond_broadcast(&perf_counters_walkers_done);
+		pthread_mutex_unlock(&perf_counters_mutex);
+	}
+}
+
+static perf_counter_t perf_list_head()
+{
+	return __atomic_load_n(&perf_counters, __ATOMIC_ACQUIRE);
+}
+
+static perf_counter_t perf_list_next(perf_counter_t handle)
+{
+	return __atomic_load_n(&handle->next, __ATOMIC_ACQUIRE);
+}
+
+static perf_counter_t perf_new(enum perf_counter_type type, const char *name)
 {
 	perf_counter_t ctr = nullptr;
 
@@ -138,9 +436,49 @@ perf_alloc(enum perf_counter_type type, const char *name)
 	if (ctr != nullptr) {
 		ctr->type = type;
 		ctr->name = name;
-		pthread_mutex_lock(&perf_counters_mutex);
-		sq_addfirst(&ctr->link, &perf_counters);
-		pthread_mutex_unlock(&perf_counters_mutex);
+	}
+
+	return ctr;
+}
+
+static void perf_delete(perf_counter_t handle)
+{
+	switch (handle->type) {
+	case PC_COUNT:
+		delete (struct perf_ctr_count *)handle;
+		break;
+
+	case PC_ELAPSED:
+		delete (struct perf_ctr_elapsed *)handle;
+		break;
+
+	case PC_INTERVAL:
+		delete (struct perf_ctr_interval *)handle;
+		break;
+	}
+}
+
+/**
+ * Push a counter to the list head
+ * @param expected_head the head the caller has seen, updated to the current head on failure
+ * @return false if the head changed in the meantime
+ */
+static bool perf_list_push(perf_counter_t ctr, perf_counter_t &expected_head)
+{
+	ctr->next = expected_head;
+	return __atomic_compare_exchange_n(&perf_counters, &expected_head, ctr, false, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE);
+}
+
+perf_counter_t
+perf_alloc(enum perf_counter_type type, const char *name)
+{
+	perf_counter_t ctr = perf_new(type, name);
+
+	if (ctr != nullptr) {
+		perf_counter_t head = perf_list_head();
+
+		while (!perf_list_push(ctr, head)) {
+		}
 	}
 
 	return ctr;
@@ -149,30 +487,52 @@ perf_alloc(enum perf_counter_type type, const char *name)
 perf_counter_t
 perf_alloc_once(enum perf_counter_type type, const char *name)
 {
-	pthread_mutex_lock(&perf_counters_mutex);
-	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+	perf_walk_begin();
 
-	while (handle != nullptr) {
-		if (!strcmp(handle->name, name)) {
-			if (type == handle->type) {
-				/* they are the same counter */
-				pthread_mutex_unlock(&perf_counters_mutex);
-				return handle;
+	perf_counter_t head = perf_list_head();
+	perf_counter_t found = nullptr;
+	perf_counter_t ctr = nullptr;
 
-			} else {
-				/* same name but different type, assuming this is an error and not intended */
-				pthread_mutex_unlock(&perf_counters_mutex);
-				return nullptr;
+	while (true) {
+		for (perf_counter_t handle = head; handle != nullptr; handle = perf_list_next(handle)) {
+			if (!strcmp(handle->name, name)) {
+				found = handle;
+				break;
+			}
+		}
+
+		if (found != nullptr) {
+			break;
+		}
+
+		/* no existing counter of that name was found: add one, unless another thread registered one meanwhile */
+		if (ctr == nullptr) {
+			ctr = perf_new(type, name);
+
+			if (ctr == nullptr) {
+				break;
 			}
 		}
 
-		handle = (perf_counter_t)sq_next(&handle->link);
+		if (perf_list_push(ctr, head)) {
+			perf_walk_end();
+			return ctr;
+		}
 	}
 
-	pthread_mutex_unlock(&perf_counters_mutex);
+	perf_walk_end();
+
+	if (ctr != nullptr) {
+		perf_delete(ctr);
+	}
 
-	/* if the execution reaches here, no existing counter of that name was found */
-	return perf_alloc(type, name);
+	if (found != nullptr && found->type != type) {
+		/* same name but different type, assuming this is an error and not intended */
+		return nullptr;
+	}
+
+	/* they are the same counter */
+	return found;
 }
 
 void
@@ -183,10 +543,35 @@ perf_free(perf_counter_t handle)
 	}
 
 	pthread_mutex_lock(&perf_counters_mutex);
-	sq_rem(&handle->link, &perf_counters);
+
+	// the head can concurrently change by registrations, all other links only change here
+	perf_counter_t expected = handle;
+
+	if (!__atomic_compare_exchange_n(&perf_counters, &expected, perf_list_next(handle), false, __ATOMIC_ACQ_REL,
+					 __ATOMIC_ACQUIRE)) {
+		perf_counter_t prev = perf_list_head();
+
+		while (prev != nullptr && perf_list_next(prev) != handle) {
+			prev = perf_list_next(prev);
+		}
+
+		if (prev != nullptr) {
+			__atomic_store_n(&prev->next, perf_list_next(handle), __ATOMIC_RELEASE);
+		}
+	}
+
+	// lookups that started before the removal might still be looking at the counter
+	perf_counters_freeing.fetch_add(1);
+
+	while (perf_counters_walkers.load() > 0) {
+		pthread_cond_wait(&perf_counters_walkers_done, &perf_counters_mutex);
+	}
+
+	perf_counters_freeing.fetch_sub(1);
+
 	pthread_mutex_unlock(&perf_counters_mutex);
 
-	delete handle;
+	perf_delete(handle);
 }
 
 void
@@ -197,8 +582,10 @@ perf_count(perf_counter_t handle)
 	}
 
 	switch (handle->type) {
-	case PC_COUNT:
-		((struct perf_ctr_count *)handle)->event_count++;
+	case PC_COUNT: {
+			perf_shard_count &shard = ((struct perf_ctr_count *)handle)->local();
+			perf_store(shard.event_count, shard.event_count + 1);
+		}
 		break;
 
 	case PC_INTERVAL:
@@ -219,7 +606,7 @@ perf_begin(perf_counter_t handle)
 
 	switch (handle->type) {
 	case PC_ELAPSED:
-		((struct perf_ctr_elapsed *)handle)->time_start = hrt_absolute_time();
+		perf_store(((struct perf_ctr_elapsed *)handle)->time_start, hrt_absolute_time());
 		break;
 
 	default:
@@ -238,8 +625,11 @@ perf_end(perf_counter_t handle)
 	case PC_ELAPSED: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 
-			if (pce->time_start != 0) {
-				perf_set_elapsed(handle, hrt_elapsed_time(&pce->time_start));
+			// begin and end can be called from different threads, so the start time is not part of a shard
+			const hrt_abstime time_start = perf_exchange(pce->time_start, (uint64_t)0);
+
+			if (time_start != 0) {
+				perf_set_elapsed(handle, hrt_elapsed_time(&time_start));
 			}
 		}
 		break;
@@ -249,6 +639,42 @@ perf_end(perf_counter_t handle)
 	}
 }
 
+/**
+ * Add a measurement to a shard: count, least, most, mean and variance (Knuth/Welford recursive mean and variance,
+ * via Wikipedia)
+ */
+static void perf_shard_add(perf_shard_time &shard, uint32_t value)
+{
+	// only the owning thread writes the shard
+	const uint64_t event_count = shard.event_count + 1;
+
+	if ((shard.time_least > value) || (shard.time_least == 0)) {
+		perf_store(shard.time_least, value);
+	}
+
+	if (shard.time_most < value) {
+		perf_store(shard.time_most, value);
+	}
+
+	// maintain mean and variance in seconds
+	float dt = value / 1e6f;
+	float delta_intvl = dt - shard.mean;
+	const float mean = shard.mean + delta_intvl / event_count;
+	perf_store(shard.M2, shard.M2 + delta_intvl * (dt - mean));
+	perf_store(shard.mean, mean);
+	perf_store(shard.event_count, event_count);
+}
+
+static void perf_shard_reset(perf_shard_time &shard)
+{
+	perf_store(shard.event_count, (uint64_t)0);
+	perf_store(shard.time_total, (uint64_t)0);
+	perf_store(shard.time_least, (uint32_t)0);
+	perf_store(shard.time_most, (uint32_t)0);
+	perf_store(shard.mean, 0.0f);
+	perf_store(shard.M2, 0.0f);
+}
+
 void
 perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 {
@@ -261,25 +687,11 @@ perf_set_elapsed(perf_counter_t handle, int64_t elapsed)
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 
 			if (elapsed >= 0) {
-				pce->event_count++;
-				pce->time_total += elapsed;
-
-				if ((pce->time_least > (uint32_t)elapsed) || (pce->time_least == 0)) {
-					pce->time_least = elapsed;
-				}
-
-				if (pce->time_most < (uint32_t)elapsed) {
-					pce->time_most = elapsed;
-				}
-
-				// maintain mean and variance of the elapsed time in seconds
-				// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-				float dt = elapsed / 1e6f;
-				float delta_intvl = dt - pce->mean;
-				pce->mean += delta_intvl / pce->event_count;
-				pce->M2 += delta_intvl * (dt - pce->mean);
+				perf_shard_time &shard = pce->local();
+				perf_store(shard.time_total, shard.time_total + elapsed);
+				perf_shard_add(shard, elapsed);
 
-				pce->time_start = 0;
+				perf_store(pce->time_start, (uint64_t)0);
 			}
 		}
 		break;
@@ -300,41 +712,16 @@ perf_count_interval(perf_counter_t handle, hrt_abstime now)
 	case PC_INTERVAL: {
 			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
 
-			switch (pci->event_count) {
-			case 0:
-				pci->time_first = now;
-				break;
+			// the interval is between consecutive events of any thread, the shards only hold the statistics
+			const hrt_abstime time_last = perf_exchange(pci->time_last, now);
 
-			case 1:
-				pci->time_least = (uint32_t)(now - pci->time_last);
-				pci->time_most = (uint32_t)(now - pci->time_last);
-				pci->mean = pci->time_least / 1e6f;
-				pci->M2 = 0;
-				break;
+			if (time_last == 0) {
+				perf_store(pci->time_first, now);
 
-			default: {
-					hrt_abstime interval = now - pci->time_last;
-
-					if ((uint32_t)interval < pci->time_least) {
-						pci->time_least = (uint32_t)interval;
-					}
-
-					if ((uint32_t)interval > pci->time_most) {
-						pci->time_most = (uint32_t)interval;
-					}
-
-					// maintain mean and variance of interval in seconds
-					// Knuth/Welford recursive mean and variance of update intervals (via Wikipedia)
-					float dt = interval / 1e6f;
-					float delta_intvl = dt - pci->mean;
-					pci->mean += delta_intvl / pci->event_count;
-					pci->M2 += delta_intvl * (dt - pci->mean);
-					break;
-				}
+			} else {
+				perf_shard_add(pci->local(), (uint32_t)(now - time_last));
 			}
 
-			pci->time_last = now;
-			pci->event_count++;
 			break;
 		}
 
@@ -352,7 +739,11 @@ perf_set_count(perf_counter_t handle, uint64_t count)
 
 	switch (handle->type) {
 	case PC_COUNT: {
-			((struct perf_ctr_count *)handle)->event_count = count;
+			struct perf_ctr_count *pcc = (struct perf_ctr_count *)handle;
+			pcc->for_each([](perf_shard_count & shard) {
+				perf_store(shard.event_count, (uint64_t)0);
+			});
+			perf_store(pcc->local().event_count, count);
 		}
 		break;
 
@@ -373,7 +764,7 @@ perf_cancel(perf_counter_t handle)
 	case PC_ELAPSED: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 
-			pce->time_start = 0;
+			perf_store(pce->time_start, (uint64_t)0);
 		}
 		break;
 
@@ -389,29 +780,26 @@ perf_reset(perf_counter_t handle)
 		return;
 	}
 
+	// not synchronized with concurrent updates, which can survive the reset
 	switch (handle->type) {
 	case PC_COUNT:
-		((struct perf_ctr_count *)handle)->event_count = 0;
+		((struct perf_ctr_count *)handle)->for_each([](perf_shard_count & shard) {
+			perf_store(shard.event_count, (uint64_t)0);
+		});
 		break;
 
 	case PC_ELAPSED: {
 			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
-			pce->event_count = 0;
-			pce->time_start = 0;
-			pce->time_total = 0;
-			pce->time_least = 0;
-			pce->time_most = 0;
+			pce->for_each(perf_shard_reset);
+			perf_store(pce->time_start, (uint64_t)0);
 			break;
 		}
 
 	case PC_INTERVAL: {
 			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
-			pci->event_count = 0;
-			pci->time_event = 0;
-			pci->time_first = 0;
-			pci->time_last = 0;
-			pci->time_least = 0;
-			pci->time_most = 0;
+			pci->for_each(perf_shard_reset);
+			perf_store(pci->time_first, (uint64_t)0);
+			perf_store(pci->time_last, (uint64_t)0);
 			break;
 		}
 	}
@@ -434,15 +822,18 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 		return;
 	}
 
+	const perf_snapshot snapshot = perf_aggregate(handle);
+	const perf_snapshot *pce = &snapshot;
+	const perf_snapshot *pci = &snapshot;
+
 	switch (handle->type) {
 	case PC_COUNT:
 		dprintf(fd, "%s: %llu events\n",
 			handle->name,
-			(unsigned long long)((struct perf_ctr_count *)handle)->event_count);
+			(unsigned long long)snapshot.event_count);
 		break;
 
 	case PC_ELAPSED: {
-			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			float rms = sqrtf(pce->M2 / (pce->event_count - 1));
 			dprintf(fd, "%s: %llu events, %lluus elapsed, %.2fus avg, min %lluus max %lluus %5.3fus rms\n",
 				handle->name,
@@ -456,13 +847,14 @@ perf_print_counter_fd(int fd, perf_counter_t handle)
 		}
 
 	case PC_INTERVAL: {
-			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
+			const struct perf_ctr_interval *interval = (struct perf_ctr_interval *)handle;
 			float rms = sqrtf(pci->M2 / (pci->event_count - 1));
 
 			dprintf(fd, "%s: %llu events, %.2fus avg, min %lluus max %lluus %5.3fus rms\n",
 				handle->name,
 				(unsigned long long)pci->event_count,
-				(pci->event_count == 0) ? 0 : (double)(pci->time_last - pci->time_first) / (double)pci->event_count,
+				(pci->event_count == 0) ? 0 : (double)(perf_load(interval->time_last) - perf_load(interval->time_first)) /
+				(double)pci->event_count,
 				(unsigned long long)pci->time_least,
 				(unsigned long long)pci->time_most,
 				(double)(1e6f * rms));
@@ -484,15 +876,18 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 		return 0;
 	}
 
+	const perf_snapshot snapshot = perf_aggregate(handle);
+	const perf_snapshot *pce = &snapshot;
+	const perf_snapshot *pci = &snapshot;
+
 	switch (handle->type) {
 	case PC_COUNT:
 		num_written = snprintf(buffer, length, "%s: %llu events",
 				       handle->name,
-				       (unsigned long long)((struct perf_ctr_count *)handle)->event_count);
+				       (unsigned long long)snapshot.event_count);
 		break;
 
 	case PC_ELAPSED: {
-			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
 			float rms = sqrtf(pce->M2 / (pce->event_count - 1));
 			num_written = snprintf(buffer, length, "%s: %llu events, %lluus elapsed, %.2fus avg, min %lluus max %lluus %5.3fus rms",
 					       handle->name,
@@ -506,13 +901,14 @@ perf_print_counter_buffer(char *buffer, int length, perf_counter_t handle)
 		}
 
 	case PC_INTERVAL: {
-			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
+			const struct perf_ctr_interval *interval = (struct perf_ctr_interval *)handle;
 			float rms = sqrtf(pci->M2 / (pci->event_count - 1));
 
 			num_written = snprintf(buffer, length, "%s: %llu events, %.2f avg, min %lluus max %lluus %5.3fus rms",
 					       handle->name,
 					       (unsigned long long)pci->event_count,
-					       (pci->event_count == 0) ? 0 : (double)(pci->time_last - pci->time_first) / (double)pci->event_count,
+					       (pci->event_count == 0) ? 0 : (double)(perf_load(interval->time_last) - perf_load(interval->time_first)) /
+					       (double)pci->event_count,
 					       (unsigned long long)pci->time_least,
 					       (unsigned long long)pci->time_most,
 					       (double)(1e6f * rms));
@@ -534,25 +930,7 @@ perf_event_count(perf_counter_t handle)
 		return 0;
 	}
 
-	switch (handle->type) {
-	case PC_COUNT:
-		return ((struct perf_ctr_count *)handle)->event_count;
-
-	case PC_ELAPSED: {
-			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
-			return pce->event_count;
-		}
-
-	case PC_INTERVAL: {
-			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
-			return pci->event_count;
-		}
-
-	default:
-		break;
-	}
-
-	return 0;
+	return perf_aggregate(handle).event_count;
 }
 
 float
@@ -563,15 +941,9 @@ perf_mean(perf_counter_t handle)
 	}
 
 	switch (handle->type) {
-	case PC_ELAPSED: {
-			struct perf_ctr_elapsed *pce = (struct perf_ctr_elapsed *)handle;
-			return pce->mean;
-		}
-
-	case PC_INTERVAL: {
-			struct perf_ctr_interval *pci = (struct perf_ctr_interval *)handle;
-			return pci->mean;
-		}
+	case PC_ELAPSED:
+	case PC_INTERVAL:
+		return perf_aggregate(handle).mean;
 
 	default:
 		break;
@@ -584,11 +956,11 @@ void
 perf_iterate_all(perf_callback cb, void *user)
 {
 	pthread_mutex_lock(&perf_counters_mutex);
-	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+	perf_counter_t handle = perf_list_head();
 
 	while (handle != nullptr) {
 		cb(handle, user);
-		handle = (perf_counter_t)sq_next(&handle->link);
+		handle = perf_list_next(handle);
 	}
 
 	pthread_mutex_unlock(&perf_counters_mutex);
@@ -598,11 +970,11 @@ void
 perf_print_all(int fd)
 {
 	pthread_mutex_lock(&perf_counters_mutex);
-	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+	perf_counter_t handle = perf_list_head();
 
 	while (handle != nullptr) {
 		perf_print_counter_fd(fd, handle);
-		handle = (perf_counter_t)sq_next(&handle->link);
+		handle = perf_list_next(handle);
 	}
 
 	pthread_mutex_unlock(&perf_counters_mutex);
@@ -625,11 +997,11 @@ void
 perf_reset_all(void)
 {
 	pthread_mutex_lock(&perf_counters_mutex);
-	perf_counter_t handle = (perf_counter_t)sq_peek(&perf_counters);
+	perf_counter_t handle = perf_list_head();
 
 	while (handle != nullptr) {
 		perf_reset(handle);
-		handle = (perf_counter_t)sq_next(&handle->link);
+		handle = perf_list_next(handle);
 	}
 
 	pthread_mutex_unlock(&perf_counters_mutex);
@@ -0,0 +1,336 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file perf_trace.cpp
+ *
+ * On POSIX, every thread records into its own buffer, which it allocates on the first event after
+ * tracing is started. A buffer of an exited thread is handed to a new thread on the next start.
+ * On NuttX, all threads (and interrupt handlers) share a single buffer, and a record slot is
+ * claimed with an atomic increment.
+ */
+
+#include "perf_trace.h"
+
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <new>
+#include <pthread.h>
+#include <drivers/drv_hrt.h>
+#include <px4_platform_common/atomic.h>
+
+#if defined(__PX4_POSIX) && !defined(__PX4_QURT)
+#define PERF_TRACE_PER_THREAD
+static constexpr unsigned PERF_TRACE_BUFFER_SIZE = 8192;	///< records per thread
+static constexpr unsigned PERF_TRACE_MAX_BUFFERS = 64;
+static constexpr unsigned PERF_TRACE_MAX_NAMES = 256;
+#else
+static constexpr unsigned PERF_TRACE_BUFFER_SIZE = 1024;	///< records shared by all threads
+static constexpr unsigned PERF_TRACE_MAX_BUFFERS = 1;
+static constexpr unsigned PERF_TRACE_MAX_NAMES = 64;
+#endif
+
+static_assert((PERF_TRACE_BUFFER_SIZE & (PERF_TRACE_BUFFER_SIZE - 1)) == 0, "buffer size must be a power of 2");
+static_assert(PERF_TRACE_MAX_BUFFERS <= 256, "buffer index must fit into perf_trace_record_s::thread");
+
+volatile bool perf_trace_enabled = false;
+
+struct perf_trace_buffer {
+	enum State : uint8_t {
+		OWNED,		///< written by a running thread
+		EXITED,		///< thread exited, records are kept until the next start
+		FREE,		///< can be taken over by a new thread
+	};
+
+	px4::atomic<uint32_t>	head{0};	///< number of records written since the start
+	px4::atomic<uint8_t>	state{OWNED};
+	char			thread_name[16] {};
+	perf_trace_record_s	records[PERF_TRACE_BUFFER_SIZE];
+};
+
+static perf_trace_buffer *perf_trace_buffers[PERF_TRACE_MAX_BUFFERS] {};
+static px4::atomic<uint32_t> perf_trace_buffer_count{0};
+static px4::atomic<uint32_t> perf_trace_lost{0};	///< events of threads without a buffer
+
+static const char *perf_trace_names[PERF_TRACE_MAX_NAMES] {};
+static px4::atomic<uint32_t> perf_trace_name_count{0};
+
+/** protects adding names and buffers */
+static pthread_mutex_t perf_trace_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+#if defined(PERF_TRACE_PER_THREAD)
+struct perf_trace_thread {
+	int index{-1};
+	bool failed{false};	///< no buffer available, do not try again until the next start
+
+	~perf_trace_thread()
+	{
+		if (index >= 0) {
+			perf_trace_buffers[index]->state.store(perf_trace_buffer::EXITED);
+		}
+	}
+};
+
+static thread_local perf_trace_thread perf_trace_thread_buffer;
+static px4::atomic<uint32_t> perf_trace_generation{0};	///< incremented on every start
+static thread_local uint32_t perf_trace_thread_generation{0};
+
+static int perf_trace_acquire_buffer()
+{
+	pthread_mutex_lock(&perf_trace_mutex);
+
+	const unsigned count = perf_trace_buffer_count.load();
+	int index = -1;
+
+	for (unsigned i = 0; i < count; i++) {
+		uint8_t expected = perf_trace_buffer::FREE;
+
+		if (perf_trace_buffers[i]->state.compare_exchange(&expected, perf_trace_buffer::OWNED)) {
+			index = i;
+			break;
+		}
+	}
+
+	if (index < 0 && count < PERF_TRACE_MAX_BUFFERS) {
+		perf_trace_buffer *buffer = new (std::nothrow) perf_trace_buffer;
+
+		if (buffer != nullptr) {
+			perf_trace_buffers[count] = buffer;
+			perf_trace_buffer_count.store(count + 1);
+			index = count;
+		}
+	}
+
+	if (index >= 0) {
+		perf_trace_buffer *buffer = perf_trace_buffers[index];
+		buffer->head.store(0);
+		buffer->thread_name[0] = '\0';
+		pthread_getname_np(pthread_self(), buffer->thread_name, sizeof(buffer->thread_name));
+	}
+
+	pthread_mutex_unlock(&perf_trace_mutex);
+	return index;
+}
+#endif /* PERF_TRACE_PER_THREAD */
+
+uint16_t perf_trace_register(const char *name)
+{
+	if (name == nullptr) {
+		return PERF_TRACE_ID_INVALID;
+	}
+
+	pthread_mutex_lock(&perf_trace_mutex);
+
+	const unsigned count = perf_trace_name_count.load();
+	uint16_t id = PERF_TRACE_ID_INVALID;
+
+	for (unsigned i = 0; i < count; i++) {
+		if (strcmp(perf_trace_names[i], name) == 0) {
+			id = i;
+			break;
+		}
+	}
+
+	if (id == PERF_TRACE_ID_INVALID && count < PERF_TRACE_MAX_NAMES) {
+		perf_trace_names[count] = name;
+		perf_trace_name_count.store(count + 1);
+		id = count;
+	}
+
+	pthread_mutex_unlock(&perf_trace_mutex);
+	return id;
+}
+
+const char *perf_trace_name(uint16_t id)
+{
+	if (id < perf_trace_name_count.load()) {
+		return perf_trace_names[id];
+	}
+
+	return nullptr;
+}
+
+void perf_trace_record(enum perf_trace_event event, uint16_t id, uint32_t arg)
+{
+	const hrt_abstime now = hrt_absolute_time();
+
+#if defined(PERF_TRACE_PER_THREAD)
+	perf_trace_thread &thread = perf_trace_thread_buffer;
+	const uint32_t generation = perf_trace_generation.load();
+
+	if (perf_trace_thread_generation != generation) {
+		// first event since the start
+		perf_trace_thread_generation = generation;
+		thread.failed = false;
+	}
+
+	if (thread.index < 0) {
+		if (!thread.failed) {
+			thread.index = perf_trace_acquire_buffer();
+			thread.failed = thread.index < 0;
+		}
+
+		if (thread.index < 0) {
+			perf_trace_lost.fetch_add(1);
+			return;
+		}
+	}
+
+	perf_trace_buffer *buffer = perf_trace_buffers[thread.index];
+
+	// single writer: no need for an atomic increment
+	const uint32_t head = buffer->head.load();
+	perf_trace_record_s &record = buffer->records[head & (PERF_TRACE_BUFFER_SIZE - 1)];
+	record.thread = (uint8_t)thread.index;
+#else
+	perf_trace_buffer *buffer = perf_trace_buffers[0];
+
+	if (buffer == nullptr) {
+		return;
+	}
+
+	const uint32_t head = buffer->head.fetch_add(1);
+	perf_trace_record_s &record = buffer->records[head & (PERF_TRACE_BUFFER_SIZE - 1)];
+	record.thread = (uint8_t)getpid();
+#endif
+
+	record.timestamp = now;
+	record.arg = arg;
+	record.id = id;
+	record.event = (uint8_t)event;
+
+#if defined(PERF_TRACE_PER_THREAD)
+	// publish the record to readers
+	buffer->head.store(head + 1);
+#endif
+}
+
+int perf_trace_start()
+{
+	pthread_mutex_lock(&perf_trace_mutex);
+
+	perf_trace_enabled = false;
+
+#if defined(PERF_TRACE_PER_THREAD)
+	const unsigned count = perf_trace_buffer_count.load();
+
+	for (unsigned i = 0; i < count; i++) {
+		uint8_t expected = perf_trace_buffer::EXITED;
+		perf_trace_buffers[i]->state.compare_exchange(&expected, perf_trace_buffer::FREE);
+	}
+
+	perf_trace_generation.fetch_add(1);
+#else
+
+	// allocated once and kept, as an interrupt handler might still be recording into it
+	if (perf_trace_buffers[0] == nullptr) {
+		perf_trace_buffers[0] = new (std::nothrow) perf_trace_buffer;
+
+		if (perf_trace_buffers[0] == nullptr) {
+			pthread_mutex_unlock(&perf_trace_mutex);
+			return -ENOMEM;
+		}
+
+		perf_trace_buffer_count.store(1);
+	}
+
+	const unsigned count = 1;
+#endif
+
+	for (unsigned i = 0; i < count; i++) {
+		perf_trace_buffers[i]->head.store(0);
+	}
+
+	perf_trace_lost.store(0);
+	perf_trace_enabled = true;
+
+	pthread_mutex_unlock(&perf_trace_mutex);
+	return 0;
+}
+
+void perf_trace_stop()
+{
+	perf_trace_enabled = false;
+}
+
+unsigned perf_trace_num_buffers()
+{
+	return perf_trace_buffer_count.load();
+}
+
+const perf_trace_record_s *perf_trace_get(unsigned buffer, unsigned index)
+{
+	if (buffer >= perf_trace_buffer_count.load()) {
+		return nullptr;
+	}
+
+	const perf_trace_buffer *b = perf_trace_buffers[buffer];
+	const uint32_t head = b->head.load();
+	const uint32_t count = head < PERF_TRACE_BUFFER_SIZE ? head : PERF_TRACE_BUFFER_SIZE;
+
+	if (index >= count) {
+		return nullptr;
+	}
+
+	return &b->records[(head - count + index) & (PERF_TRACE_BUFFER_SIZE - 1)];
+}
+
+const char *perf_trace_buffer_name(unsigned buffer)
+{
+#if defined(PERF_TRACE_PER_THREAD)
+
+	if (buffer < perf_trace_buffer_count.load()) {
+		return perf_trace_buffers[buffer]->thread_name;
+	}
+
+#endif
+
+	return nullptr;
+}
+
+uint32_t perf_trace_num_dropped()
+{
+	uint32_t dropped = perf_trace_lost.load();
+	const unsigned count = perf_trace_buffer_count.load();
+
+	for (unsigned i = 0; i < count; i++) {
+		const uint32_t head = perf_trace_buffers[i]->head.load();
+
+		if (head > PERF_TRACE_BUFFER_SIZE) {
+			dropped += head - PERF_TRACE_BUFFER_SIZE;
+		}
+	}
+
+	return dropped;
+}
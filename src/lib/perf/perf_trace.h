@@ -0,0 +1,154 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file perf_trace.h
+ * Event tracing: a timeline of work item runs, uORB publications and bus transfers.
+ *
+ * Events are recorded into ring buffers (one per thread on POSIX, a single shared one on NuttX)
+ * while tracing is enabled, and are read out afterwards (see 'perf trace').
+ * When tracing is disabled, an event costs a single load and branch.
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <px4_platform_common/defines.h>
+
+/**
+ * Trace event types. The meaning of id and arg depends on the event.
+ */
+enum perf_trace_event {
+	PERF_TRACE_WORK_ITEM_BEGIN = 0,	/**< id: work item name (perf_trace_register()) */
+	PERF_TRACE_WORK_ITEM_END,	/**< id: work item name */
+	PERF_TRACE_ORB_PUBLISH,		/**< id: ORB_ID, arg: instance */
+	PERF_TRACE_ORB_CALLBACK,	/**< id: ORB_ID, arg: name of the work item scheduled by the callback */
+	PERF_TRACE_TRANSFER_BEGIN,	/**< id: bus type, arg: device id */
+	PERF_TRACE_TRANSFER_END,	/**< id: bus type, arg: device id */
+};
+
+/**
+ * A single trace record (16 bytes).
+ */
+struct perf_trace_record_s {
+	uint64_t	timestamp;	/**< hrt time of the event */
+	uint32_t	arg;
+	uint16_t	id;
+	uint8_t		event;		/**< enum perf_trace_event */
+	uint8_t		thread;		/**< buffer index on POSIX, (truncated) pid on NuttX */
+};
+
+#define PERF_TRACE_ID_INVALID	0xffff
+
+__BEGIN_DECLS
+
+/**
+ * Set while tracing is enabled. Use perf_trace_start() and perf_trace_stop() to change it.
+ */
+__EXPORT extern volatile bool perf_trace_enabled;
+
+/**
+ * Get the id for a name (e.g. of a work item). Registering the same name again returns the same id.
+ *
+ * @param name			Name, it must stay valid for the lifetime of the process.
+ * @return			Id, or PERF_TRACE_ID_INVALID if there is no more space.
+ */
+__EXPORT extern uint16_t	perf_trace_register(const char *name);
+
+/**
+ * Get the name registered for an id.
+ *
+ * @return			Name, or NULL for an unknown id.
+ */
+__EXPORT extern const char	*perf_trace_name(uint16_t id);
+
+/**
+ * Record an event unconditionally. Use perf_trace() instead.
+ */
+__EXPORT extern void		perf_trace_record(enum perf_trace_event event, uint16_t id, uint32_t arg);
+
+/**
+ * Record an event if tracing is enabled. Can be called from any thread and from interrupt context.
+ *
+ * @param event			Event type.
+ * @param id			Event id (see enum perf_trace_event).
+ * @param arg			Event argument (see enum perf_trace_event).
+ */
+static inline void perf_trace(enum perf_trace_event event, uint16_t id, uint32_t arg)
+{
+	if (perf_trace_enabled) {
+		perf_trace_record(event, id, arg);
+	}
+}
+
+/**
+ * Clear all trace buffers and start recording.
+ *
+ * @return			0 on success, -ENOMEM if the buffer could not be allocated.
+ */
+__EXPORT extern int		perf_trace_start(void);
+
+/**
+ * Stop recording. The buffers are kept until the next start.
+ */
+__EXPORT extern void		perf_trace_stop(void);
+
+/**
+ * Get the number of trace buffers.
+ */
+__EXPORT extern unsigned	perf_trace_num_buffers(void);
+
+/**
+ * Get a record of a buffer. Records of a buffer are in chronological order.
+ * Tracing should be stopped while reading, otherwise records might be overwritten.
+ *
+ * @param buffer		Buffer index (0 ... perf_trace_num_buffers() - 1).
+ * @param index			Record index, 0 is the oldest record available.
+ * @return			Record, or NULL if there is no record with that index.
+ */
+__EXPORT extern const struct perf_trace_record_s *perf_trace_get(unsigned buffer, unsigned index);
+
+/**
+ * Get the name of the thread writing into a buffer.
+ *
+ * @return			Thread name, or NULL if the buffer is shared between threads.
+ */
+__EXPORT extern const char	*perf_trace_buffer_name(unsigned buffer);
+
+/**
+ * Get the number of records lost since the start, because a buffer overflowed.
+ */
+__EXPORT extern uint32_t	perf_trace_num_dropped(void);
+
+__END_DECLS
@@ -48,8 +48,9 @@ static px4::atomic<EKF2Selector *> _ekf2_selector {nullptr};
 EKF2::EKF2(int instance, const px4::wq_config_t &config, int imu, int mag, bool replay_mode):
 	ModuleParams(nullptr),
 	ScheduledWorkItem(MODULE_NAME, config),
-	_replay_mode(replay_mode && instance < 0),
+	_replay_mode(replay_mode),
 	_multi_mode(instance >= 0),
+	_batch_mode(replay_mode && instance >= 0),
 	_instance(math::constrain(instance, 0, EKF2_MAX_INSTANCES - 1)),
 	_attitude_pub(_multi_mode ? ORB_ID(estimator_attitude) : ORB_ID(vehicle_attitude)),
 	_local_position_pub(_multi_mode ? ORB_ID(estimator_local_position) : ORB_ID(vehicle_local_position)),
@@ -193,7 +194,7 @@ EKF2::EKF2(int instance, const px4::wq_config_t &config, int imu, int mag, bool
 
 EKF2::~EKF2()
 {
-	if (!_multi_mode) {
+	if (!_multi_mode || _batch_mode) {
 		px4_lockstep_unregister_component(_lockstep_component);
 	}
 
@@ -238,7 +239,7 @@ void EKF2::Run()
 	}
 
 	if (!_callback_registered) {
-		if (_multi_mode) {
+		if (_multi_mode && !_batch_mode) {
 			_callback_registered = _vehicle_imu_sub.registerCallback();
 
 		} else {
@@ -252,8 +253,8 @@ void EKF2::Run()
 		}
 	}
 
-	// check for parameter updates
-	if (_parameter_update_sub.updated()) {
+	// check for parameter updates (batch replay variants keep the parameters they were started with)
+	if (_parameter_update_sub.updated() && !_batch_mode) {
 		// clear update
 		parameter_update_s pupdate;
 		_parameter_update_sub.copy(&pupdate);
@@ -267,7 +268,7 @@ void EKF2::Run()
 
 	hrt_abstime imu_dt = 0; // for tracking time slip later
 
-	if (_multi_mode) {
+	if (_multi_mode && !_batch_mode) {
 		vehicle_imu_s imu;
 		imu_updated = _vehicle_imu_sub.update(&imu);
 
@@ -458,7 +459,7 @@ void EKF2::Run()
 		// publish ekf2_timestamps
 		_ekf2_timestamps_pub.publish(ekf2_timestamps);
 
-		if (!_multi_mode) {
+		if (!_multi_mode || _batch_mode) {
 			if (_lockstep_component == -1) {
 				_lockstep_component = px4_lockstep_register_component();
 			}
@@ -1500,17 +1501,155 @@ int EKF2::custom_command(int argc, char *argv[])
 	return print_usage("unknown command");
 }
 
+#if !defined(CONSTRAINED_FLASH)
+/**
+ * Start one multi-instance EKF2 per line of a variants file for batch replay. Each line is a list of
+ * whitespace separated parameter overrides (NAME=value), '#' starts a comment. The overrides are only
+ * applied while the instance is constructed, so every variant keeps its own parameter snapshot.
+ * @return number of instances started
+ */
+static int start_replay_variants(const char *variants_file)
+{
+	FILE *fp = fopen(variants_file, "r");
+
+	if (fp == nullptr) {
+		PX4_ERR("failed to open %s", variants_file);
+		return 0;
+	}
+
+	static constexpr int MAX_OVERRIDES = 32;
+
+	// the logger records at most 4 instances of the estimator_* topics (see logged_topics.cpp),
+	// further variants would run but their output would be missing from the replay log
+	static constexpr int MAX_REPLAY_VARIANTS = math::min(4, (int)EKF2_MAX_INSTANCES);
+
+	struct Override {
+		param_t handle;
+		union {
+			int32_t i;
+			float f;
+		} original;
+	};
+
+	int num_variants = 0;
+	char line[512];
+
+	while (fgets(line, sizeof(line), fp) != nullptr) {
+		char *comment = strchr(line, '#');
+
+		if (comment) {
+			*comment = '\0';
+		}
+
+		Override overrides[MAX_OVERRIDES];
+		int num_overrides = 0;
+		bool valid = true;
+		char *save_ptr = nullptr;
+
+		for (char *token = strtok_r(line, " \t\r\n", &save_ptr); token != nullptr;
+		     token = strtok_r(nullptr, " \t\r\n", &save_ptr)) {
+
+			char *value = strchr(token, '=');
+
+			if (value == nullptr || num_overrides >= MAX_OVERRIDES) {
+				PX4_ERR("invalid override '%s'", token);
+				valid = false;
+				break;
+			}
+
+			*value++ = '\0';
+			const param_t handle = param_find(token);
+
+			if (handle == PARAM_INVALID) {
+				PX4_ERR("unknown parameter %s", token);
+				valid = false;
+				break;
+			}
+
+			Override &o = overrides[num_overrides++];
+			o.handle = handle;
+			param_get(handle, &o.original);
+
+			if (param_type(handle) == PARAM_TYPE_INT32) {
+				const int32_t v = strtol(value, nullptr, 0);
+				param_set_no_notification(handle, &v);
+
+			} else {
+				const float v = strtof(value, nullptr);
+				param_set_no_notification(handle, &v);
+			}
+		}
+
+		if (valid && num_overrides > 0) {
+			// spread the variants over the INS work queues so that they run in parallel
+			const int instance = num_variants;
+			EKF2 *ekf2_inst = new EKF2(instance, px4::ins_instance_to_wq(instance % 4), 0, 0, true);
+
+			if (ekf2_inst) {
+				PX4_INFO("starting variant %d (%d overrides)", instance, num_overrides);
+				_objects[instance].store(ekf2_inst);
+				ekf2_inst->ScheduleNow();
+				num_variants++;
+
+			} else {
+				PX4_ERR("instance %d alloc failed", instance);
+			}
+		}
+
+		// restore the original values for the next variant
+		for (int i = num_overrides - 1; i >= 0; i--) {
+			param_set_no_notification(overrides[i].handle, &overrides[i].original);
+		}
+
+		if (num_variants >= MAX_REPLAY_VARIANTS) {
+			PX4_WARN("max %d variants (logged estimator instances), ignoring the rest of %s", MAX_REPLAY_VARIANTS, variants_file);
+			break;
+		}
+	}
+
+	fclose(fp);
+	return num_variants;
+}
+#endif // !CONSTRAINED_FLASH
+
 int EKF2::task_spawn(int argc, char *argv[])
 {
 	bool success = false;
 	bool replay_mode = false;
+	const char *variants_file = nullptr;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "rb:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'r':
+			PX4_INFO("replay mode enabled");
+			replay_mode = true;
+			break;
+
+		case 'b':
+			variants_file = myoptarg;
+			break;
 
-	if (argc > 1 && !strcmp(argv[1], "-r")) {
-		PX4_INFO("replay mode enabled");
-		replay_mode = true;
+		default:
+			print_usage("unrecognized flag");
+			return PX4_ERROR;
+		}
 	}
 
 #if !defined(CONSTRAINED_FLASH)
+
+	if (variants_file) {
+		if (!replay_mode) {
+			print_usage("-b requires replay mode (-r)");
+			return PX4_ERROR;
+		}
+
+		return (start_replay_variants(variants_file) > 0) ? PX4_OK : PX4_ERROR;
+	}
+
 	bool multi_mode = false;
 	int32_t imu_instances = 0;
 	int32_t mag_instances = 0;
@@ -1662,11 +1801,18 @@ The documentation can be found on the [ECL/EKF Overview & Tuning](https://docs.p
 ekf2 can be started in replay mode (`-r`): in this mode it does not access the system time, but only uses the
 timestamps from the sensor topics.
 
+Together with `-b` it runs a batch of parameter variants over the same replayed log, one estimator instance per
+line of the given file (e.g. `EKF2_GPS_DELAY=120 EKF2_BARO_NOISE=2.5`). The variants run in parallel on the INS
+work queues, each with its own parameter snapshot, and publish the estimator_* topics with the variant index as
+multi-instance, so that a single replay produces the outputs of all variants in lockstep.
+The default logging profile records the first 4 estimator instances, use a custom logger topics file for more.
+
 )DESCR_STR");
 
 	PRINT_MODULE_USAGE_NAME("ekf2", "estimator");
 	PRINT_MODULE_USAGE_COMMAND("start");
 	PRINT_MODULE_USAGE_PARAM_FLAG('r', "Enable replay mode", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('b', nullptr, "<file>", "Batch replay: file with one line of parameter overrides per variant", true);
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
 
 	return 0;
@@ -50,6 +50,7 @@
 #include <lib/mathlib/mathlib.h>
 #include <lib/perf/perf_counter.h>
 #include <px4_platform_common/defines.h>
+#include <px4_platform_common/getopt.h>
 #include <px4_platform_common/module.h>
 #include <px4_platform_common/module_params.h>
 #include <px4_platform_common/posix.h>
@@ -159,6 +160,7 @@ private:
 
 	const bool _replay_mode{false};			///< true when we use replay data from a log
 	const bool _multi_mode;
+	const bool _batch_mode;				///< replay of a parameter variant (multi instance output, sensor_combined input)
 	const int _instance;
 
 	px4::atomic_bool _task_should_exit{false};
@@ -640,7 +640,7 @@ void FixedwingAttitudeControl::Run()
 
 		/* lazily publish the setpoint only once available */
 		_actuators.timestamp = hrt_absolute_time();
-		_actuators.timestamp_sample = att.timestamp;
+		_actuators.timestamp_sample = angular_velocity.timestamp_sample;
 
 		/* Only publish if any of the proper modes are enabled */
 		if (_vcontrol_mode.flag_control_rates_enabled ||
@@ -86,46 +86,43 @@ bool GyroFFT::SensorSelectionUpdate(bool force)
 				    && (sensor_gyro_fifo_sub.get().device_id == sensor_selection.gyro_device_id)) {
 
 					if (_sensor_gyro_fifo_sub.ChangeInstance(i) && _sensor_gyro_fifo_sub.registerCallback()) {
-						// find corresponding vehicle_imu_status instance
-						for (uint8_t imu_status = 0; imu_status < MAX_SENSOR_COUNT; imu_status++) {
-							uORB::Subscription imu_status_sub{ORB_ID(vehicle_imu_status), imu_status};
-
-							vehicle_imu_status_s vehicle_imu_status;
-
-							if (imu_status_sub.copy(&vehicle_imu_status)) {
-								if (vehicle_imu_status.gyro_device_id == sensor_selection.gyro_device_id) {
-									_vehicle_imu_status_sub.ChangeInstance(imu_status);
-									return true;
-								}
-							}
-						}
-
-						PX4_WARN("unable to find IMU status for gyro %d", sensor_selection.gyro_device_id);
+						_selected_sensor_device_id = sensor_selection.gyro_device_id;
+						Reset();
 						return true;
 					}
 				}
 			}
 
 			PX4_ERR("unable to find or subscribe to selected sensor (%d)", sensor_selection.gyro_device_id);
+			_selected_sensor_device_id = 0;
 		}
 	}
 
 	return false;
 }
 
-void GyroFFT::VehicleIMUStatusUpdate()
+void GyroFFT::Reset()
 {
-	vehicle_imu_status_s vehicle_imu_status;
+	_buffer_index = 0;
+	_buffer_samples = 0;
 
-	if (_vehicle_imu_status_sub.update(&vehicle_imu_status)) {
-		if ((vehicle_imu_status.gyro_rate_hz > 0) && (fabsf(vehicle_imu_status.gyro_rate_hz - _gyro_sample_rate_hz) > 1.f)) {
-			_gyro_sample_rate_hz = vehicle_imu_status.gyro_rate_hz;
-		}
+	for (int axis = 0; axis < 3; axis++) {
+		_fft_new_samples[axis] = 0;
+		_median_filter[axis] = {};
+
+		// invalidate peaks estimated from the previous data
+		_sensor_gyro_fft.peak_frequency[axis] = NAN;
+	}
+
+	for (int i = 0; i < MAX_NUM_PEAKS; i++) {
+		_sensor_gyro_fft.peak_frequencies_x[i] = NAN;
+		_sensor_gyro_fft.peak_frequencies_y[i] = NAN;
+		_sensor_gyro_fft.peak_frequencies_z[i] = NAN;
 	}
 }
 
 // helper function used for frequency estimation
-static constexpr float tau(float x)
+static float tau(float x)
 {
 	float p1 = logf(3.f * powf(x, 2.f) + 6 * x + 1);
 	float part1 = x + 1 - sqrtf(2.f / 3.f);
@@ -134,9 +131,11 @@ static constexpr float tau(float x)
 	return (1.f / 4.f * p1 - sqrtf(6) / 24 * p2);
 }
 
-float GyroFFT::EstimatePeakFrequency(q15_t fft[FFT_LENGTH * 2], uint8_t peak_index)
+float GyroFFT::EstimatePeakFrequency(const q15_t fft[FFT_LENGTH * 2], int peak_bin) const
 {
 	// find peak location using Quinn's Second Estimator (2020-06-14: http://dspguru.com/dsp/howtos/how-to-interpolate-fft-peak/)
+	// output is ordered [real[0], imag[0], real[1], imag[1], real[2], imag[2] ... real[(N/2)-1], imag[(N/2)-1]
+	const int peak_index = peak_bin * 2;
 	int16_t real[3] { fft[peak_index - 2],     fft[peak_index],     fft[peak_index + 2]     };
 	int16_t imag[3] { fft[peak_index - 2 + 1], fft[peak_index + 1], fft[peak_index + 2 + 1] };
 
@@ -154,8 +153,8 @@ float GyroFFT::EstimatePeakFrequency(q15_t fft[FFT_LENGTH * 2], uint8_t peak_ind
 	float dm = am / (1.f - am);
 	float d = (dp + dm) / 2 + tau(dp * dp) - tau(dm * dm);
 
-	float adjusted_bin = peak_index + d;
-	float peak_freq_adjusted = (_gyro_sample_rate_hz * adjusted_bin / (FFT_LENGTH * 2.f));
+	float adjusted_bin = peak_bin + d;
+	float peak_freq_adjusted = (_gyro_sample_rate_hz * adjusted_bin / FFT_LENGTH);
 
 	return peak_freq_adjusted;
 }
@@ -169,6 +168,125 @@ static int float_cmp(const void *elem1, const void *elem2)
 	return *(const float *)elem1 > *(const float *)elem2;
 }
 
+void GyroFFT::FindPeaks(int axis)
+{
+	// window the latest FFT_LENGTH samples, the oldest sample is at the current write position
+	const int oldest = _buffer_index;
+	const int first_length = FFT_LENGTH - oldest;
+	arm_mult_q15(&_gyro_data_buffer[axis][oldest], &_hanning_window[0], &_fft_input_buffer[0], first_length);
+	arm_mult_q15(&_gyro_data_buffer[axis][0], &_hanning_window[first_length], &_fft_input_buffer[first_length], oldest);
+
+	perf_begin(_fft_perf);
+	arm_rfft_q15(&_rfft_q15, _fft_input_buffer, _fft_outupt_buffer);
+	perf_end(_fft_perf);
+
+	const float resolution_hz = _gyro_sample_rate_hz / FFT_LENGTH;
+
+	// only look at the configured band (skipping DC), and leave a neighbour bin for the peak interpolation
+	const int bin_min = math::max((int)ceilf(_param_imu_gyro_fft_min.get() / resolution_hz), 1);
+	const int bin_max = math::min((int)(_param_imu_gyro_fft_max.get() / resolution_hz), FFT_LENGTH / 2 - 2);
+
+	if (bin_max - bin_min < 2) {
+		return;
+	}
+
+	const auto magnitude_squared = [this](int bin) {
+		const int32_t real = _fft_outupt_buffer[bin * 2];
+		const int32_t imag = _fft_outupt_buffer[bin * 2 + 1];
+		return (uint32_t)(real * real) + (uint32_t)(imag * imag);
+	};
+
+	// noise floor: mean magnitude over the band
+	uint64_t magnitude_sum = 0;
+
+	for (int bin = bin_min; bin <= bin_max; bin++) {
+		magnitude_sum += magnitude_squared(bin);
+	}
+
+	const float snr = _param_imu_gyro_fft_snr.get();
+	const uint32_t threshold = (uint32_t)math::min((float)magnitude_sum / (bin_max - bin_min + 1) * snr * snr, (float)UINT32_MAX);
+
+	// local maxima above the threshold, strongest first
+	uint32_t peak_magnitude[MAX_NUM_PEAKS] {};
+	int peak_bin[MAX_NUM_PEAKS] {};
+
+	uint32_t magnitude_prev = magnitude_squared(bin_min - 1);
+	uint32_t magnitude = magnitude_squared(bin_min);
+
+	for (int bin = bin_min; bin <= bin_max; bin++) {
+		const uint32_t magnitude_next = magnitude_squared(bin + 1);
+
+		if ((magnitude > threshold) && (magnitude > magnitude_prev) && (magnitude >= magnitude_next)) {
+			for (int i = 0; i < MAX_NUM_PEAKS; i++) {
+				if (magnitude > peak_magnitude[i]) {
+					// insert, dropping the weakest
+					for (int j = MAX_NUM_PEAKS - 1; j > i; j--) {
+						peak_magnitude[j] = peak_magnitude[j - 1];
+						peak_bin[j] = peak_bin[j - 1];
+					}
+
+					peak_magnitude[i] = magnitude;
+					peak_bin[i] = bin;
+					break;
+				}
+			}
+		}
+
+		magnitude_prev = magnitude;
+		magnitude = magnitude_next;
+	}
+
+	float *peak_frequencies = nullptr;
+
+	switch (axis) {
+	case 0:
+		peak_frequencies = _sensor_gyro_fft.peak_frequencies_x;
+		break;
+
+	case 1:
+		peak_frequencies = _sensor_gyro_fft.peak_frequencies_y;
+		break;
+
+	case 2:
+		peak_frequencies = _sensor_gyro_fft.peak_frequencies_z;
+		break;
+	}
+
+	int peaks_found = 0;
+
+	for (int i = 0; i < MAX_NUM_PEAKS; i++) {
+		if (peak_magnitude[i] > 0) {
+			const float freq = EstimatePeakFrequency(_fft_outupt_buffer, peak_bin[i]);
+
+			if (PX4_ISFINITE(freq) && (freq >= _param_imu_gyro_fft_min.get()) && (freq <= _param_imu_gyro_fft_max.get())) {
+				if (peaks_found == 0) {
+					// strongest peak
+					_sensor_gyro_fft.peak_frequency[axis] = _median_filter[axis].apply(freq);
+				}
+
+				peak_frequencies[peaks_found] = freq;
+				peaks_found++;
+			}
+		}
+	}
+
+	if (peaks_found == 0) {
+		_sensor_gyro_fft.peak_frequency[axis] = NAN;
+	}
+
+	// mark remaining slots empty
+	for (int i = peaks_found; i < MAX_NUM_PEAKS; i++) {
+		peak_frequencies[i] = NAN;
+	}
+
+	// publish in sorted order, so that a slot tends to follow the same peak
+	if (peaks_found > 0) {
+		qsort(peak_frequencies, peaks_found, sizeof(float), float_cmp);
+	}
+
+	_sensor_gyro_fft.resolution_hz = resolution_hz;
+}
+
 void GyroFFT::Run()
 {
 	if (should_exit()) {
@@ -194,172 +312,66 @@ void GyroFFT::Run()
 
 	SensorSelectionUpdate();
 
-	const float resolution_hz = _gyro_sample_rate_hz / FFT_LENGTH;
-
-	bool publish = false;
-	bool fft_updated = false;
-
 	// run on sensor gyro fifo updates
 	sensor_gyro_fifo_s sensor_gyro_fifo;
+	hrt_abstime timestamp_sample = 0;
 
 	while (_sensor_gyro_fifo_sub.update(&sensor_gyro_fifo)) {
 
 		if (_sensor_gyro_fifo_sub.get_last_generation() != _gyro_last_generation + 1) {
 			// force reset if we've missed a sample
-			_fft_buffer_index[0] = 0;
-			_fft_buffer_index[1] = 0;
-			_fft_buffer_index[2] = 0;
-
+			Reset();
 			perf_count(_gyro_fifo_generation_gap_perf);
 		}
 
 		_gyro_last_generation = _sensor_gyro_fifo_sub.get_last_generation();
 
-		const int N = sensor_gyro_fifo.samples;
+		if (sensor_gyro_fifo.dt > 0.f) {
+			const float sample_rate_hz = 1e6f / sensor_gyro_fifo.dt;
 
-		for (int axis = 0; axis < 3; axis++) {
-			int16_t *input = nullptr;
-
-			switch (axis) {
-			case 0:
-				input = sensor_gyro_fifo.x;
-				break;
-
-			case 1:
-				input = sensor_gyro_fifo.y;
-				break;
-
-			case 2:
-				input = sensor_gyro_fifo.z;
-				break;
+			if (fabsf(sample_rate_hz - _gyro_sample_rate_hz) > 1.f) {
+				_gyro_sample_rate_hz = sample_rate_hz;
+				Reset();
 			}
+		}
 
-			int &buffer_index = _fft_buffer_index[axis];
-
-			for (int n = 0; n < N; n++) {
-				if (buffer_index < FFT_LENGTH) {
-					// convert int16_t -> q15_t (scaling isn't relevant)
-					_gyro_data_buffer[axis][buffer_index] = input[n] / 2;
-					buffer_index++;
-				}
-
-				// if we have enough samples begin processing, but only one FFT per cycle
-				if ((buffer_index >= FFT_LENGTH) && !fft_updated) {
-
-					arm_mult_q15(_gyro_data_buffer[axis], _hanning_window, _fft_input_buffer, FFT_LENGTH);
-
-					perf_begin(_fft_perf);
-					arm_rfft_q15(&_rfft_q15, _fft_input_buffer, _fft_outupt_buffer);
-					perf_end(_fft_perf);
-					fft_updated = true;
-
-					static constexpr uint16_t MIN_SNR = 10; // TODO:
-
-					uint32_t max_peak_magnitude = 0;
-					uint8_t max_peak_index = 0;
-
-					static constexpr int MAX_NUM_PEAKS = 4;
-					uint32_t peaks_magnitude[MAX_NUM_PEAKS] {};
-					uint8_t peak_index[MAX_NUM_PEAKS] {};
-
-					// start at 2 to skip DC
-					// output is ordered [real[0], imag[0], real[1], imag[1], real[2], imag[2] ... real[(N/2)-1], imag[(N/2)-1]
-					for (uint8_t bucket_index = 2; bucket_index < (FFT_LENGTH / 2); bucket_index = bucket_index + 2) {
-						const float freq_hz = (bucket_index / 2) * resolution_hz;
-
-						if (freq_hz > _param_imu_gyro_fft_max.get()) {
-							break;
-						}
-
-						if (freq_hz >= _param_imu_gyro_fft_min.get()) {
-							const int16_t real = _fft_outupt_buffer[bucket_index];
-							const int16_t complex = _fft_outupt_buffer[bucket_index + 1];
-
-							const uint32_t fft_magnitude_squared = real * real + complex * complex;
-
-							if (fft_magnitude_squared > MIN_SNR) {
-
-								if (fft_magnitude_squared > max_peak_magnitude) {
-									max_peak_magnitude = fft_magnitude_squared;
-									max_peak_index = bucket_index;
-								}
+		const int N = math::min((int)sensor_gyro_fifo.samples, (int)(sizeof(sensor_gyro_fifo.x) / sizeof(sensor_gyro_fifo.x[0])));
 
-								for (int i = 0; i < MAX_NUM_PEAKS; i++) {
-									if (fft_magnitude_squared > peaks_magnitude[i]) {
-										peaks_magnitude[i] = fft_magnitude_squared;
-										peak_index[i] = bucket_index;
-										publish = true;
-										break;
-									}
-								}
-							}
-						}
-					}
+		for (int n = 0; n < N; n++) {
+			// convert int16_t -> q15_t (scaling isn't relevant)
+			_gyro_data_buffer[0][_buffer_index] = sensor_gyro_fifo.x[n] / 2;
+			_gyro_data_buffer[1][_buffer_index] = sensor_gyro_fifo.y[n] / 2;
+			_gyro_data_buffer[2][_buffer_index] = sensor_gyro_fifo.z[n] / 2;
 
-					if (max_peak_index > 0) {
-						_sensor_gyro_fft.peak_frequency[axis] = _median_filter[axis].apply(EstimatePeakFrequency(_fft_outupt_buffer,
-											max_peak_index));
-					}
+			_buffer_index = (_buffer_index + 1) % FFT_LENGTH;
+		}
 
-					if (publish) {
-						float *peak_frequencies;
-
-						switch (axis) {
-						case 0:
-							peak_frequencies = _sensor_gyro_fft.peak_frequencies_x;
-							break;
-
-						case 1:
-							peak_frequencies = _sensor_gyro_fft.peak_frequencies_y;
-							break;
-
-						case 2:
-							peak_frequencies = _sensor_gyro_fft.peak_frequencies_z;
-							break;
-						}
-
-						int peaks_found = 0;
-
-						for (int i = 0; i < MAX_NUM_PEAKS; i++) {
-							if ((peak_index[i] > 0) && (peak_index[i] < FFT_LENGTH) && (peaks_magnitude[i] > 0)) {
-								const float freq = EstimatePeakFrequency(_fft_outupt_buffer, peak_index[i]);
-
-								if (freq >= _param_imu_gyro_fft_min.get() && freq <= _param_imu_gyro_fft_max.get()) {
-									peak_frequencies[peaks_found] = freq;
-									peaks_found++;
-								}
-							}
-						}
-
-						// mark remaining slots empty
-						for (int i = peaks_found; i < MAX_NUM_PEAKS; i++) {
-							peak_frequencies[i] = NAN;
-						}
-
-						// publish in sorted order for convenience
-						if (peaks_found > 0) {
-							qsort(peak_frequencies, peaks_found, sizeof(float), float_cmp);
-						}
-					}
+		_buffer_samples = math::min(_buffer_samples + N, (int)FFT_LENGTH);
 
-					// reset
-					// shift buffer (75% overlap)
-					int overlap_start = FFT_LENGTH / 4;
-					memmove(&_gyro_data_buffer[axis][0], &_gyro_data_buffer[axis][overlap_start], sizeof(q15_t) * overlap_start * 3);
-					buffer_index = overlap_start * 3;
-				}
-			}
+		for (int axis = 0; axis < 3; axis++) {
+			_fft_new_samples[axis] += N;
 		}
 
-		if (publish) {
-			_sensor_gyro_fft.dt = 1e6f / _gyro_sample_rate_hz;
-			_sensor_gyro_fft.device_id = sensor_gyro_fifo.device_id;
-			_sensor_gyro_fft.resolution_hz = resolution_hz;
-			_sensor_gyro_fft.timestamp_sample = sensor_gyro_fifo.timestamp_sample;
-			_sensor_gyro_fft.timestamp = hrt_absolute_time();
-			_sensor_gyro_fft_pub.publish(_sensor_gyro_fft);
+		timestamp_sample = sensor_gyro_fifo.timestamp_sample;
+	}
 
-			publish = false;
+	// at most one FFT per cycle (axes round-robin) to spread the load
+	if (_buffer_samples >= FFT_LENGTH) {
+		for (int i = 0; i < 3; i++) {
+			const int axis = (_fft_axis + i) % 3;
+
+			if (_fft_new_samples[axis] >= FFT_HOP) {
+				FindPeaks(axis);
+				_fft_new_samples[axis] = 0;
+				_fft_axis = (axis + 1) % 3;
+
+				_sensor_gyro_fft.dt = 1e6f / _gyro_sample_rate_hz;
+				_sensor_gyro_fft.device_id = _selected_sensor_device_id;
+				_sensor_gyro_fft.timestamp_sample = timestamp_sample;
+				_sensor_gyro_fft.timestamp = hrt_absolute_time();
+				_sensor_gyro_fft_pub.publish(_sensor_gyro_fft);
+				break;
+			}
 		}
 	}
 
@@ -412,6 +424,13 @@ int GyroFFT::print_usage(const char *reason)
 	PRINT_MODULE_DESCRIPTION(
 		R"DESCR_STR(
 ### Description
+Real-time FFT of the selected gyro's raw FIFO data.
+
+The latest 2048 samples of each axis are kept in a ring buffer, and a windowed FFT
+is computed whenever enough new samples arrived (75% overlap, at most one axis per cycle).
+Up to 4 peaks per axis within [IMU_GYRO_FFT_MIN, IMU_GYRO_FFT_MAX] that stand out from the
+noise floor (IMU_GYRO_FFT_SNR) are published in sensor_gyro_fft, which is used by the
+dynamic notch filters of the rate controller (IMU_GYRO_DNF_EN).
 
 )DESCR_STR");
 
@@ -49,7 +49,6 @@
 #include <uORB/topics/sensor_gyro_fft.h>
 #include <uORB/topics/sensor_gyro_fifo.h>
 #include <uORB/topics/sensor_selection.h>
-#include <uORB/topics/vehicle_imu_status.h>
 
 #include "arm_math.h"
 #include "arm_const_structs.h"
@@ -76,11 +75,16 @@ public:
 
 private:
 	static constexpr uint16_t FFT_LENGTH = 2048;
+	static constexpr uint16_t FFT_HOP = FFT_LENGTH / 4; // new samples per FFT and axis (75% overlap)
 
-	float EstimatePeakFrequency(q15_t fft[FFT_LENGTH * 2], uint8_t peak_index);
+	static constexpr int MAX_NUM_PEAKS = sizeof(sensor_gyro_fft_s::peak_frequencies_x) / sizeof(
+			sensor_gyro_fft_s::peak_frequencies_x[0]);
+
+	float EstimatePeakFrequency(const q15_t fft[FFT_LENGTH * 2], int peak_bin) const;
+	void FindPeaks(int axis);
+	void Reset();
 	void Run() override;
 	bool SensorSelectionUpdate(bool force = false);
-	void VehicleIMUStatusUpdate();
 
 	static constexpr int MAX_SENSOR_COUNT = 3;
 
@@ -88,7 +92,6 @@ private:
 
 	uORB::Subscription _parameter_update_sub{ORB_ID(parameter_update)};
 	uORB::Subscription _sensor_selection_sub{ORB_ID(sensor_selection)};
-	uORB::Subscription _vehicle_imu_status_sub{ORB_ID(vehicle_imu_status)};
 
 	uORB::SubscriptionCallbackWorkItem _sensor_gyro_fifo_sub{this, ORB_ID(sensor_gyro_fifo)};
 
@@ -101,6 +104,7 @@ private:
 
 	arm_rfft_instance_q15 _rfft_q15;
 
+	// ring buffers of the latest FFT_LENGTH samples per axis
 	q15_t _gyro_data_buffer[3][FFT_LENGTH] {};
 	q15_t _hanning_window[FFT_LENGTH] {};
 	q15_t _fft_input_buffer[FFT_LENGTH] {};
@@ -108,7 +112,10 @@ private:
 
 	float _gyro_sample_rate_hz{8000}; // 8 kHz default
 
-	int _fft_buffer_index[3] {};
+	int _buffer_index{0}; ///< next write position (oldest sample) of the ring buffers
+	int _buffer_samples{0}; ///< number of valid samples in the ring buffers
+	int _fft_new_samples[3] {}; ///< samples added since the last FFT per axis
+	int _fft_axis{0}; ///< next axis to check (round-robin)
 
 	unsigned _gyro_last_generation{0};
 
@@ -118,6 +125,7 @@ private:
 
 	DEFINE_PARAMETERS(
 		(ParamFloat<px4::params::IMU_GYRO_FFT_MIN>) _param_imu_gyro_fft_min,
-		(ParamFloat<px4::params::IMU_GYRO_FFT_MAX>) _param_imu_gyro_fft_max
+		(ParamFloat<px4::params::IMU_GYRO_FFT_MAX>) _param_imu_gyro_fft_max,
+		(ParamFloat<px4::params::IMU_GYRO_FFT_SNR>) _param_imu_gyro_fft_snr
 	)
 };
@@ -61,3 +61,16 @@ PARAM_DEFINE_FLOAT(IMU_GYRO_FFT_MIN, 50.0f);
 * @group Sensors
 */
 PARAM_DEFINE_FLOAT(IMU_GYRO_FFT_MAX, 200.0f);
+
+/**
+* IMU gyro FFT SNR.
+*
+* Minimum peak magnitude, relative to the mean magnitude over the
+* [IMU_GYRO_FFT_MIN, IMU_GYRO_FFT_MAX] band, for a peak to be reported.
+*
+* @min 1
+* @max 30
+* @decimal 1
+* @group Sensors
+*/
+PARAM_DEFINE_FLOAT(IMU_GYRO_FFT_SNR, 10.0f);
@@ -76,6 +76,9 @@ void LogWriterMavlink::start_log()
 	_ulog_stream_data.length = 0;
 	_ulog_stream_data.first_message_offset = 0;
 
+	_last_acked_sequence = _ulog_stream_data.msg_sequence - 1;
+	_window_size = 1;
+
 	_is_started = true;
 }
 
@@ -122,6 +125,9 @@ void LogWriterMavlink::set_need_reliable_transfer(bool need_reliable)
 			// make sure to send previous data using reliable transfer
 			publish_message();
 		}
+
+		// all reliable data needs to be acked before continuing without acks
+		wait_for_acks(0);
 	}
 
 	_need_reliable_transfer = need_reliable;
@@ -138,49 +144,60 @@ int LogWriterMavlink::publish_message()
 
 	_ulog_stream_pub.publish(_ulog_stream_data);
 
-	if (_need_reliable_transfer) {
-		// we need to wait for an ack. Note that this blocks the main logger thread, so if a file logging
-		// is already running, it will miss samples.
-		px4_pollfd_struct_t fds[1];
-		fds[0].fd = _ulog_stream_ack_sub;
-		fds[0].events = POLLIN;
-		bool got_ack = false;
-		const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
+	_ulog_stream_data.msg_sequence++;
+	_ulog_stream_data.length = 0;
+	_ulog_stream_data.first_message_offset = 255;
 
-		hrt_abstime started = hrt_absolute_time();
+	if (_need_reliable_transfer) {
+		// Wait until there is room in the send window. Note that this blocks the main logger thread, so if a file
+		// logging is already running, it will miss samples.
+		return wait_for_acks(_window_size - 1);
+	}
 
-		do {
-			int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
+	_last_acked_sequence = _ulog_stream_data.msg_sequence - 1;
+	return 0;
+}
 
-			if (ret <= 0) {
-				break;
-			}
+int LogWriterMavlink::wait_for_acks(int max_in_flight)
+{
+	px4_pollfd_struct_t fds[1];
+	fds[0].fd = _ulog_stream_ack_sub;
+	fds[0].events = POLLIN;
+	const int timeout_ms = ulog_stream_ack_s::ACK_TIMEOUT * ulog_stream_ack_s::ACK_MAX_TRIES;
 
-			if (fds[0].revents & POLLIN) {
-				ulog_stream_ack_s ack;
-				orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
+	hrt_abstime last_progress = hrt_absolute_time();
 
-				if (ack.msg_sequence == _ulog_stream_data.msg_sequence) {
-					got_ack = true;
-				}
+	while (_is_started && num_in_flight() > max_in_flight) {
+		if (hrt_elapsed_time(&last_progress) / 1000 >= (hrt_abstime)timeout_ms) {
+			PX4_ERR("Ack timeout. Stopping mavlink log");
+			stop_log();
+			return -2;
+		}
 
-			} else {
-				break;
-			}
-		} while (!got_ack && hrt_elapsed_time(&started) / 1000 < timeout_ms);
+		int ret = px4_poll(fds, sizeof(fds) / sizeof(fds[0]), timeout_ms);
 
-		if (!got_ack) {
+		if (ret <= 0 || !(fds[0].revents & POLLIN)) {
 			PX4_ERR("Ack timeout. Stopping mavlink log");
 			stop_log();
 			return -2;
 		}
 
-		PX4_DEBUG("got ack in %i ms", (int)(hrt_elapsed_time(&started) / 1000));
+		ulog_stream_ack_s ack;
+		orb_copy(ORB_ID(ulog_stream_ack), _ulog_stream_ack_sub, &ack);
+
+		// acks are cumulative: only accept ones that are within the range of the messages in flight
+		const uint16_t acked_ahead = ack.msg_sequence - _last_acked_sequence;
+
+		if (acked_ahead > 0 && acked_ahead <= num_in_flight()) {
+			_last_acked_sequence = ack.msg_sequence;
+			last_progress = hrt_absolute_time();
+		}
+
+		if (ack.window_size > 0) {
+			_window_size = math::min((int)ack.window_size, (int)ulog_stream_ack_s::WINDOW_SIZE_MAX);
+		}
 	}
 
-	_ulog_stream_data.msg_sequence++;
-	_ulog_stream_data.length = 0;
-	_ulog_stream_data.first_message_offset = 255;
 	return 0;
 }
 
@@ -76,9 +76,20 @@ private:
 	/** publish message, wait for ack if needed & reset message */
 	int publish_message();
 
+	/**
+	 * wait until at most max_in_flight published messages are not yet acked
+	 * @return 0 on success, -2 on timeout (logging is stopped in that case)
+	 */
+	int wait_for_acks(int max_in_flight);
+
+	/** number of published messages that are not yet acked */
+	int num_in_flight() const { return (uint16_t)(_ulog_stream_data.msg_sequence - _last_acked_sequence - 1); }
+
 	ulog_stream_s _ulog_stream_data{};
 	uORB::Publication<ulog_stream_s> _ulog_stream_pub{ORB_ID(ulog_stream)};
 	int _ulog_stream_ack_sub{-1};
+	uint16_t _last_acked_sequence{0}; ///< all messages up to this sequence are acked
+	int _window_size{1}; ///< number of unacked messages we can have in flight (set by the receiver)
 	bool _need_reliable_transfer{false};
 	bool _is_started{false};
 };
@@ -66,6 +66,7 @@ void LoggedTopics::add_default_topics()
 	add_topic("navigator_mission_item");
 	add_topic("offboard_control_mode", 100);
 	add_topic("onboard_computer_status", 10);
+	add_topic("perf_trace");
 	add_topic("position_controller_status", 500);
 	add_topic("position_setpoint_triplet", 200);
 	add_topic("px4io_status");
@@ -104,13 +105,14 @@ void LoggedTopics::add_default_topics()
 
 	// multi topics
 	add_topic_multi("actuator_outputs", 100, 2);
+	add_topic_multi("control_latency", 0, 2);
 	add_topic_multi("logger_status", 0, 2);
 	add_topic_multi("multirotor_motor_limits", 1000, 2);
 	add_topic_multi("rate_ctrl_status", 200, 2);
 	add_topic_multi("telemetry_status", 1000, 4);
 
 	// EKF multi topics (currently max 9 estimators)
-	static constexpr uint8_t MAX_ESTIMATOR_INSTANCES = 4;
+	static constexpr uint8_t MAX_ESTIMATOR_INSTANCES = 4; // also limits the ekf2 replay variants (ekf2 start -r -b)
 	add_topic("estimator_selector_status", 200);
 	add_topic_multi("ekf_gps_drift", 1000, MAX_ESTIMATOR_INSTANCES);
 	add_topic_multi("estimator_attitude", 500, MAX_ESTIMATOR_INSTANCES);
@@ -138,6 +140,7 @@ void LoggedTopics::add_default_topics()
 	add_topic_multi("sensor_gyro", 1000, 4);
 	add_topic_multi("sensor_mag", 1000, 4);
 	add_topic_multi("vehicle_imu", 500, 4);
+	add_topic("vehicle_imu_fused", 500);
 	add_topic_multi("vehicle_imu_status", 1000, 4);
 
 #ifdef CONFIG_ARCH_BOARD_PX4_SITL
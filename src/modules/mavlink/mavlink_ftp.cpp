@@ -42,6 +42,8 @@
 #include <errno.h>
 #include <cstring>
 
+#include <parameters/param.h>
+
 #include "mavlink_ftp.h"
 #include "mavlink_tests/mavlink_ftp_test.h"
 
@@ -54,6 +56,7 @@
 using namespace time_literals;
 
 constexpr const char MavlinkFTP::_root_dir[];
+constexpr const char MavlinkFTP::kParamFile[];
 
 MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 	_mavlink(mavlink)
@@ -64,6 +67,10 @@ MavlinkFTP::MavlinkFTP(Mavlink *mavlink) :
 
 MavlinkFTP::~MavlinkFTP()
 {
+	if (_session_info.fd >= 0) {
+		_close_session();
+	}
+
 	delete[] _work_buffer1;
 	delete[] _work_buffer2;
 }
@@ -505,8 +512,28 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 		return kErrNoSessionsAvailable;
 	}
 
-	strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
-	strncpy(_work_buffer1 + _root_dir_len, _data_as_cstring(payload), _work_buffer1_len - _root_dir_len);
+	const bool param_export = (oflag == O_RDONLY && strcmp(_data_as_cstring(payload), kParamFile) == 0);
+
+	if (param_export) {
+		// virtual file: export the current parameter set, then read it like any other file
+#ifdef MAVLINK_FTP_UNIT_TEST
+		snprintf(_param_export_path, sizeof(_param_export_path), "param_ftp_unit_test.bson");
+#else
+		snprintf(_param_export_path, sizeof(_param_export_path), PX4_STORAGEDIR "/.param_ftp_%d.bson",
+			 _mavlink->get_instance_id());
+#endif
+
+		if (!_export_parameters(_param_export_path)) {
+			::unlink(_param_export_path);
+			return kErrFailErrno;
+		}
+
+		strncpy(_work_buffer1, _param_export_path, _work_buffer1_len);
+
+	} else {
+		strncpy(_work_buffer1, _root_dir, _work_buffer1_len);
+		strncpy(_work_buffer1 + _root_dir_len, _data_as_cstring(payload), _work_buffer1_len - _root_dir_len);
+	}
 
 #ifdef MAVLINK_FTP_DEBUG
 	PX4_INFO("FTP: open '%s'", _work_buffer1);
@@ -531,11 +558,18 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 	int fd = ::open(_work_buffer1, oflag, PX4_O_MODE_666);
 
 	if (fd < 0) {
+		if (param_export) {
+			const int errno_open = errno;
+			::unlink(_param_export_path);
+			errno = errno_open;
+		}
+
 		return kErrFailErrno;
 	}
 
 	_session_info.fd = fd;
 	_session_info.file_size = fileSize;
+	_param_export_open = param_export;
 	_session_info.stream_download = false;
 
 	payload->session = 0;
@@ -545,6 +579,30 @@ MavlinkFTP::_workOpen(PayloadHeader *payload, int oflag)
 	return kErrNone;
 }
 
+/// @brief Writes all parameters to path (for the kParamFile virtual file)
+///	@return true on success
+bool
+MavlinkFTP::_export_parameters(const char *path)
+{
+	int fd = ::open(path, O_CREAT | O_TRUNC | O_WRONLY, PX4_O_MODE_666);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	int ret = param_export_used(fd);
+	int errno_export = errno;
+	::close(fd);
+
+	if (ret != 0) {
+		// make sure the Nak contains a meaningful errno
+		errno = (errno_export != 0) ? errno_export : EIO;
+		return false;
+	}
+
+	return true;
+}
+
 /// @brief Responds to a Read command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRead(PayloadHeader *payload)
@@ -751,9 +809,7 @@ MavlinkFTP::_workTerminate(PayloadHeader *payload)
 		return kErrInvalidSession;
 	}
 
-	::close(_session_info.fd);
-	_session_info.fd = -1;
-	_session_info.stream_download = false;
+	_close_session();
 
 	payload->size = 0;
 
@@ -765,9 +821,7 @@ MavlinkFTP::ErrorCode
 MavlinkFTP::_workReset(PayloadHeader *payload)
 {
 	if (_session_info.fd != -1) {
-		::close(_session_info.fd);
-		_session_info.fd = -1;
-		_session_info.stream_download = false;
+		_close_session();
 	}
 
 	payload->size = 0;
@@ -775,6 +829,20 @@ MavlinkFTP::_workReset(PayloadHeader *payload)
 	return kErrNone;
 }
 
+/// @brief Closes the open session, removing the parameter export file if that is what it was reading
+void
+MavlinkFTP::_close_session()
+{
+	::close(_session_info.fd);
+	_session_info.fd = -1;
+	_session_info.stream_download = false;
+
+	if (_param_export_open) {
+		::unlink(_param_export_path);
+		_param_export_open = false;
+	}
+}
+
 /// @brief Responds to a Rename command
 MavlinkFTP::ErrorCode
 MavlinkFTP::_workRename(PayloadHeader *payload)
@@ -976,9 +1044,7 @@ void MavlinkFTP::send()
 	} else if (_session_info.fd != -1) {
 		// close session without activity
 		if (hrt_elapsed_time(&_last_work_buffer_access) > 10_s) {
-			::close(_session_info.fd);
-			_session_info.fd = -1;
-			_session_info.stream_download = false;
+			_close_session();
 			_last_reply_valid = false;
 			PX4_WARN("Session was closed without activity");
 		}
@@ -130,12 +130,19 @@ public:
 
 	unsigned get_size();
 
+	/// @brief Path of the virtual file containing all parameters (BSON, @see param_export_used()).
+	/// It is generated whenever it is opened for reading. A ground station can compare the leading
+	/// "_HASH_CHECK" entry (or the _HASH_CHECK parameter) with its cache to skip the parameter sync.
+	static constexpr const char kParamFile[] = "@PARAM/param.bson";
+
 private:
 	char		*_data_as_cstring(PayloadHeader *payload);
 
 	void		_process_request(mavlink_file_transfer_protocol_t *ftp_req, uint8_t target_system_id, uint8_t target_comp_id);
 	void		_reply(mavlink_file_transfer_protocol_t *ftp_req);
 	int		_copy_file(const char *src_path, const char *dst_path, size_t length);
+	bool		_export_parameters(const char *path);
+	void		_close_session();
 
 	ErrorCode	_workList(PayloadHeader *payload);
 	ErrorCode	_workOpen(PayloadHeader *payload, int oflag);
@@ -205,6 +212,10 @@ private:
 #endif
 	static constexpr const int _root_dir_len = sizeof(_root_dir) - 1;
 
+	// real file backing kParamFile, one per mavlink instance. It only exists while the session reading it is open.
+	char _param_export_path[64] {};
+	bool _param_export_open{false};
+
 	bool _last_reply_valid = false;
 	uint8_t _last_reply[MAVLINK_MSG_ID_FILE_TRANSFER_PROTOCOL_LEN - MAVLINK_MSG_FILE_TRANSFER_PROTOCOL_FIELD_PAYLOAD_LEN
 								      + sizeof(PayloadHeader) + sizeof(uint32_t)];
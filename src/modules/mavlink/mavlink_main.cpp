@@ -406,6 +406,12 @@ Mavlink::get_status_all_instances(bool show_streams_status)
 
 	unsigned iterations = 0;
 
+	if (show_streams_status && !MavlinkStream::send_timing_enabled()) {
+		// send() timing costs two clock reads per message, so it only runs once requested
+		MavlinkStream::enable_send_timing();
+		PX4_INFO("stream send timing enabled, statistics are accounted from now on");
+	}
+
 	while (inst != nullptr) {
 
 		printf("\ninstance #%u:\n", iterations);
@@ -1235,6 +1241,17 @@ Mavlink::configure_stream(const char *stream_name, const float rate)
 {
 	PX4_DEBUG("configure_stream(%s, %.3f)", stream_name, (double)rate);
 
+	if (strcmp(stream_name, "all") == 0) {
+		// configure every supported stream (used for benchmarking)
+		const char *name = nullptr;
+
+		for (unsigned i = 0; (name = get_stream_name_by_index(i)) != nullptr; i++) {
+			configure_stream(name, rate);
+		}
+
+		return OK;
+	}
+
 	/* calculate interval in us, -1 means unlimited stream, 0 means disabled */
 	int interval = 0;
 
@@ -2620,6 +2637,7 @@ void Mavlink::publish_telemetry_status()
 	_tstatus.mavlink_v2 = (_protocol_version == 2);
 
 	_tstatus.streams = _streams.size();
+	_tstatus.tx_buffer_overruns = perf_event_count(_send_start_tx_buf_low);
 
 	// telemetry_status is also updated from the receiver thread, but never the same fields
 	_tstatus.timestamp = hrt_absolute_time();
@@ -2798,6 +2816,7 @@ Mavlink::display_status()
 	printf("\trates:\n");
 	printf("\t  tx: %.3f kB/s\n", (double)_tstatus.rate_tx);
 	printf("\t  txerr: %.3f kB/s\n", (double)_tstatus.rate_txerr);
+	printf("\t  tx buffer overruns: %u\n", (unsigned)perf_event_count(_send_start_tx_buf_low));
 	printf("\t  tx rate mult: %.3f\n", (double)_rate_mult);
 	printf("\t  tx rate max: %i B/s\n", _datarate);
 	printf("\t  rx: %.3f kB/s\n", (double)_tstatus.rate_rx);
@@ -2848,7 +2867,8 @@ Mavlink::display_status()
 void
 Mavlink::display_status_streams()
 {
-	printf("\t%-20s%-16s %s\n", "Name", "Rate Config (current) [Hz]", "Message Size (if active) [B]");
+	printf("\t%-20s%-16s %s %s\n", "Name", "Rate Config (current) [Hz]", "Message Size (if active) [B]",
+	       "Sent (send time avg/max [us])");
 
 	const float rate_mult = _rate_mult;
 
@@ -2871,7 +2891,17 @@ Mavlink::display_status_streams()
 		printf("\t%-30s%-16s", stream->get_name(), rate_str);
 
 		if (size > 0) {
-			printf(" %3i\n", size);
+			printf(" %3i", size);
+
+		} else {
+			printf("    ");
+		}
+
+		const uint32_t send_count = stream->send_count();
+
+		if (send_count > 0) {
+			printf(" %8u (%.1f/%llu)\n", (unsigned)send_count, (double)stream->send_elapsed() / send_count,
+			       (unsigned long long)stream->send_elapsed_max());
 
 		} else {
 			printf("\n");
@@ -3081,14 +3111,14 @@ $ mavlink stream -u 14556 -s HIGHRES_IMU -r 50
 	PRINT_MODULE_USAGE_COMMAND_DESCR("stop-all", "Stop all instances");
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print status for all instances");
-	PRINT_MODULE_USAGE_ARG("streams", "Print all enabled streams", true);
+	PRINT_MODULE_USAGE_ARG("streams", "Print all enabled streams (enables send time statistics on first use)", true);
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("stream", "Configure the sending rate of a stream for a running instance");
 #if defined(CONFIG_NET) || defined(__PX4_POSIX)
 	PRINT_MODULE_USAGE_PARAM_INT('u', -1, 0, 65536, "Select Mavlink instance via local Network Port", true);
 #endif
 	PRINT_MODULE_USAGE_PARAM_STRING('d', nullptr, "<file:dev>", "Select Mavlink instance via Serial Device", true);
-	PRINT_MODULE_USAGE_PARAM_STRING('s', nullptr, nullptr, "Mavlink stream to configure", false);
+	PRINT_MODULE_USAGE_PARAM_STRING('s', nullptr, nullptr, "Mavlink stream to configure (all: every supported stream)", false);
 	PRINT_MODULE_USAGE_PARAM_FLOAT('r', -1.0f, 0.0f, 2000.0f, "Rate in Hz (0 = turn off, -1 = set to default)", false);
 
 	PRINT_MODULE_USAGE_COMMAND_DESCR("boot_complete",
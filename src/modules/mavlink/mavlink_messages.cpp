@@ -4375,6 +4375,9 @@ protected:
 	}
 };
 
+// Every mavlink instance packs its own stream messages. Sharing the packed messages
+// between instances was measured to be slower: locking the shared copy costs about as
+// much as packing, and the uORB copies needed to detect new data are required either way.
 static const StreamListItem streams_list[] = {
 	create_stream_list_item<MavlinkStreamHeartbeat>(),
 	create_stream_list_item<MavlinkStreamStatustext>(),
@@ -4502,6 +4505,15 @@ const char *get_stream_name(const uint16_t msg_id)
 	return nullptr;
 }
 
+const char *get_stream_name_by_index(const unsigned index)
+{
+	if (index < sizeof(streams_list) / sizeof(streams_list[0])) {
+		return streams_list[index].get_name();
+	}
+
+	return nullptr;
+}
+
 MavlinkStream *create_mavlink_stream(const char *stream_name, Mavlink *mavlink)
 {
 	// search for stream with specified name in supported streams list
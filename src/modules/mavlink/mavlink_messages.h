@@ -68,6 +68,11 @@ static StreamListItem create_stream_list_item()
 
 const char *get_stream_name(const uint16_t msg_id);
 
+/**
+ * @return name of the stream at index in the supported streams list, nullptr if index is out of range
+ */
+const char *get_stream_name_by_index(const unsigned index);
+
 MavlinkStream *create_mavlink_stream(const char *stream_name, Mavlink *mavlink);
 
 MavlinkStream *create_mavlink_stream(const uint16_t msg_id, Mavlink *mavlink);
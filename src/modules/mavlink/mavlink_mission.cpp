@@ -73,6 +73,8 @@ uint16_t MavlinkMissionManager::_safepoint_update_counter = 0;
 MavlinkMissionManager::MavlinkMissionManager(Mavlink *mavlink) :
 	_mavlink(mavlink)
 {
+	_param_pipeline_length = param_find("MAV_MIS_PIPELINE");
+
 	init_offboard_mission();
 }
 
@@ -512,12 +514,33 @@ MavlinkMissionManager::send()
 		}
 	}
 
+	if (_state == MAVLINK_WPM_STATE_GETLIST && pipelined_transfer()) {
+		// write-behind: store the items received since the last update, then refill the pipeline
+		if (flush_transfer_buffer() == PX4_OK) {
+			request_pipelined_items();
+
+		} else {
+			PX4_DEBUG("WPM: MISSION_ITEM ERROR: error writing seq %u to dataman ID %i", _transfer_write_seq,
+				  _transfer_dataman_id);
+
+			send_mission_ack(_transfer_partner_sysid, _transfer_partner_compid, MAV_MISSION_ERROR);
+			_mavlink->send_statustext_critical("Unable to write on micro SD");
+			switch_to_idle_state();
+			_transfer_in_progress = false;
+		}
+	}
+
 	/* check for timed-out operations */
 	if (_state == MAVLINK_WPM_STATE_GETLIST && (_time_last_sent > 0)
 	    && hrt_elapsed_time(&_time_last_sent) > MAVLINK_MISSION_RETRY_TIMEOUT_DEFAULT) {
 
-		// try to request item again after timeout
-		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		// try to request item(s) again after timeout
+		if (pipelined_transfer()) {
+			resend_pipelined_requests();
+
+		} else {
+			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		}
 
 	} else if (_state != MAVLINK_WPM_STATE_IDLE && (_time_last_recv > 0)
 		   && hrt_elapsed_time(&_time_last_recv) > MAVLINK_MISSION_PROTOCOL_TIMEOUT_DEFAULT) {
@@ -911,6 +934,20 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			_transfer_dataman_id = (_dataman_id == DM_KEY_WAYPOINTS_OFFBOARD_0 ? DM_KEY_WAYPOINTS_OFFBOARD_1 :
 						DM_KEY_WAYPOINTS_OFFBOARD_0);	// use inactive storage for transmission
 			_transfer_current_seq = -1;
+			_transfer_request_seq = 0;
+			_transfer_write_seq = 0;
+
+			for (BufferedMissionItem &buffered : _transfer_buffer) {
+				buffered.valid = false;
+			}
+
+			int32_t pipeline_length = 1;
+
+			if (_param_pipeline_length != PARAM_INVALID) {
+				param_get(_param_pipeline_length, &pipeline_length);
+			}
+
+			_pipeline_length = math::constrain(pipeline_length, (int32_t)1, (int32_t)MAX_PIPELINE_LENGTH);
 
 			if (_mission_type == MAV_MISSION_TYPE_FENCE) {
 				// We're about to write new geofence items, so take the lock. It will be released when
@@ -951,8 +988,54 @@ MavlinkMissionManager::handle_mission_count(const mavlink_message_t *msg)
 			return;
 		}
 
-		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		if (pipelined_transfer()) {
+			resend_pipelined_requests();
+			request_pipelined_items();
+
+		} else {
+			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
+		}
+	}
+}
+
+void
+MavlinkMissionManager::request_pipelined_items()
+{
+	while (_transfer_request_seq < _transfer_count
+	       && _transfer_request_seq - _transfer_seq < _pipeline_length
+	       && _transfer_request_seq - _transfer_write_seq < MAX_PIPELINE_LENGTH) {
+
+		send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_request_seq);
+		_transfer_request_seq++;
+	}
+}
+
+void
+MavlinkMissionManager::resend_pipelined_requests()
+{
+	for (uint16_t seq = _transfer_seq; seq < _transfer_request_seq; seq++) {
+		if (!_transfer_buffer[seq % MAX_PIPELINE_LENGTH].valid) {
+			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, seq);
+		}
+	}
+}
+
+int
+MavlinkMissionManager::flush_transfer_buffer()
+{
+	while (_transfer_write_seq < _transfer_seq) {
+		BufferedMissionItem &buffered = _transfer_buffer[_transfer_write_seq % MAX_PIPELINE_LENGTH];
+
+		if (dm_write(_transfer_dataman_id, _transfer_write_seq, DM_PERSIST_POWER_ON_RESET, &buffered.item,
+			     sizeof(struct mission_item_s)) != sizeof(struct mission_item_s)) {
+			return PX4_ERROR;
+		}
+
+		buffered.valid = false;
+		_transfer_write_seq++;
 	}
+
+	return PX4_OK;
 }
 
 void
@@ -1014,7 +1097,17 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 		if (_state == MAVLINK_WPM_STATE_GETLIST) {
 			_time_last_recv = hrt_absolute_time();
 
-			if (wp.seq != _transfer_seq) {
+			if (pipelined_transfer()) {
+				// accept any item of the pipeline that we did not get yet
+				if (wp.seq < _transfer_seq || wp.seq >= _transfer_request_seq
+				    || _transfer_buffer[wp.seq % MAX_PIPELINE_LENGTH].valid) {
+					// duplicate or not requested: ignore it, missing items are requested again after a timeout
+					PX4_DEBUG("WPM: MISSION_ITEM seq %u not expected (pipeline %u - %u)", wp.seq, _transfer_seq,
+						  _transfer_request_seq);
+					return;
+				}
+
+			} else if (wp.seq != _transfer_seq) {
 				PX4_DEBUG("WPM: MISSION_ITEM ERROR: seq %u was not the expected %u", wp.seq, _transfer_seq);
 
 				/* request next item again */
@@ -1075,6 +1168,13 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 				    mission_item.nav_cmd == MAV_CMD_NAV_RALLY_POINT) {
 					check_failed = true;
 
+				} else if (pipelined_transfer()) {
+					// write-behind: keep the item in memory, it is written to dataman in send() or when the
+					// transfer completes
+					BufferedMissionItem &buffered = _transfer_buffer[wp.seq % MAX_PIPELINE_LENGTH];
+					buffered.item = mission_item;
+					buffered.valid = true;
+
 				} else {
 					dm_item_t dm_item = _transfer_dataman_id;
 
@@ -1159,13 +1259,32 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 
 		PX4_DEBUG("WPM: MISSION_ITEM seq %u received", wp.seq);
 
-		_transfer_seq = wp.seq + 1;
+		if (pipelined_transfer()) {
+			// items might arrive out of order: advance over all items received in sequence
+			while (_transfer_seq < _transfer_request_seq && _transfer_buffer[_transfer_seq % MAX_PIPELINE_LENGTH].valid) {
+				_transfer_seq++;
+			}
+
+		} else {
+			_transfer_seq = wp.seq + 1;
+		}
 
 		if (_transfer_seq == _transfer_count) {
 			/* got all new mission items successfully */
 			PX4_DEBUG("WPM: MISSION_ITEM got all %u items, current_seq=%u, changing state to MAVLINK_WPM_STATE_IDLE",
 				  _transfer_count, _transfer_current_seq);
 
+			if (pipelined_transfer() && flush_transfer_buffer() != PX4_OK) {
+				PX4_DEBUG("WPM: MISSION_ITEM ERROR: error writing seq %u to dataman ID %i", _transfer_write_seq,
+					  _transfer_dataman_id);
+
+				send_mission_ack(_transfer_partner_sysid, _transfer_partner_compid, MAV_MISSION_ERROR);
+				_mavlink->send_statustext_critical("Unable to write on micro SD");
+				switch_to_idle_state();
+				_transfer_in_progress = false;
+				return;
+			}
+
 			ret = 0;
 
 			switch (_mission_type) {
@@ -1199,6 +1318,10 @@ MavlinkMissionManager::handle_mission_item_both(const mavlink_message_t *msg)
 
 			_transfer_in_progress = false;
 
+		} else if (pipelined_transfer()) {
+			/* request next items (if there is space in the transfer buffer) */
+			request_pipelined_items();
+
 		} else {
 			/* request next item */
 			send_mission_request(_transfer_partner_sysid, _transfer_partner_compid, _transfer_seq);
@@ -46,6 +46,7 @@
 #pragma once
 
 #include <dataman/dataman.h>
+#include <parameters/param.h>
 #include <uORB/Publication.hpp>
 #include <uORB/Subscription.hpp>
 #include <uORB/topics/mission_result.h>
@@ -121,6 +122,20 @@ private:
 
 	int32_t			_transfer_current_seq{-1};		///< Current item ID for current transmission (-1 means not initialized)
 
+	static constexpr uint16_t	MAX_PIPELINE_LENGTH = 8;		///< Maximum number of mission items requested ahead during an upload
+
+	struct BufferedMissionItem {
+		mission_item_s		item;
+		bool			valid;
+	};
+
+	uint16_t		_pipeline_length{1};			///< Number of items requested ahead in current transmission (MAV_MIS_PIPELINE)
+	uint16_t		_transfer_request_seq{0};		///< Next item sequence to request (pipelined upload)
+	uint16_t		_transfer_write_seq{0};			///< First item sequence not yet written to dataman (pipelined upload)
+	BufferedMissionItem	_transfer_buffer[MAX_PIPELINE_LENGTH] {};	///< Received items not yet written to dataman, indexed by seq
+
+	param_t			_param_pipeline_length{PARAM_INVALID};
+
 	uint8_t			_transfer_partner_sysid{0};		///< Partner system ID for current transmission
 	uint8_t			_transfer_partner_compid{0};		///< Partner component ID for current transmission
 
@@ -245,4 +260,29 @@ private:
 	 * set _state to idle (and do necessary cleanup)
 	 */
 	void switch_to_idle_state();
+
+	/**
+	 * true if the current upload requests several mission items ahead and buffers them in memory
+	 * (only used for missions, which are committed by switching the dataman ID once complete)
+	 */
+	bool pipelined_transfer() const
+	{
+		return _mission_type == MAV_MISSION_TYPE_MISSION && _pipeline_length > 1;
+	}
+
+	/**
+	 * request as many items ahead as the pipeline and the transfer buffer allow
+	 */
+	void request_pipelined_items();
+
+	/**
+	 * request again all items of the pipeline that were not received yet
+	 */
+	void resend_pipelined_requests();
+
+	/**
+	 * write all buffered items that were received in sequence to dataman
+	 * @return PX4_OK on success
+	 */
+	int flush_transfer_buffer();
 };
@@ -176,6 +176,23 @@ PARAM_DEFINE_INT32(MAV_HB_FORW_EN, 1);
  */
 PARAM_DEFINE_INT32(MAV_ODOM_LP, 0);
 
+/**
+ * Mission upload pipeline length
+ *
+ * Number of mission items that are requested ahead from the ground station during a
+ * mission upload. Received items are buffered in memory and written to storage in the
+ * background, so the upload of large missions is not limited by the link round trip
+ * time and the storage write time per item anymore. The new mission is only activated
+ * once all items are received.
+ * Set to 1 to request one item at a time, as expected by some ground stations.
+ * Geofence and rally point uploads always request one item at a time.
+ *
+ * @min 1
+ * @max 8
+ * @group MAVLink
+ */
+PARAM_DEFINE_INT32(MAV_MIS_PIPELINE, 1);
+
 /**
  * Timeout in seconds for the RADIO_STATUS reports coming in
  *
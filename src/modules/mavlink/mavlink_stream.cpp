@@ -44,6 +44,8 @@
 #include "mavlink_stream.h"
 #include "mavlink_main.h"
 
+px4::atomic_bool MavlinkStream::_send_timing_enabled{false};
+
 MavlinkStream::MavlinkStream(Mavlink *mavlink) :
 	_mavlink(mavlink)
 {
@@ -64,7 +66,7 @@ MavlinkStream::update(const hrt_abstime &t)
 		// this will give different messages on the same run a different
 		// initial timestamp which will help spacing them out
 		// on the link scheduling
-		if (send()) {
+		if (_send_timing_enabled.load() ? timed_send() : send()) {
 			_last_sent = hrt_absolute_time();
 
 			if (!_first_message_sent) {
@@ -112,7 +114,7 @@ MavlinkStream::update(const hrt_abstime &t)
 		// do not use the actual time but increment at a fixed rate, so that processing delays do not
 		// distort the average rate. The check of the maximum interval is done to ensure that after a
 		// long time not sending anything, sending multiple messages in a short time is avoided.
-		if (send()) {
+		if (_send_timing_enabled.load() ? timed_send() : send()) {
 			_last_sent = ((interval > 0) && ((int64_t)(1.5f * interval) > dt)) ? _last_sent + interval : t;
 
 			if (!_first_message_sent) {
@@ -128,3 +130,23 @@ MavlinkStream::update(const hrt_abstime &t)
 
 	return -1;
 }
+
+bool
+MavlinkStream::timed_send()
+{
+	const hrt_abstime start = hrt_absolute_time();
+
+	if (send()) {
+		const hrt_abstime elapsed = hrt_absolute_time() - start;
+		_send_elapsed += elapsed;
+
+		if (elapsed > _send_elapsed_max) {
+			_send_elapsed_max = elapsed;
+		}
+
+		_send_count++;
+		return true;
+	}
+
+	return false;
+}
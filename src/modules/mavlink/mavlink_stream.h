@@ -42,6 +42,7 @@
 #define MAVLINK_STREAM_H_
 
 #include <drivers/drv_hrt.h>
+#include <px4_platform_common/atomic.h>
 #include <px4_platform_common/module_params.h>
 #include <containers/List.hpp>
 
@@ -122,6 +123,31 @@ public:
 	 */
 	void reset_last_sent() { _last_sent = 0; }
 
+	/**
+	 * @return number of messages sent by this stream
+	 */
+	uint32_t send_count() const { return _send_count; }
+
+	/**
+	 * @return accumulated time spent in send() for sent messages [us]
+	 */
+	hrt_abstime send_elapsed() const { return _send_elapsed; }
+
+	/**
+	 * @return maximum time spent in a single send() call [us]
+	 */
+	hrt_abstime send_elapsed_max() const { return _send_elapsed_max; }
+
+	/**
+	 * Enable accounting of the time spent in send() for all streams (disabled by default)
+	 */
+	static void enable_send_timing() { _send_timing_enabled.store(true); }
+
+	/**
+	 * @return true if the time spent in send() is accounted
+	 */
+	static bool send_timing_enabled() { return _send_timing_enabled.load(); }
+
 protected:
 	Mavlink      *const _mavlink;
 	int _interval{1000000};		///< if set to negative value = unlimited rate
@@ -137,8 +163,19 @@ protected:
 	virtual void update_data() { }
 
 private:
+	/**
+	 * Call send() and account the time spent in it
+	 */
+	bool timed_send();
+
 	hrt_abstime _last_sent{0};
 	bool _first_message_sent{false};
+
+	uint32_t _send_count{0};
+	hrt_abstime _send_elapsed{0};
+	hrt_abstime _send_elapsed_max{0};
+
+	static px4::atomic_bool _send_timing_enabled;
 };
 
 
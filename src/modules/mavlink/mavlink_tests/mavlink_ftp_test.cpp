@@ -38,6 +38,7 @@
 #include <crc32.h>
 #include <stdio.h>
 #include <fcntl.h>
+#include <parameters/param.h>
 
 #include "mavlink_ftp_test.h"
 #include "../mavlink_ftp.h"
@@ -996,6 +997,81 @@ void MavlinkFtpTest::_cleanup_microsd()
 	::rmdir(_unittest_microsd_dir);
 }
 
+/// @brief Tests reading the virtual parameter file
+bool MavlinkFtpTest::_param_file_test()
+{
+	MavlinkFTP::PayloadHeader		payload;
+	const MavlinkFTP::PayloadHeader		*reply;
+	const char				*file = MavlinkFTP::kParamFile;
+
+	payload.opcode = MavlinkFTP::kCmdOpenFileRO;
+	payload.offset = 0;
+
+	bool success = _send_receive_msg(&payload,	// FTP payload header
+					 strlen(file) + 1,	// size in bytes of data
+					 (uint8_t *)file,	// Data to start into FTP message payload
+					 &reply);		// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_compare("Incorrect payload size", reply->size, sizeof(uint32_t));
+
+	const uint32_t file_size = *((uint32_t *)&reply->data[0]);
+	ut_assert("File is empty", file_size > 0);
+
+	// the backing file only exists while the session is open
+	struct stat st;
+	ut_compare("Export file missing", stat(_ftp_server->_param_export_path, &st), 0);
+
+	payload.opcode = MavlinkFTP::kCmdReadFile;
+	payload.session = reply->session;
+	payload.offset = 0;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+
+	// BSON document: int32 length, then the first element: type byte (0x10 = int32), "_HASH_CHECK" and the int32 value
+	static constexpr char hash_name[] = "_HASH_CHECK";
+	const uint8_t *data = &reply->data[0];
+	uint32_t document_size;
+	memcpy(&document_size, data, sizeof(document_size));
+	ut_compare("BSON document size incorrect", document_size, file_size);
+	ut_compare("Hash is not an int32", data[4], 0x10);
+	ut_compare("First element is not the hash", memcmp(&data[5], hash_name, sizeof(hash_name)), 0);
+
+	int32_t hash;
+	memcpy(&hash, &data[5 + sizeof(hash_name)], sizeof(hash));
+	ut_compare("Hash incorrect", hash, (int32_t)param_hash_check());
+
+	payload.opcode = MavlinkFTP::kCmdTerminateSession;
+	payload.size = 0;
+
+	success = _send_receive_msg(&payload,	// FTP payload header
+				    0,		// size in bytes of data
+				    nullptr,	// Data to start into FTP message payload
+				    &reply);	// Payload inside FTP message response
+
+	if (!success) {
+		return false;
+	}
+
+	ut_compare("Didn't get Ack back", reply->opcode, MavlinkFTP::kRspAck);
+	ut_assert("Export file not removed", stat(_ftp_server->_param_export_path, &st) != 0);
+
+	return true;
+}
+
 /// @brief Runs all the unit tests
 bool MavlinkFtpTest::run_tests()
 {
@@ -1013,6 +1089,7 @@ bool MavlinkFtpTest::run_tests()
 	ut_run_test(_removedirectory_test);
 	ut_run_test(_createdirectory_test);
 	ut_run_test(_removefile_test);
+	ut_run_test(_param_file_test);
 
 	return (_tests_failed == 0);
 
@@ -0,0 +1,297 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_stream_bench.cpp
+///	Stream throughput and latency benchmark against a running mavlink instance on a UDP loopback link.
+
+#include <px4_platform_common/px4_config.h>
+
+#if defined(CONFIG_NET) || defined(__PX4_POSIX)
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <px4_platform_common/getopt.h>
+#include <px4_platform_common/log.h>
+#include <uORB/SubscriptionMultiArray.hpp>
+#include <uORB/topics/telemetry_status.h>
+
+#include "mavlink_stream_bench.h"
+
+static constexpr hrt_abstime PROBE_INTERVAL_US = 20000;
+static constexpr hrt_abstime HEARTBEAT_INTERVAL_US = 1000000;
+
+bool MavlinkStreamBench::run(uint16_t instance_port, uint16_t remote_port, hrt_abstime duration_us)
+{
+	int fd = socket(AF_INET, SOCK_DGRAM, 0);
+
+	if (fd < 0) {
+		PX4_ERR("socket failed: %s", strerror(errno));
+		return false;
+	}
+
+	struct sockaddr_in addr {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(remote_port);
+
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		PX4_ERR("bind to port %u failed: %s", remote_port, strerror(errno));
+		close(fd);
+		return false;
+	}
+
+	const uint32_t tx_buffer_overruns_start = _tx_buffer_overruns();
+
+	mavlink_message_t rx_msg{};
+	mavlink_status_t rx_status{};
+	mavlink_message_t msg{};
+	mavlink_status_t status{};
+	uint8_t buf[2048];
+
+	const hrt_abstime start = hrt_absolute_time();
+	hrt_abstime last_probe = 0;
+	hrt_abstime last_heartbeat = 0;
+	hrt_abstime now = start;
+
+	while (now - start < duration_us) {
+		if (now - last_heartbeat >= HEARTBEAT_INTERVAL_US) {
+			// announce ourselves as GCS, so that the instance considers the link connected
+			_send_heartbeat(fd, instance_port);
+			last_heartbeat = now;
+		}
+
+		if (now - last_probe >= PROBE_INTERVAL_US) {
+			_publish_probe();
+			last_probe = now;
+		}
+
+		pollfd fds[1] {};
+		fds[0].fd = fd;
+		fds[0].events = POLLIN;
+
+		if (poll(fds, 1, 10) > 0) {
+			const ssize_t nread = recv(fd, buf, sizeof(buf), 0);
+
+			for (ssize_t i = 0; i < nread; i++) {
+				const uint8_t result = mavlink_frame_char_buffer(&rx_msg, &rx_status, buf[i], &msg, &status);
+
+				if (result == MAVLINK_FRAMING_OK) {
+					_handle_message(msg);
+				}
+			}
+		}
+
+		now = hrt_absolute_time();
+	}
+
+	close(fd);
+
+	_print_results(now - start, _tx_buffer_overruns() - tx_buffer_overruns_start);
+	return true;
+}
+
+void MavlinkStreamBench::_handle_message(const mavlink_message_t &msg)
+{
+	unsigned length = msg.len + MAVLINK_NUM_NON_PAYLOAD_BYTES;
+
+	if (msg.incompat_flags & MAVLINK_IFLAG_SIGNED) {
+		length += MAVLINK_SIGNATURE_BLOCK_LEN;
+	}
+
+	++_total_messages;
+	_total_bytes += length;
+
+	if (_last_sequence >= 0) {
+		_lost_messages += (uint8_t)(msg.seq - _last_sequence - 1);
+	}
+
+	_last_sequence = msg.seq;
+
+	if (msg.msgid == MAVLINK_MSG_ID_DEBUG_VECT) {
+		mavlink_debug_vect_t debug_vect;
+		mavlink_msg_debug_vect_decode(&msg, &debug_vect);
+
+		if (strncmp(debug_vect.name, PROBE_NAME, sizeof(debug_vect.name)) == 0) {
+			const hrt_abstime latency = hrt_absolute_time() - debug_vect.time_usec;
+			++_probes_received;
+			_latency_sum += latency;
+
+			if (latency < _latency_min) {
+				_latency_min = latency;
+			}
+
+			if (latency > _latency_max) {
+				_latency_max = latency;
+			}
+		}
+	}
+
+	for (int i = 0; i < _num_stats; i++) {
+		if (_stats[i].msg_id == msg.msgid) {
+			++_stats[i].count;
+			_stats[i].bytes += length;
+			return;
+		}
+	}
+
+	if (_num_stats < MAX_MESSAGE_IDS) {
+		_stats[_num_stats].msg_id = msg.msgid;
+		_stats[_num_stats].count = 1;
+		_stats[_num_stats].bytes = length;
+		++_num_stats;
+	}
+}
+
+void MavlinkStreamBench::_send_heartbeat(int fd, uint16_t instance_port)
+{
+	mavlink_message_t msg{};
+	mavlink_msg_heartbeat_pack(255, MAV_COMP_ID_MISSIONPLANNER, &msg, MAV_TYPE_GCS, MAV_AUTOPILOT_INVALID, 0, 0,
+				   MAV_STATE_ACTIVE);
+
+	uint8_t buf[MAVLINK_MAX_PACKET_LEN];
+	const uint16_t len = mavlink_msg_to_send_buffer(buf, &msg);
+
+	struct sockaddr_in addr {};
+	addr.sin_family = AF_INET;
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+	addr.sin_port = htons(instance_port);
+
+	sendto(fd, buf, len, 0, (struct sockaddr *)&addr, sizeof(addr));
+}
+
+void MavlinkStreamBench::_publish_probe()
+{
+	debug_vect_s debug_vect{};
+	strncpy(debug_vect.name, PROBE_NAME, sizeof(debug_vect.name));
+	debug_vect.x = _probes_published++;
+	debug_vect.timestamp = hrt_absolute_time();
+	_debug_vect_pub.publish(debug_vect);
+}
+
+uint32_t MavlinkStreamBench::_tx_buffer_overruns()
+{
+	uORB::SubscriptionMultiArray<telemetry_status_s> telemetry_status_subs{ORB_ID::telemetry_status};
+
+	uint32_t overruns = 0;
+
+	for (auto &telemetry_status_sub : telemetry_status_subs) {
+		telemetry_status_s telemetry_status;
+
+		if (telemetry_status_sub.copy(&telemetry_status)) {
+			overruns += telemetry_status.tx_buffer_overruns;
+		}
+	}
+
+	return overruns;
+}
+
+void MavlinkStreamBench::_print_results(hrt_abstime elapsed_us, uint32_t tx_buffer_overruns)
+{
+	const float elapsed_s = elapsed_us * 1e-6f;
+
+	PX4_INFO("%-8s %10s %10s %12s", "msg id", "messages", "msg/s", "bytes/s");
+
+	for (int i = 0; i < _num_stats; i++) {
+		PX4_INFO("%-8u %10u %10.1f %12.1f", (unsigned)_stats[i].msg_id, (unsigned)_stats[i].count,
+			 (double)(_stats[i].count / elapsed_s), (double)(_stats[i].bytes / elapsed_s));
+	}
+
+	PX4_INFO("total: %u messages, %.1f msg/s, %.1f bytes/s", (unsigned)_total_messages,
+		 (double)(_total_messages / elapsed_s), (double)(_total_bytes / elapsed_s));
+	PX4_INFO("lost (sequence gaps): %u", (unsigned)_lost_messages);
+	PX4_INFO("tx buffer overruns (all instances): %u", (unsigned)tx_buffer_overruns);
+
+	if (_probes_received > 0) {
+		PX4_INFO("publish to wire latency: %u/%u probes, min %llu us, avg %llu us, max %llu us",
+			 (unsigned)_probes_received, (unsigned)_probes_published, (unsigned long long)_latency_min,
+			 (unsigned long long)(_latency_sum / _probes_received), (unsigned long long)_latency_max);
+
+	} else {
+		PX4_WARN("no latency probes received (is the DEBUG_VECT stream enabled?)");
+	}
+}
+
+int mavlink_stream_bench_main(int argc, char *argv[])
+{
+	int instance_port = 14601;
+	int remote_port = 14600;
+	int duration_s = 10;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "u:o:t:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'u':
+			instance_port = atoi(myoptarg);
+			break;
+
+		case 'o':
+			remote_port = atoi(myoptarg);
+			break;
+
+		case 't':
+			duration_s = atoi(myoptarg);
+			break;
+
+		default:
+			PX4_INFO("usage: mavlink_tests bench [-u <instance port>] [-o <remote port>] [-t <seconds>]");
+			return -1;
+		}
+	}
+
+	if (instance_port <= 0 || remote_port <= 0 || duration_s <= 0) {
+		PX4_ERR("invalid arguments");
+		return -1;
+	}
+
+	MavlinkStreamBench *bench = new MavlinkStreamBench();
+
+	if (bench == nullptr) {
+		return -1;
+	}
+
+	const bool success = bench->run(instance_port, remote_port, duration_s * 1000000ULL);
+	delete bench;
+	return success ? 0 : -1;
+}
+
+#endif // CONFIG_NET || __PX4_POSIX
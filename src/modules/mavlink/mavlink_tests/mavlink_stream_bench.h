@@ -0,0 +1,108 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_stream_bench.h
+///	Stream throughput and latency benchmark against a running mavlink instance on a UDP loopback link.
+///
+///	Usage (SITL):
+///		mavlink start -u 14601 -o 14600 -t 127.0.0.1 -m custom -r 4000000
+///		mavlink stream -u 14601 -s all -r 50
+///		mavlink_tests bench -u 14601 -o 14600 -t 10
+///		mavlink status streams
+///
+///	The benchmark receives everything the instance sends and reports bytes and messages per second for each
+///	message ID, lost messages (sequence gaps), the latency from uORB publication to the wire (via DEBUG_VECT)
+///	and the number of messages the instance dropped because its tx buffer was full. The CPU time spent
+///	packing each stream is reported by the instance itself in `mavlink status streams`.
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <uORB/Publication.hpp>
+#include <uORB/topics/debug_vect.h>
+#ifndef MAVLINK_FTP_UNIT_TEST
+#include "../mavlink_bridge_header.h"
+#else
+#include <v2.0/standard/mavlink.h>
+#endif
+
+class MavlinkStreamBench
+{
+public:
+	MavlinkStreamBench() = default;
+	~MavlinkStreamBench() = default;
+
+	/// Run the benchmark
+	///	@param instance_port	UDP port of the mavlink instance (mavlink start -u)
+	///	@param remote_port	UDP port the instance sends to (mavlink start -o)
+	///	@param duration_us	benchmark duration
+	///	@return true on success
+	bool run(uint16_t instance_port, uint16_t remote_port, hrt_abstime duration_us);
+
+private:
+	/// Statistics of a single message ID
+	struct MessageStats {
+		uint32_t	msg_id;
+		uint32_t	count;
+		uint32_t	bytes;
+	};
+
+	void _handle_message(const mavlink_message_t &msg);
+	void _send_heartbeat(int fd, uint16_t instance_port);
+	void _publish_probe();
+	uint32_t _tx_buffer_overruns();
+	void _print_results(hrt_abstime elapsed_us, uint32_t tx_buffer_overruns);
+
+	static constexpr int MAX_MESSAGE_IDS = 128;
+	static constexpr const char *PROBE_NAME = "BENCH";
+
+	MessageStats _stats[MAX_MESSAGE_IDS] {};
+	int _num_stats{0};
+
+	uint32_t _total_messages{0};
+	uint32_t _total_bytes{0};
+	uint32_t _lost_messages{0};
+	int _last_sequence{-1};
+
+	uint32_t _probes_published{0};
+	uint32_t _probes_received{0};
+	hrt_abstime _latency_sum{0};
+	hrt_abstime _latency_min{UINT64_MAX};
+	hrt_abstime _latency_max{0};
+
+	uORB::Publication<debug_vect_s> _debug_vect_pub{ORB_ID(debug_vect)};
+};
+
+/// Parses the command line and runs the benchmark
+///	mavlink_tests bench [-u <instance port>] [-o <remote port>] [-t <seconds>]
+int mavlink_stream_bench_main(int argc, char *argv[]);
@@ -35,13 +35,27 @@
  * @file mavlink_ftp_tests.cpp
  */
 
+#include <px4_platform_common/px4_config.h>
+#include <string.h>
 #include <systemlib/err.h>
 
 #include "mavlink_ftp_test.h"
+#include "mavlink_stream_bench.h"
+#include "mavlink_ulog_test.h"
 
 extern "C" __EXPORT int mavlink_tests_main(int argc, char *argv[]);
 
 int mavlink_tests_main(int argc, char *argv[])
 {
-	return mavlink_ftp_test() ? 0 : -1;
+#if defined(CONFIG_NET) || defined(__PX4_POSIX)
+
+	if (argc > 1 && strcmp(argv[1], "bench") == 0) {
+		return mavlink_stream_bench_main(argc - 1, argv + 1);
+	}
+
+#endif // CONFIG_NET || __PX4_POSIX
+
+	bool success = mavlink_ftp_test();
+	success = mavlink_ulog_test() && success;
+	return success ? 0 : -1;
 }
@@ -0,0 +1,251 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_ulog_test.cpp
+///	Tests for the reliable ULog streaming send window over a simulated link
+
+#include <string.h>
+
+#include "mavlink_ulog_test.h"
+
+static constexpr hrt_abstime SIMULATION_STEP_US = 1000;
+
+bool MavlinkULogTest::_simulate_link(hrt_abstime rtt_us, hrt_abstime duration_us, int loss_every, LinkResult &result)
+{
+	struct PendingAck {
+		uint16_t	sequence;
+		hrt_abstime	arrival;
+	};
+
+	PendingAck pending_acks[MAX_PENDING_ACKS];
+	int num_pending_acks = 0;
+
+	MavlinkULogWindow window;
+	uint16_t next_sequence = 0;
+
+	memset(_received, 0, sizeof(_received));
+	result = {};
+
+	auto transmit = [&](uint16_t sequence, hrt_abstime now) -> bool {
+		++result.transmissions;
+
+		if (loss_every > 0 && result.transmissions % loss_every == 0)
+		{
+			return true;
+		}
+
+		if (sequence >= MAX_SIMULATED_MESSAGES || num_pending_acks >= MAX_PENDING_ACKS)
+		{
+			return false;
+		}
+
+		if (!_received[sequence])
+		{
+			_received[sequence] = true;
+			++result.delivered;
+		}
+
+		pending_acks[num_pending_acks++] = {sequence, now + rtt_us};
+		return true;
+	};
+
+	for (hrt_abstime now = SIMULATION_STEP_US; now < duration_us; now += SIMULATION_STEP_US) {
+
+		// acks arriving from the link partner
+		for (int i = 0; i < num_pending_acks;) {
+			if (pending_acks[i].arrival <= now) {
+				window.ack(pending_acks[i].sequence, now);
+				pending_acks[i] = pending_acks[--num_pending_acks];
+
+			} else {
+				++i;
+			}
+		}
+
+		const ulog_stream_s *timed_out;
+
+		while ((timed_out = window.get_timed_out(now, result.max_tries_exceeded))) {
+			if (!transmit(timed_out->msg_sequence, now)) {
+				return false;
+			}
+		}
+
+		if (result.max_tries_exceeded) {
+			break;
+		}
+
+		while (!window.full()) {
+			ulog_stream_s ulog_data{};
+			ulog_data.msg_sequence = next_sequence++;
+			window.add(ulog_data, now);
+
+			if (!transmit(ulog_data.msg_sequence, now)) {
+				return false;
+			}
+		}
+	}
+
+	result.last_acked = window.last_acked_sequence();
+	return true;
+}
+
+bool MavlinkULogTest::_ack_test()
+{
+	MavlinkULogWindow window;
+	ulog_stream_s ulog_data{};
+
+	ut_compare("initial window size", window.window_size(), 1);
+
+	ulog_data.msg_sequence = 10;
+	ut_assert_true(window.add(ulog_data, 1000));
+	ut_assert_true(window.full());
+	ut_compare("no cumulative ack yet", window.last_acked_sequence(), 9);
+
+	// unknown sequences are ignored
+	ut_assert_false(window.ack(11, 2000));
+	ut_compare("in flight", window.num_in_flight(), 1);
+
+	ut_assert_true(window.ack(10, 2000));
+	ut_assert_false(window.ack(10, 2000)); // duplicate
+	ut_assert_true(window.empty());
+	ut_compare("cumulative ack", window.last_acked_sequence(), 10);
+	ut_compare("window grows", window.window_size(), 2);
+
+	// selective ack: the second message is acked before the first
+	ulog_data.msg_sequence = 11;
+	ut_assert_true(window.add(ulog_data, 3000));
+	ulog_data.msg_sequence = 12;
+	ut_assert_true(window.add(ulog_data, 3000));
+	ut_assert_true(window.ack(12, 4000));
+	ut_compare("blocked by missing ack", window.last_acked_sequence(), 10);
+	ut_compare("in flight", window.num_in_flight(), 2);
+
+	// only the unacked message gets re-sent
+	bool max_tries_exceeded;
+	const ulog_stream_s *timed_out = window.get_timed_out(3000 + window.retransmit_timeout() + 1, max_tries_exceeded);
+	ut_assert("timed out message", timed_out != nullptr);
+	ut_compare("re-sent sequence", timed_out->msg_sequence, 11);
+	ut_assert("only one message timed out",
+		  window.get_timed_out(3000 + window.retransmit_timeout() + 1, max_tries_exceeded) == nullptr);
+	ut_assert_false(max_tries_exceeded);
+
+	ut_assert_true(window.ack(11, 200000));
+	ut_assert_true(window.empty());
+	ut_compare("cumulative ack", window.last_acked_sequence(), 12);
+
+	return true;
+}
+
+bool MavlinkULogTest::_window_growth_test()
+{
+	MavlinkULogWindow window;
+	ulog_stream_s ulog_data{};
+	hrt_abstime now = 1000;
+
+	// ack every message one RTT later: the window must open up to its maximum
+	for (int i = 0; i < 10 * MavlinkULogWindow::MAX_SIZE; ++i) {
+		ulog_data.msg_sequence = i;
+		ut_assert_true(window.add(ulog_data, now));
+		now += 10000;
+		ut_assert_true(window.ack(i, now));
+	}
+
+	ut_compare("max window size", window.window_size(), MavlinkULogWindow::MAX_SIZE);
+
+	// a timeout halves the window
+	ulog_data.msg_sequence = 1000;
+	ut_assert_true(window.add(ulog_data, now));
+	bool max_tries_exceeded;
+	ut_assert("timed out message", window.get_timed_out(now + 1000000, max_tries_exceeded) != nullptr);
+	ut_compare("halved window size", window.window_size(), MavlinkULogWindow::MAX_SIZE / 2);
+
+	return true;
+}
+
+bool MavlinkULogTest::_throughput_test()
+{
+	// 4G link
+	const hrt_abstime rtt_us = 150000;
+	const hrt_abstime duration_us = 10000000;
+	const int stop_and_wait_msgs = duration_us / rtt_us;
+
+	LinkResult result;
+	ut_assert_true(_simulate_link(rtt_us, duration_us, 0, result));
+	ut_assert_false(result.max_tries_exceeded);
+
+	const float bytes_per_sec = (float)result.delivered * sizeof(ulog_stream_s::data) / (duration_us * 1e-6f);
+	PX4_INFO("RTT %i ms: %i msgs (%.0f B/s), stop-and-wait: %i msgs, %i re-sends", (int)(rtt_us / 1000),
+		 result.delivered, (double)bytes_per_sec, stop_and_wait_msgs, result.transmissions - result.delivered);
+
+	// after the initial window increase we must be close to MAX_SIZE messages per RTT
+	ut_less_than("throughput", stop_and_wait_msgs * MavlinkULogWindow::MAX_SIZE * 3 / 4, result.delivered);
+	// the initial timeout is shorter than the RTT, so only the first message(s) may get re-sent
+	ut_less_than("spurious re-sends", result.transmissions - result.delivered, 5);
+
+	return true;
+}
+
+bool MavlinkULogTest::_lossy_throughput_test()
+{
+	const hrt_abstime rtt_us = 150000;
+	const hrt_abstime duration_us = 10000000;
+	const int stop_and_wait_msgs = duration_us / rtt_us;
+
+	LinkResult result;
+	ut_assert_true(_simulate_link(rtt_us, duration_us, 10, result));
+	ut_assert_false(result.max_tries_exceeded);
+
+	PX4_INFO("RTT %i ms, 10%% loss: %i msgs, %i transmissions", (int)(rtt_us / 1000), result.delivered,
+		 result.transmissions);
+
+	// everything up to the cumulative ack must have arrived
+	for (int i = 0; i <= result.last_acked; ++i) {
+		ut_assert("message delivered", _received[i]);
+	}
+
+	ut_less_than("throughput", stop_and_wait_msgs * 2, result.delivered);
+
+	return true;
+}
+
+bool MavlinkULogTest::run_tests()
+{
+	ut_run_test(_ack_test);
+	ut_run_test(_window_growth_test);
+	ut_run_test(_throughput_test);
+	ut_run_test(_lossy_throughput_test);
+
+	return (_tests_failed == 0);
+}
+
+ut_declare_test(mavlink_ulog_test, MavlinkULogTest)
@@ -0,0 +1,79 @@
+/****************************************************************************
+ *
+ *   Copyright (C) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/// @file mavlink_ulog_test.h
+///	Tests for the reliable ULog streaming send window over a simulated link
+
+#pragma once
+
+#include <unit_test.h>
+
+#include "../mavlink_ulog_window.h"
+
+class MavlinkULogTest : public UnitTest
+{
+public:
+	MavlinkULogTest() = default;
+	virtual ~MavlinkULogTest() = default;
+
+	virtual bool run_tests(void);
+
+private:
+	bool _ack_test(void);
+	bool _window_growth_test(void);
+	bool _throughput_test(void);
+	bool _lossy_throughput_test(void);
+
+	/// Result of a simulated transfer
+	struct LinkResult {
+		int		delivered;	///< number of unique messages received by the link partner
+		int		transmissions;	///< number of messages sent, including re-sends
+		uint16_t	last_acked;	///< cumulative ack at the end of the transfer
+		bool		max_tries_exceeded;
+	};
+
+	/// Simulates streaming through a link with a fixed round trip time (in simulated time, without sleeping).
+	///	@param rtt_us		round trip time of the link
+	///	@param duration_us	simulated transfer duration
+	///	@param loss_every	drop every n-th transmission (0 for a lossless link)
+	///	@param result		filled with the transfer statistics
+	///	@return false if the simulation ran out of buffer space
+	bool _simulate_link(hrt_abstime rtt_us, hrt_abstime duration_us, int loss_every, LinkResult &result);
+
+	static constexpr int MAX_SIMULATED_MESSAGES = 4096;
+	static constexpr int MAX_PENDING_ACKS = 64;
+
+	bool _received[MAX_SIMULATED_MESSAGES] {};
+};
+
+bool mavlink_ulog_test(void);
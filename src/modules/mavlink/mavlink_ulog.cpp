@@ -91,63 +91,52 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 		return 0;
 	}
 
-	// check if we're waiting for an ACK
-	if (_last_sent_time) {
-		bool check_for_updates = false;
+	// re-send messages for which we did not get an ack in time
+	ulog_stream_s resend_data;
+	bool max_tries_exceeded = false;
 
-		if (_ack_received) {
-			_last_sent_time = 0;
-			check_for_updates = true;
+	while (_current_num_msgs < _max_num_messages) {
+		lock();
+		const ulog_stream_s *timed_out = _window.get_timed_out(hrt_absolute_time(), max_tries_exceeded);
 
-		} else {
+		if (timed_out) {
+			resend_data = *timed_out;
+		}
 
-			if (hrt_elapsed_time(&_last_sent_time) > ulog_stream_ack_s::ACK_TIMEOUT * 1000) {
-				if (++_sent_tries > ulog_stream_ack_s::ACK_MAX_TRIES) {
-					return -ETIMEDOUT;
-
-				} else {
-					PX4_DEBUG("re-sending ulog mavlink message (try=%i)", _sent_tries);
-					_last_sent_time = hrt_absolute_time();
-
-					const ulog_stream_s &ulog_data = _ulog_stream_sub.get();
-
-					mavlink_logging_data_acked_t msg;
-					msg.sequence = ulog_data.msg_sequence;
-					msg.length = ulog_data.length;
-					msg.first_message_offset = ulog_data.first_message_offset;
-					msg.target_system = _target_system;
-					msg.target_component = _target_component;
-					memcpy(msg.data, ulog_data.data, sizeof(msg.data));
-					mavlink_msg_logging_data_acked_send_struct(channel, &msg);
-				}
-			}
+		unlock();
+
+		if (max_tries_exceeded) {
+			return -ETIMEDOUT;
 		}
 
-		if (!check_for_updates) {
-			return 0;
+		if (!timed_out) {
+			break;
 		}
+
+		PX4_DEBUG("re-sending ulog mavlink message (seq=%i)", resend_data.msg_sequence);
+		send_acked(channel, resend_data);
+		++_current_num_msgs;
 	}
 
-	while ((_current_num_msgs < _max_num_messages) && _ulog_stream_sub.update()) {
+	while (_current_num_msgs < _max_num_messages) {
+		lock();
+		const bool window_full = _window.full();
+		unlock();
+
+		// leave the remaining messages queued in uORB until we get acks (this throttles the logger)
+		if (window_full || !_ulog_stream_sub.update()) {
+			break;
+		}
+
 		const ulog_stream_s &ulog_data = _ulog_stream_sub.get();
 
 		if (ulog_data.timestamp > 0) {
 			if (ulog_data.flags & ulog_stream_s::FLAGS_NEED_ACK) {
-				_sent_tries = 1;
-				_last_sent_time = hrt_absolute_time();
 				lock();
-				_wait_for_ack_sequence = ulog_data.msg_sequence;
-				_ack_received = false;
+				_window.add(ulog_data, hrt_absolute_time());
 				unlock();
 
-				mavlink_logging_data_acked_t msg;
-				msg.sequence = ulog_data.msg_sequence;
-				msg.length = ulog_data.length;
-				msg.first_message_offset = ulog_data.first_message_offset;
-				msg.target_system = _target_system;
-				msg.target_component = _target_component;
-				memcpy(msg.data, ulog_data.data, sizeof(msg.data));
-				mavlink_msg_logging_data_acked_send_struct(channel, &msg);
+				send_acked(channel, ulog_data);
 
 			} else {
 				mavlink_logging_data_t msg;
@@ -184,6 +173,18 @@ int MavlinkULog::handle_update(mavlink_channel_t channel)
 	return 0;
 }
 
+void MavlinkULog::send_acked(mavlink_channel_t channel, const ulog_stream_s &ulog_data)
+{
+	mavlink_logging_data_acked_t msg;
+	msg.sequence = ulog_data.msg_sequence;
+	msg.length = ulog_data.length;
+	msg.first_message_offset = ulog_data.first_message_offset;
+	msg.target_system = _target_system;
+	msg.target_component = _target_component;
+	memcpy(msg.data, ulog_data.data, sizeof(msg.data));
+	mavlink_msg_logging_data_acked_send_struct(channel, &msg);
+}
+
 void MavlinkULog::initialize()
 {
 	if (_init) {
@@ -235,20 +236,20 @@ void MavlinkULog::handle_ack(mavlink_logging_ack_t ack)
 	lock();
 
 	if (_instance) { // make sure stop() was not called right before
-		if (_wait_for_ack_sequence == ack.sequence) {
-			_ack_received = true;
-			publish_ack(ack.sequence);
+		if (_window.ack(ack.sequence, hrt_absolute_time())) {
+			publish_ack();
 		}
 	}
 
 	unlock();
 }
 
-void MavlinkULog::publish_ack(uint16_t sequence)
+void MavlinkULog::publish_ack()
 {
-	ulog_stream_ack_s ack;
+	ulog_stream_ack_s ack{};
 	ack.timestamp = hrt_absolute_time();
-	ack.msg_sequence = sequence;
+	ack.msg_sequence = _window.last_acked_sequence();
+	ack.window_size = _window.window_size();
 
 	_ulog_stream_ack_pub.publish(ack);
 }
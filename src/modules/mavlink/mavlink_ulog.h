@@ -52,10 +52,12 @@
 #include <uORB/topics/ulog_stream_ack.h>
 
 #include "mavlink_bridge_header.h"
+#include "mavlink_ulog_window.h"
 
 /**
  * @class MavlinkULog
  * ULog streaming class. At most one instance (stream) can exist, assigned to a specific mavlink channel.
+ * Messages that need an ack are sent with a sliding window (@see MavlinkULogWindow).
  */
 class MavlinkULog
 {
@@ -114,7 +116,10 @@ private:
 		px4_sem_post(&_lock);
 	}
 
-	void publish_ack(uint16_t sequence);
+	/** publish the cumulative ack and the current window size to the logger */
+	void publish_ack();
+
+	void send_acked(mavlink_channel_t channel, const ulog_stream_s &ulog_data);
 
 	static px4_sem_t _lock;
 	static bool _init;
@@ -123,10 +128,8 @@ private:
 
 	uORB::SubscriptionData<ulog_stream_s> _ulog_stream_sub{ORB_ID(ulog_stream)};
 	uORB::Publication<ulog_stream_ack_s> _ulog_stream_ack_pub{ORB_ID(ulog_stream_ack)};
-	uint16_t _wait_for_ack_sequence;
-	uint8_t _sent_tries = 0;
-	volatile bool _ack_received = false; ///< set to true if a matching ack received
-	hrt_abstime _last_sent_time = 0; ///< last time we sent a message that requires an ack
+	MavlinkULogWindow _window; ///< messages in flight that require an ack (protected by _lock)
+	hrt_abstime _last_sent_time = 0; ///< time when the stream was started (to detect a missing logger)
 	bool _waiting_for_initial_ack = false;
 	const uint8_t _target_system;
 	const uint8_t _target_component;
@@ -0,0 +1,266 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file mavlink_ulog_window.h
+ * Send window for reliable ULog streaming (LOGGING_DATA_ACKED).
+ *
+ * Keeps a copy of every message in flight, so that a single lost message
+ * can be re-sent without stalling the rest of the stream. The window size
+ * adapts to the link: it grows with every ack (slow start, then additive
+ * increase) and is halved when a message times out. The retransmission
+ * timeout follows the measured round trip time.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <drivers/drv_hrt.h>
+#include <mathlib/mathlib.h>
+#include <uORB/topics/ulog_stream.h>
+#include <uORB/topics/ulog_stream_ack.h>
+
+/**
+ * @class MavlinkULogWindow
+ */
+class MavlinkULogWindow
+{
+public:
+	static constexpr int MAX_SIZE = ulog_stream_ack_s::WINDOW_SIZE_MAX;
+
+	static_assert(MAX_SIZE <= ulog_stream_s::ORB_QUEUE_LENGTH, "window must fit into the ulog_stream queue");
+
+	MavlinkULogWindow() { reset(); }
+
+	/** clear all messages in flight and restart with the initial window size */
+	void reset()
+	{
+		_head = 0;
+		_count = 0;
+		_window_size = 1;
+		_slow_start_threshold = MAX_SIZE;
+		_num_acks = 0;
+		_srtt_us = 0;
+		_rttvar_us = 0;
+		_rto_us = MIN_RTO_US;
+		_last_decrease = 0;
+		_last_added_sequence = 0;
+	}
+
+	/** @return true if no more messages can be sent until some are acked */
+	bool full() const { return _count >= _window_size; }
+
+	bool empty() const { return _count == 0; }
+
+	/** number of messages in flight (including selectively acked ones behind a missing ack) */
+	int num_in_flight() const { return _count; }
+
+	uint8_t window_size() const { return (uint8_t)_window_size; }
+
+	/** current retransmission timeout [us] */
+	hrt_abstime retransmit_timeout() const { return _rto_us; }
+
+	/**
+	 * Sequence up to which all messages are acked (cumulative ack). The publisher uses this to
+	 * determine how many messages it has in flight.
+	 */
+	uint16_t last_acked_sequence() const
+	{
+		if (_count > 0) {
+			return _entries[_head].msg.msg_sequence - 1;
+		}
+
+		return _last_added_sequence;
+	}
+
+	/**
+	 * Add a message that was just sent. Must only be called if the window is not full.
+	 * @return false if the window is full
+	 */
+	bool add(const ulog_stream_s &msg, hrt_abstime now)
+	{
+		if (_count >= MAX_SIZE) {
+			return false;
+		}
+
+		Entry &entry = _entries[(_head + _count) % MAX_SIZE];
+		entry.msg = msg;
+		entry.sent_time = now;
+		entry.tries = 1;
+		entry.acked = false;
+		++_count;
+
+		_last_added_sequence = msg.msg_sequence;
+		return true;
+	}
+
+	/**
+	 * Handle an ack for a single message (selective ack).
+	 * @return true if the sequence was in flight and not yet acked
+	 */
+	bool ack(uint16_t sequence, hrt_abstime now)
+	{
+		for (int i = 0; i < _count; ++i) {
+			Entry &entry = _entries[(_head + i) % MAX_SIZE];
+
+			if (entry.msg.msg_sequence != sequence) {
+				continue;
+			}
+
+			if (entry.acked) {
+				return false;
+			}
+
+			entry.acked = true;
+
+			// Karn's algorithm: only take RTT samples from messages that were not re-sent
+			if (entry.tries == 1) {
+				update_rtt(now - entry.sent_time);
+			}
+
+			grow();
+
+			// slide the window over all acked messages at the start
+			while (_count > 0 && _entries[_head].acked) {
+				_head = (_head + 1) % MAX_SIZE;
+				--_count;
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+
+	/**
+	 * Get the oldest message that timed out and needs to be re-sent. The send time and number of tries
+	 * of the message are updated, so the caller is expected to send it right away.
+	 * @param max_tries_exceeded set to true if a message exceeded ulog_stream_ack_s::ACK_MAX_TRIES
+	 * @return message to re-send or nullptr
+	 */
+	const ulog_stream_s *get_timed_out(hrt_abstime now, bool &max_tries_exceeded)
+	{
+		max_tries_exceeded = false;
+
+		for (int i = 0; i < _count; ++i) {
+			Entry &entry = _entries[(_head + i) % MAX_SIZE];
+
+			if (entry.acked || now - entry.sent_time <= _rto_us) {
+				continue;
+			}
+
+			if (++entry.tries > ulog_stream_ack_s::ACK_MAX_TRIES) {
+				max_tries_exceeded = true;
+				return nullptr;
+			}
+
+			shrink(now);
+			entry.sent_time = now;
+			return &entry.msg;
+		}
+
+		return nullptr;
+	}
+
+private:
+	static constexpr hrt_abstime MIN_RTO_US = ulog_stream_ack_s::ACK_TIMEOUT * 1000;
+	static constexpr hrt_abstime MAX_RTO_US = 500 * 1000;
+
+	struct Entry {
+		ulog_stream_s msg;
+		hrt_abstime sent_time;
+		uint8_t tries;
+		bool acked;
+	};
+
+	void update_rtt(hrt_abstime rtt_us)
+	{
+		const int32_t rtt = (int32_t)math::min(rtt_us, MAX_RTO_US);
+
+		if (_srtt_us == 0) {
+			_srtt_us = rtt;
+			_rttvar_us = rtt / 2;
+
+		} else {
+			const int32_t err = rtt - _srtt_us;
+			_srtt_us += err / 8;
+			_rttvar_us += ((err < 0 ? -err : err) - _rttvar_us) / 4;
+		}
+
+		_rto_us = math::constrain((hrt_abstime)(_srtt_us + 4 * _rttvar_us), MIN_RTO_US, MAX_RTO_US);
+	}
+
+	void grow()
+	{
+		if (_window_size >= MAX_SIZE) {
+			return;
+		}
+
+		if (_window_size < _slow_start_threshold) {
+			++_window_size;
+
+		} else if (++_num_acks >= _window_size) {
+			_num_acks = 0;
+			++_window_size;
+		}
+	}
+
+	void shrink(hrt_abstime now)
+	{
+		// react at most once per timeout period (a burst loss counts as one event)
+		if (now - _last_decrease > _rto_us) {
+			// back off the timer, so that an underestimated RTT does not lead to endless re-sending
+			_rto_us = math::min(_rto_us * 2, MAX_RTO_US);
+
+			_slow_start_threshold = math::max(_window_size / 2, 1);
+			_window_size = _slow_start_threshold;
+			_num_acks = 0;
+			_last_decrease = now;
+		}
+	}
+
+	Entry _entries[MAX_SIZE] {};
+	int _head{0};
+	int _count{0};
+
+	int _window_size{1};
+	int _slow_start_threshold{MAX_SIZE};
+	int _num_acks{0}; ///< acks received since the last window increase (congestion avoidance)
+
+	int32_t _srtt_us{0}; ///< smoothed round trip time
+	int32_t _rttvar_us{0}; ///< round trip time variation
+	hrt_abstime _rto_us{MIN_RTO_US}; ///< retransmission timeout
+	hrt_abstime _last_decrease{0};
+
+	uint16_t _last_added_sequence{0};
+};
@@ -0,0 +1,157 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file MappedULogFile.cpp
+ * Memory-mapped ULog file with an index of the data section.
+ */
+
+#include "MappedULogFile.hpp"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <px4_platform_common/log.h>
+#include <logger/messages.h>
+
+namespace px4
+{
+
+MappedULogFile::~MappedULogFile()
+{
+	close();
+}
+
+bool
+MappedULogFile::open(const char *file_name)
+{
+	close();
+
+	int fd = ::open(file_name, O_RDONLY);
+
+	if (fd < 0) {
+		return false;
+	}
+
+	struct stat st;
+
+	if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+
+	void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd); // the mapping stays valid
+
+	if (data == MAP_FAILED) {
+		PX4_ERR("mmap failed (%s)", strerror(errno));
+		return false;
+	}
+
+	// the file is read mostly sequentially
+	madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+	_data = (uint8_t *)data;
+	_size = st.st_size;
+	return true;
+}
+
+void
+MappedULogFile::close()
+{
+	if (_data) {
+		munmap(_data, _size);
+		_data = nullptr;
+		_size = 0;
+	}
+
+	_data_messages.clear();
+	_subscription_messages.clear();
+	_additional_messages.clear();
+	_num_data_messages = 0;
+}
+
+bool
+MappedULogFile::buildIndex(uint64_t data_section_start, uint64_t read_until)
+{
+	const uint64_t end = read_until < _size ? read_until : _size;
+	uint64_t offset = data_section_start;
+
+	while (offset + ULOG_MSG_HEADER_LEN <= end) {
+		ulog_message_header_s message_header;
+		memcpy(&message_header, _data + offset, ULOG_MSG_HEADER_LEN);
+
+		if (offset + ULOG_MSG_HEADER_LEN + message_header.msg_size > end) {
+			break;
+		}
+
+		switch (message_header.msg_type) {
+		case (int)ULogMessageType::DATA:
+			if (message_header.msg_size >= sizeof(uint16_t)) {
+				uint16_t msg_id;
+				memcpy(&msg_id, _data + offset + ULOG_MSG_HEADER_LEN, sizeof(msg_id));
+
+				if (msg_id >= _data_messages.size()) {
+					_data_messages.resize(msg_id + 1);
+				}
+
+				_data_messages[msg_id].push_back(offset);
+				++_num_data_messages;
+			}
+
+			break;
+
+		case (int)ULogMessageType::ADD_LOGGED_MSG:
+			_subscription_messages.push_back(offset);
+			break;
+
+		case (int)ULogMessageType::PARAMETER:
+		case (int)ULogMessageType::DROPOUT:
+			_additional_messages.push_back(offset);
+			break;
+
+		default: // nothing to index
+			break;
+		}
+
+		offset += ULOG_MSG_HEADER_LEN + message_header.msg_size;
+	}
+
+	return offset == end;
+}
+
+} //namespace px4
@@ -0,0 +1,110 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+namespace px4
+{
+
+/**
+ * @class MappedULogFile
+ * Read-only, memory-mapped ULog file with an index of the data section.
+ *
+ * The index is built in a single pass over the data section and contains the file offsets of all data
+ * messages (per msg_id), of all subscriptions and of the messages that need to be handled in file order
+ * (parameter changes and dropouts). This allows to iterate the data of each subscription without seeking
+ * through the file or scanning over messages of other subscriptions.
+ */
+class MappedULogFile
+{
+public:
+	MappedULogFile() = default;
+	~MappedULogFile();
+
+	MappedULogFile(const MappedULogFile &) = delete;
+	MappedULogFile &operator=(const MappedULogFile &) = delete;
+
+	/**
+	 * map a file into memory
+	 * @return true on success
+	 */
+	bool open(const char *file_name);
+
+	void close();
+
+	bool isOpen() const { return _data != nullptr; }
+
+	const uint8_t *data() const { return _data; }
+	uint64_t size() const { return _size; }
+
+	/**
+	 * Build the index of the data section
+	 * @param data_section_start file offset of the first message in the data section
+	 * @param read_until stop indexing at this file offset (e.g. start of appended data)
+	 * @return false if the data section is truncated (the index is still valid up to that point)
+	 */
+	bool buildIndex(uint64_t data_section_start, uint64_t read_until);
+
+	/**
+	 * @return file offsets of all data messages for msg_id (pointing to the message header)
+	 */
+	const std::vector<uint64_t> &dataMessages(uint16_t msg_id) const
+	{
+		return msg_id < _data_messages.size() ? _data_messages[msg_id] : _empty;
+	}
+
+	/** @return file offsets of all ADD_LOGGED_MSG messages */
+	const std::vector<uint64_t> &subscriptionMessages() const { return _subscription_messages; }
+
+	/** @return file offsets of all PARAMETER and DROPOUT messages in the data section */
+	const std::vector<uint64_t> &additionalMessages() const { return _additional_messages; }
+
+	/** @return total number of indexed data messages */
+	uint64_t numDataMessages() const { return _num_data_messages; }
+
+private:
+	uint8_t *_data{nullptr};
+	uint64_t _size{0};
+
+	std::vector<std::vector<uint64_t>> _data_messages;
+	std::vector<uint64_t> _subscription_messages;
+	std::vector<uint64_t> _additional_messages;
+	uint64_t _num_data_messages{0};
+
+	const std::vector<uint64_t> _empty;
+};
+
+} //namespace px4
@@ -51,8 +51,10 @@
 #include <cstring>
 #include <float.h>
 #include <fstream>
+#include <functional>
 #include <iostream>
 #include <math.h>
+#include <queue>
 #include <time.h>
 #include <sstream>
 #include <stdio.h>
@@ -63,6 +65,7 @@
 
 #include "Replay.hpp"
 #include "ReplayEkf2.hpp"
+#include "ReplayLockstep.hpp"
 
 #define PARAMS_OVERRIDE_FILE PX4_ROOTFSDIR "/replay_params.txt"
 
@@ -72,6 +75,14 @@ using namespace time_literals;
 namespace px4
 {
 
+/** wall clock time (not affected by lockstep) [us] */
+static uint64_t wallclockTime()
+{
+	struct timespec ts;
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts_to_abstime(&ts);
+}
+
 char *Replay::_replay_file = nullptr;
 
 Replay::CompatSensorCombinedDtType::CompatSensorCombinedDtType(int gyro_integral_dt_offset_log,
@@ -87,6 +98,10 @@ Replay::CompatSensorCombinedDtType::CompatSensorCombinedDtType(int gyro_integral
 Replay::~Replay()
 {
 	for (size_t i = 0; i < _subscriptions.size(); ++i) {
+		if (_subscriptions[i]) {
+			delete _subscriptions[i]->compat;
+		}
+
 		delete (_subscriptions[i]);
 	}
 
@@ -183,16 +198,16 @@ Replay::setUserParams(const char *filename)
 }
 
 bool
-Replay::readFileHeader(std::ifstream &file)
+Replay::readFileHeader()
 {
-	file.seekg(0);
 	ulog_file_header_s msg_header;
-	file.read((char *)&msg_header, sizeof(msg_header));
 
-	if (!file) {
+	if (_file.size() < sizeof(msg_header)) {
 		return false;
 	}
 
+	memcpy(&msg_header, _file.data(), sizeof(msg_header));
+
 	_file_start_time = msg_header.timestamp;
 	//verify it's an ULog file
 	char magic[8];
@@ -207,75 +222,76 @@ Replay::readFileHeader(std::ifstream &file)
 }
 
 bool
-Replay::readFileDefinitions(std::ifstream &file)
+Replay::readFileDefinitions()
 {
 	PX4_INFO("Applying params from ULog file...");
 
-	ulog_message_header_s message_header;
-	file.seekg(sizeof(ulog_file_header_s));
+	uint64_t offset = sizeof(ulog_file_header_s);
 
 	while (true) {
-		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+		ulog_message_header_s message_header;
+
+		if (offset + ULOG_MSG_HEADER_LEN > _file.size()) {
+			return false;
+		}
+
+		memcpy(&message_header, _file.data() + offset, ULOG_MSG_HEADER_LEN);
+		const uint8_t *message = _file.data() + offset + ULOG_MSG_HEADER_LEN;
 
-		if (!file) {
+		if (offset + ULOG_MSG_HEADER_LEN + message_header.msg_size > _file.size()) {
 			return false;
 		}
 
 		switch (message_header.msg_type) {
 		case (int)ULogMessageType::FLAG_BITS:
-			if (!readFlagBits(file, message_header.msg_size)) {
+			if (!readFlagBits(message, message_header.msg_size)) {
 				return false;
 			}
 
 			break;
 
 		case (int)ULogMessageType::FORMAT:
-			if (!readFormat(file, message_header.msg_size)) {
+			if (!readFormat(message, message_header.msg_size)) {
 				return false;
 			}
 
 			break;
 
 		case (int)ULogMessageType::PARAMETER:
-			if (!readAndApplyParameter(file, message_header.msg_size)) {
+			if (!readAndApplyParameter(message, message_header.msg_size)) {
 				return false;
 			}
 
 			break;
 
 		case (int)ULogMessageType::ADD_LOGGED_MSG:
-			_data_section_start = file.tellg() - (streamoff)ULOG_MSG_HEADER_LEN;
+			_data_section_start = offset;
 			return true;
 
 		case (int)ULogMessageType::INFO: //skip
 		case (int)ULogMessageType::INFO_MULTIPLE: //skip
-			file.seekg(message_header.msg_size, ios::cur);
 			break;
 
 		default:
 			PX4_ERR("unknown log definition type %i, size %i (offset %i)",
-				(int)message_header.msg_type, (int)message_header.msg_size, (int)file.tellg());
-			file.seekg(message_header.msg_size, ios::cur);
+				(int)message_header.msg_type, (int)message_header.msg_size, (int)offset);
 			break;
 		}
-	}
 
-	return true;
+		offset += ULOG_MSG_HEADER_LEN + message_header.msg_size;
+	}
 }
 
 bool
-Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
+Replay::readFlagBits(const uint8_t *message, uint16_t msg_size)
 {
 	if (msg_size != 40) {
 		PX4_ERR("unsupported message length for FLAG_BITS message (%i)", msg_size);
 		return false;
 	}
 
-	_read_buffer.reserve(msg_size);
-	uint8_t *message = (uint8_t *)_read_buffer.data();
-	file.read((char *)message, msg_size);
-	//uint8_t *compat_flags = message;
-	uint8_t *incompat_flags = message + 8;
+	//const uint8_t *compat_flags = message;
+	const uint8_t *incompat_flags = message + 8;
 
 	// handle & validate the flags
 	bool contains_appended_data = incompat_flags[0] & ULOG_INCOMPAT_FLAG0_DATA_APPENDED_MASK;
@@ -311,18 +327,9 @@ Replay::readFlagBits(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::readFormat(std::ifstream &file, uint16_t msg_size)
+Replay::readFormat(const uint8_t *message, uint16_t msg_size)
 {
-	_read_buffer.reserve(msg_size + 1);
-	char *format = (char *)_read_buffer.data();
-	file.read(format, msg_size);
-	format[msg_size] = 0;
-
-	if (!file) {
-		return false;
-	}
-
-	string str_format(format);
+	string str_format((const char *)message, msg_size);
 	size_t pos = str_format.find(':');
 
 	if (pos == string::npos) {
@@ -337,27 +344,15 @@ Replay::readFormat(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::readAndAddSubscription(std::ifstream &file, uint16_t msg_size)
+Replay::readAndAddSubscription(const uint8_t *message, uint16_t msg_size)
 {
-	_read_buffer.reserve(msg_size + 1);
-	char *message = (char *)_read_buffer.data();
-	streampos this_message_pos = file.tellg() - (streamoff)ULOG_MSG_HEADER_LEN;
-	file.read(message, msg_size);
-	message[msg_size] = 0;
-
-	if (!file) {
+	if (msg_size <= 3) {
 		return false;
 	}
 
-	if (file.tellg() <= _subscription_file_pos) { //already read this subscription
-		return true;
-	}
-
-	_subscription_file_pos = file.tellg();
-
-	uint8_t multi_id = *(uint8_t *)message;
+	uint8_t multi_id = message[0];
 	uint16_t msg_id = ((uint16_t) message[1]) | (((uint16_t) message[2]) << 8);
-	string topic_name(message + 3);
+	string topic_name((const char *)message + 3, msg_size - 3);
 	const orb_metadata *orb_meta = findTopic(topic_name);
 
 	if (!orb_meta) {
@@ -416,26 +411,21 @@ Replay::readAndAddSubscription(std::ifstream &file, uint16_t msg_size)
 	bool timestamp_found = findFieldOffset(orb_meta->o_fields, "timestamp", subscription->timestamp_offset, field_size);
 
 	if (!timestamp_found) {
+		delete subscription;
 		return true;
 	}
 
 	if (field_size != 8) {
 		PX4_ERR("Unsupported timestamp with size %i, ignoring the topic %s", field_size, orb_meta->o_name);
+		delete subscription;
 		return true;
 	}
 
 	//find first data message (and the timestamp)
-	streampos cur_pos = file.tellg();
-	subscription->next_read_pos = this_message_pos; //this will be skipped
-
-	if (!nextDataMessage(file, *subscription, msg_id)) {
-		return false;
-	}
-
-	file.seekg(cur_pos);
-
-	if (!subscription->orb_meta) {
+	if (!nextDataMessage(*subscription, msg_id)) {
 		//no message found. This is not a fatal error
+		delete subscription->compat;
+		delete subscription;
 		return true;
 	}
 
@@ -485,31 +475,31 @@ Replay::findFieldOffset(const string &format, const string &field_name, int &off
 }
 
 bool
-Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_position)
+Replay::readAndHandleAdditionalMessages(uint64_t end_position)
 {
-	ulog_message_header_s message_header;
+	const std::vector<uint64_t> &additional_messages = _file.additionalMessages();
 
-	while (file.tellg() < end_position) {
-		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+	while (_next_additional_message < additional_messages.size()
+	       && additional_messages[_next_additional_message] < end_position) {
 
-		if (!file) {
-			return false;
-		}
+		const uint64_t offset = additional_messages[_next_additional_message++];
+		ulog_message_header_s message_header;
+		memcpy(&message_header, _file.data() + offset, ULOG_MSG_HEADER_LEN);
+		const uint8_t *message = _file.data() + offset + ULOG_MSG_HEADER_LEN;
 
 		switch (message_header.msg_type) {
 		case (int)ULogMessageType::PARAMETER:
-			if (!readAndApplyParameter(file, message_header.msg_size)) {
+			if (!readAndApplyParameter(message, message_header.msg_size)) {
 				return false;
 			}
 
 			break;
 
 		case (int)ULogMessageType::DROPOUT:
-			readDropout(file, message_header.msg_size);
+			readDropout(message, message_header.msg_size);
 			break;
 
-		default: //skip all others
-			file.seekg(message_header.msg_size, ios::cur);
+		default: //not indexed
 			break;
 		}
 	}
@@ -518,13 +508,9 @@ Replay::readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_
 }
 
 bool
-Replay::readAndApplyParameter(std::ifstream &file, uint16_t msg_size)
+Replay::readAndApplyParameter(const uint8_t *message, uint16_t msg_size)
 {
-	_read_buffer.reserve(msg_size);
-	uint8_t *message = (uint8_t *)_read_buffer.data();
-	file.read((char *)message, msg_size);
-
-	if (!file) {
+	if (msg_size < 1 || message[0] >= msg_size) {
 		return false;
 	}
 
@@ -550,6 +536,10 @@ Replay::readAndApplyParameter(std::ifstream &file, uint16_t msg_size)
 		return true;
 	}
 
+	if (_benchmark) {
+		return true;
+	}
+
 	param_t handle = param_find(param_name.c_str());
 
 	if (handle != PARAM_INVALID) {
@@ -560,98 +550,47 @@ Replay::readAndApplyParameter(std::ifstream &file, uint16_t msg_size)
 }
 
 bool
-Replay::readDropout(std::ifstream &file, uint16_t msg_size)
+Replay::readDropout(const uint8_t *message, uint16_t msg_size)
 {
 	uint16_t duration;
-	file.read((char *)&duration, sizeof(duration));
+
+	if (msg_size < sizeof(duration)) {
+		return false;
+	}
+
+	memcpy(&duration, message, sizeof(duration));
 
 	PX4_ERR("Dropout in replayed log, %i ms", (int)duration);
-	return file.good();
+	return true;
 }
 
 bool
-Replay::nextDataMessage(std::ifstream &file, Subscription &subscription, int msg_id)
+Replay::nextDataMessage(Subscription &subscription, int msg_id)
 {
-	ulog_message_header_s message_header;
-	file.seekg(subscription.next_read_pos);
-	//ignore the first message (it's data we already read)
-	file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
-
-	if (file) {
-		file.seekg(message_header.msg_size, ios::cur);
-	}
-
-	uint16_t file_msg_id;
-	bool done = false;
-
-	while (file && !done) {
-		streampos cur_pos = file.tellg();
-		file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
-
-		if (!file) {
-			break;
-		}
-
-		if (((streamoff)cur_pos) + ULOG_MSG_HEADER_LEN + message_header.msg_size > _read_until_file_position) {
-			file.setstate(std::ios::eofbit);
-			break;
-		}
-
-		switch (message_header.msg_type) {
-		case (int)ULogMessageType::ADD_LOGGED_MSG:
-			readAndAddSubscription(file, message_header.msg_size);
-			break;
-
-		case (int)ULogMessageType::DATA:
-			file.read((char *)&file_msg_id, sizeof(file_msg_id));
-
-			if (file) {
-				if (msg_id == file_msg_id) {
-					if (message_header.msg_size == subscription.orb_meta->o_size_no_padding + 2) {
-						subscription.next_read_pos = cur_pos;
-						file.seekg(subscription.timestamp_offset, ios::cur);
-						file.read((char *)&subscription.next_timestamp, sizeof(subscription.next_timestamp));
-						done = true;
-
-					} else { //sanity check failed!
-						PX4_ERR("data message %s has wrong size %i (expected %i). Skipping",
-							subscription.orb_meta->o_name, message_header.msg_size,
-							subscription.orb_meta->o_size_no_padding + 2);
-						file.seekg(message_header.msg_size - sizeof(file_msg_id), ios::cur);
-					}
-
-				} else { //not the one we are looking for
-					file.seekg(message_header.msg_size - sizeof(file_msg_id), ios::cur);
-				}
-			}
-
-			break;
-
-		case (int)ULogMessageType::REMOVE_LOGGED_MSG: //skip these
-		case (int)ULogMessageType::PARAMETER:
-		case (int)ULogMessageType::DROPOUT:
-		case (int)ULogMessageType::INFO:
-		case (int)ULogMessageType::INFO_MULTIPLE:
-		case (int)ULogMessageType::SYNC:
-		case (int)ULogMessageType::LOGGING:
-			file.seekg(message_header.msg_size, ios::cur);
-			break;
-
-		default:
-			//this really should not happen
-			PX4_ERR("unknown log message type %i, size %i (offset %i)",
-				(int)message_header.msg_type, (int)message_header.msg_size, (int)file.tellg());
-			file.seekg(message_header.msg_size, ios::cur);
-			break;
+	const std::vector<uint64_t> &data_messages = _file.dataMessages(msg_id);
+
+	while (subscription.next_index < data_messages.size()) {
+		const uint64_t offset = data_messages[subscription.next_index++];
+		ulog_message_header_s message_header;
+		memcpy(&message_header, _file.data() + offset, ULOG_MSG_HEADER_LEN);
+
+		if (message_header.msg_size == subscription.orb_meta->o_size_no_padding + 2) {
+			subscription.next_read_pos = offset;
+			memcpy(&subscription.next_timestamp,
+			       _file.data() + offset + ULOG_MSG_HEADER_LEN + 2 + subscription.timestamp_offset, //skip header & msg id
+			       sizeof(subscription.next_timestamp));
+			return true;
 		}
-	}
 
-	if (file.eof()) { //no more data messages for this subscription
-		subscription.orb_meta = nullptr;
-		file.clear();
+		//sanity check failed!
+		PX4_ERR("data message %s has wrong size %i (expected %i). Skipping",
+			subscription.orb_meta->o_name, message_header.msg_size,
+			subscription.orb_meta->o_size_no_padding + 2);
 	}
 
-	return file.good();
+	//no more data messages for this subscription
+	subscription.orb_meta = nullptr;
+	return false;
 }
 
 const orb_metadata *
@@ -727,7 +666,7 @@ Replay::sizeOfFullType(const std::string &type_name_full)
 }
 
 bool
-Replay::readDefinitionsAndApplyParams(std::ifstream &file)
+Replay::readDefinitionsAndApplyParams()
 {
 	// log reader currently assumes little endian
 	int num = 1;
@@ -737,120 +676,137 @@ Replay::readDefinitionsAndApplyParams(std::ifstream &file)
 		return false;
 	}
 
-	if (!file.is_open()) {
+	if (!_file.isOpen()) {
 		PX4_ERR("Failed to open replay file");
 		return false;
 	}
 
-	if (!readFileHeader(file)) {
+	if (!readFileHeader()) {
 		PX4_ERR("Failed to read file header. Not a valid ULog file");
 		return false;
 	}
 
 	//initialize the formats and apply the parameters from the log file
-	if (!readFileDefinitions(file)) {
+	if (!readFileDefinitions()) {
 		PX4_ERR("Failed to read ULog definitions section. Broken file?");
 		return false;
 	}
 
-	setUserParams(PARAMS_OVERRIDE_FILE);
+	if (!_benchmark) {
+		setUserParams(PARAMS_OVERRIDE_FILE);
+	}
+
 	return true;
 }
 
-void
-Replay::run()
+bool
+Replay::indexDataSection()
 {
-	ifstream replay_file(_replay_file, ios::in | ios::binary);
+	const uint64_t start = wallclockTime();
 
-	if (!readDefinitionsAndApplyParams(replay_file)) {
-		return;
+	if (!_file.buildIndex(_data_section_start, _read_until_file_position)) {
+		PX4_DEBUG("last message in the data section is incomplete");
 	}
 
-	_speed_factor = 1.f;
-	const char *speedup = getenv("PX4_SIM_SPEED_FACTOR");
+	for (uint64_t offset : _file.subscriptionMessages()) {
+		ulog_message_header_s message_header;
+		memcpy(&message_header, _file.data() + offset, ULOG_MSG_HEADER_LEN);
 
-	if (speedup) {
-		_speed_factor = atof(speedup);
+		if (!readAndAddSubscription(_file.data() + offset + ULOG_MSG_HEADER_LEN, message_header.msg_size)) {
+			return false;
+		}
 	}
 
-	onEnterMainLoop();
-
-	_replay_start_time = hrt_absolute_time();
+	PX4_INFO("Indexed %llu data messages (%.3lf s)", (unsigned long long)_file.numDataMessages(),
+		 (double)(wallclockTime() - start) / 1.e6);
+	return true;
+}
 
-	PX4_INFO("Replay in progress...");
+uint32_t
+Replay::replayMessages()
+{
+	const uint64_t timestamp_offset = _benchmark ? 0 : getTimestampOffset();
+	uint32_t nr_published_messages = 0;
 
-	ulog_message_header_s message_header;
-	replay_file.seekg(_data_section_start);
+	//Messages from different subscriptions don't need to be in chronological order, so we merge
+	//the subscriptions by the timestamp of their next message
+	std::priority_queue<NextMessage, std::vector<NextMessage>, std::greater<NextMessage>> next_messages;
 
-	//we know the next message must be an ADD_LOGGED_MSG
-	replay_file.read((char *)&message_header, ULOG_MSG_HEADER_LEN);
+	for (size_t i = 0; i < _subscriptions.size(); ++i) {
+		const Subscription *subscription = _subscriptions[i];
 
-	if (!readAndAddSubscription(replay_file, message_header.msg_size)) {
-		PX4_ERR("Failed to read subscription");
-		return;
+		if (subscription && subscription->orb_meta && !subscription->ignored) {
+			next_messages.push(NextMessage{subscription->next_timestamp, subscription->next_index, (uint16_t)i});
+		}
 	}
 
-	const uint64_t timestamp_offset = getTimestampOffset();
-	uint32_t nr_published_messages = 0;
-	streampos last_additional_message_pos = _data_section_start;
+	while (!should_exit() && !next_messages.empty()) {
+		const NextMessage next = next_messages.top();
+		next_messages.pop();
+
+		Subscription &sub = *_subscriptions[next.msg_id];
 
-	while (!should_exit() && replay_file) {
+		if (!sub.orb_meta || sub.ignored || sub.next_index != next.index) {
+			continue; // the subscription was advanced in the meantime
+		}
 
-		//Find the next message to publish. Messages from different subscriptions don't need
-		//to be in chronological order, so we need to check all subscriptions
-		uint64_t next_file_time = 0;
-		int next_msg_id = -1;
-		bool first_time = true;
+		// a timestamp of 0 means someone didn't set the timestamp properly. Consider the message invalid
+		if (next.timestamp != 0) {
+			//handle additional messages between last and next published data
+			readAndHandleAdditionalMessages(sub.next_read_pos);
 
-		for (size_t i = 0; i < _subscriptions.size(); ++i) {
-			const Subscription *subscription = _subscriptions[i];
+			const uint64_t publish_timestamp = _benchmark ? next.timestamp : handleTopicDelay(next.timestamp, timestamp_offset);
 
-			if (!subscription) {
-				continue;
-			}
+			// It's time to publish
+			readTopicDataToBuffer(sub);
+			memcpy(_read_buffer.data() + sub.timestamp_offset, &publish_timestamp, sizeof(uint64_t)); //adjust the timestamp
 
-			if (subscription->orb_meta && !subscription->ignored) {
-				if (first_time || subscription->next_timestamp < next_file_time) {
-					first_time = false;
-					next_msg_id = (int)i;
-					next_file_time = subscription->next_timestamp;
-				}
+			if (_benchmark || handleTopicUpdate(sub, _read_buffer.data())) {
+				++nr_published_messages;
 			}
 		}
 
-		if (next_msg_id == -1) {
-			break; //no active subscription anymore. We're done.
+		if (sub.orb_meta && nextDataMessage(sub, next.msg_id)) {
+			next_messages.push(NextMessage{sub.next_timestamp, sub.next_index, next.msg_id});
 		}
 
-		Subscription &sub = *_subscriptions[next_msg_id];
+		// TODO: output status (eg. every sec), including total duration...
+	}
 
-		if (next_file_time == 0) {
-			//someone didn't set the timestamp properly. Consider the message invalid
-			nextDataMessage(replay_file, sub, next_msg_id);
-			continue;
-		}
+	return nr_published_messages;
+}
 
-		//handle additional messages between last and next published data
-		replay_file.seekg(last_additional_message_pos);
-		streampos next_additional_message_pos = sub.next_read_pos;
-		readAndHandleAdditionalMessages(replay_file, next_additional_message_pos);
-		last_additional_message_pos = next_additional_message_pos;
+void
+Replay::run()
+{
+	_file.open(_replay_file);
 
-		const uint64_t publish_timestamp = handleTopicDelay(next_file_time, timestamp_offset);
+	if (!readDefinitionsAndApplyParams()) {
+		return;
+	}
 
-		// It's time to publish
-		readTopicDataToBuffer(sub, replay_file);
-		memcpy(_read_buffer.data() + sub.timestamp_offset, &publish_timestamp, sizeof(uint64_t)); //adjust the timestamp
+	_speed_factor = 1.f;
+	const char *speedup = getenv("PX4_SIM_SPEED_FACTOR");
 
-		if (handleTopicUpdate(sub, _read_buffer.data(), replay_file)) {
-			++nr_published_messages;
-		}
+	if (speedup) {
+		_speed_factor = atof(speedup);
+	}
 
-		nextDataMessage(replay_file, sub, next_msg_id);
+	onEnterMainLoop();
 
-		// TODO: output status (eg. every sec), including total duration...
+	if (!indexDataSection()) {
+		PX4_ERR("Failed to read subscription");
+		return;
 	}
 
+	_replay_start_time = hrt_absolute_time();
+	const uint64_t wallclock_start_time = wallclockTime();
+
+	PX4_INFO("Replay in progress...");
+
+	const uint32_t nr_published_messages = replayMessages();
+	const double wallclock_elapsed = (double)(wallclockTime() - wallclock_start_time) / 1.e6;
+
 	for (auto &subscription : _subscriptions) {
 		if (!subscription) {
 			continue;
@@ -868,14 +824,15 @@ Replay::run()
 	}
 
 	if (!should_exit()) {
-		PX4_INFO("Replay done (published %u msgs, %.3lf s)", nr_published_messages,
-			 (double)hrt_elapsed_time(&_replay_start_time) / 1.e6);
+		PX4_INFO("Replay done (published %u msgs, %.3lf s, %.0lf msgs/s wall clock)", nr_published_messages,
+			 (double)hrt_elapsed_time(&_replay_start_time) / 1.e6,
+			 wallclock_elapsed > 0. ? nr_published_messages / wallclock_elapsed : 0.);
 	}
 
 	onExitMainLoop();
 
 	if (!should_exit()) {
-		replay_file.close();
+		_file.close();
 		px4_shutdown_request();
 		// we need to ensure the shutdown logic gets updated and eventually triggers shutdown
 		hrt_abstime t = hrt_absolute_time();
@@ -890,17 +847,16 @@ Replay::run()
 }
 
 void
-Replay::readTopicDataToBuffer(const Subscription &sub, std::ifstream &replay_file)
+Replay::readTopicDataToBuffer(const Subscription &sub)
 {
 	const size_t msg_read_size = sub.orb_meta->o_size_no_padding;
 	const size_t msg_write_size = sub.orb_meta->o_size;
 	_read_buffer.reserve(msg_write_size);
-	replay_file.seekg(sub.next_read_pos + (streamoff)(ULOG_MSG_HEADER_LEN + 2)); //skip header & msg id
-	replay_file.read((char *)_read_buffer.data(), msg_read_size);
+	memcpy(_read_buffer.data(), _file.data() + sub.next_read_pos + ULOG_MSG_HEADER_LEN + 2, msg_read_size); //skip header & msg id
 }
 
 bool
-Replay::handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file)
+Replay::handleTopicUpdate(Subscription &sub, void *data)
 {
 	return publishTopic(sub, data);
 }
@@ -995,6 +951,10 @@ Replay::custom_command(int argc, char *argv[])
 		return Replay::task_spawn(argc, argv);
 	}
 
+	if (!strcmp(argv[0], "benchmark")) {
+		return Replay::benchmark();
+	}
+
 	return print_usage("unknown command");
 }
 
@@ -1046,9 +1006,9 @@ Replay::applyParams(bool quiet)
 		return -ENOMEM;
 	}
 
-	ifstream replay_file(_replay_file, ios::in | ios::binary);
+	r->_file.open(_replay_file);
 
-	if (!r->readDefinitionsAndApplyParams(replay_file)) {
+	if (!r->readDefinitionsAndApplyParams()) {
 		ret = -1;
 	}
 
@@ -1057,6 +1017,47 @@ Replay::applyParams(bool quiet)
 	return ret;
 }
 
+int
+Replay::benchmark()
+{
+	if (!isSetup()) {
+		PX4_ERR("no log file given (via env variable %s)", replay::ENV_FILENAME);
+		return -1;
+	}
+
+	Replay *r = new Replay();
+
+	if (r == nullptr) {
+		PX4_ERR("alloc failed");
+		return -ENOMEM;
+	}
+
+	// read and merge all messages, but do not apply parameters and do not publish
+	r->_benchmark = true;
+
+	const uint64_t start_time = wallclockTime();
+	int ret = -1;
+
+	if (r->_file.open(_replay_file) && r->readDefinitionsAndApplyParams() && r->indexDataSection()) {
+		const uint64_t replay_start_time = wallclockTime();
+		const uint32_t nr_messages = r->replayMessages();
+		const uint64_t end_time = wallclockTime();
+
+		const double replay_elapsed = (double)(end_time - replay_start_time) / 1.e6;
+		const double total_elapsed = (double)(end_time - start_time) / 1.e6;
+
+		PX4_INFO("file size: %.1f MB", (double)r->_file.size() / 1.e6);
+		PX4_INFO("replayed %u msgs in %.3lf s (%.0lf msgs/s), %.3lf s including indexing (%.0lf msgs/s)", nr_messages,
+			 replay_elapsed, replay_elapsed > 0. ? nr_messages / replay_elapsed : 0.,
+			 total_elapsed, total_elapsed > 0. ? nr_messages / total_elapsed : 0.);
+		ret = 0;
+	}
+
+	delete r;
+
+	return ret;
+}
+
 Replay *
 Replay::instantiate(int argc, char *argv[])
 {
@@ -1069,6 +1070,10 @@ Replay::instantiate(int argc, char *argv[])
 		PX4_INFO("Ekf2 replay mode");
 		instance = new ReplayEkf2();
 
+	} else if (replay_mode && strcmp(replay_mode, "lockstep") == 0) {
+		PX4_INFO("Lockstep replay mode");
+		instance = new ReplayLockstep();
+
 	} else {
 		instance = new Replay();
 	}
@@ -1092,6 +1097,10 @@ There are 2 environment variables used for configuration: `replay`, which must b
 the log file to be replayed. The second is the mode, specified via `replay_mode`:
 - `replay_mode=ekf2`: specific EKF2 replay mode. It can only be used with the ekf2 module, but allows the replay
   to run as fast as possible.
+- `replay_mode=lockstep`: deterministic generic replay. The lockstep time follows the log, and after each message
+  the replay waits until all work queues are idle, so any chain of work queue modules (e.g. sensors, controllers)
+  runs as fast as possible and gives the same result on every run. Modules running in their own task are not
+  waited for.
 - Generic otherwise: this can be used to replay any module(s), but the replay will be done with the same speed as the
   log was recorded.
 
@@ -1107,6 +1116,8 @@ page.
 	PRINT_MODULE_USAGE_COMMAND_DESCR("start", "Start replay, using log file from ENV variable 'replay'");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("trystart", "Same as 'start', but silently exit if no log file given");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("tryapplyparams", "Try to apply the parameters from the log file");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("benchmark", "Read the log file as fast as possible without publishing and "
+					 "print the throughput");
 	PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
 
 	return 0;
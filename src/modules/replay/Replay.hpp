@@ -33,13 +33,13 @@
 
 #pragma once
 
-#include <fstream>
 #include <map>
 #include <vector>
 #include <set>
 #include <string>
 
 #include "definitions.hpp"
+#include "MappedULogFile.hpp"
 
 #include <px4_platform_common/module.h>
 #include <uORB/topics/uORBTopics.hpp>
@@ -51,9 +51,9 @@ namespace px4
 /**
  * @class Replay
  * Parses an ULog file and replays it in 'real-time'. The timestamp of each replayed message is offset
- * to match the starting time of replay. It keeps a stream for each subscription to find the next message
- * to replay. This is necessary because data messages from different subscriptions don't need to be in
- * monotonic increasing order.
+ * to match the starting time of replay. The file is memory-mapped and indexed once, and each subscription
+ * iterates over the indexed data messages of its msg_id. The subscriptions are merged by timestamp, as data
+ * messages from different subscriptions don't need to be in monotonic increasing order.
  */
 class Replay : public ModuleBase<Replay>
 {
@@ -91,6 +91,12 @@ public:
 	 */
 	static void setupReplayFile(const char *file_name);
 
+	/**
+	 * Read the whole replay file without publishing and print the throughput.
+	 * @return 0 on success
+	 */
+	static int benchmark();
+
 	static bool isSetup() { return _replay_file; }
 
 protected:
@@ -134,7 +140,8 @@ protected:
 
 		bool ignored = false; ///< if true, it will not be considered for publication in the main loop
 
-		std::streampos next_read_pos;
+		uint64_t next_read_pos; ///< file offset of the next data message
+		size_t next_index = 0; ///< index of the next data message in MappedULogFile::dataMessages()
 		uint64_t next_timestamp; ///< timestamp of the file
 
 		CompatBase *compat = nullptr;
@@ -189,22 +196,19 @@ protected:
 	 * handle the publication of a topic update
 	 * @return true if published, false otherwise
 	 */
-	virtual bool handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file);
+	virtual bool handleTopicUpdate(Subscription &sub, void *data);
 
 	/**
 	 * read a topic from the file (offset given by the subscription) into _read_buffer
 	 */
-	void readTopicDataToBuffer(const Subscription &sub, std::ifstream &replay_file);
+	void readTopicDataToBuffer(const Subscription &sub);
 
 	/**
-	 * Find next data message for this subscription, starting with the stored file offset.
-	 * Skip the first message, and if found, read the timestamp and store the new file offset.
-	 * This also takes care of new subscriptions and parameter updates. When reaching EOF,
-	 * the subscription is set to invalid.
-	 * File seek position is arbitrary after this call.
-	 * @return false on file error
+	 * Advance to the next data message for this subscription, read the timestamp and store the new file
+	 * offset. When there are no more messages, the subscription is set to invalid.
+	 * @return false if there are no more messages
 	 */
-	bool nextDataMessage(std::ifstream &file, Subscription &subscription, int msg_id);
+	bool nextDataMessage(Subscription &subscription, int msg_id);
 
 	virtual uint64_t getTimestampOffset()
 	{
@@ -216,6 +220,8 @@ protected:
 	std::vector<Subscription *> _subscriptions;
 	std::vector<uint8_t> _read_buffer;
 
+	MappedULogFile _file;
+
 	float _speed_factor{1.f}; ///< from PX4_SIM_SPEED_FACTOR env variable (set to 0 to avoid usleep = unlimited rate)
 
 private:
@@ -224,45 +230,73 @@ private:
 
 	uint64_t _file_start_time;
 	uint64_t _replay_start_time;
-	std::streampos _data_section_start; ///< first ADD_LOGGED_MSG message
+	uint64_t _data_section_start; ///< first ADD_LOGGED_MSG message
 
-	/** keep track of file position to avoid adding a subscription multiple times. */
-	std::streampos _subscription_file_pos = 0;
+	uint64_t _read_until_file_position = 1ULL << 60; ///< read limit if log contains appended data
 
-	int64_t _read_until_file_position = 1ULL << 60; ///< read limit if log contains appended data
+	size_t _next_additional_message{0}; ///< index into MappedULogFile::additionalMessages()
 
 	float _accumulated_delay{0.f};
 
-	bool readFileHeader(std::ifstream &file);
+	bool _benchmark{false}; ///< if true, read the log without applying parameters or publishing
+
+	/**
+	 * Sort key for merging the subscriptions by timestamp (ties are resolved by msg_id)
+	 */
+	struct NextMessage {
+		uint64_t timestamp;
+		size_t index;
+		uint16_t msg_id;
+
+		bool operator>(const NextMessage &other) const
+		{
+			return timestamp > other.timestamp || (timestamp == other.timestamp && msg_id > other.msg_id);
+		}
+	};
+
+	bool readFileHeader();
 
 	/**
 	 * Read definitions section: check formats, apply parameters and store
 	 * the start of the data section.
 	 * @return true on success
 	 */
-	bool readFileDefinitions(std::ifstream &file);
+	bool readFileDefinitions();
 
-	///file parsing methods. They return false, when further parsing should be aborted.
-	bool readFormat(std::ifstream &file, uint16_t msg_size);
-	bool readAndAddSubscription(std::ifstream &file, uint16_t msg_size);
-	bool readFlagBits(std::ifstream &file, uint16_t msg_size);
+	///file parsing methods. They get a pointer to the message (after the header) and return false,
+	///when further parsing should be aborted.
+	bool readFormat(const uint8_t *message, uint16_t msg_size);
+	bool readAndAddSubscription(const uint8_t *message, uint16_t msg_size);
+	bool readFlagBits(const uint8_t *message, uint16_t msg_size);
 
 	/**
 	 * Read the file header and definitions sections. Apply the parameters from this section
 	 * and apply user-defined overridden parameters.
 	 * @return true on success
 	 */
-	bool readDefinitionsAndApplyParams(std::ifstream &file);
+	bool readDefinitionsAndApplyParams();
 
 	/**
-	 * Read and handle additional messages starting at current file position, while position < end_position.
+	 * Index the data section and add all subscriptions
+	 * @return true on success
+	 */
+	bool indexDataSection();
+
+	/**
+	 * Read and handle the indexed additional messages that are before end_position and not handled yet.
 	 * This handles dropout and parameter update messages.
 	 * We need to handle these separately, because they have no timestamp. We look at the file position instead.
 	 * @return false on file error
 	 */
-	bool readAndHandleAdditionalMessages(std::ifstream &file, std::streampos end_position);
-	bool readDropout(std::ifstream &file, uint16_t msg_size);
-	bool readAndApplyParameter(std::ifstream &file, uint16_t msg_size);
+	bool readAndHandleAdditionalMessages(uint64_t end_position);
+	bool readDropout(const uint8_t *message, uint16_t msg_size);
+	bool readAndApplyParameter(const uint8_t *message, uint16_t msg_size);
+
+	/**
+	 * Merge all subscriptions by timestamp and handle the messages
+	 * @return number of published messages
+	 */
+	uint32_t replayMessages();
 
 	static const orb_metadata *findTopic(const std::string &name);
 
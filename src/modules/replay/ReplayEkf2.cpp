@@ -31,6 +31,8 @@
  *
  ****************************************************************************/
 
+#include <cstring>
+
 #include <drivers/drv_hrt.h>
 #include <px4_platform_common/defines.h>
 #include <px4_platform_common/posix.h>
@@ -56,13 +58,13 @@ namespace px4
 {
 
 bool
-ReplayEkf2::handleTopicUpdate(Subscription &sub, void *data, std::ifstream &replay_file)
+ReplayEkf2::handleTopicUpdate(Subscription &sub, void *data)
 {
 	if (sub.orb_meta == ORB_ID(ekf2_timestamps)) {
 		ekf2_timestamps_s ekf2_timestamps;
 		memcpy(&ekf2_timestamps, data, sub.orb_meta->o_size);
 
-		if (!publishEkf2Topics(ekf2_timestamps, replay_file)) {
+		if (!publishEkf2Topics(ekf2_timestamps)) {
 			return false;
 		}
 
@@ -112,13 +114,13 @@ ReplayEkf2::onSubscriptionAdded(Subscription &sub, uint16_t msg_id)
 }
 
 bool
-ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifstream &replay_file)
+ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps)
 {
 	auto handle_sensor_publication = [&](int16_t timestamp_relative, uint16_t msg_id) {
 		if (timestamp_relative != ekf2_timestamps_s::RELATIVE_TIMESTAMP_INVALID) {
 			// timestamp_relative is already given in 0.1 ms
 			uint64_t t = timestamp_relative + ekf2_timestamps.timestamp / 100; // in 0.1 ms
-			findTimestampAndPublish(t, msg_id, replay_file);
+			findTimestampAndPublish(t, msg_id);
 		}
 	};
 
@@ -130,7 +132,7 @@ ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifs
 	handle_sensor_publication(ekf2_timestamps.visual_odometry_timestamp_rel, _vehicle_visual_odometry_msg_id);
 
 	// sensor_combined: publish last because ekf2 is polling on this
-	if (!findTimestampAndPublish(ekf2_timestamps.timestamp / 100, _sensor_combined_msg_id, replay_file)) {
+	if (!findTimestampAndPublish(ekf2_timestamps.timestamp / 100, _sensor_combined_msg_id)) {
 		if (_sensor_combined_msg_id == msg_id_invalid) {
 			// subscription not found yet or sensor_combined not contained in log
 			return false;
@@ -140,7 +142,7 @@ ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifs
 
 		} else {
 			// we should publish a topic, just publish the same again
-			readTopicDataToBuffer(*_subscriptions[_sensor_combined_msg_id], replay_file);
+			readTopicDataToBuffer(*_subscriptions[_sensor_combined_msg_id]);
 			publishTopic(*_subscriptions[_sensor_combined_msg_id], _read_buffer.data());
 		}
 	}
@@ -149,7 +151,7 @@ ReplayEkf2::publishEkf2Topics(const ekf2_timestamps_s &ekf2_timestamps, std::ifs
 }
 
 bool
-ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, std::ifstream &replay_file)
+ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id)
 {
 	if (msg_id == msg_id_invalid) {
 		// could happen if a topic is not logged
@@ -159,7 +161,7 @@ ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, std::if
 	Subscription &sub = *_subscriptions[msg_id];
 
 	while (sub.next_timestamp / 100 < timestamp && sub.orb_meta) {
-		nextDataMessage(replay_file, sub, msg_id);
+		nextDataMessage(sub, msg_id);
 	}
 
 	if (!sub.orb_meta) { // no messages anymore
@@ -174,7 +176,7 @@ ReplayEkf2::findTimestampAndPublish(uint64_t timestamp, uint16_t msg_id, std::if
 		return false;
 	}
 
-	readTopicDataToBuffer(sub, replay_file);
+	readTopicDataToBuffer(sub);
 	publishTopic(sub, _read_buffer.data());
 	return true;
 }
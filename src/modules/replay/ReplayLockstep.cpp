@@ -0,0 +1,80 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <drivers/drv_hrt.h>
+
+#include "ReplayLockstep.hpp"
+
+namespace px4
+{
+
+void
+ReplayLockstep::onEnterMainLoop()
+{
+	_speed_factor = 0.f; // iterate as fast as possible
+}
+
+uint64_t
+ReplayLockstep::handleTopicDelay(uint64_t next_file_time, uint64_t timestamp_offset)
+{
+	// advance the lockstep time to the message, then let everything that became due run to completion
+	const uint64_t publish_timestamp = Replay::handleTopicDelay(next_file_time, timestamp_offset);
+
+	waitForIdle();
+
+	return publish_timestamp;
+}
+
+bool
+ReplayLockstep::handleTopicUpdate(Subscription &sub, void *data)
+{
+	const bool published = publishTopic(sub, data);
+
+	// wait for the modules to process the data (including everything they publish in turn)
+	waitForIdle();
+
+	return published;
+}
+
+void
+ReplayLockstep::waitForIdle()
+{
+	if (px4_lockstep_wait_for_idle() != PX4_OK) {
+		// the result would depend on the timing of this run, which defeats the purpose of this mode
+		PX4_ERR("work queues did not settle, aborting the replay");
+		request_stop();
+	}
+}
+
+} // namespace px4
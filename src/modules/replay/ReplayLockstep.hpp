@@ -0,0 +1,73 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#pragma once
+
+#include "Replay.hpp"
+
+namespace px4
+{
+
+/**
+ * @class ReplayLockstep
+ * Generic replay, but deterministic and as fast as possible: the lockstep time follows the log timestamps,
+ * and before every time step and after every publication it waits until all work queues are idle. This way
+ * any chain of work queue modules sees the same inputs at the same (simulated) time on every run.
+ */
+class ReplayLockstep : public Replay
+{
+public:
+protected:
+
+	void onEnterMainLoop() override;
+
+	uint64_t handleTopicDelay(uint64_t next_file_time, uint64_t timestamp_offset) override;
+
+	bool handleTopicUpdate(Subscription &sub, void *data) override;
+
+	uint64_t getTimestampOffset() override
+	{
+		// keep the log timestamps, so that the result does not depend on the replay start time
+		return 0;
+	}
+
+private:
+
+	/**
+	 * Wait until all work queues are idle, stop the replay if they don't settle
+	 */
+	void waitForIdle();
+};
+
+} //namespace px4
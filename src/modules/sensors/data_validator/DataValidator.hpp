@@ -163,10 +163,17 @@ public:
 	static constexpr uint32_t ERROR_FLAG_HIGH_ERRCOUNT = (0x00000001U << 3);
 	static constexpr uint32_t ERROR_FLAG_HIGH_ERRDENSITY = (0x00000001U << 4);
 
+	static constexpr uint32_t TIMEOUT_DEFAULT = 20000; /**< default timeout interval in us */
+	static constexpr unsigned NORETURN_ERRCOUNT =
+		10000; /**< if the error count reaches this value, return sensor as invalid */
+	static constexpr float ERROR_DENSITY_WINDOW = 100.0f; /**< window in measurement counts for errors */
+	static constexpr unsigned VALUE_EQUAL_COUNT_DEFAULT =
+		100; /**< if the sensor value is the same (accumulated also between axes) this many times, flag it */
+
 private:
 	uint32_t _error_mask{ERROR_FLAG_NO_ERROR}; /**< sensor error state */
 
-	uint32_t _timeout_interval{20000}; /**< interval in which the datastream times out in us */
+	uint32_t _timeout_interval{TIMEOUT_DEFAULT}; /**< interval in which the datastream times out in us */
 
 	uint64_t _time_last{0};   /**< last timestamp */
 	uint64_t _event_count{0}; /**< total data counter */
@@ -188,12 +195,6 @@ private:
 
 	DataValidator *_sibling{nullptr}; /**< sibling in the group */
 
-	static const constexpr unsigned NORETURN_ERRCOUNT =
-		10000; /**< if the error count reaches this value, return sensor as invalid */
-	static const constexpr float ERROR_DENSITY_WINDOW = 100.0f; /**< window in measurement counts for errors */
-	static const constexpr unsigned VALUE_EQUAL_COUNT_DEFAULT =
-		100; /**< if the sensor value is the same (accumulated also between axes) this many times, flag it */
-
 	/* we don't want this class to be copied */
 	DataValidator(const DataValidator &) = delete;
 	DataValidator operator=(const DataValidator &) = delete;
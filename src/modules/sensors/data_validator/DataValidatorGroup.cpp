@@ -47,101 +47,133 @@
 
 DataValidatorGroup::DataValidatorGroup(unsigned siblings)
 {
+	_num_validators = (siblings < MAX_VALIDATORS) ? siblings : MAX_VALIDATORS;
+}
 
-	DataValidator *next = nullptr;
-	DataValidator *prev = nullptr;
-
-	for (unsigned i = 0; i < siblings; i++) {
-		next = new DataValidator();
-
-		if (i == 0) {
-			_first = next;
-
-		} else {
-			prev->setSibling(next);
-		}
-
-		prev = next;
+bool DataValidatorGroup::add_new_validator()
+{
+	if (_num_validators >= MAX_VALIDATORS) {
+		return false;
 	}
 
-	_last = next;
+	_num_validators++;
+	return true;
+}
 
-	if (_first) {
-		_timeout_interval_us = _first->get_timeout();
+void DataValidatorGroup::put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count,
+			     uint8_t priority)
+{
+	if (index < _num_validators) {
+		update(index, timestamp, val, error_count, priority);
 	}
 }
 
-DataValidatorGroup::~DataValidatorGroup()
+void DataValidatorGroup::put(uint8_t update_mask, const uint64_t timestamp[], const float val[][3],
+			     const uint32_t error_count[], const uint8_t priority[])
 {
-	while (_first) {
-		DataValidator *next = _first->sibling();
-		delete (_first);
-		_first = next;
+	for (unsigned i = 0; i < _num_validators; i++) {
+		if (update_mask & (1 << i)) {
+			update(i, timestamp[i], val[i], error_count[i], priority[i]);
+		}
 	}
 }
 
-DataValidator *DataValidatorGroup::add_new_validator()
+void DataValidatorGroup::update(unsigned i, uint64_t timestamp, const float val[dimensions], uint32_t error_count,
+				uint8_t priority)
 {
+	_event_count[i]++;
 
-	DataValidator *validator = new DataValidator();
+	if (error_count > _error_count[i]) {
+		_error_density[i] += (error_count - _error_count[i]);
 
-	if (!validator) {
-		return nullptr;
+	} else if (_error_density[i] > 0) {
+		_error_density[i]--;
 	}
 
-	_last->setSibling(validator);
-	_last = validator;
-	_last->set_timeout(_timeout_interval_us);
-	return _last;
-}
+	_error_count[i] = error_count;
+	_priority[i] = priority;
 
-void DataValidatorGroup::set_timeout(uint32_t timeout_interval_us)
-{
+	if (_time_last[i] == 0) {
+		for (unsigned axis = 0; axis < dimensions; axis++) {
+			_mean[axis][i] = 0;
+			_lp[axis][i] = val[axis];
+			_M2[axis][i] = 0;
+		}
 
-	DataValidator *next = _first;
+	} else {
+		const float event_count_inv = 1.f / _event_count[i];
 
-	while (next != nullptr) {
-		next->set_timeout(timeout_interval_us);
-		next = next->sibling();
-	}
+		for (unsigned axis = 0; axis < dimensions; axis++) {
+			const float lp_val = val[axis] - _lp[axis][i];
 
-	_timeout_interval_us = timeout_interval_us;
-}
+			const float delta_val = lp_val - _mean[axis][i];
+			_mean[axis][i] += delta_val * event_count_inv;
+			_M2[axis][i] += delta_val * (lp_val - _mean[axis][i]);
 
-void DataValidatorGroup::set_equal_value_threshold(uint32_t threshold)
-{
+			if (fabsf(_value[i][axis] - val[axis]) < 0.000001f) {
+				_value_equal_count[i]++;
+
+			} else {
+				_value_equal_count[i] = 0;
+			}
+		}
+	}
 
-	DataValidator *next = _first;
+	for (unsigned axis = 0; axis < dimensions; axis++) {
+		// XXX replace with better filter, make it auto-tune to update rate
+		_lp[axis][i] = _lp[axis][i] * 0.99f + 0.01f * val[axis];
 
-	while (next != nullptr) {
-		next->set_equal_value_threshold(threshold);
-		next = next->sibling();
+		_value[i][axis] = val[axis];
 	}
+
+	_time_last[i] = timestamp;
 }
 
-void DataValidatorGroup::put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count,
-			     uint8_t priority)
+float DataValidatorGroup::confidence(unsigned i, uint64_t timestamp)
 {
+	float ret = 1.0f;
+
+	/* check if we have any data */
+	if (_time_last[i] == 0) {
+		_error_mask[i] |= DataValidator::ERROR_FLAG_NO_DATA;
+		ret = 0.0f;
+
+	} else if (timestamp - _time_last[i] > _timeout_interval_us) {
+		/* timed out - that's it */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_TIMEOUT;
+		ret = 0.0f;
+
+	} else if (_value_equal_count[i] > _value_equal_count_threshold) {
+		/* we got the exact same sensor value N times in a row */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_STALE_DATA;
+		ret = 0.0f;
+
+	} else if (_error_count[i] > DataValidator::NORETURN_ERRCOUNT) {
+		/* check error count limit */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_HIGH_ERRCOUNT;
+		ret = 0.0f;
+
+	} else if (_error_density[i] > DataValidator::ERROR_DENSITY_WINDOW) {
+		/* cap error density counter at window size */
+		_error_mask[i] |= DataValidator::ERROR_FLAG_HIGH_ERRDENSITY;
+		_error_density[i] = DataValidator::ERROR_DENSITY_WINDOW;
+	}
 
-	DataValidator *next = _first;
-	unsigned i = 0;
+	/* no critical errors */
+	if (ret > 0.0f) {
+		/* return local error density for last N measurements */
+		ret = 1.0f - (_error_density[i] / DataValidator::ERROR_DENSITY_WINDOW);
 
-	while (next != nullptr) {
-		if (i == index) {
-			next->put(timestamp, val, error_count, priority);
-			break;
+		if (ret > 0.0f) {
+			_error_mask[i] = DataValidator::ERROR_FLAG_NO_ERROR;
 		}
-
-		next = next->sibling();
-		i++;
 	}
+
+	return ret;
 }
 
 float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 {
-
-	DataValidator *next = _first;
-
 	// XXX This should eventually also include voting
 	int pre_check_best = _curr_best;
 	float pre_check_confidence = 1.0f;
@@ -149,16 +181,13 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 	float max_confidence = -1.0f;
 	int max_priority = -1000;
 	int max_index = -1;
-	DataValidator *best = nullptr;
-
-	int i = 0;
 
-	while (next != nullptr) {
-		float confidence = next->confidence(timestamp);
+	for (int i = 0; i < (int)_num_validators; i++) {
+		const float confidence_i = confidence(i, timestamp);
 
 		if (i == pre_check_best) {
-			pre_check_prio = next->priority();
-			pre_check_confidence = confidence;
+			pre_check_prio = _priority[i];
+			pre_check_confidence = confidence_i;
 		}
 
 		/*
@@ -166,18 +195,14 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 		 * 1) the confidence is higher and priority is equal or higher
 		 * 2) the confidence is no less than 1% different and the priority is higher
 		 */
-		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence >= MIN_REGULAR_CONFIDENCE)) ||
-		     (confidence > max_confidence && (next->priority() >= max_priority)) ||
-		     (fabsf(confidence - max_confidence) < 0.01f && (next->priority() > max_priority))) &&
-		    (confidence > 0.0f)) {
+		if ((((max_confidence < MIN_REGULAR_CONFIDENCE) && (confidence_i >= MIN_REGULAR_CONFIDENCE)) ||
+		     (confidence_i > max_confidence && (_priority[i] >= max_priority)) ||
+		     (fabsf(confidence_i - max_confidence) < 0.01f && (_priority[i] > max_priority))) &&
+		    (confidence_i > 0.0f)) {
 			max_index = i;
-			max_confidence = confidence;
-			max_priority = next->priority();
-			best = next;
+			max_confidence = confidence_i;
+			max_priority = _priority[i];
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	/* the current best sensor is not matching the previous best sensor,
@@ -192,8 +217,8 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 			true_failsafe = false;
 
 			/* reset error flags, this is likely a hotplug sensor coming online late */
-			if (best != nullptr) {
-				best->reset_state();
+			if (max_index >= 0) {
+				_error_mask[max_index] = DataValidator::ERROR_FLAG_NO_ERROR;
 			}
 		}
 
@@ -220,7 +245,7 @@ float *DataValidatorGroup::get_best(uint64_t timestamp, int *index)
 	}
 
 	*index = max_index;
-	return (best) ? best->value() : nullptr;
+	return (max_index >= 0) ? _value[max_index] : nullptr;
 }
 
 void DataValidatorGroup::print()
@@ -228,14 +253,11 @@ void DataValidatorGroup::print()
 	PX4_INFO("validator: best: %d, prev best: %d, failsafe: %s (%u events)", _curr_best, _prev_best,
 		 (_toggle_count > 0) ? "YES" : "NO", _toggle_count);
 
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used()) {
-			uint32_t flags = next->state();
+	for (unsigned i = 0; i < _num_validators; i++) {
+		if (used(i)) {
+			uint32_t flags = _error_mask[i];
 
-			PX4_INFO("sensor #%u, prio: %d, state:%s%s%s%s%s%s", i, next->priority(),
+			PX4_INFO("sensor #%u, prio: %d, state:%s%s%s%s%s%s", i, _priority[i],
 				 ((flags & DataValidator::ERROR_FLAG_NO_DATA) ? " OFF" : ""),
 				 ((flags & DataValidator::ERROR_FLAG_STALE_DATA) ? " STALE" : ""),
 				 ((flags & DataValidator::ERROR_FLAG_TIMEOUT) ? " TOUT" : ""),
@@ -243,27 +265,24 @@ void DataValidatorGroup::print()
 				 ((flags & DataValidator::ERROR_FLAG_HIGH_ERRDENSITY) ? " EDNST" : ""),
 				 ((flags == DataValidator::ERROR_FLAG_NO_ERROR) ? " OK" : ""));
 
-			next->print();
-		}
+			const float conf = confidence(i, hrt_absolute_time());
 
-		next = next->sibling();
-		i++;
+			for (unsigned axis = 0; axis < dimensions; axis++) {
+				const float rms = (_event_count[i] > 1) ? sqrtf(_M2[axis][i] / (_event_count[i] - 1)) : 0.f;
+
+				PX4_INFO("\tval: %8.4f, lp: %8.4f mean dev: %8.4f RMS: %8.4f conf: %8.4f", (double)_value[i][axis],
+					 (double)_lp[axis][i], (double)_mean[axis][i], (double)rms, (double)conf);
+			}
+		}
 	}
 }
 
 int DataValidatorGroup::failover_index()
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) &&
-		    (i == (unsigned)_prev_best)) {
+	for (unsigned i = 0; i < _num_validators; i++) {
+		if (used(i) && (_error_mask[i] != DataValidator::ERROR_FLAG_NO_ERROR) && (i == (unsigned)_prev_best)) {
 			return i;
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	return -1;
@@ -271,18 +290,10 @@ int DataValidatorGroup::failover_index()
 
 uint32_t DataValidatorGroup::failover_state()
 {
-
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (next->used() && (next->state() != DataValidator::ERROR_FLAG_NO_ERROR) &&
-		    (i == (unsigned)_prev_best)) {
-			return next->state();
+	for (unsigned i = 0; i < _num_validators; i++) {
+		if (used(i) && (_error_mask[i] != DataValidator::ERROR_FLAG_NO_ERROR) && (i == (unsigned)_prev_best)) {
+			return _error_mask[i];
 		}
-
-		next = next->sibling();
-		i++;
 	}
 
 	return DataValidator::ERROR_FLAG_NO_ERROR;
@@ -290,16 +301,8 @@ uint32_t DataValidatorGroup::failover_state()
 
 uint32_t DataValidatorGroup::get_sensor_state(unsigned index)
 {
-	DataValidator *next = _first;
-	unsigned i = 0;
-
-	while (next != nullptr) {
-		if (i == index) {
-			return next->state();
-		}
-
-		next = next->sibling();
-		i++;
+	if (index < _num_validators) {
+		return _error_mask[index];
 	}
 
 	// sensor index not found
@@ -43,20 +43,27 @@
 
 #include "DataValidator.hpp"
 
+/**
+ * The state of all validators is kept in arrays indexed by sensor (structure of arrays),
+ * so that put() and get_best() run over contiguous memory instead of a linked list of
+ * individually allocated validators.
+ */
 class DataValidatorGroup
 {
 public:
+	static constexpr unsigned MAX_VALIDATORS = 4;
+
 	/**
-	 * @param siblings initial number of DataValidator's. Must be > 0.
+	 * @param siblings initial number of validators. Must be > 0 and <= MAX_VALIDATORS.
 	 */
 	DataValidatorGroup(unsigned siblings);
-	~DataValidatorGroup();
+	~DataValidatorGroup() = default;
 
 	/**
-	 * Create a new Validator (with index equal to the number of currently existing validators)
-	 * @return the newly created DataValidator or nullptr on error
+	 * Create a new validator (with index equal to the number of currently existing validators)
+	 * @return false if the group is full
 	 */
-	DataValidator *add_new_validator();
+	bool add_new_validator();
 
 	/**
 	 * Put an item into the validator group.
@@ -69,6 +76,19 @@ public:
 	 */
 	void put(unsigned index, uint64_t timestamp, const float val[3], uint32_t error_count, uint8_t priority);
 
+	/**
+	 * Put the items of several sensors into the validator group at once.
+	 * All arrays are indexed by sensor index, only the sensors set in update_mask are read.
+	 *
+	 * @param update_mask	Bitmask of the sensor indexes with a new measurement
+	 * @param timestamp	The timestamps of the measurements
+	 * @param val		The 3D vectors
+	 * @param error_count	The current error counts of the sensors
+	 * @param priority	The priorities of the sensors
+	 */
+	void put(uint8_t update_mask, const uint64_t timestamp[], const float val[][3], const uint32_t error_count[],
+		 const uint8_t priority[]);
+
 	/**
 	 * Get the best data triplet of the group
 	 *
@@ -104,6 +124,20 @@ public:
 	 */
 	uint32_t get_sensor_state(unsigned index);
 
+	/**
+	 * Get the error count of the sensor with the specified index
+	 *
+	 * @return		the last error count put into the group
+	 */
+	uint32_t get_sensor_error_count(unsigned index) const { return (index < _num_validators) ? _error_count[index] : 0; }
+
+	/**
+	 * Get the last value of the sensor with the specified index
+	 *
+	 * @return		pointer to the array of values or nullptr
+	 */
+	const float *get_sensor_value(unsigned index) const { return (index < _num_validators) ? _value[index] : nullptr; }
+
 	/**
 	 * Print the validator value
 	 *
@@ -115,20 +149,51 @@ public:
 	 *
 	 * @param timeout_interval_us The timeout interval in microseconds
 	 */
-	void set_timeout(uint32_t timeout_interval_us);
+	void set_timeout(uint32_t timeout_interval_us) { _timeout_interval_us = timeout_interval_us; }
+
+	/**
+	 * Get the timeout value of the group
+	 *
+	 * @return The timeout interval in microseconds
+	 */
+	uint32_t get_timeout() const { return _timeout_interval_us; }
 
 	/**
 	 * Set the equal count threshold for the whole group
 	 *
 	 * @param threshold The number of equal values before considering the sensor stale
 	 */
-	void set_equal_value_threshold(uint32_t threshold);
+	void set_equal_value_threshold(uint32_t threshold) { _value_equal_count_threshold = threshold; }
 
 private:
-	DataValidator *_first{nullptr}; /**< first node in the group */
-	DataValidator *_last{nullptr};  /**< last node in the group */
+	static constexpr unsigned dimensions = DataValidator::dimensions;
+
+	void update(unsigned index, uint64_t timestamp, const float val[dimensions], uint32_t error_count, uint8_t priority);
+
+	float confidence(unsigned index, uint64_t timestamp);
+
+	bool used(unsigned index) const { return (_time_last[index] > 0); }
+
+	unsigned _num_validators{0};
+
+	// per sensor state
+	uint64_t _time_last[MAX_VALIDATORS] {};    /**< last timestamp */
+	uint32_t _event_count[MAX_VALIDATORS] {};  /**< total data counter */
+	uint32_t _error_count[MAX_VALIDATORS] {};  /**< error count */
+	uint32_t _error_mask[MAX_VALIDATORS] {};   /**< sensor error state */
+	int _error_density[MAX_VALIDATORS] {};     /**< ratio between successful reads and errors */
+	unsigned _value_equal_count[MAX_VALIDATORS] {}; /**< equal values in a row */
+	uint8_t _priority[MAX_VALIDATORS] {};      /**< sensor nominal priority */
+
+	// per axis state of all sensors, the RMS error is calculated from _M2 on demand
+	float _mean[dimensions][MAX_VALIDATORS] {}; /**< mean of value */
+	float _lp[dimensions][MAX_VALIDATORS] {};   /**< low pass value */
+	float _M2[dimensions][MAX_VALIDATORS] {};   /**< RMS component value */
+
+	float _value[MAX_VALIDATORS][dimensions] {}; /**< last value (contiguous per sensor for get_best()) */
 
-	uint32_t _timeout_interval_us{0}; /**< currently set timeout */
+	uint32_t _timeout_interval_us{DataValidator::TIMEOUT_DEFAULT}; /**< interval in which the datastream times out in us */
+	unsigned _value_equal_count_threshold{DataValidator::VALUE_EQUAL_COUNT_DEFAULT}; /**< when to consider an equal count as a problem */
 
 	int _curr_best{-1}; /**< currently best index */
 	int _prev_best{-1}; /**< the previous best index */
@@ -140,6 +205,6 @@ private:
 	static constexpr float MIN_REGULAR_CONFIDENCE = 0.9f;
 
 	/* we don't want this class to be copied */
-	DataValidatorGroup(const DataValidatorGroup &);
-	DataValidatorGroup operator=(const DataValidatorGroup &);
+	DataValidatorGroup(const DataValidatorGroup &) = delete;
+	DataValidatorGroup operator=(const DataValidatorGroup &) = delete;
 };
@@ -0,0 +1,165 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 Todd Stellanova. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be  used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file benchmark_data_validator_group.cpp
+ * Measure the cost of the sensor voting of the sensors module (3 accels, 3 gyros, 4 mags, 2 baros)
+ * with DataValidatorGroup: putting new samples one sensor at a time, all at once (batch) and
+ * selecting the best sensor.
+ */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "../DataValidatorGroup.hpp"
+
+static constexpr unsigned ITERATIONS = 500000;
+static constexpr unsigned MAX_SENSORS = DataValidatorGroup::MAX_VALIDATORS;
+static constexpr unsigned NUM_SAMPLES = 16;
+static constexpr uint64_t INTERVAL_US = 1000;
+
+struct SensorClass {
+	const char *name;
+	unsigned count;
+};
+
+struct Result {
+	double put_ns;
+	double put_batch_ns;
+	double get_best_ns;
+};
+
+static volatile float sink; // keep the results alive
+
+static double elapsed_ns(std::chrono::steady_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / ITERATIONS;
+}
+
+static Result run(unsigned count, const float data[NUM_SAMPLES][MAX_SENSORS][3])
+{
+	Result result{};
+	uint64_t timestamp[MAX_SENSORS] {};
+	uint32_t error_count[MAX_SENSORS] {};
+	uint8_t priority[MAX_SENSORS] {100, 100, 100, 100};
+	const uint8_t update_mask = (1 << count) - 1;
+
+	{
+		DataValidatorGroup group(count);
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned n = 0; n < ITERATIONS; n++) {
+			for (unsigned i = 0; i < count; i++) {
+				timestamp[i] += INTERVAL_US;
+				group.put(i, timestamp[i], data[n % NUM_SAMPLES][i], error_count[i], priority[i]);
+			}
+		}
+
+		result.put_ns = elapsed_ns(start);
+	}
+
+	DataValidatorGroup group(count);
+
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned n = 0; n < ITERATIONS; n++) {
+			for (unsigned i = 0; i < count; i++) {
+				timestamp[i] += INTERVAL_US;
+			}
+
+			group.put(update_mask, timestamp, data[n % NUM_SAMPLES], error_count, priority);
+		}
+
+		result.put_batch_ns = elapsed_ns(start);
+	}
+
+	{
+		const auto start = std::chrono::steady_clock::now();
+
+		for (unsigned n = 0; n < ITERATIONS; n++) {
+			int best_index = -1;
+			const float *best = group.get_best(timestamp[0], &best_index);
+			sink = (best != nullptr) ? best[0] : 0.f;
+		}
+
+		result.get_best_ns = elapsed_ns(start);
+	}
+
+	return result;
+}
+
+int main(int argc, char *argv[])
+{
+	(void)argc; // unused
+	(void)argv; // unused
+
+	static const SensorClass sensor_classes[] {
+		{"accel", 3},
+		{"gyro", 3},
+		{"mag", 4},
+		{"baro", 2},
+	};
+
+	// a few different samples, so that the values are never flagged as stale
+	float data[NUM_SAMPLES][MAX_SENSORS][3];
+
+	for (auto &sample : data) {
+		for (auto &sensor : sample) {
+			for (auto &axis : sensor) {
+				axis = (float)rand() / (float)RAND_MAX;
+			}
+		}
+	}
+
+	Result total{};
+
+	printf("time per update of all sensors of a class\n");
+	printf("%-6s %8s %10s %14s %14s\n", "class", "sensors", "put [ns]", "put batch [ns]", "get_best [ns]");
+
+	for (const SensorClass &sensor_class : sensor_classes) {
+		const Result result = run(sensor_class.count, data);
+
+		printf("%-6s %8u %10.1f %14.1f %14.1f\n", sensor_class.name, sensor_class.count, result.put_ns,
+		       result.put_batch_ns, result.get_best_ns);
+
+		total.put_ns += result.put_ns;
+		total.put_batch_ns += result.put_batch_ns;
+		total.get_best_ns += result.get_best_ns;
+	}
+
+	printf("%-6s %8s %10.1f %14.1f %14.1f\n", "total", "", total.put_ns, total.put_batch_ns, total.get_best_ns);
+
+	return 0;
+}
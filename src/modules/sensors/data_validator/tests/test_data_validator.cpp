@@ -42,8 +42,8 @@
 #include <cstdlib>
 #include <stdio.h>
 #include <math.h>
-#include <validation/data_validator.h>
-#include <validation/tests/tests_common.h>
+#include "../DataValidator.hpp"
+#include "tests_common.h"
 
 
 void test_init()
@@ -42,15 +42,15 @@
 #include <cstdlib>
 #include <stdio.h>
 #include <math.h>
-#include <validation/data_validator.h>
-#include <validation/data_validator_group.h>
-#include <validation/tests/tests_common.h>
+#include "../DataValidator.hpp"
+#include "../DataValidatorGroup.hpp"
+#include "tests_common.h"
 
 
 const uint32_t base_timeout_usec = 2000;//from original private value
 const int equal_value_count = 100; //default is private VALUE_EQUAL_COUNT_DEFAULT
 const uint64_t base_timestamp = 666;
-const unsigned base_num_siblings = 4;
+const unsigned base_num_siblings = 2;
 
 
 /**
@@ -72,10 +72,8 @@ DataValidatorGroup  *setup_base_group(unsigned *sibling_count)
 	assert(DataValidator::ERROR_FLAG_NO_ERROR == group->failover_state());
 	assert(-1 == group->failover_index());
 
-	//this sets the timeout on all current members of the group, as well as members added later
+	//these apply to all current members of the group, as well as members added later
 	group->set_timeout(base_timeout_usec);
-	//the following sets the threshold on all CURRENT members of the group, but not any added later
-	//TODO This is likely a bug in DataValidatorGroup
 	group->set_equal_value_threshold(equal_value_count);
 
 	//return values
@@ -147,43 +145,63 @@ void fill_two_with_valid_data(DataValidatorGroup *group, int val1_idx, int val2_
 /**
  * Dynamically add a validator to the group after construction
  * @param group
- * @return
+ * @param sibling_count (in/out) number of validators in the group
+ * @return index of the new validator
  */
-DataValidator *add_validator_to_group(DataValidatorGroup *group)
+unsigned add_validator_to_group(DataValidatorGroup *group, unsigned *sibling_count)
 {
-	DataValidator *validator = group->add_new_validator();
+	bool added = group->add_new_validator();
+	assert(added);
+	(void)added;
 	//verify the previously set timeout applies to the new group member
-	assert(validator->get_timeout() == base_timeout_usec);
-	//for testing purposes, ensure this newly added member is consistent with the rest of the group
-	//TODO this is likely a bug in DataValidatorGroup
-	validator->set_equal_value_threshold(equal_value_count);
+	assert(group->get_timeout() == base_timeout_usec);
 
-	return validator;
+	return (*sibling_count)++;
 }
 
 /**
- * Create a DataValidatorGroup and tack on two additional DataValidators
+ * Create a DataValidatorGroup and tack on two additional validators
  *
- * @param validator1_handle (out) first DataValidator added to the group
- * @param validator2_handle (out) second DataValidator added to the group
- * @param sibling_count (in/out) in: number of initial siblings to create, out: total
+ * @param sibling_count (out) the total number of validators
  * @return
  */
-DataValidatorGroup *setup_group_with_two_validator_handles(
-	DataValidator **validator1_handle,
-	DataValidator **validator2_handle,
-	unsigned *sibling_count)
+DataValidatorGroup *setup_group_with_two_validators(unsigned *sibling_count)
 {
 	DataValidatorGroup *group = setup_base_group(sibling_count);
 
 	//now we add validators
-	*validator1_handle = add_validator_to_group(group);
-	*validator2_handle = add_validator_to_group(group);
-	*sibling_count += 2;
+	add_validator_to_group(group, sibling_count);
+	add_validator_to_group(group, sibling_count);
 
 	return group;
 }
 
+/**
+ * Insert a time series of samples into a validator of the group
+ * @param group
+ * @param idx Index of the validator to fill with samples
+ * @param incr_value The amount to increment the value by on each iteration
+ * @param value_io (in/out) in: initial value, out: final value
+ * @param timestamp_io (in/out) in: initial timestamp, out: final timestamp
+ */
+void fill_group_with_samples(DataValidatorGroup *group, unsigned idx, const float incr_value, float *value_io,
+			     uint64_t *timestamp_io)
+{
+	uint64_t timestamp = *timestamp_io;
+	const uint64_t timestamp_incr = 5; //usec
+	float val = *value_io;
+
+	//put a bunch of values that are all different
+	for (int i = 0; i < equal_value_count; i++, val += incr_value) {
+		float data[DataValidator::dimensions] = {val};
+		timestamp += timestamp_incr;
+		group->put(idx, timestamp, data, 0, 50);
+	}
+
+	*timestamp_io = timestamp;
+	*value_io = val;
+}
+
 
 void test_init()
 {
@@ -198,6 +216,25 @@ void test_init()
 	delete group; //force cleanup
 }
 
+/**
+ * Verify that no more than MAX_VALIDATORS validators can be added
+ */
+void test_max_validators()
+{
+	unsigned num_siblings = 0;
+
+	DataValidatorGroup *group = setup_base_group(&num_siblings);
+
+	while (num_siblings < DataValidatorGroup::MAX_VALIDATORS) {
+		add_validator_to_group(group, &num_siblings);
+	}
+
+	assert(!group->add_new_validator());
+	assert(UINT32_MAX == group->get_sensor_state(num_siblings));
+
+	delete group;
+}
+
 
 /**
  * Happy path test of put method -- ensure the "best" sensor selected is the one with highest priority
@@ -205,12 +242,10 @@ void test_init()
 void test_put()
 {
 	unsigned num_siblings = 0;
-	DataValidator *validator1 = nullptr;
-	DataValidator *validator2 = nullptr;
 
 	uint64_t timestamp = base_timestamp;
 
-	DataValidatorGroup *group = setup_group_with_two_validator_handles(&validator1, &validator2, &num_siblings);
+	DataValidatorGroup *group = setup_group_with_two_validators(&num_siblings);
 	printf("num_siblings: %d \n", num_siblings);
 	unsigned val1_idx = num_siblings - 2;
 	unsigned val2_idx = num_siblings - 1;
@@ -221,14 +256,12 @@ void test_put()
 	assert(nullptr != best_data);
 	float best_val = best_data[0];
 
-	float *cur_val1 = validator1->value();
+	const float *cur_val1 = group->get_sensor_value(val1_idx);
 	assert(nullptr != cur_val1);
-	//printf("cur_val1 %p \n", cur_val1);
 	assert(best_val == cur_val1[0]);
 
-	float *cur_val2 = validator2->value();
+	const float *cur_val2 = group->get_sensor_value(val2_idx);
 	assert(nullptr != cur_val2);
-	//printf("cur_val12 %p \n", cur_val2);
 	assert(best_val == cur_val2[0]);
 
 	delete group; //force cleanup
@@ -241,12 +274,10 @@ void test_put()
 void test_priority_switch()
 {
 	unsigned num_siblings = 0;
-	DataValidator *validator1 = nullptr;
-	DataValidator *validator2 = nullptr;
 
 	uint64_t timestamp = base_timestamp;
 
-	DataValidatorGroup *group = setup_group_with_two_validator_handles(&validator1, &validator2, &num_siblings);
+	DataValidatorGroup *group = setup_group_with_two_validators(&num_siblings);
 	//printf("num_siblings: %d \n",num_siblings);
 	int val1_idx = (int)num_siblings - 2;
 	int val2_idx = (int)num_siblings - 1;
@@ -278,12 +309,10 @@ void test_priority_switch()
 void test_simple_failover()
 {
 	unsigned num_siblings = 0;
-	DataValidator *validator1 = nullptr;
-	DataValidator *validator2 = nullptr;
 
 	uint64_t timestamp = base_timestamp;
 
-	DataValidatorGroup *group = setup_group_with_two_validator_handles(&validator1, &validator2, &num_siblings);
+	DataValidatorGroup *group = setup_group_with_two_validators(&num_siblings);
 	//printf("num_siblings: %d \n",num_siblings);
 	int val1_idx = (int)num_siblings - 2;
 	int val2_idx = (int)num_siblings - 1;
@@ -305,7 +334,7 @@ void test_simple_failover()
 		group->put(val2_idx, timestamp, data, 0, 10);
 	}
 
-	assert(validator1->error_count() == val1_err_count);
+	assert(group->get_sensor_error_count(val1_idx) == val1_err_count);
 
 	//since validator1 is experiencing errors, we should see a failover to validator2
 	best_data = group->get_best(timestamp + 1, &best_idx);
@@ -317,7 +346,7 @@ void test_simple_failover()
 	assert(1 == group->failover_count());
 
 	//even though validator1 has encountered a bunch of errors, it hasn't failed
-	assert(DataValidator::ERROR_FLAG_NO_ERROR == validator1->state());
+	assert(DataValidator::ERROR_FLAG_NO_ERROR == group->get_sensor_state(val1_idx));
 
 	// although we failed over from one sensor to another, this is not the same thing tracked by failover_index
 	int fail_idx = group->failover_index();
@@ -344,13 +373,10 @@ void test_sensor_failure()
 
 	DataValidatorGroup *group =  setup_base_group(&num_siblings);
 
-	//now we add validators
-	DataValidator *validator  = add_validator_to_group(group);
-	assert(nullptr != validator);
-	num_siblings++;
-	int val_idx = num_siblings - 1;
+	//now we add a validator
+	int val_idx = add_validator_to_group(group, &num_siblings);
 
-	fill_validator_with_samples(validator,  sufficient_incr_value, &val, &timestamp);
+	fill_group_with_samples(group, val_idx, sufficient_incr_value, &val, &timestamp);
 	//the best should now be the one validator we've filled with samples
 
 	int best_idx = -1;
@@ -360,8 +386,8 @@ void test_sensor_failure()
 	assert(best_idx == val_idx);
 
 	//now force a timeout failure in the one validator, by checking confidence long past timeout
-	validator->confidence(timestamp + (1.1 * timeout_usec));
-	assert(DataValidator::ERROR_FLAG_TIMEOUT == (DataValidator::ERROR_FLAG_TIMEOUT & validator->state()));
+	group->get_best(timestamp + (1.1 * timeout_usec), &best_idx);
+	assert(DataValidator::ERROR_FLAG_TIMEOUT == (DataValidator::ERROR_FLAG_TIMEOUT & group->get_sensor_state(val_idx)));
 
 	//now that the one sensor has failed, the group should detect this as well
 	int fail_idx = group->failover_index();
@@ -370,16 +396,74 @@ void test_sensor_failure()
 	delete  group;
 }
 
+/**
+ * Verify that putting the samples of several sensors at once is equivalent to putting them one by one
+ */
+void test_batch_put()
+{
+	unsigned num_siblings = 0;
+	DataValidatorGroup *group_single = setup_group_with_two_validators(&num_siblings);
+	num_siblings = 0;
+	DataValidatorGroup *group_batch = setup_group_with_two_validators(&num_siblings);
+
+	uint64_t timestamp[DataValidatorGroup::MAX_VALIDATORS] {};
+	float data[DataValidatorGroup::MAX_VALIDATORS][DataValidator::dimensions] {};
+	uint32_t error_count[DataValidatorGroup::MAX_VALIDATORS] {};
+	uint8_t priority[DataValidatorGroup::MAX_VALIDATORS] {};
+
+	for (uint32_t i = 0; i < 500; i++) {
+		// a different subset of the sensors updates every time, the last sensor reports errors
+		const uint8_t update_mask = (i % 7) + 1;
+
+		for (unsigned idx = 0; idx < num_siblings; idx++) {
+			timestamp[idx] = base_timestamp + i * 5;
+
+			for (unsigned axis = 0; axis < DataValidator::dimensions; axis++) {
+				data[idx][axis] = ((float) rand() / (float) RAND_MAX);
+			}
+
+			error_count[idx] = (idx == num_siblings - 1) ? i / 4 : 0;
+			priority[idx] = 100 - idx;
+
+			if (update_mask & (1 << idx)) {
+				group_single->put(idx, timestamp[idx], data[idx], error_count[idx], priority[idx]);
+			}
+		}
+
+		group_batch->put(update_mask, timestamp, data, error_count, priority);
+
+		int best_idx_single = -1;
+		int best_idx_batch = -1;
+		const float *best_single = group_single->get_best(timestamp[0], &best_idx_single);
+		const float *best_batch = group_batch->get_best(timestamp[0], &best_idx_batch);
+
+		assert(best_idx_single == best_idx_batch);
+		assert((best_single == nullptr) == (best_batch == nullptr));
+		assert(best_single == nullptr || best_single[0] == best_batch[0]);
+
+		for (unsigned idx = 0; idx < num_siblings; idx++) {
+			assert(group_single->get_sensor_state(idx) == group_batch->get_sensor_state(idx));
+		}
+	}
+
+	assert(group_single->failover_count() == group_batch->failover_count());
+
+	delete group_single;
+	delete group_batch;
+}
+
 int main(int argc, char *argv[])
 {
 	(void)argc; // unused
 	(void)argv; // unused
 
 	test_init();
+	test_max_validators();
 	test_put();
 	test_simple_failover();
 	test_priority_switch();
 	test_sensor_failure();
+	test_batch_put();
 
 	return 0; //passed
 }
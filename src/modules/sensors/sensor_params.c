@@ -221,3 +221,19 @@ PARAM_DEFINE_INT32(SENS_EXT_I2C_PRB, 1);
  * @group Sensors
  */
 PARAM_DEFINE_INT32(SENS_IMU_MODE, 1);
+
+/**
+ * Sensors hub IMU fusion
+ *
+ * Combine the full rate data of all healthy IMUs (weighted by their estimated noise)
+ * into a single, less noisy IMU for sensor_combined, instead of using the primary IMU only.
+ * The voting and failover (SENS_IMU_MODE) continue to select the primary IMU for
+ * the rate controllers, and are used to exclude unhealthy IMUs from the fusion.
+ * Requires drivers publishing FIFO data (sensor_gyro_fifo and sensor_accel_fifo).
+ *
+ * @boolean
+ * @category system
+ * @reboot_required true
+ * @group Sensors
+ */
+PARAM_DEFINE_INT32(SENS_IMU_FUSE, 0);
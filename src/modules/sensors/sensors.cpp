@@ -75,6 +75,7 @@
 #include "vehicle_air_data/VehicleAirData.hpp"
 #include "vehicle_gps_position/VehicleGPSPosition.hpp"
 #include "vehicle_imu/VehicleIMU.hpp"
+#include "vehicle_imu_fusion/VehicleIMUFusion.hpp"
 #include "vehicle_magnetometer/VehicleMagnetometer.hpp"
 
 using namespace sensors;
@@ -124,6 +125,8 @@ private:
 		{this, ORB_ID(vehicle_imu), 3}
 	};
 
+	uORB::SubscriptionCallbackWorkItem _vehicle_imu_fused_sub{this, ORB_ID(vehicle_imu_fused)};
+
 	uORB::Subscription _diff_pres_sub{ORB_ID(differential_pressure)};
 	uORB::Subscription _parameter_update_sub{ORB_ID(parameter_update)};
 	uORB::Subscription _vcontrol_mode_sub{ORB_ID(vehicle_control_mode)};
@@ -177,6 +180,7 @@ private:
 	VehicleGPSPosition	*_vehicle_gps_position{nullptr};
 
 	VehicleIMU      *_vehicle_imu_list[MAX_SENSOR_COUNT] {};
+	VehicleIMUFusion *_vehicle_imu_fusion{nullptr};
 
 	int _lockstep_component{-1};
 
@@ -209,12 +213,14 @@ private:
 	void		InitializeVehicleAirData();
 	void		InitializeVehicleGPSPosition();
 	void		InitializeVehicleIMU();
+	void		InitializeVehicleIMUFusion();
 	void		InitializeVehicleMagnetometer();
 
 	DEFINE_PARAMETERS(
 		(ParamBool<px4::params::SYS_HAS_BARO>) _param_sys_has_baro,
 		(ParamBool<px4::params::SYS_HAS_MAG>) _param_sys_has_mag,
-		(ParamBool<px4::params::SENS_IMU_MODE>) _param_sens_imu_mode
+		(ParamBool<px4::params::SENS_IMU_MODE>) _param_sens_imu_mode,
+		(ParamBool<px4::params::SENS_IMU_FUSE>) _param_sens_imu_fuse
 	)
 };
 
@@ -223,7 +229,7 @@ Sensors::Sensors(bool hil_enabled) :
 	ScheduledWorkItem(MODULE_NAME, px4::wq_configurations::nav_and_controllers),
 	_hil_enabled(hil_enabled),
 	_loop_perf(perf_alloc(PC_ELAPSED, "sensors")),
-	_voted_sensors_update(hil_enabled, _vehicle_imu_sub)
+	_voted_sensors_update(hil_enabled, _vehicle_imu_sub, _vehicle_imu_fused_sub)
 {
 	/* Differential pressure offset */
 	_parameter_handles.diff_pres_offset_pa = param_find("SENS_DPRES_OFF");
@@ -272,6 +278,8 @@ Sensors::~Sensors()
 		sub.unregisterCallback();
 	}
 
+	_vehicle_imu_fused_sub.unregisterCallback();
+
 	_vehicle_acceleration.Stop();
 	_vehicle_angular_velocity.Stop();
 
@@ -297,6 +305,11 @@ Sensors::~Sensors()
 		}
 	}
 
+	if (_vehicle_imu_fusion) {
+		_vehicle_imu_fusion->Stop();
+		delete _vehicle_imu_fusion;
+	}
+
 	perf_free(_loop_perf);
 
 	px4_lockstep_unregister_component(_lockstep_component);
@@ -562,6 +575,22 @@ void Sensors::InitializeVehicleIMU()
 	}
 }
 
+void Sensors::InitializeVehicleIMUFusion()
+{
+	if (_param_sens_imu_fuse.get()) {
+		if (_vehicle_imu_fusion == nullptr) {
+			if (orb_exists(ORB_ID(sensor_gyro_fifo), 0) == PX4_OK) {
+				_vehicle_imu_fusion = new VehicleIMUFusion();
+
+				if (_vehicle_imu_fusion) {
+					_vehicle_imu_fusion->Start();
+					_vehicle_imu_fused_sub.registerCallback();
+				}
+			}
+		}
+	}
+}
+
 void Sensors::InitializeVehicleMagnetometer()
 {
 	if (_param_sys_has_mag.get()) {
@@ -585,6 +614,8 @@ void Sensors::Run()
 			sub.unregisterCallback();
 		}
 
+		_vehicle_imu_fused_sub.unregisterCallback();
+
 		exit_and_cleanup();
 		return;
 	}
@@ -593,6 +624,7 @@ void Sensors::Run()
 	if (_last_config_update == 0) {
 		InitializeVehicleAirData();
 		InitializeVehicleIMU();
+		InitializeVehicleIMUFusion();
 		InitializeVehicleGPSPosition();
 		InitializeVehicleMagnetometer();
 		_voted_sensors_update.init(_sensor_combined);
@@ -633,6 +665,7 @@ void Sensors::Run()
 		_voted_sensors_update.initializeSensors();
 		InitializeVehicleAirData();
 		InitializeVehicleIMU();
+		InitializeVehicleIMUFusion();
 		InitializeVehicleGPSPosition();
 		InitializeVehicleMagnetometer();
 		_last_config_update = hrt_absolute_time();
@@ -740,6 +773,11 @@ int Sensors::print_status()
 		}
 	}
 
+	if (_vehicle_imu_fusion) {
+		PX4_INFO_RAW("\n");
+		_vehicle_imu_fusion->PrintStatus();
+	}
+
 	return 0;
 }
 
@@ -769,6 +807,7 @@ The provided functionality includes:
   on startup. The sensor drivers use the ioctl interface for parameter updates. For this to work properly, the
   sensor drivers must already be running when `sensors` is started.
 - Do sensor consistency checks and publish the `sensors_status_imu` topic.
+- Optionally (SENS_IMU_FUSE) combine the data of all healthy IMUs into a single, less noisy IMU for `sensor_combined`.
 
 ### Implementation
 It runs in its own thread and polls on the currently selected gyro topic.
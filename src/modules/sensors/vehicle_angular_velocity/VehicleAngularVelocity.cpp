@@ -79,6 +79,7 @@ void VehicleAngularVelocity::Stop()
 {
 	// clear all registered callbacks
 	_sensor_sub.unregisterCallback();
+	_sensor_fifo_sub.unregisterCallback();
 	_sensor_selection_sub.unregisterCallback();
 
 	Deinit();
@@ -101,7 +102,8 @@ void VehicleAngularVelocity::CheckFilters()
 				reset_filters = true;
 			}
 
-			if (reset_filters || (_required_sample_updates == 0)) {
+			// in FIFO mode every driver update is processed (and already paced by IMU_GYRO_RATEMAX)
+			if (!_fifo_available && (reset_filters || (_required_sample_updates == 0))) {
 				if (_param_imu_gyro_rate_max.get() > 0) {
 					// determine number of sensor samples that will get closest to the desired rate
 					const float configured_interval_us = 1e6f / _param_imu_gyro_rate_max.get();
@@ -139,21 +141,200 @@ void VehicleAngularVelocity::CheckFilters()
 		if (reset_filters) {
 			PX4_DEBUG("resetting filters, sample rate: %.3f Hz -> %.3f Hz", (double)_filter_sample_rate, (double)_update_rate_hz);
 			_filter_sample_rate = _update_rate_hz;
+			ResetFilters(_angular_velocity_prev, _angular_acceleration_prev);
+		}
+
+		// reset sample interval accumulator
+		_timestamp_sample_last = 0;
+	}
+}
+
+void VehicleAngularVelocity::ResetFilters(const Vector3f &angular_velocity, const Vector3f &angular_acceleration)
+{
+	// update software low pass filters
+	_lp_filter_velocity.set_cutoff_frequency(_filter_sample_rate, _param_imu_gyro_cutoff.get());
+	_lp_filter_velocity.reset(angular_velocity);
+
+	_notch_filter_velocity.setParameters(_filter_sample_rate, _param_imu_gyro_nf_freq.get(), _param_imu_gyro_nf_bw.get());
+	_notch_filter_velocity.reset(angular_velocity);
+
+	_lp_filter_acceleration.set_cutoff_frequency(_filter_sample_rate, _param_imu_dgyro_cutoff.get());
+	_lp_filter_acceleration.reset(angular_acceleration);
 
-			// update software low pass filters
-			_lp_filter_velocity.set_cutoff_frequency(_filter_sample_rate, _param_imu_gyro_cutoff.get());
-			_lp_filter_velocity.reset(_angular_velocity_prev);
+	// retune the dynamic notch filters to the (new) sample rate
+	DynamicNotchFFTUpdate(true);
+	DynamicNotchEscRpmUpdate(true);
+	ResetDynamicNotch(angular_velocity);
 
-			_notch_filter_velocity.setParameters(_filter_sample_rate, _param_imu_gyro_nf_freq.get(), _param_imu_gyro_nf_bw.get());
-			_notch_filter_velocity.reset(_angular_velocity_prev);
+	_angular_velocity_prev = angular_velocity;
+	_angular_acceleration_prev = angular_acceleration;
 
-			_lp_filter_acceleration.set_cutoff_frequency(_filter_sample_rate, _param_imu_dgyro_cutoff.get());
-			_lp_filter_acceleration.reset(_angular_acceleration_prev);
+	_reset_filters = false;
+}
+
+void VehicleAngularVelocity::ApplyDynamicNotch(float angular_velocity[3])
+{
+	if (_dynamic_notch_fft_active) {
+		_dynamic_notch_filter_fft.apply(angular_velocity);
+	}
+
+	if (_dynamic_notch_esc_rpm_active != 0) {
+		for (int esc = 0; esc < MAX_NUM_ESCS; esc++) {
+			if (_dynamic_notch_esc_rpm_active & (1 << esc)) {
+				_dynamic_notch_filter_esc_rpm[esc].apply(angular_velocity);
+			}
 		}
+	}
+}
 
-		// reset sample interval accumulator
-		_timestamp_sample_last = 0;
+void VehicleAngularVelocity::ResetDynamicNotch(const Vector3f &angular_velocity)
+{
+	float angular_velocity_array[3] {angular_velocity(0), angular_velocity(1), angular_velocity(2)};
+
+	_dynamic_notch_filter_fft.reset(angular_velocity_array);
+
+	for (int esc = 0; esc < MAX_NUM_ESCS; esc++) {
+		_dynamic_notch_filter_esc_rpm[esc].reset(angular_velocity_array);
+	}
+}
+
+void VehicleAngularVelocity::DynamicNotchEscRpmUpdate(bool force)
+{
+	if (!(_param_imu_gyro_dnf_en.get() & DynamicNotch::EscRpm)) {
+		_dynamic_notch_esc_rpm_active = 0;
+		return;
+	}
+
+	if (_esc_status_sub.updated() || force) {
+		esc_status_s esc_status;
+
+		if (_esc_status_sub.copy(&esc_status) && (hrt_elapsed_time(&esc_status.timestamp) < 1_s)) {
+
+			// With a fixed bandwidth the notch coefficients only differ in b1 = a1 = -2 cos(w) / (1 + alpha)
+			// (see NotchFilter::setParameters()), so a retune costs a single cosf() per ESC, and the
+			// harmonics follow from the recurrence cos((k+1) w) = 2 cos(w) cos(k w) - cos((k-1) w).
+			const float alpha = tanf(M_PI_F * _param_imu_gyro_dnf_bw.get() / _filter_sample_rate);
+			const float a0_inv = 1.f / (alpha + 1.f);
+			const float b0 = a0_inv;
+			const float a2 = (1.f - alpha) * a0_inv;
+
+			const int num_harmonics = math::constrain(_param_imu_gyro_dnf_hmc.get(), 1, MAX_NUM_ESC_RPM_HARMONICS);
+			const float nyquist_freq = _filter_sample_rate / 2.f;
+
+			const uint8_t active_prev = _dynamic_notch_esc_rpm_active;
+			_dynamic_notch_esc_rpm_active = 0;
+
+			for (int esc = 0; esc < math::min((int)esc_status.esc_count, MAX_NUM_ESCS); esc++) {
+				const float esc_freq_hz = abs(esc_status.esc[esc].esc_rpm) / 60.f;
+
+				if (!(esc_status.esc_online_flags & (1 << esc)) || (esc_freq_hz < _param_imu_gyro_dnf_min.get())
+				    || (esc_freq_hz >= nyquist_freq)) {
+					continue;
+				}
+
+				math::BiquadFilterBank<3, MAX_NUM_ESC_RPM_HARMONICS> &filter = _dynamic_notch_filter_esc_rpm[esc];
+
+				const float cos_w = cosf(2.f * M_PI_F * esc_freq_hz / _filter_sample_rate);
+				float cos_kw = cos_w;
+				float cos_kw_prev = 1.f;
+
+				for (int harmonic = 0; harmonic < MAX_NUM_ESC_RPM_HARMONICS; harmonic++) {
+					if ((harmonic < num_harmonics) && (esc_freq_hz * (harmonic + 1) < nyquist_freq)) {
+						const float b1 = -2.f * cos_kw * a0_inv;
+
+						for (int axis = 0; axis < 3; axis++) {
+							filter.setCoefficients(harmonic, axis, b0, b1, b0, b1, a2);
+						}
+
+					} else {
+						filter.setPassThrough(harmonic);
+					}
+
+					const float cos_kw_next = 2.f * cos_w * cos_kw - cos_kw_prev;
+					cos_kw_prev = cos_kw;
+					cos_kw = cos_kw_next;
+				}
+
+				if (!(active_prev & (1 << esc))) {
+					// the filter state is stale while the filters aren't applied
+					float angular_velocity[3] {_angular_velocity_prev(0), _angular_velocity_prev(1), _angular_velocity_prev(2)};
+					filter.reset(angular_velocity);
+				}
+
+				_dynamic_notch_esc_rpm_active |= (1 << esc);
+			}
+
+			_dynamic_notch_esc_rpm_timestamp = esc_status.timestamp;
+		}
+	}
+
+	// disable the notches if the ESC telemetry stops updating
+	if ((_dynamic_notch_esc_rpm_active != 0) && (hrt_elapsed_time(&_dynamic_notch_esc_rpm_timestamp) > 1_s)) {
+		_dynamic_notch_esc_rpm_active = 0;
+	}
+}
+
+void VehicleAngularVelocity::DynamicNotchFFTUpdate(bool force)
+{
+	if (!_fifo_available || !(_param_imu_gyro_dnf_en.get() & DynamicNotch::FFT)) {
+		if (_dynamic_notch_fft_active) {
+			DynamicNotchFFTDisable();
+		}
+
+		return;
+	}
+
+	if (_sensor_gyro_fft_sub.updated() || force) {
+		sensor_gyro_fft_s sensor_gyro_fft;
+
+		// the FFT runs on the same raw FIFO samples (units, frame and rate) as the filters here
+		if (_sensor_gyro_fft_sub.copy(&sensor_gyro_fft) && (sensor_gyro_fft.device_id == _selected_sensor_device_id)
+		    && (hrt_elapsed_time(&sensor_gyro_fft.timestamp) < 1_s)) {
+
+			const float *peak_frequencies[3] {
+				sensor_gyro_fft.peak_frequencies_x,
+				sensor_gyro_fft.peak_frequencies_y,
+				sensor_gyro_fft.peak_frequencies_z
+			};
+
+			for (int axis = 0; axis < 3; axis++) {
+				for (int peak = 0; peak < MAX_NUM_FFT_PEAKS; peak++) {
+					const float peak_freq = peak_frequencies[axis][peak];
+
+					// a frequency of 0 disables the notch (unused peak)
+					_dynamic_notch_filter_fft.setNotch(peak, axis, _filter_sample_rate,
+									   PX4_ISFINITE(peak_freq) ? peak_freq : 0.f, _param_imu_gyro_dnf_bw.get());
+				}
+			}
+
+			if (!_dynamic_notch_fft_active) {
+				// the filter state is stale while the filters aren't applied
+				float angular_velocity[3] {_angular_velocity_prev(0), _angular_velocity_prev(1), _angular_velocity_prev(2)};
+				_dynamic_notch_filter_fft.reset(angular_velocity);
+			}
+
+			_dynamic_notch_fft_timestamp = sensor_gyro_fft.timestamp;
+			_dynamic_notch_fft_active = true;
+
+		} else if (force && _dynamic_notch_fft_active) {
+			// no matching FFT for the selected sensor
+			DynamicNotchFFTDisable();
+		}
+	}
+
+	// disable the notches if the FFT stops updating
+	if (_dynamic_notch_fft_active && (hrt_elapsed_time(&_dynamic_notch_fft_timestamp) > 1_s)) {
+		DynamicNotchFFTDisable();
+	}
+}
+
+void VehicleAngularVelocity::DynamicNotchFFTDisable()
+{
+	for (int peak = 0; peak < MAX_NUM_FFT_PEAKS; peak++) {
+		_dynamic_notch_filter_fft.setPassThrough(peak);
 	}
+
+	_dynamic_notch_fft_active = false;
 }
 
 void VehicleAngularVelocity::SensorBiasUpdate(bool force)
@@ -193,8 +374,32 @@ bool VehicleAngularVelocity::SensorSelectionUpdate(bool force)
 
 				if ((sensor_gyro_sub.get().device_id != 0) && (sensor_gyro_sub.get().device_id == sensor_selection.gyro_device_id)) {
 
-					if (_sensor_sub.ChangeInstance(i) && _sensor_sub.registerCallback()) {
-						PX4_DEBUG("selected sensor changed %d -> %d", _selected_sensor_sub_index, i);
+					if (!_sensor_sub.ChangeInstance(i)) {
+						continue;
+					}
+
+					// filter the full rate FIFO data of the same sensor if it's available
+					_fifo_available = false;
+
+					for (uint8_t j = 0; j < MAX_SENSOR_COUNT; j++) {
+						uORB::SubscriptionData<sensor_gyro_fifo_s> sensor_gyro_fifo_sub{ORB_ID(sensor_gyro_fifo), j};
+
+						if ((sensor_gyro_fifo_sub.get().device_id == sensor_selection.gyro_device_id)
+						    && _sensor_fifo_sub.ChangeInstance(j) && _sensor_fifo_sub.registerCallback()) {
+
+							_sensor_sub.unregisterCallback();
+							_fifo_rotation = get_rot_matrix(static_cast<Rotation>(sensor_gyro_fifo_sub.get().rotation));
+							_fifo_available = true;
+							break;
+						}
+					}
+
+					if (!_fifo_available) {
+						_sensor_fifo_sub.unregisterCallback();
+					}
+
+					if (_fifo_available || _sensor_sub.registerCallback()) {
+						PX4_DEBUG("selected sensor changed %d -> %d%s", _selected_sensor_sub_index, i, _fifo_available ? " (FIFO)" : "");
 
 						// record selected sensor (array index)
 						_selected_sensor_sub_index = i;
@@ -209,6 +414,9 @@ bool VehicleAngularVelocity::SensorSelectionUpdate(bool force)
 						_timestamp_sample_last = 0;
 						_required_sample_updates = 0;
 
+						// filter input changed (units and frame differ in FIFO mode)
+						_reset_filters = true;
+
 						return true;
 					}
 				}
@@ -249,6 +457,19 @@ void VehicleAngularVelocity::Run()
 	SensorBiasUpdate(selection_updated);
 	ParametersUpdate();
 
+	DynamicNotchEscRpmUpdate();
+
+	if (_fifo_available) {
+		DynamicNotchFFTUpdate();
+		UpdateSensorGyroFifo();
+
+	} else {
+		UpdateSensorGyro();
+	}
+}
+
+void VehicleAngularVelocity::UpdateSensorGyro()
+{
 	// process all outstanding messages
 	sensor_gyro_s sensor_data;
 
@@ -276,12 +497,20 @@ void VehicleAngularVelocity::Run()
 		// correct for in-run bias errors
 		const Vector3f angular_velocity_raw = _calibration.Correct(val) - _bias;
 
+		if (_reset_filters) {
+			ResetFilters(angular_velocity_raw, Vector3f{});
+		}
+
 		// Gyro filtering:
+		// - Apply dynamic notch filters (IMU_GYRO_DNF_EN)
 		// - Apply general notch filter (IMU_GYRO_NF_FREQ)
 		// - Apply general low-pass filter (IMU_GYRO_CUTOFF)
 		// - Differentiate & apply specific angular acceleration (D-term) low-pass (IMU_DGYRO_CUTOFF)
 
-		const Vector3f angular_velocity_notched{_notch_filter_velocity.apply(angular_velocity_raw)};
+		float angular_velocity_dynamic_notched[3] {angular_velocity_raw(0), angular_velocity_raw(1), angular_velocity_raw(2)};
+		ApplyDynamicNotch(angular_velocity_dynamic_notched);
+
+		const Vector3f angular_velocity_notched{_notch_filter_velocity.apply(Vector3f{angular_velocity_dynamic_notched})};
 
 		const Vector3f angular_velocity{_lp_filter_velocity.apply(angular_velocity_notched)};
 
@@ -294,44 +523,140 @@ void VehicleAngularVelocity::Run()
 
 		// publish once all new samples are processed
 		if (!_sensor_sub.updated()) {
-			bool publish = true;
+			if (Publish(sensor_data.timestamp_sample, angular_velocity, angular_acceleration)) {
+				return;
+			}
+		}
+	}
+}
 
-			if (_param_imu_gyro_rate_max.get() > 0) {
-				const uint64_t interval = 1e6f / _param_imu_gyro_rate_max.get();
+void VehicleAngularVelocity::UpdateSensorGyroFifo()
+{
+	// process all outstanding messages
+	sensor_gyro_fifo_s sensor_fifo_data;
 
-				if (hrt_elapsed_time(&_last_publish) < interval) {
-					publish = false;
-				}
-			}
+	static constexpr int FIFO_SIZE_MAX = sizeof(sensor_gyro_fifo_s::x) / sizeof(sensor_gyro_fifo_s::x[0]);
+
+	while (_sensor_fifo_sub.update(&sensor_fifo_data)) {
+
+		const int N = math::min((int)sensor_fifo_data.samples, FIFO_SIZE_MAX);
+
+		if ((N < 1) || !(sensor_fifo_data.dt > 0.f)) {
+			continue;
+		}
+
+		// restart the sample interval average if messages were missed
+		if (_sensor_fifo_sub.get_last_generation() != _fifo_last_generation + 1) {
+			_timestamp_sample_last = 0;
+		}
+
+		_fifo_last_generation = _sensor_fifo_sub.get_last_generation();
+
+		// collect sample interval average for filters
+		if ((_timestamp_sample_last > 0) && (sensor_fifo_data.timestamp_sample > _timestamp_sample_last)) {
+			_interval_sum += (sensor_fifo_data.timestamp_sample - _timestamp_sample_last);
+			_interval_count += N;
+
+		} else {
+			_interval_sum = 0.f;
+			_interval_count = 0.f;
+		}
+
+		_timestamp_sample_last = sensor_fifo_data.timestamp_sample;
+
+		if (_reset_filters) {
+			// start at the nominal sensor rate, CheckFilters() corrects it once the actual rate is known
+			_update_rate_hz = 1e6f / sensor_fifo_data.dt;
+			_filter_sample_rate = _update_rate_hz;
+			ResetFilters(Vector3f{sensor_fifo_data.x[0], sensor_fifo_data.y[0], sensor_fifo_data.z[0]}, Vector3f{});
+		}
+
+		// Gyro filtering of every sample in raw sensor units (before rotation, scaling and corrections,
+		// which are linear and applied only to the published result). All three axes are processed
+		// per sample as independent filter chains.
+		// - Apply dynamic notch filters (IMU_GYRO_DNF_EN)
+		// - Apply general notch filter (IMU_GYRO_NF_FREQ)
+		// - Apply general low-pass filter (IMU_GYRO_CUTOFF)
+		// - Differentiate & apply specific angular acceleration (D-term) low-pass (IMU_DGYRO_CUTOFF)
+		Vector3f angular_velocity;
+		Vector3f angular_acceleration;
+
+		for (int n = 0; n < N; n++) {
+			float angular_velocity_raw[3] {sensor_fifo_data.x[n], sensor_fifo_data.y[n], sensor_fifo_data.z[n]};
+
+			ApplyDynamicNotch(angular_velocity_raw);
+
+			const Vector3f angular_velocity_notched{_notch_filter_velocity.apply(Vector3f{angular_velocity_raw})};
+
+			angular_velocity = _lp_filter_velocity.apply(angular_velocity_notched);
+
+			const Vector3f angular_acceleration_raw = (angular_velocity - _angular_velocity_prev) * _filter_sample_rate;
+			_angular_velocity_prev = angular_velocity;
+			_angular_acceleration_prev = angular_acceleration_raw;
+			angular_acceleration = _lp_filter_acceleration.apply(angular_acceleration_raw);
+		}
+
+		CheckFilters();
 
-			if (publish) {
-				// Publish vehicle_angular_acceleration
-				vehicle_angular_acceleration_s v_angular_acceleration;
-				v_angular_acceleration.timestamp_sample = sensor_data.timestamp_sample;
-				angular_acceleration.copyTo(v_angular_acceleration.xyz);
-				v_angular_acceleration.timestamp = hrt_absolute_time();
-				_vehicle_angular_acceleration_pub.publish(v_angular_acceleration);
-
-				// Publish vehicle_angular_velocity
-				vehicle_angular_velocity_s v_angular_velocity;
-				v_angular_velocity.timestamp_sample = sensor_data.timestamp_sample;
-				angular_velocity.copyTo(v_angular_velocity.xyz);
-				v_angular_velocity.timestamp = hrt_absolute_time();
-				_vehicle_angular_velocity_pub.publish(v_angular_velocity);
-
-				_last_publish = v_angular_velocity.timestamp_sample;
+		// publish once all new samples are processed
+		if (!_sensor_fifo_sub.updated()) {
+			// rotate and scale into the sensor frame (as PX4Gyroscope does), then apply calibration and bias
+			const Vector3f angular_velocity_sensor{_fifo_rotation * (angular_velocity * sensor_fifo_data.scale)};
+			const Vector3f angular_acceleration_sensor{_fifo_rotation * (angular_acceleration * sensor_fifo_data.scale)};
+
+			if (Publish(sensor_fifo_data.timestamp_sample,
+				    _calibration.Correct(angular_velocity_sensor) - _bias,
+				    _calibration.rotation() * angular_acceleration_sensor)) {
 				return;
 			}
 		}
 	}
 }
 
+bool VehicleAngularVelocity::Publish(const hrt_abstime &timestamp_sample, const Vector3f &angular_velocity,
+				     const Vector3f &angular_acceleration)
+{
+	if (_param_imu_gyro_rate_max.get() > 0) {
+		const uint64_t interval = 1e6f / _param_imu_gyro_rate_max.get();
+
+		if (hrt_elapsed_time(&_last_publish) < interval) {
+			return false;
+		}
+	}
+
+	// Publish vehicle_angular_acceleration
+	vehicle_angular_acceleration_s v_angular_acceleration;
+	v_angular_acceleration.timestamp_sample = timestamp_sample;
+	angular_acceleration.copyTo(v_angular_acceleration.xyz);
+	v_angular_acceleration.timestamp = hrt_absolute_time();
+	_vehicle_angular_acceleration_pub.publish(v_angular_acceleration);
+
+	// Publish vehicle_angular_velocity
+	vehicle_angular_velocity_s v_angular_velocity;
+	v_angular_velocity.timestamp_sample = timestamp_sample;
+	angular_velocity.copyTo(v_angular_velocity.xyz);
+	v_angular_velocity.timestamp = hrt_absolute_time();
+	_vehicle_angular_velocity_pub.publish(v_angular_velocity);
+
+	_last_publish = v_angular_velocity.timestamp_sample;
+
+	return true;
+}
+
 void VehicleAngularVelocity::PrintStatus()
 {
-	PX4_INFO("selected sensor: %d (%d), rate: %.1f Hz",
-		 _selected_sensor_device_id, _selected_sensor_sub_index, (double)_update_rate_hz);
+	PX4_INFO("selected sensor: %d (%d), rate: %.1f Hz%s",
+		 _selected_sensor_device_id, _selected_sensor_sub_index, (double)_update_rate_hz, _fifo_available ? " (FIFO)" : "");
 	PX4_INFO("estimated bias: [%.4f %.4f %.4f]", (double)_bias(0), (double)_bias(1), (double)_bias(2));
 
+	if (_dynamic_notch_fft_active) {
+		PX4_INFO("dynamic notch filters (FFT) active");
+	}
+
+	if (_dynamic_notch_esc_rpm_active != 0) {
+		PX4_INFO("dynamic notch filters (ESC RPM) active, ESC mask: 0x%02x", _dynamic_notch_esc_rpm_active);
+	}
+
 	_calibration.PrintStatus();
 }
 
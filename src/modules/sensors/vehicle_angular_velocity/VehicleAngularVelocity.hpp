@@ -33,9 +33,11 @@
 
 #pragma once
 
+#include <lib/conversion/rotation.h>
 #include <lib/sensor_calibration/Gyroscope.hpp>
 #include <lib/mathlib/math/Limits.hpp>
 #include <lib/matrix/matrix/math.hpp>
+#include <lib/mathlib/math/filter/BiquadFilterBank.hpp>
 #include <lib/mathlib/math/filter/LowPassFilter2pVector3f.hpp>
 #include <lib/mathlib/math/filter/NotchFilter.hpp>
 #include <px4_platform_common/log.h>
@@ -45,10 +47,13 @@
 #include <uORB/Publication.hpp>
 #include <uORB/Subscription.hpp>
 #include <uORB/SubscriptionCallback.hpp>
+#include <uORB/topics/esc_status.h>
 #include <uORB/topics/estimator_selector_status.h>
 #include <uORB/topics/estimator_sensor_bias.h>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_gyro_fft.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
 #include <uORB/topics/sensor_selection.h>
 #include <uORB/topics/vehicle_angular_acceleration.h>
 #include <uORB/topics/vehicle_angular_velocity.h>
@@ -71,26 +76,55 @@ private:
 	void Run() override;
 
 	void CheckFilters();
+	void ResetFilters(const matrix::Vector3f &angular_velocity, const matrix::Vector3f &angular_acceleration);
+	bool Publish(const hrt_abstime &timestamp_sample, const matrix::Vector3f &angular_velocity,
+		     const matrix::Vector3f &angular_acceleration);
+
+	void UpdateSensorGyro();
+	void UpdateSensorGyroFifo();
+
+	void ApplyDynamicNotch(float angular_velocity[3]);
+	void ResetDynamicNotch(const matrix::Vector3f &angular_velocity);
+
+	void DynamicNotchEscRpmUpdate(bool force = false);
+	void DynamicNotchFFTUpdate(bool force = false);
+	void DynamicNotchFFTDisable();
+
 	void ParametersUpdate(bool force = false);
 	void SensorBiasUpdate(bool force = false);
 	bool SensorSelectionUpdate(bool force = false);
 
 	static constexpr int MAX_SENSOR_COUNT = 4;
 
+	static constexpr int MAX_NUM_FFT_PEAKS = sizeof(sensor_gyro_fft_s::peak_frequencies_x) / sizeof(
+				sensor_gyro_fft_s::peak_frequencies_x[0]);
+
+	static constexpr int MAX_NUM_ESCS = esc_status_s::CONNECTED_ESC_MAX;
+	static constexpr int MAX_NUM_ESC_RPM_HARMONICS = 3;
+
+	enum DynamicNotch {
+		FFT    = 1,
+		EscRpm = 2,
+	};
+
 	uORB::Publication<vehicle_angular_acceleration_s> _vehicle_angular_acceleration_pub{ORB_ID(vehicle_angular_acceleration)};
 	uORB::Publication<vehicle_angular_velocity_s> _vehicle_angular_velocity_pub{ORB_ID(vehicle_angular_velocity)};
 
+	uORB::Subscription _esc_status_sub{ORB_ID(esc_status)};
 	uORB::Subscription _estimator_selector_status_sub{ORB_ID(estimator_selector_status)};
 	uORB::Subscription _estimator_sensor_bias_sub{ORB_ID(estimator_sensor_bias)};
 	uORB::Subscription _params_sub{ORB_ID(parameter_update)};
+	uORB::Subscription _sensor_gyro_fft_sub{ORB_ID(sensor_gyro_fft)};
 
 	uORB::SubscriptionCallbackWorkItem _sensor_selection_sub{this, ORB_ID(sensor_selection)};
 	uORB::SubscriptionCallbackWorkItem _sensor_sub{this, ORB_ID(sensor_gyro)};
+	uORB::SubscriptionCallbackWorkItem _sensor_fifo_sub{this, ORB_ID(sensor_gyro_fifo)};
 
 	calibration::Gyroscope _calibration{};
 
 	matrix::Vector3f _bias{0.f, 0.f, 0.f};
 
+	// filter state, in raw sensor units and frame in FIFO mode
 	matrix::Vector3f _angular_acceleration_prev{0.f, 0.f, 0.f};
 	matrix::Vector3f _angular_velocity_prev{0.f, 0.f, 0.f};
 	hrt_abstime _timestamp_sample_prev{0};
@@ -105,10 +139,26 @@ private:
 	math::LowPassFilter2pVector3f _lp_filter_velocity{kInitialRateHz, 30.0f};
 	math::NotchFilter<matrix::Vector3f> _notch_filter_velocity{};
 
+	// dynamic notch filters (FIFO mode only), tuned at runtime to the peaks tracked by gyro_fft
+	math::BiquadFilterBank<3, MAX_NUM_FFT_PEAKS> _dynamic_notch_filter_fft{};
+	hrt_abstime _dynamic_notch_fft_timestamp{0};
+	bool _dynamic_notch_fft_active{false};
+
+	// dynamic notch filters at the rotor frequency (and harmonics) of each ESC, updated from esc_status
+	math::BiquadFilterBank<3, MAX_NUM_ESC_RPM_HARMONICS> _dynamic_notch_filter_esc_rpm[MAX_NUM_ESCS] {};
+	hrt_abstime _dynamic_notch_esc_rpm_timestamp{0};
+	uint8_t _dynamic_notch_esc_rpm_active{0}; ///< bitmask of ESCs with active notch filters
+
 	// angular acceleration filter
 	math::LowPassFilter2pVector3f _lp_filter_acceleration{kInitialRateHz, 30.0f};
 
 	float _filter_sample_rate{kInitialRateHz};
+	bool _reset_filters{true}; /**< reset filters with the next sample (filter input changed) */
+
+	// FIFO mode: filter every raw sample of sensor_gyro_fifo instead of the (integrated) sensor_gyro
+	bool _fifo_available{false};
+	unsigned _fifo_last_generation{0};
+	matrix::Dcmf _fifo_rotation{};
 
 	uint32_t _selected_sensor_device_id{0};
 	uint8_t _selected_sensor_sub_index{0};
@@ -122,6 +172,10 @@ private:
 		(ParamFloat<px4::params::IMU_GYRO_NF_FREQ>) _param_imu_gyro_nf_freq,
 		(ParamFloat<px4::params::IMU_GYRO_NF_BW>) _param_imu_gyro_nf_bw,
 		(ParamInt<px4::params::IMU_GYRO_RATEMAX>) _param_imu_gyro_rate_max,
+		(ParamInt<px4::params::IMU_GYRO_DNF_EN>) _param_imu_gyro_dnf_en,
+		(ParamFloat<px4::params::IMU_GYRO_DNF_BW>) _param_imu_gyro_dnf_bw,
+		(ParamInt<px4::params::IMU_GYRO_DNF_HMC>) _param_imu_gyro_dnf_hmc,
+		(ParamFloat<px4::params::IMU_GYRO_DNF_MIN>) _param_imu_gyro_dnf_min,
 
 		(ParamFloat<px4::params::IMU_DGYRO_CUTOFF>) _param_imu_dgyro_cutoff
 	)
@@ -65,6 +65,59 @@ PARAM_DEFINE_FLOAT(IMU_GYRO_NF_FREQ, 0.0f);
 */
 PARAM_DEFINE_FLOAT(IMU_GYRO_NF_BW, 20.0f);
 
+/**
+* IMU gyro dynamic notch filtering
+*
+* Enable bank of dynamically updating notch filters.
+* FFT: the notch frequencies follow the vibration peaks found by the gyro_fft module (IMU_GYRO_FFT_EN),
+* requires the full rate gyro FIFO data of the selected gyro.
+* ESC RPM: one notch filter per ESC and harmonic (IMU_GYRO_DNF_HMC) at the rotor frequency reported
+* in the ESC telemetry (esc_status).
+* Applies to both angular velocity and angular acceleration sent to the controllers.
+*
+* @min 0
+* @max 3
+* @bit 0 FFT
+* @bit 1 ESC RPM
+* @group Sensors
+*/
+PARAM_DEFINE_INT32(IMU_GYRO_DNF_EN, 0);
+
+/**
+* IMU gyro dynamic notch bandwidth
+*
+* The frequency width of the stop band of each dynamic notch filter (see IMU_GYRO_DNF_EN).
+*
+* @min 5
+* @max 100
+* @unit Hz
+* @group Sensors
+*/
+PARAM_DEFINE_FLOAT(IMU_GYRO_DNF_BW, 15.0f);
+
+/**
+* IMU gyro ESC notch filter harmonics
+*
+* ESC RPM number of harmonics (multiples of the ESC frequency) to filter (see IMU_GYRO_DNF_EN).
+*
+* @min 1
+* @max 3
+* @group Sensors
+*/
+PARAM_DEFINE_INT32(IMU_GYRO_DNF_HMC, 3);
+
+/**
+* IMU gyro ESC notch filter minimum frequency
+*
+* Minimum rotor frequency for the ESC RPM notch filters of an ESC to be active (see IMU_GYRO_DNF_EN).
+*
+* @min 0
+* @max 1000
+* @unit Hz
+* @group Sensors
+*/
+PARAM_DEFINE_FLOAT(IMU_GYRO_DNF_MIN, 25.0f);
+
 /**
 * Low pass filter cutoff frequency for gyro
 *
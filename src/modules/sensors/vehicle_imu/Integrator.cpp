@@ -73,6 +73,115 @@ bool Integrator::put(const hrt_abstime &timestamp, const Vector3f &val)
 	return true;
 }
 
+bool Integrator::put(const hrt_abstime &timestamp, const int16_t x[], const int16_t y[], const int16_t z[],
+		     int samples, float dt, float scale)
+{
+	if ((samples < 1) || (samples > BLOCK_SIZE_MAX) || !(dt > 0.f)) {
+		return false;
+	}
+
+	const int N = samples;
+
+	if ((_last_integration_time == 0) || (timestamp <= _last_integration_time)) {
+		/* this is the first item in the integrator */
+		_last_integration_time = timestamp;
+		_last_reset_time = timestamp;
+		_last_val = Vector3f{(float)x[N - 1], (float)y[N - 1], (float)z[N - 1]} * scale;
+
+		return false;
+	}
+
+	// use the actual sample interval if it's consistent with the nominal one, otherwise (e.g. after a gap)
+	// the first interval spans the time since the last sample, like individual put() calls
+	float interval_first_us = dt;
+	float interval_us = dt;
+
+	const float block_interval_us = static_cast<float>(timestamp - _last_integration_time) / N;
+
+	if (fabsf(block_interval_us - dt) < 0.1f * dt) {
+		interval_first_us = block_interval_us;
+		interval_us = block_interval_us;
+
+	} else {
+		const float gap_us = static_cast<float>(timestamp - _last_integration_time) - (N - 1) * dt;
+
+		if (gap_us > 0.f) {
+			interval_first_us = gap_us;
+		}
+	}
+
+	// trapezoidal delta integral of every sample interval
+	float delta_x[BLOCK_SIZE_MAX];
+	float delta_y[BLOCK_SIZE_MAX];
+	float delta_z[BLOCK_SIZE_MAX];
+
+	const float first = interval_first_us * 1e-6f * 0.5f;
+	delta_x[0] = (_last_val(0) + x[0] * scale) * first;
+	delta_y[0] = (_last_val(1) + y[0] * scale) * first;
+	delta_z[0] = (_last_val(2) + z[0] * scale) * first;
+
+	const float k = interval_us * 1e-6f * 0.5f * scale;
+
+	for (int n = 1; n < N; n++) {
+		delta_x[n] = (x[n - 1] + x[n]) * k;
+		delta_y[n] = (y[n - 1] + y[n]) * k;
+		delta_z[n] = (z[n - 1] + z[n]) * k;
+	}
+
+	if (_coning_comp_on) {
+		// same coning corrections as put() for every sample: beta += ((last_alpha + last_delta_alpha / 6) x delta_alpha) / 2,
+		// where last_alpha + last_delta_alpha is the integral before the current sample
+		float alpha_x[BLOCK_SIZE_MAX];
+		float alpha_y[BLOCK_SIZE_MAX];
+		float alpha_z[BLOCK_SIZE_MAX];
+
+		alpha_x[0] = _last_alpha(0) + _last_delta_alpha(0) * (1.f / 6.f);
+		alpha_y[0] = _last_alpha(1) + _last_delta_alpha(1) * (1.f / 6.f);
+		alpha_z[0] = _last_alpha(2) + _last_delta_alpha(2) * (1.f / 6.f);
+
+		Vector3f alpha{_alpha};
+
+		for (int n = 1; n < N; n++) {
+			alpha_x[n] = alpha(0) + delta_x[n - 1] * (1.f / 6.f);
+			alpha_y[n] = alpha(1) + delta_y[n - 1] * (1.f / 6.f);
+			alpha_z[n] = alpha(2) + delta_z[n - 1] * (1.f / 6.f);
+
+			alpha(0) += delta_x[n - 1];
+			alpha(1) += delta_y[n - 1];
+			alpha(2) += delta_z[n - 1];
+		}
+
+		float beta_x = 0.f;
+		float beta_y = 0.f;
+		float beta_z = 0.f;
+
+		for (int n = 0; n < N; n++) {
+			beta_x += alpha_y[n] * delta_z[n] - alpha_z[n] * delta_y[n];
+			beta_y += alpha_z[n] * delta_x[n] - alpha_x[n] * delta_z[n];
+			beta_z += alpha_x[n] * delta_y[n] - alpha_y[n] * delta_x[n];
+		}
+
+		_beta += Vector3f{beta_x, beta_y, beta_z} * 0.5f;
+
+		// state after the last sample
+		_last_alpha = alpha;
+		_last_delta_alpha = Vector3f{delta_x[N - 1], delta_y[N - 1], delta_z[N - 1]};
+	}
+
+	// accumulate delta integrals
+	for (int n = 0; n < N; n++) {
+		_alpha(0) += delta_x[n];
+		_alpha(1) += delta_y[n];
+		_alpha(2) += delta_z[n];
+	}
+
+	_last_val = Vector3f{(float)x[N - 1], (float)y[N - 1], (float)z[N - 1]} * scale;
+	_last_integration_time = timestamp;
+	_integrated_samples += N;
+
+	return true;
+}
+
 bool Integrator::reset(Vector3f &integral, uint32_t &integral_dt)
 {
 	if (integral_ready()) {
@@ -75,6 +75,25 @@ public:
 		return put(timestamp, val) && reset(integral, integral_dt);
 	}
 
+	/**
+	 * Put a block of equally spaced raw samples (e.g. a sensor FIFO read) into the integral.
+	 * The trapezoidal integration and coning corrections of the whole block are calculated in
+	 * a single pass over the sample arrays.
+	 *
+	 * @param timestamp	Timestamp of the last sample.
+	 * @param x		Samples x axis.
+	 * @param y		Samples y axis.
+	 * @param z		Samples z axis.
+	 * @param samples	Number of samples (1 - BLOCK_SIZE_MAX).
+	 * @param dt		Nominal time between samples in us.
+	 * @param scale		Scale of the raw samples.
+	 * @return		true if data was accepted and integrated.
+	 */
+	bool put(const uint64_t &timestamp, const int16_t x[], const int16_t y[], const int16_t z[], int samples, float dt,
+		 float scale);
+
+	static constexpr int BLOCK_SIZE_MAX = 32;
+
 	/**
 	 * Set reset interval during runtime. This won't reset the integrator.
 	 *
@@ -87,8 +106,8 @@ public:
 	 *
 	 * @param reset_samples	    	New reset time interval for the integrator.
 	 */
-	void set_reset_samples(uint8_t reset_samples) { _reset_samples_min = reset_samples; }
-	uint8_t get_reset_samples() const { return _reset_samples_min; }
+	void set_reset_samples(uint16_t reset_samples) { _reset_samples_min = reset_samples; }
+	uint16_t get_reset_samples() const { return _reset_samples_min; }
 
 	/**
 	 * Is the Integrator ready to reset?
@@ -116,8 +135,8 @@ private:
 
 	uint32_t _reset_interval_min{1}; /**< the interval after which the content will be published and the integrator reset */
 
-	uint8_t _integrated_samples{0};
-	uint8_t _reset_samples_min{1};
+	uint16_t _integrated_samples{0};
+	uint16_t _reset_samples_min{1};
 
 	const bool _coning_comp_on{false};                       /**< true to turn on coning corrections */
 };
@@ -0,0 +1,213 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include "Integrator.hpp"
+
+using matrix::Vector3f;
+
+static constexpr float SCALE = 0.001f;   // rad/s per LSB
+static constexpr float DT_US = 125.f;    // 8 kHz FIFO
+
+// coning motion: rotation about z with an oscillating x/y rate
+static int16_t sample(int axis, int n)
+{
+	const float t = n * DT_US * 1e-6f;
+
+	switch (axis) {
+	case 0: return (int16_t)(2000.f * sinf(2.f * M_PI_F * 37.f * t));
+
+	case 1: return (int16_t)(2000.f * cosf(2.f * M_PI_F * 37.f * t));
+
+	default: return (int16_t)(500.f + 300.f * sinf(2.f * M_PI_F * 11.f * t));
+	}
+}
+
+// feeds blocks of FIFO samples through both put() variants and compares every published integral
+static void compare(bool coning, int block_size, uint64_t gap_us = 0)
+{
+	Integrator single{coning};
+	Integrator block{coning};
+	single.set_reset_interval(UINT32_MAX);
+	block.set_reset_interval(UINT32_MAX);
+	single.set_reset_samples(block_size * 2);
+	block.set_reset_samples(block_size * 2);
+
+	int16_t x[Integrator::BLOCK_SIZE_MAX];
+	int16_t y[Integrator::BLOCK_SIZE_MAX];
+	int16_t z[Integrator::BLOCK_SIZE_MAX];
+
+	// first sample only initializes the integrators
+	const uint64_t t0 = 1'000'000;
+	x[0] = sample(0, 0);
+	y[0] = sample(1, 0);
+	z[0] = sample(2, 0);
+	EXPECT_FALSE(single.put(t0, Vector3f{(float)x[0], (float)y[0], (float)z[0]} * SCALE));
+	EXPECT_FALSE(block.put(t0, x, y, z, 1, DT_US, SCALE));
+
+	int published = 0;
+	int n_total = 1;
+	uint64_t offset_us = 0;
+
+	for (int b = 0; b < 40; b++) {
+		if (b == 20) {
+			offset_us = gap_us;
+		}
+
+		uint64_t timestamp = 0;
+
+		for (int i = 0; i < block_size; i++) {
+			const int n = n_total + i;
+			x[i] = sample(0, n);
+			y[i] = sample(1, n);
+			z[i] = sample(2, n);
+
+			timestamp = t0 + offset_us + (uint64_t)(n * DT_US);
+			single.put(timestamp, Vector3f{(float)x[i], (float)y[i], (float)z[i]} * SCALE);
+		}
+
+		n_total += block_size;
+
+		EXPECT_TRUE(block.put(timestamp, x, y, z, block_size, DT_US, SCALE));
+
+		if (single.integral_ready()) {
+			ASSERT_TRUE(block.integral_ready());
+
+			Vector3f integral_single;
+			Vector3f integral_block;
+			uint32_t dt_single = 0;
+			uint32_t dt_block = 0;
+			ASSERT_TRUE(single.reset(integral_single, dt_single));
+			ASSERT_TRUE(block.reset(integral_block, dt_block));
+
+			EXPECT_EQ(dt_single, dt_block);
+
+			for (int axis = 0; axis < 3; axis++) {
+				EXPECT_NEAR(integral_single(axis), integral_block(axis), 1e-6f) << "axis " << axis << " block " << b;
+			}
+
+			published++;
+		}
+	}
+
+	EXPECT_EQ(published, 20);
+}
+
+TEST(IntegratorTest, BlockDeltaAngle)
+{
+	compare(false, 1);
+	compare(false, 8);
+	compare(false, Integrator::BLOCK_SIZE_MAX);
+}
+
+TEST(IntegratorTest, BlockConing)
+{
+	compare(true, 1);
+	compare(true, 8);
+	compare(true, Integrator::BLOCK_SIZE_MAX);
+}
+
+TEST(IntegratorTest, BlockGap)
+{
+	// a missed FIFO read, the first interval of the next block spans the gap
+	compare(false, 8, 3000);
+	compare(true, 8, 3000);
+}
+
+TEST(IntegratorTest, BlockConingTerm)
+{
+	// the coning correction alone (integral with minus without compensation) must match as well
+	Integrator single{true};
+	Integrator single_off{false};
+	Integrator block{true};
+	Integrator block_off{false};
+
+	Integrator *integrators[] {&single, &single_off, &block, &block_off};
+
+	for (auto integrator : integrators) {
+		integrator->set_reset_interval(UINT32_MAX);
+		integrator->set_reset_samples(64);
+	}
+
+	int16_t x[Integrator::BLOCK_SIZE_MAX];
+	int16_t y[Integrator::BLOCK_SIZE_MAX];
+	int16_t z[Integrator::BLOCK_SIZE_MAX];
+
+	const uint64_t t0 = 1'000'000;
+	x[0] = sample(0, 0);
+	y[0] = sample(1, 0);
+	z[0] = sample(2, 0);
+
+	for (int k = 0; k < 2; k++) {
+		integrators[k]->put(t0, Vector3f{(float)x[0], (float)y[0], (float)z[0]} * SCALE);
+		integrators[k + 2]->put(t0, x, y, z, 1, DT_US, SCALE);
+	}
+
+	uint64_t timestamp = 0;
+
+	for (int b = 0; b < 2; b++) {
+		for (int i = 0; i < Integrator::BLOCK_SIZE_MAX; i++) {
+			const int n = 1 + b * Integrator::BLOCK_SIZE_MAX + i;
+			x[i] = sample(0, n);
+			y[i] = sample(1, n);
+			z[i] = sample(2, n);
+			timestamp = t0 + (uint64_t)(n * DT_US);
+
+			single.put(timestamp, Vector3f{(float)x[i], (float)y[i], (float)z[i]} * SCALE);
+			single_off.put(timestamp, Vector3f{(float)x[i], (float)y[i], (float)z[i]} * SCALE);
+		}
+
+		block.put(timestamp, x, y, z, Integrator::BLOCK_SIZE_MAX, DT_US, SCALE);
+		block_off.put(timestamp, x, y, z, Integrator::BLOCK_SIZE_MAX, DT_US, SCALE);
+	}
+
+	Vector3f integral[4];
+	uint32_t integral_dt = 0;
+
+	for (int k = 0; k < 4; k++) {
+		ASSERT_TRUE(integrators[k]->reset(integral[k], integral_dt));
+	}
+
+	const Vector3f coning_single = integral[0] - integral[1];
+	const Vector3f coning_block = integral[2] - integral[3];
+
+	// coning motion produces a non-zero correction
+	EXPECT_GT(coning_single.norm(), 1e-7f);
+
+	for (int axis = 0; axis < 3; axis++) {
+		EXPECT_NEAR(coning_single(axis), coning_block(axis), 1e-8f) << "axis " << axis;
+	}
+}
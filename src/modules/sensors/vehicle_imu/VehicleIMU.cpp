@@ -93,8 +93,18 @@ bool VehicleIMU::Start()
 	// force initial updates
 	ParametersUpdate(true);
 
-	_sensor_gyro_sub.registerCallback();
-	_sensor_accel_sub.registerCallback();
+	// integrate the full rate FIFO data if both drivers publish it
+	_fifo_available = SelectFifo();
+
+	if (_fifo_available) {
+		// the gyro sets the scheduling
+		_sensor_gyro_fifo_sub.registerCallback();
+
+	} else {
+		_sensor_gyro_sub.registerCallback();
+		_sensor_accel_sub.registerCallback();
+	}
+
 	ScheduleNow();
 	return true;
 }
@@ -104,10 +114,49 @@ void VehicleIMU::Stop()
 	// clear all registered callbacks
 	_sensor_accel_sub.unregisterCallback();
 	_sensor_gyro_sub.unregisterCallback();
+	_sensor_gyro_fifo_sub.unregisterCallback();
 
 	Deinit();
 }
 
+bool VehicleIMU::SelectFifo()
+{
+	uORB::SubscriptionData<sensor_accel_s> sensor_accel_sub{ORB_ID(sensor_accel), _sensor_accel_sub.get_instance()};
+	uORB::SubscriptionData<sensor_gyro_s> sensor_gyro_sub{ORB_ID(sensor_gyro), _sensor_gyro_sub.get_instance()};
+
+	const uint32_t accel_device_id = sensor_accel_sub.get().device_id;
+	const uint32_t gyro_device_id = sensor_gyro_sub.get().device_id;
+
+	if ((accel_device_id == 0) || (gyro_device_id == 0)) {
+		return false;
+	}
+
+	bool accel_fifo_found = false;
+	bool gyro_fifo_found = false;
+
+	for (uint8_t i = 0; i < MAX_SENSOR_COUNT; i++) {
+		if (!accel_fifo_found) {
+			uORB::SubscriptionData<sensor_accel_fifo_s> sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo), i};
+
+			if ((sensor_accel_fifo_sub.get().device_id == accel_device_id) && _sensor_accel_fifo_sub.ChangeInstance(i)) {
+				_accel_fifo_rotation = get_rot_matrix(static_cast<Rotation>(sensor_accel_fifo_sub.get().rotation));
+				accel_fifo_found = true;
+			}
+		}
+
+		if (!gyro_fifo_found) {
+			uORB::SubscriptionData<sensor_gyro_fifo_s> sensor_gyro_fifo_sub{ORB_ID(sensor_gyro_fifo), i};
+
+			if ((sensor_gyro_fifo_sub.get().device_id == gyro_device_id) && _sensor_gyro_fifo_sub.ChangeInstance(i)) {
+				_gyro_fifo_rotation = get_rot_matrix(static_cast<Rotation>(sensor_gyro_fifo_sub.get().rotation));
+				gyro_fifo_found = true;
+			}
+		}
+	}
+
+	return accel_fifo_found && gyro_fifo_found;
+}
+
 void VehicleIMU::ParametersUpdate(bool force)
 {
 	// Check if parameters have changed
@@ -209,125 +258,106 @@ void VehicleIMU::Run()
 	bool update_integrator_config = false;
 	bool publish_status = false;
 
-	// integrate queued gyro
-	sensor_gyro_s gyro;
+	if (_fifo_available) {
+		UpdateFifo(sensor_data_gap, update_integrator_config, publish_status);
 
-	while (_sensor_gyro_sub.update(&gyro)) {
-		perf_count_interval(_gyro_update_perf, gyro.timestamp_sample);
+	} else {
+		// integrate queued gyro
+		sensor_gyro_s gyro;
 
-		if (_sensor_gyro_sub.get_last_generation() != _gyro_last_generation + 1) {
-			sensor_data_gap = true;
-			perf_count(_gyro_generation_gap_perf);
+		while (_sensor_gyro_sub.update(&gyro)) {
+			perf_count_interval(_gyro_update_perf, gyro.timestamp_sample);
 
-			_gyro_interval.timestamp_sample_last = 0; // invalidate any ongoing publication rate averaging
+			if (_sensor_gyro_sub.get_last_generation() != _gyro_last_generation + 1) {
+				sensor_data_gap = true;
+				perf_count(_gyro_generation_gap_perf);
 
-		} else {
-			// collect sample interval average for filters
-			if (!_intervals_configured && UpdateIntervalAverage(_gyro_interval, gyro.timestamp_sample)) {
-				update_integrator_config = true;
-				publish_status = true;
-				_status.gyro_rate_hz = roundf(1e6f / _gyro_interval.update_interval);
+				_gyro_interval.timestamp_sample_last = 0; // invalidate any ongoing publication rate averaging
+
+			} else {
+				// collect sample interval average for filters
+				if (!_intervals_configured && UpdateIntervalAverage(_gyro_interval, gyro.timestamp_sample)) {
+					update_integrator_config = true;
+					publish_status = true;
+					_status.gyro_rate_hz = roundf(1e6f / _gyro_interval.update_interval);
+				}
 			}
-		}
 
-		_gyro_last_generation = _sensor_gyro_sub.get_last_generation();
+			_gyro_last_generation = _sensor_gyro_sub.get_last_generation();
 
-		_gyro_calibration.set_device_id(gyro.device_id);
+			_gyro_calibration.set_device_id(gyro.device_id);
 
-		if (gyro.error_count != _status.gyro_error_count) {
-			publish_status = true;
-			_status.gyro_error_count = gyro.error_count;
-		}
+			if (gyro.error_count != _status.gyro_error_count) {
+				publish_status = true;
+				_status.gyro_error_count = gyro.error_count;
+			}
 
-		const Vector3f gyro_raw{gyro.x, gyro.y, gyro.z};
-		_gyro_sum += gyro_raw;
-		_gyro_temperature += gyro.temperature;
-		_gyro_sum_count++;
+			const Vector3f gyro_raw{gyro.x, gyro.y, gyro.z};
+			_gyro_sum += gyro_raw;
+			_gyro_temperature += gyro.temperature;
+			_gyro_sum_count++;
 
-		_gyro_integrator.put(gyro.timestamp_sample, gyro_raw);
-		_last_timestamp_sample_gyro = gyro.timestamp_sample;
+			_gyro_integrator.put(gyro.timestamp_sample, gyro_raw);
+			_last_timestamp_sample_gyro = gyro.timestamp_sample;
 
-		// break if interval is configured and we haven't fallen behind
-		if (_intervals_configured && _gyro_integrator.integral_ready()
-		    && (hrt_elapsed_time(&gyro.timestamp) < _imu_integration_interval_us) && !sensor_data_gap) {
+			// break if interval is configured and we haven't fallen behind
+			if (_intervals_configured && _gyro_integrator.integral_ready()
+			    && (hrt_elapsed_time(&gyro.timestamp) < _imu_integration_interval_us) && !sensor_data_gap) {
 
-			break;
+				break;
+			}
 		}
-	}
 
-	// update accel, stopping once caught up to the last gyro sample
-	sensor_accel_s accel;
+		// update accel, stopping once caught up to the last gyro sample
+		sensor_accel_s accel;
 
-	while (_sensor_accel_sub.update(&accel)) {
-		perf_count_interval(_accel_update_perf, accel.timestamp_sample);
+		while (_sensor_accel_sub.update(&accel)) {
+			perf_count_interval(_accel_update_perf, accel.timestamp_sample);
 
-		if (_sensor_accel_sub.get_last_generation() != _accel_last_generation + 1) {
-			sensor_data_gap = true;
-			perf_count(_accel_generation_gap_perf);
+			if (_sensor_accel_sub.get_last_generation() != _accel_last_generation + 1) {
+				sensor_data_gap = true;
+				perf_count(_accel_generation_gap_perf);
 
-			_accel_interval.timestamp_sample_last = 0; // invalidate any ongoing publication rate averaging
+				_accel_interval.timestamp_sample_last = 0; // invalidate any ongoing publication rate averaging
 
-		} else {
-			// collect sample interval average for filters
-			if (!_intervals_configured && UpdateIntervalAverage(_accel_interval, accel.timestamp_sample)) {
-				update_integrator_config = true;
-				publish_status = true;
-				_status.accel_rate_hz = roundf(1e6f / _accel_interval.update_interval);
+			} else {
+				// collect sample interval average for filters
+				if (!_intervals_configured && UpdateIntervalAverage(_accel_interval, accel.timestamp_sample)) {
+					update_integrator_config = true;
+					publish_status = true;
+					_status.accel_rate_hz = roundf(1e6f / _accel_interval.update_interval);
+				}
 			}
-		}
-
-		_accel_last_generation = _sensor_accel_sub.get_last_generation();
-
-		_accel_calibration.set_device_id(accel.device_id);
 
-		if (accel.error_count != _status.accel_error_count) {
-			publish_status = true;
-			_status.accel_error_count = accel.error_count;
-		}
-
-		const Vector3f accel_raw{accel.x, accel.y, accel.z};
-		_accel_sum += accel_raw;
-		_accel_temperature += accel.temperature;
-		_accel_sum_count++;
+			_accel_last_generation = _sensor_accel_sub.get_last_generation();
 
-		_accel_integrator.put(accel.timestamp_sample, accel_raw);
-		_last_timestamp_sample_accel = accel.timestamp_sample;
+			_accel_calibration.set_device_id(accel.device_id);
 
-		if (accel.clip_counter[0] > 0 || accel.clip_counter[1] > 0 || accel.clip_counter[2] > 0) {
+			if (accel.error_count != _status.accel_error_count) {
+				publish_status = true;
+				_status.accel_error_count = accel.error_count;
+			}
 
-			// rotate sensor clip counts into vehicle body frame
-			const Vector3f clipping{_accel_calibration.rotation() *
-						Vector3f{(float)accel.clip_counter[0], (float)accel.clip_counter[1], (float)accel.clip_counter[2]}};
+			const Vector3f accel_raw{accel.x, accel.y, accel.z};
+			_accel_sum += accel_raw;
+			_accel_temperature += accel.temperature;
+			_accel_sum_count++;
 
-			// round to get reasonble clip counts per axis (after board rotation)
-			const uint8_t clip_x = roundf(fabsf(clipping(0)));
-			const uint8_t clip_y = roundf(fabsf(clipping(1)));
-			const uint8_t clip_z = roundf(fabsf(clipping(2)));
+			_accel_integrator.put(accel.timestamp_sample, accel_raw);
+			_last_timestamp_sample_accel = accel.timestamp_sample;
 
-			_status.accel_clipping[0] += clip_x;
-			_status.accel_clipping[1] += clip_y;
-			_status.accel_clipping[2] += clip_z;
+			const Vector3f clip_counter{(float)accel.clip_counter[0], (float)accel.clip_counter[1], (float)accel.clip_counter[2]};
 
-			if (clip_x > 0) {
-				_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_X;
+			if (UpdateAccelClipping(clip_counter)) {
+				publish_status = true;
 			}
 
-			if (clip_y > 0) {
-				_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Y;
-			}
+			// break once caught up to gyro
+			if (!sensor_data_gap && _intervals_configured
+			    && (_last_timestamp_sample_accel >= (_last_timestamp_sample_gyro - 0.5f * _accel_interval.update_interval))) {
 
-			if (clip_z > 0) {
-				_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Z;
+				break;
 			}
-
-			publish_status = true;
-		}
-
-		// break once caught up to gyro
-		if (!sensor_data_gap && _intervals_configured
-		    && (_last_timestamp_sample_accel >= (_last_timestamp_sample_gyro - 0.5f * _accel_interval.update_interval))) {
-
-			break;
 		}
 	}
 
@@ -359,6 +389,12 @@ void VehicleIMU::Run()
 		if (_accel_integrator.reset(delta_velocity, accel_integral_dt)
 		    && _gyro_integrator.reset(delta_angle, gyro_integral_dt)) {
 
+			if (_fifo_available) {
+				// FIFO data is in the sensor frame, apply the driver rotation
+				delta_angle = _gyro_fifo_rotation * delta_angle;
+				delta_velocity = _accel_fifo_rotation * delta_velocity;
+			}
+
 			if (_accel_calibration.enabled() && _gyro_calibration.enabled()) {
 
 				// delta angle: apply offsets, scale, and board rotation
@@ -424,6 +460,173 @@ void VehicleIMU::Run()
 	}
 }
 
+void VehicleIMU::UpdateFifo(bool &sensor_data_gap, bool &update_integrator_config, bool &publish_status)
+{
+	static constexpr int FIFO_SIZE_MAX = sizeof(sensor_gyro_fifo_s::x) / sizeof(sensor_gyro_fifo_s::x[0]);
+	static_assert(FIFO_SIZE_MAX <= Integrator::BLOCK_SIZE_MAX, "FIFO size exceeds integrator block size");
+	static_assert(sizeof(sensor_accel_fifo_s::x) == sizeof(sensor_gyro_fifo_s::x), "accel & gyro FIFO size mismatch");
+
+	// temperature and error count are only published with sensor_accel & sensor_gyro
+	sensor_gyro_s gyro;
+
+	while (_sensor_gyro_sub.update(&gyro)) {
+		if (gyro.error_count != _status.gyro_error_count) {
+			publish_status = true;
+			_status.gyro_error_count = gyro.error_count;
+		}
+
+		_gyro_temperature_last = gyro.temperature;
+	}
+
+	sensor_accel_s accel;
+
+	while (_sensor_accel_sub.update(&accel)) {
+		if (accel.error_count != _status.accel_error_count) {
+			publish_status = true;
+			_status.accel_error_count = accel.error_count;
+		}
+
+		_accel_temperature_last = accel.temperature;
+	}
+
+	// integrate gyro FIFO
+	sensor_gyro_fifo_s gyro_fifo;
+
+	while (_sensor_gyro_fifo_sub.update(&gyro_fifo)) {
+		const int N = math::min((int)gyro_fifo.samples, FIFO_SIZE_MAX);
+
+		if ((N < 1) || !(gyro_fifo.dt > 0.f)) {
+			continue;
+		}
+
+		perf_count_interval(_gyro_update_perf, gyro_fifo.timestamp_sample);
+
+		if (_sensor_gyro_fifo_sub.get_last_generation() != _gyro_last_generation + 1) {
+			sensor_data_gap = true;
+			perf_count(_gyro_generation_gap_perf);
+		}
+
+		_gyro_last_generation = _sensor_gyro_fifo_sub.get_last_generation();
+
+		// the sample interval is known exactly
+		if (fabsf(gyro_fifo.dt - _gyro_interval.update_interval) > FLT_EPSILON) {
+			_gyro_interval.update_interval = gyro_fifo.dt;
+			_status.gyro_rate_hz = roundf(1e6f / gyro_fifo.dt);
+			update_integrator_config = true;
+			publish_status = true;
+		}
+
+		_gyro_calibration.set_device_id(gyro_fifo.device_id);
+
+		float sum[3] {};
+
+		for (int n = 0; n < N; n++) {
+			sum[0] += gyro_fifo.x[n];
+			sum[1] += gyro_fifo.y[n];
+			sum[2] += gyro_fifo.z[n];
+		}
+
+		_gyro_sum += _gyro_fifo_rotation * (Vector3f{sum} * gyro_fifo.scale);
+		_gyro_temperature += _gyro_temperature_last * N;
+		_gyro_sum_count += N;
+
+		_gyro_integrator.put(gyro_fifo.timestamp_sample, gyro_fifo.x, gyro_fifo.y, gyro_fifo.z, N, gyro_fifo.dt,
+				     gyro_fifo.scale);
+		_last_timestamp_sample_gyro = gyro_fifo.timestamp_sample;
+	}
+
+	// integrate accel FIFO
+	sensor_accel_fifo_s accel_fifo;
+
+	while (_sensor_accel_fifo_sub.update(&accel_fifo)) {
+		const int N = math::min((int)accel_fifo.samples, FIFO_SIZE_MAX);
+
+		if ((N < 1) || !(accel_fifo.dt > 0.f)) {
+			continue;
+		}
+
+		perf_count_interval(_accel_update_perf, accel_fifo.timestamp_sample);
+
+		if (_sensor_accel_fifo_sub.get_last_generation() != _accel_last_generation + 1) {
+			sensor_data_gap = true;
+			perf_count(_accel_generation_gap_perf);
+		}
+
+		_accel_last_generation = _sensor_accel_fifo_sub.get_last_generation();
+
+		if (fabsf(accel_fifo.dt - _accel_interval.update_interval) > FLT_EPSILON) {
+			_accel_interval.update_interval = accel_fifo.dt;
+			_status.accel_rate_hz = roundf(1e6f / accel_fifo.dt);
+			update_integrator_config = true;
+			publish_status = true;
+		}
+
+		_accel_calibration.set_device_id(accel_fifo.device_id);
+
+		float sum[3] {};
+		float clip_counter[3] {};
+
+		for (int n = 0; n < N; n++) {
+			const int16_t sample[3] {accel_fifo.x[n], accel_fifo.y[n], accel_fifo.z[n]};
+
+			for (int axis = 0; axis < 3; axis++) {
+				sum[axis] += sample[axis];
+
+				// raw sample at the limit of the sensor range
+				if ((sample[axis] >= INT16_MAX) || (sample[axis] <= -INT16_MAX)) {
+					clip_counter[axis]++;
+				}
+			}
+		}
+
+		_accel_sum += _accel_fifo_rotation * (Vector3f{sum} * accel_fifo.scale);
+		_accel_temperature += _accel_temperature_last * N;
+		_accel_sum_count += N;
+
+		_accel_integrator.put(accel_fifo.timestamp_sample, accel_fifo.x, accel_fifo.y, accel_fifo.z, N, accel_fifo.dt,
+				      accel_fifo.scale);
+		_last_timestamp_sample_accel = accel_fifo.timestamp_sample;
+
+		if (UpdateAccelClipping(_accel_fifo_rotation * Vector3f{clip_counter})) {
+			publish_status = true;
+		}
+	}
+}
+
+bool VehicleIMU::UpdateAccelClipping(const Vector3f &clip_counter)
+{
+	if ((fabsf(clip_counter(0)) > 0.f) || (fabsf(clip_counter(1)) > 0.f) || (fabsf(clip_counter(2)) > 0.f)) {
+
+		// rotate sensor clip counts into vehicle body frame
+		const Vector3f clipping{_accel_calibration.rotation() * clip_counter};
+
+		// round to get reasonble clip counts per axis (after board rotation)
+		const uint8_t clip_x = roundf(fabsf(clipping(0)));
+		const uint8_t clip_y = roundf(fabsf(clipping(1)));
+		const uint8_t clip_z = roundf(fabsf(clipping(2)));
+
+		_status.accel_clipping[0] += clip_x;
+		_status.accel_clipping[1] += clip_y;
+		_status.accel_clipping[2] += clip_z;
+
+		if (clip_x > 0) {
+			_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_X;
+		}
+
+		if (clip_y > 0) {
+			_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Y;
+		}
+
+		if (clip_z > 0) {
+			_delta_velocity_clipping |= vehicle_imu_s::CLIPPING_Z;
+		}
+
+		return true;
+	}
+
+	return false;
+}
+
 void VehicleIMU::UpdateIntegratorConfiguration()
 {
 	if ((_accel_interval.update_interval > 0) && (_gyro_interval.update_interval > 0)) {
@@ -431,8 +634,8 @@ void VehicleIMU::UpdateIntegratorConfiguration()
 		const float configured_interval_us = 1e6f / _param_imu_integ_rate.get();
 
 		// determine number of sensor samples that will get closest to the desired integration interval
-		const uint8_t accel_integral_samples = math::max(1.f, roundf(configured_interval_us / _accel_interval.update_interval));
-		const uint8_t gyro_integral_samples = math::max(1.f, roundf(configured_interval_us / _gyro_interval.update_interval));
+		const uint16_t accel_integral_samples = math::max(1.f, roundf(configured_interval_us / _accel_interval.update_interval));
+		const uint16_t gyro_integral_samples = math::max(1.f, roundf(configured_interval_us / _gyro_interval.update_interval));
 
 		// let the gyro set the configuration and scheduling
 		// accel integrator will be forced to reset when gyro integrator is ready
@@ -443,6 +646,17 @@ void VehicleIMU::UpdateIntegratorConfiguration()
 		_accel_integrator.set_reset_interval(roundf((accel_integral_samples - 0.5f) * _accel_interval.update_interval));
 		_gyro_integrator.set_reset_interval(roundf((gyro_integral_samples - 0.5f) * _gyro_interval.update_interval));
 
+		if (_fifo_available) {
+			// scheduled on every gyro FIFO publication
+			_intervals_configured = true;
+
+			PX4_DEBUG("accel (%d), gyro (%d), accel samples: %d, gyro samples: %d, accel interval: %.1f, gyro interval: %.1f (FIFO)",
+				  _accel_calibration.device_id(), _gyro_calibration.device_id(), accel_integral_samples, gyro_integral_samples,
+				  (double)_accel_interval.update_interval, (double)_gyro_interval.update_interval);
+
+			return;
+		}
+
 		// gyro: find largest integer multiple of gyro_integral_samples
 		for (int n = sensor_gyro_s::ORB_QUEUE_LENGTH; n > 0; n--) {
 			if (gyro_integral_samples % n == 0) {
@@ -488,13 +702,14 @@ void VehicleIMU::UpdateGyroVibrationMetrics(const Vector3f &delta_angle)
 void VehicleIMU::PrintStatus()
 {
 	if (_accel_calibration.device_id() == _gyro_calibration.device_id()) {
-		PX4_INFO("%d - IMU ID: %d, accel interval: %.1f us, gyro interval: %.1f us", _instance, _accel_calibration.device_id(),
-			 (double)_accel_interval.update_interval, (double)_gyro_interval.update_interval);
+		PX4_INFO("%d - IMU ID: %d, accel interval: %.1f us, gyro interval: %.1f us%s", _instance, _accel_calibration.device_id(),
+			 (double)_accel_interval.update_interval, (double)_gyro_interval.update_interval, _fifo_available ? " (FIFO)" : "");
 
 	} else {
-		PX4_INFO("%d - Accel ID: %d, interval: %.1f us, Gyro ID: %d, interval: %.1f us", _instance,
+		PX4_INFO("%d - Accel ID: %d, interval: %.1f us, Gyro ID: %d, interval: %.1f us%s", _instance,
 			 _accel_calibration.device_id(),
-			 (double)_accel_interval.update_interval, _gyro_calibration.device_id(), (double)_gyro_interval.update_interval);
+			 (double)_accel_interval.update_interval, _gyro_calibration.device_id(), (double)_gyro_interval.update_interval,
+			 _fifo_available ? " (FIFO)" : "");
 	}
 
 	perf_print_counter(_accel_generation_gap_perf);
@@ -35,6 +35,7 @@
 
 #include "Integrator.hpp"
 
+#include <lib/conversion/rotation.h>
 #include <lib/mathlib/math/Limits.hpp>
 #include <lib/matrix/matrix/math.hpp>
 #include <lib/perf/perf_counter.h>
@@ -49,7 +50,9 @@
 #include <uORB/SubscriptionCallback.hpp>
 #include <uORB/topics/parameter_update.h>
 #include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_accel_fifo.h>
 #include <uORB/topics/sensor_gyro.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
 #include <uORB/topics/vehicle_imu.h>
 #include <uORB/topics/vehicle_imu_status.h>
 
@@ -73,6 +76,8 @@ private:
 	void ParametersUpdate(bool force = false);
 	void Run() override;
 
+	static constexpr int MAX_SENSOR_COUNT = 4;
+
 	struct IntervalAverage {
 		hrt_abstime timestamp_sample_last{0};
 		float interval_sum{0.f};
@@ -80,6 +85,9 @@ private:
 		float update_interval{0.f};
 	};
 
+	bool SelectFifo();
+	void UpdateFifo(bool &sensor_data_gap, bool &update_integrator_config, bool &publish_status);
+	bool UpdateAccelClipping(const matrix::Vector3f &clip_counter);
 	bool UpdateIntervalAverage(IntervalAverage &intavg, const hrt_abstime &timestamp_sample);
 	void UpdateIntegratorConfiguration();
 	void UpdateGyroVibrationMetrics(const matrix::Vector3f &delta_angle);
@@ -91,6 +99,13 @@ private:
 	uORB::SubscriptionCallbackWorkItem _sensor_accel_sub;
 	uORB::SubscriptionCallbackWorkItem _sensor_gyro_sub;
 
+	// FIFO mode: integrate every raw sample of sensor_accel_fifo & sensor_gyro_fifo instead of sensor_accel & sensor_gyro
+	uORB::Subscription _sensor_accel_fifo_sub{ORB_ID(sensor_accel_fifo)};
+	uORB::SubscriptionCallbackWorkItem _sensor_gyro_fifo_sub{this, ORB_ID(sensor_gyro_fifo)};
+	matrix::Dcmf _accel_fifo_rotation{};
+	matrix::Dcmf _gyro_fifo_rotation{};
+	bool _fifo_available{false};
+
 	calibration::Accelerometer _accel_calibration{};
 	calibration::Gyroscope _gyro_calibration{};
 
@@ -115,6 +130,8 @@ private:
 	int _gyro_sum_count{0};
 	float _accel_temperature{0};
 	float _gyro_temperature{0};
+	float _accel_temperature_last{0};
+	float _gyro_temperature_last{0};
 
 	matrix::Vector3f _delta_angle_prev{0.f, 0.f, 0.f};	// delta angle from the previous IMU measurement
 	matrix::Vector3f _delta_velocity_prev{0.f, 0.f, 0.f};	// delta velocity from the previous IMU measurement
@@ -0,0 +1,134 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "IMUSampleHistory.hpp"
+
+#include <lib/mathlib/math/Limits.hpp>
+#include <px4_platform_common/defines.h>
+
+using namespace matrix;
+
+namespace sensors
+{
+
+void IMUSampleHistory::reset()
+{
+	head = 0;
+	count = 0;
+	sum.zero();
+	sum_count = 0;
+	noise_variance = NAN;
+	sample_interval_us = NAN;
+	clipping = 0;
+}
+
+void IMUSampleHistory::push(const hrt_abstime &timestamp_sample, const Vector3f &value)
+{
+	if (count > 0) {
+		const Sample &prev = newest();
+
+		if (timestamp_sample <= prev.timestamp_sample) {
+			// time went backwards
+			reset();
+
+		} else {
+			// noise estimate from the difference of consecutive samples (variance of the difference is 2x the variance
+			// of the noise), the change of the actual signal between samples is small at these rates
+			const Vector3f diff{value - Vector3f{prev.xyz}};
+			const float variance = diff.norm_squared() / 6.f;
+			const float interval_us = timestamp_sample - prev.timestamp_sample;
+
+			if (PX4_ISFINITE(noise_variance)) {
+				noise_variance = 0.995f * noise_variance + 0.005f * variance;
+				sample_interval_us = 0.995f * sample_interval_us + 0.005f * interval_us;
+
+			} else {
+				noise_variance = variance;
+				sample_interval_us = interval_us;
+			}
+		}
+	}
+
+	Sample &sample = samples[(head + count) % HISTORY_LENGTH];
+	sample.timestamp_sample = timestamp_sample;
+	value.copyTo(sample.xyz);
+
+	if (count < HISTORY_LENGTH) {
+		count++;
+
+	} else {
+		head = (head + 1) % HISTORY_LENGTH;
+	}
+}
+
+bool IMUSampleHistory::covers(const hrt_abstime &t0, const hrt_abstime &t1) const
+{
+	return (count > 1) && (at(0).timestamp_sample <= t0) && (newest().timestamp_sample >= t1);
+}
+
+Vector3f IMUSampleHistory::integrate(const hrt_abstime &t0, const hrt_abstime &t1) const
+{
+	Vector3f integral{};
+
+	for (int k = 1; k < count; k++) {
+		const Sample &a = at(k - 1);
+		const Sample &b = at(k);
+
+		if (b.timestamp_sample <= t0) {
+			continue;
+
+		} else if (a.timestamp_sample >= t1) {
+			break;
+		}
+
+		// part of the segment [a, b] within [t0, t1], trapezoidal rule on the linear interpolation
+		const hrt_abstime start = math::max(a.timestamp_sample, t0);
+		const hrt_abstime end = math::min(b.timestamp_sample, t1);
+
+		const float segment_us = b.timestamp_sample - a.timestamp_sample;
+		const float s0 = (start - a.timestamp_sample) / segment_us;
+		const float s1 = (end - a.timestamp_sample) / segment_us;
+
+		const Vector3f va{a.xyz};
+		const Vector3f vb{b.xyz};
+		const Vector3f value_start{va + (vb - va) * s0};
+		const Vector3f value_end{va + (vb - va) * s1};
+
+		integral += (value_start + value_end) * (0.5f * (end - start) * 1e-6f);
+	}
+
+	return integral;
+}
+
+} // namespace sensors
@@ -0,0 +1,94 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file IMUSampleHistory.hpp
+ *
+ * Short history of the calibrated samples (body frame) of a single accel or gyro, used by the IMU fusion
+ * to integrate every sensor over the same time window.
+ */
+
+#pragma once
+
+#include <drivers/drv_hrt.h>
+#include <lib/matrix/matrix/math.hpp>
+
+namespace sensors
+{
+
+class IMUSampleHistory
+{
+public:
+	static constexpr int HISTORY_LENGTH = 32;
+
+	struct Sample {
+		hrt_abstime timestamp_sample;
+		float xyz[3];
+	};
+
+	void reset();
+	void push(const hrt_abstime &timestamp_sample, const matrix::Vector3f &value);
+
+	/** @return true if the history has samples at or before t0 and at or after t1 */
+	bool covers(const hrt_abstime &t0, const hrt_abstime &t1) const;
+
+	/** integrate the (linearly interpolated) samples from t0 to t1 */
+	matrix::Vector3f integrate(const hrt_abstime &t0, const hrt_abstime &t1) const;
+
+	const Sample &at(int index) const { return samples[(head + index) % HISTORY_LENGTH]; } ///< 0 is the oldest
+	const Sample &newest() const { return at(count - 1); }
+
+	/**
+	 * Noise density squared (variance of the samples times the sample interval, per axis). The variance of
+	 * an integral over T seconds is noise_density() * T, so this (and not the variance of the samples) is what
+	 * allows comparing sensors with different sample rates.
+	 */
+	float noise_density() const { return noise_variance * sample_interval_us * 1e-6f; }
+
+	Sample samples[HISTORY_LENGTH] {};
+	int head{0};
+	int count{0};
+
+	// averaging of raw samples before they are added
+	matrix::Vector3f sum{};
+	int sum_count{0};
+
+	float noise_variance{NAN};     ///< estimated per axis noise variance of the samples
+	float sample_interval_us{NAN}; ///< average interval of the samples
+	unsigned last_generation{0};
+	uint8_t clipping{0}; ///< clipping (body axes) since the last fused publication
+	bool healthy{true};
+};
+
+} // namespace sensors
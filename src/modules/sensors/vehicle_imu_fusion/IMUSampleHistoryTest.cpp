@@ -0,0 +1,219 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * Simulates IMUs with white noise of known density and compares the error of their integrals over a window, alone
+ * and combined with the weights of the IMU fusion (inverse noise density). These are the figures 'sensors status'
+ * reports as the fused noise reduction.
+ */
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <random>
+
+#include "IMUSampleHistory.hpp"
+
+using namespace sensors;
+using matrix::Vector3f;
+
+static constexpr int NUM_IMUS = 3;
+static constexpr hrt_abstime WINDOW_US = 4000;    // 250 Hz integration
+static constexpr hrt_abstime DURATION_US = 20000000;
+
+struct SimulatedIMU {
+	hrt_abstime interval_us; // interval after averaging
+	hrt_abstime offset_us;   // sampling phase
+	float noise;             // standard deviation of a sample
+};
+
+// true angular rate, slow compared to the sample rates
+static constexpr float RATE_AMPLITUDE = 0.1f;
+static constexpr float RATE_FREQUENCY = 1.f;
+
+static float rate(hrt_abstime t)
+{
+	return RATE_AMPLITUDE * sinf(2.f * M_PI_F * RATE_FREQUENCY * t * 1e-6f);
+}
+
+static float rateIntegral(hrt_abstime t0, hrt_abstime t1)
+{
+	const float w = 2.f * M_PI_F * RATE_FREQUENCY;
+	return RATE_AMPLITUDE / w * (cosf(w * t0 * 1e-6f) - cosf(w * t1 * 1e-6f));
+}
+
+struct Result {
+	float density[NUM_IMUS];             // estimated noise density
+	float variance[NUM_IMUS];            // estimated noise variance of the samples
+	float error_variance[NUM_IMUS];      // variance of the integral error of each IMU
+	float error_variance_density;        // fused, weights 1/noise density
+	float error_variance_variance;       // fused, weights 1/noise variance of the samples
+};
+
+static Result simulate(const SimulatedIMU imus[NUM_IMUS])
+{
+	std::mt19937 generator(1);
+	std::normal_distribution<float> normal(0.f, 1.f);
+
+	IMUSampleHistory history[NUM_IMUS];
+	hrt_abstime next_sample[NUM_IMUS];
+
+	for (int i = 0; i < NUM_IMUS; i++) {
+		next_sample[i] = 1000000 + imus[i].offset_us;
+	}
+
+	double error_sum[NUM_IMUS] {};
+	double error_sum_density = 0.;
+	double error_sum_variance = 0.;
+	int windows = 0;
+
+	hrt_abstime t0 = 1000000 + 10000;
+
+	for (hrt_abstime t = 1000000; t < 1000000 + DURATION_US; t += 50) {
+		for (int i = 0; i < NUM_IMUS; i++) {
+			if (t >= next_sample[i]) {
+				const float value = rate(next_sample[i]) + imus[i].noise * normal(generator);
+				history[i].push(next_sample[i], Vector3f{value, 0.f, 0.f});
+				next_sample[i] += imus[i].interval_us;
+			}
+		}
+
+		const hrt_abstime t1 = t0 + WINDOW_US;
+		bool covered = true;
+
+		for (int i = 0; i < NUM_IMUS; i++) {
+			covered = covered && history[i].covers(t0, t1);
+		}
+
+		if (!covered) {
+			continue;
+		}
+
+		const float truth = rateIntegral(t0, t1);
+		float fused_density = 0.f;
+		float fused_variance = 0.f;
+		float weight_density = 0.f;
+		float weight_variance = 0.f;
+
+		for (int i = 0; i < NUM_IMUS; i++) {
+			const float integral = history[i].integrate(t0, t1)(0);
+			error_sum[i] += (integral - truth) * (integral - truth);
+
+			fused_density += integral / history[i].noise_density();
+			weight_density += 1.f / history[i].noise_density();
+
+			fused_variance += integral / history[i].noise_variance;
+			weight_variance += 1.f / history[i].noise_variance;
+		}
+
+		fused_density /= weight_density;
+		fused_variance /= weight_variance;
+
+		error_sum_density += (fused_density - truth) * (fused_density - truth);
+		error_sum_variance += (fused_variance - truth) * (fused_variance - truth);
+		windows++;
+
+		t0 = t1;
+	}
+
+	Result result{};
+
+	for (int i = 0; i < NUM_IMUS; i++) {
+		result.density[i] = history[i].noise_density();
+		result.variance[i] = history[i].noise_variance;
+		result.error_variance[i] = error_sum[i] / windows;
+	}
+
+	result.error_variance_density = error_sum_density / windows;
+	result.error_variance_variance = error_sum_variance / windows;
+
+	return result;
+}
+
+TEST(IMUSampleHistoryTest, NoiseDensity)
+{
+	// same noise per sample, but the 500 Hz IMU averages over 4x fewer samples per window
+	const SimulatedIMU imus[NUM_IMUS] {
+		{500, 0, 0.01f},
+		{500, 170, 0.01f},
+		{2000, 330, 0.01f},
+	};
+
+	const Result result = simulate(imus);
+
+	for (int i = 0; i < NUM_IMUS; i++) {
+		// the (3 axis) estimate includes the zero noise y and z axes
+		const float expected_variance = imus[i].noise * imus[i].noise / 3.f;
+		EXPECT_NEAR(result.variance[i], expected_variance, 0.2f * expected_variance) << "IMU " << i;
+		EXPECT_NEAR(result.density[i], expected_variance * imus[i].interval_us * 1e-6f,
+			    0.2f * expected_variance * imus[i].interval_us * 1e-6f) << "IMU " << i;
+	}
+
+	// the integral error of the slow IMU is much larger, although its samples are not noisier
+	EXPECT_GT(result.error_variance[2], 2.f * result.error_variance[0]);
+}
+
+TEST(IMUSampleHistoryTest, FusedNoise)
+{
+	// two 8 kHz IMUs (averaged to 2 kHz) with different noise, and a 500 Hz IMU with less noise per sample
+	const SimulatedIMU imus[NUM_IMUS] {
+		{500, 0, 0.010f},
+		{500, 250, 0.015f},
+		{2000, 120, 0.008f},
+	};
+
+	const Result result = simulate(imus);
+
+	float best = result.error_variance[0];
+	float expected_inverse = 0.f;
+
+	for (int i = 0; i < NUM_IMUS; i++) {
+		best = fminf(best, result.error_variance[i]);
+		expected_inverse += 1.f / result.error_variance[i];
+	}
+
+	// optimal combination of independent errors
+	const float expected = 1.f / expected_inverse;
+
+	printf("integral noise reduction compared to the best IMU: %.2fx (expected %.2fx), weighted by sample variance: %.2fx\n",
+	       (double)sqrtf(best / result.error_variance_density), (double)sqrtf(best / expected),
+	       (double)sqrtf(best / result.error_variance_variance));
+
+	EXPECT_LT(result.error_variance_density, best);
+	EXPECT_NEAR(result.error_variance_density, expected, 0.1f * expected);
+
+	// weighting by the noise of the samples ignores the sample rate and is worse
+	EXPECT_LT(result.error_variance_density, result.error_variance_variance);
+}
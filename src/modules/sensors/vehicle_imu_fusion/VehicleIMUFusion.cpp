@@ -0,0 +1,386 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include "VehicleIMUFusion.hpp"
+
+#include <px4_platform_common/log.h>
+
+#include <float.h>
+
+using namespace matrix;
+using namespace time_literals;
+
+namespace sensors
+{
+
+VehicleIMUFusion::VehicleIMUFusion() :
+	ModuleParams(nullptr),
+	ScheduledWorkItem(MODULE_NAME, px4::wq_configurations::INS0)
+{
+	// advertise immediately to ensure consistent ordering
+	_vehicle_imu_fused_pub.advertise();
+}
+
+VehicleIMUFusion::~VehicleIMUFusion()
+{
+	Stop();
+
+	perf_free(_cycle_perf);
+	perf_free(_generation_gap_perf);
+
+	_vehicle_imu_fused_pub.unadvertise();
+}
+
+bool VehicleIMUFusion::Start()
+{
+	// force initial updates
+	ParametersUpdate(true);
+
+	if (_sensor_gyro_fifo_subs[0].registerCallback()) {
+		_callback_instance = 0;
+	}
+
+	ScheduleNow();
+	return true;
+}
+
+void VehicleIMUFusion::Stop()
+{
+	// clear all registered callbacks
+	for (auto &sub : _sensor_gyro_fifo_subs) {
+		sub.unregisterCallback();
+	}
+
+	_callback_instance = -1;
+
+	Deinit();
+}
+
+void VehicleIMUFusion::ParametersUpdate(bool force)
+{
+	// Check if parameters have changed
+	if (_params_sub.updated() || force) {
+		// clear update
+		parameter_update_s param_update;
+		_params_sub.copy(&param_update);
+
+		updateParams();
+
+		for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+			_accel_calibration[i].ParametersUpdate();
+			_gyro_calibration[i].ParametersUpdate();
+		}
+
+		// same constraints as VehicleIMU (100-1000 Hz)
+		_imu_integration_interval_us = 1000000 / math::constrain(_param_imu_integ_rate.get(), (int32_t)100, (int32_t)1000);
+	}
+}
+
+void VehicleIMUFusion::SensorStatusUpdate()
+{
+	sensors_status_imu_s status;
+
+	if (_sensors_status_imu_sub.update(&status)) {
+		for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+			// sensors without a status (yet) are considered healthy
+			_accel_history[i].healthy = true;
+			_gyro_history[i].healthy = true;
+
+			for (int j = 0; j < MAX_SENSOR_COUNT; j++) {
+				if ((_accel_calibration[i].device_id() != 0) && (status.accel_device_ids[j] == _accel_calibration[i].device_id())) {
+					_accel_history[i].healthy = status.accel_healthy[j];
+				}
+
+				if ((_gyro_calibration[i].device_id() != 0) && (status.gyro_device_ids[j] == _gyro_calibration[i].device_id())) {
+					_gyro_history[i].healthy = status.gyro_healthy[j];
+				}
+			}
+		}
+	}
+}
+
+void VehicleIMUFusion::Run()
+{
+	perf_begin(_cycle_perf);
+
+	// backup schedule
+	ScheduleDelayed(10_ms);
+
+	ParametersUpdate();
+	SensorStatusUpdate();
+
+	for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+		_accel_calibration[i].SensorCorrectionsUpdate();
+		_gyro_calibration[i].SensorCorrectionsUpdate();
+
+		UpdateSensor<sensor_accel_fifo_s>(_sensor_accel_fifo_subs[i], _accel_calibration[i], _accel_history[i]);
+		UpdateSensor<sensor_gyro_fifo_s>(_sensor_gyro_fifo_subs[i], _gyro_calibration[i], _gyro_history[i]);
+	}
+
+	Fuse();
+
+	perf_end(_cycle_perf);
+}
+
+template<typename T, typename S, typename C>
+void VehicleIMUFusion::UpdateSensor(S &sub, C &calibration, IMUSampleHistory &history)
+{
+	static constexpr int FIFO_SIZE_MAX = sizeof(T::x) / sizeof(T::x[0]);
+
+	T fifo;
+
+	while (sub.update(&fifo)) {
+		const int N = math::min((int)fifo.samples, FIFO_SIZE_MAX);
+
+		if ((N < 1) || !(fifo.dt > 0.f) || (fifo.device_id == 0)) {
+			continue;
+		}
+
+		if (calibration.device_id() != fifo.device_id) {
+			calibration.set_device_id(fifo.device_id);
+			history.reset();
+
+		} else if (sub.get_last_generation() != history.last_generation + 1) {
+			// samples are only continuous without data gaps
+			perf_count(_generation_gap_perf);
+			history.reset();
+		}
+
+		history.last_generation = sub.get_last_generation();
+
+		// FIFO data is in the sensor frame (before the driver rotation) and raw units
+		const Dcmf fifo_rotation{get_rot_matrix(static_cast<Rotation>(fifo.rotation))};
+
+		// average consecutive samples down to at most 2 kHz
+		const int average_samples = math::max((int)ceilf(HISTORY_INTERVAL_MIN_US / fifo.dt), 1);
+
+		Vector3f clipping{};
+
+		for (int n = 0; n < N; n++) {
+			const Vector3f raw{(float)fifo.x[n], (float)fifo.y[n], (float)fifo.z[n]};
+
+			for (int axis = 0; axis < 3; axis++) {
+				if ((raw(axis) >= INT16_MAX) || (raw(axis) <= INT16_MIN)) {
+					clipping(axis) = 1.f;
+				}
+			}
+
+			history.sum += raw;
+			history.sum_count++;
+
+			if (history.sum_count >= average_samples) {
+				// timestamp_sample corresponds to the last sample of the FIFO message
+				const float sample_age_us = (N - 1 - n) * fifo.dt + (history.sum_count - 1) * fifo.dt * 0.5f;
+				const hrt_abstime timestamp_sample = fifo.timestamp_sample - (hrt_abstime)sample_age_us;
+
+				const Vector3f average{history.sum * (fifo.scale / history.sum_count)};
+				history.push(timestamp_sample, calibration.Correct(fifo_rotation * average));
+
+				history.sum.zero();
+				history.sum_count = 0;
+			}
+		}
+
+		if (clipping.longerThan(0.f)) {
+			const Vector3f clipping_body{calibration.rotation() * (fifo_rotation * clipping)};
+
+			for (int axis = 0; axis < 3; axis++) {
+				if (fabsf(clipping_body(axis)) > 0.5f) {
+					history.clipping |= (1 << axis);
+				}
+			}
+		}
+	}
+}
+
+void VehicleIMUFusion::Fuse()
+{
+	// IMUs in use: healthy and enabled, with recent data
+	bool use[MAX_SENSOR_COUNT] {};
+	int first_used = -1;
+	hrt_abstime t1 = 0;
+
+	for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+		const IMUSampleHistory &accel = _accel_history[i];
+		const IMUSampleHistory &gyro = _gyro_history[i];
+
+		use[i] = accel.healthy && gyro.healthy
+			 && _accel_calibration[i].enabled() && _gyro_calibration[i].enabled()
+			 && (accel.count > 1) && (gyro.count > 1)
+			 && PX4_ISFINITE(accel.noise_density()) && PX4_ISFINITE(gyro.noise_density())
+			 && (hrt_elapsed_time(&accel.newest().timestamp_sample) < 20_ms)
+			 && (hrt_elapsed_time(&gyro.newest().timestamp_sample) < 20_ms);
+
+		if (use[i]) {
+			// the window can only extend up to the latest sample all IMUs have
+			const hrt_abstime newest = math::min(accel.newest().timestamp_sample, gyro.newest().timestamp_sample);
+			t1 = (first_used < 0) ? newest : math::min(t1, newest);
+
+			if (first_used < 0) {
+				first_used = i;
+			}
+		}
+	}
+
+	// run whenever the first IMU in use has new data
+	if ((first_used >= 0) && (first_used != _callback_instance)) {
+		if (_callback_instance >= 0) {
+			_sensor_gyro_fifo_subs[_callback_instance].unregisterCallback();
+		}
+
+		_callback_instance = _sensor_gyro_fifo_subs[first_used].registerCallback() ? first_used : -1;
+	}
+
+	if (first_used < 0) {
+		_fused_timestamp_sample = 0;
+		return;
+	}
+
+	const hrt_abstime t0 = _fused_timestamp_sample;
+
+	if ((t0 == 0) || (t1 < t0) || (t1 - t0 > 100_ms)) {
+		// (re)start
+		_fused_timestamp_sample = t1;
+		return;
+	}
+
+	if (t1 - t0 < _imu_integration_interval_us) {
+		return;
+	}
+
+	// weighted average of the integrals over [t0, t1], weights are the inverse noise density (variance of the integrals)
+	Vector3f delta_angle{};
+	Vector3f delta_velocity{};
+	float accel_weight_sum = 0.f;
+	float gyro_weight_sum = 0.f;
+	uint8_t clipping = 0;
+
+	for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+		_accel_weight[i] = 0.f;
+		_gyro_weight[i] = 0.f;
+
+		IMUSampleHistory &accel = _accel_history[i];
+		IMUSampleHistory &gyro = _gyro_history[i];
+
+		if (use[i] && accel.covers(t0, t1) && gyro.covers(t0, t1)) {
+			_accel_weight[i] = 1.f / math::max(accel.noise_density(), FLT_EPSILON * FLT_EPSILON);
+			_gyro_weight[i] = 1.f / math::max(gyro.noise_density(), FLT_EPSILON * FLT_EPSILON);
+
+			delta_velocity += accel.integrate(t0, t1) * _accel_weight[i];
+			delta_angle += gyro.integrate(t0, t1) * _gyro_weight[i];
+
+			accel_weight_sum += _accel_weight[i];
+			gyro_weight_sum += _gyro_weight[i];
+
+			clipping |= accel.clipping;
+		}
+	}
+
+	_fused_timestamp_sample = t1;
+
+	if (!(accel_weight_sum > 0.f) || !(gyro_weight_sum > 0.f)) {
+		return;
+	}
+
+	int accel_primary = 0;
+	int gyro_primary = 0;
+
+	for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+		_accel_weight[i] /= accel_weight_sum;
+		_gyro_weight[i] /= gyro_weight_sum;
+
+		accel_primary = (_accel_weight[i] > _accel_weight[accel_primary]) ? i : accel_primary;
+		gyro_primary = (_gyro_weight[i] > _gyro_weight[gyro_primary]) ? i : gyro_primary;
+
+		_accel_history[i].clipping = 0;
+	}
+
+	_accel_fused_noise_density = 1.f / accel_weight_sum;
+	_gyro_fused_noise_density = 1.f / gyro_weight_sum;
+
+	const uint16_t dt_us = math::min(t1 - t0, (hrt_abstime)UINT16_MAX);
+
+	vehicle_imu_s imu;
+	imu.timestamp_sample = t1;
+	imu.accel_device_id = _accel_calibration[accel_primary].device_id();
+	imu.gyro_device_id = _gyro_calibration[gyro_primary].device_id();
+	(delta_angle / gyro_weight_sum).copyTo(imu.delta_angle);
+	(delta_velocity / accel_weight_sum).copyTo(imu.delta_velocity);
+	imu.delta_angle_dt = dt_us;
+	imu.delta_velocity_dt = dt_us;
+	imu.delta_velocity_clipping = clipping;
+	imu.calibration_count = _accel_calibration[accel_primary].calibration_count()
+				+ _gyro_calibration[gyro_primary].calibration_count();
+	imu.timestamp = hrt_absolute_time();
+	_vehicle_imu_fused_pub.publish(imu);
+}
+
+void VehicleIMUFusion::PrintStatus()
+{
+	PX4_INFO("IMU fusion, integration interval: %d us", (int)_imu_integration_interval_us);
+
+	float accel_density_min = NAN;
+	float gyro_density_min = NAN;
+
+	for (int i = 0; i < MAX_SENSOR_COUNT; i++) {
+		if ((_accel_calibration[i].device_id() != 0) || (_gyro_calibration[i].device_id() != 0)) {
+			const float gyro_density = _gyro_history[i].noise_density();
+			const float accel_density = _accel_history[i].noise_density();
+
+			PX4_INFO("%d: gyro %d weight: %.3f noise: %.6f rad/s/sqrt(Hz), accel %d weight: %.3f noise: %.5f m/s^2/sqrt(Hz)", i,
+				 _gyro_calibration[i].device_id(), (double)_gyro_weight[i], (double)sqrtf(gyro_density),
+				 _accel_calibration[i].device_id(), (double)_accel_weight[i], (double)sqrtf(accel_density));
+
+			if (_gyro_weight[i] > 0.f) {
+				gyro_density_min = PX4_ISFINITE(gyro_density_min) ? math::min(gyro_density_min, gyro_density) : gyro_density;
+			}
+
+			if (_accel_weight[i] > 0.f) {
+				accel_density_min = PX4_ISFINITE(accel_density_min) ? math::min(accel_density_min, accel_density) : accel_density;
+			}
+		}
+	}
+
+	// noise of the fused data compared to the best single IMU
+	if (PX4_ISFINITE(gyro_density_min) && PX4_ISFINITE(accel_density_min)) {
+		PX4_INFO("fused noise: gyro %.6f rad/s/sqrt(Hz) (%.2fx lower), accel %.5f m/s^2/sqrt(Hz) (%.2fx lower)",
+			 (double)sqrtf(_gyro_fused_noise_density), (double)sqrtf(gyro_density_min / _gyro_fused_noise_density),
+			 (double)sqrtf(_accel_fused_noise_density), (double)sqrtf(accel_density_min / _accel_fused_noise_density));
+	}
+
+	perf_print_counter(_cycle_perf);
+	perf_print_counter(_generation_gap_perf);
+}
+
+} // namespace sensors
@@ -0,0 +1,142 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file VehicleIMUFusion.hpp
+ *
+ * Fused IMU: combines the full rate (FIFO) data of all healthy IMUs.
+ *
+ * The calibrated samples of every accel and gyro are kept in a short history. Once all IMUs in
+ * use have data up to a common time, each is integrated over the same time window [t0, t1]
+ * (linear interpolation between samples, so the windows are aligned regardless of the
+ * individual sample times and rates), and the integrals are combined with a weighted average.
+ * The weights are the inverse of the noise density estimated per sensor (the variance of its
+ * integrals), which for N IMUs with similar noise reduces the noise by sqrt(N).
+ */
+
+#pragma once
+
+#include "IMUSampleHistory.hpp"
+
+#include <lib/conversion/rotation.h>
+#include <lib/mathlib/math/Limits.hpp>
+#include <lib/matrix/matrix/math.hpp>
+#include <lib/perf/perf_counter.h>
+#include <lib/sensor_calibration/Accelerometer.hpp>
+#include <lib/sensor_calibration/Gyroscope.hpp>
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/module_params.h>
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/px4_work_queue/ScheduledWorkItem.hpp>
+#include <uORB/Publication.hpp>
+#include <uORB/Subscription.hpp>
+#include <uORB/SubscriptionCallback.hpp>
+#include <uORB/topics/parameter_update.h>
+#include <uORB/topics/sensor_accel_fifo.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
+#include <uORB/topics/sensors_status_imu.h>
+#include <uORB/topics/vehicle_imu.h>
+
+namespace sensors
+{
+
+class VehicleIMUFusion : public ModuleParams, public px4::ScheduledWorkItem
+{
+public:
+	VehicleIMUFusion();
+	~VehicleIMUFusion() override;
+
+	bool Start();
+	void Stop();
+
+	void PrintStatus();
+
+private:
+	static constexpr int MAX_SENSOR_COUNT = 4;
+
+	static constexpr uint32_t HISTORY_INTERVAL_MIN_US = 500; ///< samples are averaged down to at most 2 kHz
+
+	template<typename T, typename S, typename C>
+	void UpdateSensor(S &sub, C &calibration, IMUSampleHistory &history);
+
+	void Fuse();
+	void ParametersUpdate(bool force = false);
+	void Run() override;
+	void SensorStatusUpdate();
+
+	uORB::Publication<vehicle_imu_s> _vehicle_imu_fused_pub{ORB_ID(vehicle_imu_fused)};
+
+	uORB::Subscription _params_sub{ORB_ID(parameter_update)};
+	uORB::Subscription _sensors_status_imu_sub{ORB_ID(sensors_status_imu)};
+
+	uORB::SubscriptionCallbackWorkItem _sensor_gyro_fifo_subs[MAX_SENSOR_COUNT] {
+		{this, ORB_ID(sensor_gyro_fifo), 0},
+		{this, ORB_ID(sensor_gyro_fifo), 1},
+		{this, ORB_ID(sensor_gyro_fifo), 2},
+		{this, ORB_ID(sensor_gyro_fifo), 3}
+	};
+
+	uORB::Subscription _sensor_accel_fifo_subs[MAX_SENSOR_COUNT] {
+		{ORB_ID(sensor_accel_fifo), 0},
+		{ORB_ID(sensor_accel_fifo), 1},
+		{ORB_ID(sensor_accel_fifo), 2},
+		{ORB_ID(sensor_accel_fifo), 3}
+	};
+
+	calibration::Accelerometer _accel_calibration[MAX_SENSOR_COUNT] {};
+	calibration::Gyroscope _gyro_calibration[MAX_SENSOR_COUNT] {};
+
+	IMUSampleHistory _accel_history[MAX_SENSOR_COUNT] {};
+	IMUSampleHistory _gyro_history[MAX_SENSOR_COUNT] {};
+
+	hrt_abstime _fused_timestamp_sample{0}; ///< end of the last fused window
+
+	uint32_t _imu_integration_interval_us{4000};
+
+	int _callback_instance{-1}; ///< gyro FIFO instance scheduling the fusion
+
+	float _accel_weight[MAX_SENSOR_COUNT] {};
+	float _gyro_weight[MAX_SENSOR_COUNT] {};
+	float _accel_fused_noise_density{NAN};
+	float _gyro_fused_noise_density{NAN};
+
+	perf_counter_t _cycle_perf{perf_alloc(PC_ELAPSED, MODULE_NAME": IMU fusion cycle")};
+	perf_counter_t _generation_gap_perf{perf_alloc(PC_COUNT, MODULE_NAME": IMU fusion data gap")};
+
+	DEFINE_PARAMETERS(
+		(ParamInt<px4::params::IMU_INTEG_RATE>) _param_imu_integ_rate
+	)
+};
+
+} // namespace sensors
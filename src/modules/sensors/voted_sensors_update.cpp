@@ -49,9 +49,11 @@ using namespace matrix;
 using namespace time_literals;
 
 VotedSensorsUpdate::VotedSensorsUpdate(bool hil_enabled,
-				       uORB::SubscriptionCallbackWorkItem(&vehicle_imu_sub)[MAX_SENSOR_COUNT]) :
+				       uORB::SubscriptionCallbackWorkItem(&vehicle_imu_sub)[MAX_SENSOR_COUNT],
+				       uORB::SubscriptionCallbackWorkItem &vehicle_imu_fused_sub) :
 	ModuleParams(nullptr),
 	_vehicle_imu_sub(vehicle_imu_sub),
+	_vehicle_imu_fused_sub(vehicle_imu_fused_sub),
 	_hil_enabled(hil_enabled)
 {
 	if (_hil_enabled) { // HIL has less accurate timing so increase the timeouts a bit
@@ -138,6 +140,16 @@ void VotedSensorsUpdate::parametersUpdate()
 
 void VotedSensorsUpdate::imuPoll(struct sensor_combined_s &raw)
 {
+	// new data of all IMUs, put into the voters at once
+	uint8_t update_mask = 0;
+	uint64_t timestamp[MAX_SENSOR_COUNT] {};
+	float accel[MAX_SENSOR_COUNT][3] {};
+	float gyro[MAX_SENSOR_COUNT][3] {};
+	uint32_t accel_error_count[MAX_SENSOR_COUNT] {};
+	uint32_t gyro_error_count[MAX_SENSOR_COUNT] {};
+	uint8_t accel_priority[MAX_SENSOR_COUNT] {};
+	uint8_t gyro_priority[MAX_SENSOR_COUNT] {};
+
 	for (int uorb_index = 0; uorb_index < MAX_SENSOR_COUNT; uorb_index++) {
 		vehicle_imu_s imu_report;
 
@@ -174,14 +186,22 @@ void VotedSensorsUpdate::imuPoll(struct sensor_combined_s &raw)
 
 			_last_accel_timestamp[uorb_index] = imu_report.timestamp_sample;
 
-			_accel.voter.put(uorb_index, imu_report.timestamp, _last_sensor_data[uorb_index].accelerometer_m_s2,
-					 imu_status.accel_error_count, _accel.priority[uorb_index]);
-
-			_gyro.voter.put(uorb_index, imu_report.timestamp, _last_sensor_data[uorb_index].gyro_rad,
-					imu_status.gyro_error_count, _gyro.priority[uorb_index]);
+			update_mask |= 1 << uorb_index;
+			timestamp[uorb_index] = imu_report.timestamp;
+			accel_data.copyTo(accel[uorb_index]);
+			gyro_rate.copyTo(gyro[uorb_index]);
+			accel_error_count[uorb_index] = imu_status.accel_error_count;
+			gyro_error_count[uorb_index] = imu_status.gyro_error_count;
+			accel_priority[uorb_index] = _accel.priority[uorb_index];
+			gyro_priority[uorb_index] = _gyro.priority[uorb_index];
 		}
 	}
 
+	if (update_mask != 0) {
+		_accel.voter.put(update_mask, timestamp, accel, accel_error_count, accel_priority);
+		_gyro.voter.put(update_mask, timestamp, gyro, gyro_error_count, gyro_priority);
+	}
+
 	// find the best sensor
 	int accel_best_index = -1;
 	int gyro_best_index = -1;
@@ -218,15 +238,49 @@ void VotedSensorsUpdate::imuPoll(struct sensor_combined_s &raw)
 		}
 	}
 
+	// fused IMU replaces the data of the best sensor while it's updating
+	bool fused_valid = false;
+
+	if (_param_sens_imu_fuse.get()) {
+		vehicle_imu_s imu_fused;
+
+		// never move sensor_combined backwards in time, hold off until the fused stream catches up after a switch
+		if (_vehicle_imu_fused_sub.update(&imu_fused) && (imu_fused.delta_angle_dt > 0) && (imu_fused.delta_velocity_dt > 0)
+		    && (imu_fused.timestamp_sample > raw.timestamp)) {
+			const float accel_dt_inv = 1.e6f / (float)imu_fused.delta_velocity_dt;
+			const float gyro_dt_inv = 1.e6f / (float)imu_fused.delta_angle_dt;
+
+			raw.timestamp = imu_fused.timestamp_sample;
+
+			for (int axis = 0; axis < 3; axis++) {
+				raw.accelerometer_m_s2[axis] = imu_fused.delta_velocity[axis] * accel_dt_inv;
+				raw.gyro_rad[axis] = imu_fused.delta_angle[axis] * gyro_dt_inv;
+			}
+
+			raw.accelerometer_integral_dt = imu_fused.delta_velocity_dt;
+			raw.gyro_integral_dt = imu_fused.delta_angle_dt;
+			raw.accelerometer_clipping = imu_fused.delta_velocity_clipping;
+
+			_last_fused_timestamp = imu_fused.timestamp;
+		}
+
+		fused_valid = (_last_fused_timestamp != 0) && (hrt_elapsed_time(&_last_fused_timestamp) < 50_ms);
+	}
+
+	_fused_in_use = fused_valid;
+
 	// write data for the best sensor to output variables
 	if ((accel_best_index >= 0) && (gyro_best_index >= 0)) {
-		raw.timestamp = _last_sensor_data[gyro_best_index].timestamp;
-		memcpy(&raw.accelerometer_m_s2, &_last_sensor_data[accel_best_index].accelerometer_m_s2,
-		       sizeof(raw.accelerometer_m_s2));
-		memcpy(&raw.gyro_rad, &_last_sensor_data[gyro_best_index].gyro_rad, sizeof(raw.gyro_rad));
-		raw.accelerometer_integral_dt = _last_sensor_data[accel_best_index].accelerometer_integral_dt;
-		raw.gyro_integral_dt = _last_sensor_data[gyro_best_index].gyro_integral_dt;
-		raw.accelerometer_clipping = _last_sensor_data[accel_best_index].accelerometer_clipping;
+		// the primary may lag the last fused sample when falling back, hold off instead of going backwards
+		if (!fused_valid && (_last_sensor_data[gyro_best_index].timestamp > raw.timestamp)) {
+			raw.timestamp = _last_sensor_data[gyro_best_index].timestamp;
+			memcpy(&raw.accelerometer_m_s2, &_last_sensor_data[accel_best_index].accelerometer_m_s2,
+			       sizeof(raw.accelerometer_m_s2));
+			memcpy(&raw.gyro_rad, &_last_sensor_data[gyro_best_index].gyro_rad, sizeof(raw.gyro_rad));
+			raw.accelerometer_integral_dt = _last_sensor_data[accel_best_index].accelerometer_integral_dt;
+			raw.gyro_integral_dt = _last_sensor_data[gyro_best_index].gyro_integral_dt;
+			raw.accelerometer_clipping = _last_sensor_data[accel_best_index].accelerometer_clipping;
+		}
 
 		if ((accel_best_index != _accel.last_best_vote) || (_selection.accel_device_id != _accel_device_id[accel_best_index])) {
 			_accel.last_best_vote = (uint8_t)accel_best_index;
@@ -400,7 +454,11 @@ void VotedSensorsUpdate::sensorsPoll(sensor_combined_s &raw)
 
 void VotedSensorsUpdate::setRelativeTimestamps(sensor_combined_s &raw)
 {
-	if (_last_accel_timestamp[_accel.last_best_vote]) {
+	if (_fused_in_use) {
+		// accel and gyro of the fused IMU share the same sample time
+		raw.accelerometer_timestamp_relative = 0;
+
+	} else if (_last_accel_timestamp[_accel.last_best_vote]) {
 		raw.accelerometer_timestamp_relative = (int32_t)((int64_t)_last_accel_timestamp[_accel.last_best_vote] -
 						       (int64_t)raw.timestamp);
 	}
@@ -75,7 +75,8 @@ public:
 	 * @param parameters parameter values. These do not have to be initialized when constructing this object.
 	 * Only when calling init(), they have to be initialized.
 	 */
-	VotedSensorsUpdate(bool hil_enabled, uORB::SubscriptionCallbackWorkItem(&vehicle_imu_sub)[MAX_SENSOR_COUNT]);
+	VotedSensorsUpdate(bool hil_enabled, uORB::SubscriptionCallbackWorkItem(&vehicle_imu_sub)[MAX_SENSOR_COUNT],
+			   uORB::SubscriptionCallbackWorkItem &vehicle_imu_fused_sub);
 
 	/**
 	 * initialize subscriptions etc.
@@ -161,6 +162,7 @@ private:
 	uORB::Publication<sensors_status_imu_s> _sensors_status_imu_pub{ORB_ID(sensors_status_imu)};
 
 	uORB::SubscriptionCallbackWorkItem(&_vehicle_imu_sub)[MAX_SENSOR_COUNT];
+	uORB::SubscriptionCallbackWorkItem &_vehicle_imu_fused_sub;
 	uORB::SubscriptionMultiArray<vehicle_imu_status_s, MAX_SENSOR_COUNT> _vehicle_imu_status_subs{ORB_ID::vehicle_imu_status};
 
 	uORB::Subscription _sensor_selection_sub{ORB_ID(sensor_selection)};
@@ -179,10 +181,14 @@ private:
 
 	uint64_t _last_accel_timestamp[MAX_SENSOR_COUNT] {};	/**< latest full timestamp */
 
+	hrt_abstime _last_fused_timestamp{0};		/**< last update of the fused IMU (SENS_IMU_FUSE) */
+	bool _fused_in_use{false};			/**< sensor_combined currently carries the fused IMU sample */
+
 	sensor_selection_s _selection {};		/**< struct containing the sensor selection to be published to the uORB */
 
 	DEFINE_PARAMETERS(
-		(ParamBool<px4::params::SENS_IMU_MODE>) _param_sens_imu_mode
+		(ParamBool<px4::params::SENS_IMU_MODE>) _param_sens_imu_mode,
+		(ParamBool<px4::params::SENS_IMU_FUSE>) _param_sens_imu_fuse
 	)
 };
 
@@ -0,0 +1,189 @@
+/****************************************************************************
+*
+*   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+* 3. Neither the name PX4 nor the names of its contributors may be
+*    used to endorse or promote products derived from this software
+*    without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+* ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+****************************************************************************/
+
+#include "SihBatch.hpp"
+
+#include <ecl/geo/geo.h>
+
+SihBatch::~SihBatch()
+{
+	delete[] _buffer;
+}
+
+bool SihBatch::init(int num_vehicles)
+{
+	delete[] _buffer;
+	_buffer = nullptr;
+	_num_vehicles = 0;
+	_num_padded = 0;
+
+	if (num_vehicles <= 0) {
+		return false;
+	}
+
+	// pad each array to a multiple of the block size
+	const int stride = (num_vehicles + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+
+	_buffer = new float[stride * NUM_ARRAYS];
+
+	if (_buffer == nullptr) {
+		return false;
+	}
+
+	for (int a = 0; a < NUM_ARRAYS; a++) {
+		_x[a] = _buffer + a * stride;
+	}
+
+	_num_vehicles = num_vehicles;
+	_num_padded = stride;
+	reset();
+	return true;
+}
+
+void SihBatch::reset()
+{
+	for (int a = 0; a < NUM_ARRAYS; a++) {
+		for (int i = 0; i < _num_padded; i++) {
+			_x[a][i] = 0.f;
+		}
+	}
+
+	for (int i = 0; i < _num_padded; i++) {
+		_x[QW][i] = 1.f;
+		_x[GROUNDED][i] = 1.f;
+	}
+}
+
+void SihBatch::set_motors(int vehicle, const float u[NB_MOTORS])
+{
+	_x[U0][vehicle] = u[0];
+	_x[U1][vehicle] = u[1];
+	_x[U2][vehicle] = u[2];
+	_x[U3][vehicle] = u[3];
+}
+
+void SihBatch::step(float dt)
+{
+	const Params p = _params; // local copy, which cannot alias the state arrays
+	const float weight = p.mass * CONSTANTS_ONE_G;
+	const float mass_inv = 1.f / p.mass;
+	const float dt_inv = 1.f / dt;
+
+	float *px = _x[PX], *py = _x[PY], *pz = _x[PZ];
+	float *vx = _x[VX], *vy = _x[VY], *vz = _x[VZ];
+	float *ax = _x[AX], *ay = _x[AY], *az = _x[AZ];
+	float *qw = _x[QW], *qx = _x[QX], *qy = _x[QY], *qz = _x[QZ];
+	float *wx = _x[WX], *wy = _x[WY], *wz = _x[WZ];
+	const float *u0 = _x[U0], *u1 = _x[U1], *u2 = _x[U2], *u3 = _x[U3];
+	float *grounded = _x[GROUNDED];
+
+	// the padding vehicles are stepped as well, so that the inner loop has a fixed length and needs no scalar epilogue
+	for (int block = 0; block < _num_padded; block += BLOCK_SIZE) {
+		// the state arrays do not overlap
+#if defined(__clang__)
+		#pragma clang loop vectorize(assume_safety)
+#elif defined(__GNUC__)
+		#pragma GCC ivdep
+#endif
+
+		for (int i = block; i < block + BLOCK_SIZE; i++) {
+			// thrust (along body -z) and moments of the motors, first order aerodynamic damping
+			const float T = -p.t_max * (u0[i] + u1[i] + u2[i] + u3[i]);
+			const float Mx = p.l_roll * p.t_max * (-u0[i] + u1[i] + u2[i] - u3[i]) - p.kdw * wx[i];
+			const float My = p.l_pitch * p.t_max * (u0[i] - u1[i] + u2[i] - u3[i]) - p.kdw * wy[i];
+			const float Mz = p.q_max * (u0[i] + u1[i] - u2[i] - u3[i]) - p.kdw * wz[i];
+
+			// third column of the body to inertial rotation matrix (direction of the body z axis)
+			const float a = qw[i], b = qx[i], c = qy[i], d = qz[i];
+			const float c02 = 2.f * (a * c + b * d);
+			const float c12 = 2.f * (c * d - a * b);
+			const float c22 = a * a - b * b - c * c + d * d;
+
+			// conservation of linear momentum
+			const float dvx = (-p.kdv * vx[i] + c02 * T) * mass_inv;
+			const float dvy = (-p.kdv * vy[i] + c12 * T) * mass_inv;
+			const float dvz = (weight - p.kdv * vz[i] + c22 * T) * mass_inv;
+
+			// conservation of angular momentum: I^-1 * (M - w x (I w))
+			const float Iwx = p.I(0, 0) * wx[i] + p.I(0, 1) * wy[i] + p.I(0, 2) * wz[i];
+			const float Iwy = p.I(1, 0) * wx[i] + p.I(1, 1) * wy[i] + p.I(1, 2) * wz[i];
+			const float Iwz = p.I(2, 0) * wx[i] + p.I(2, 1) * wy[i] + p.I(2, 2) * wz[i];
+			const float rx = Mx - (wy[i] * Iwz - wz[i] * Iwy);
+			const float ry = My - (wz[i] * Iwx - wx[i] * Iwz);
+			const float rz = Mz - (wx[i] * Iwy - wy[i] * Iwx);
+			const float dwx = p.Im1(0, 0) * rx + p.Im1(0, 1) * ry + p.Im1(0, 2) * rz;
+			const float dwy = p.Im1(1, 0) * rx + p.Im1(1, 1) * ry + p.Im1(1, 2) * rz;
+			const float dwz = p.Im1(2, 0) * rx + p.Im1(2, 1) * ry + p.Im1(2, 2) * rz;
+
+			// attitude differential: 0.5 * q * (0, w)
+			const float dqw = 0.5f * (-b * wx[i] - c * wy[i] - d * wz[i]);
+			const float dqx = 0.5f * (a * wx[i] + c * wz[i] - d * wy[i]);
+			const float dqy = 0.5f * (a * wy[i] - b * wz[i] + d * wx[i]);
+			const float dqz = 0.5f * (a * wz[i] + b * wy[i] - c * wx[i]);
+
+			// fake ground, avoid free fall (bitwise logic and arithmetic instead of branches, to keep the loop vectorizable)
+			const bool on_ground = (pz[i] > 0.f) & ((dvz > 0.f) | (vz[i] > 0.f));
+			const float fly = static_cast<float>(static_cast<int>(!on_ground));
+
+			// for the accelerometer, compute the acceleration that stops the vehicle in one time step when it just hit the floor
+			const float stop = (1.f - fly) * (grounded[i] - 1.f) * dt_inv;
+			ax[i] = fly * dvx + stop * vx[i];
+			ay[i] = fly * dvy + stop * vy[i];
+			az[i] = fly * dvz + stop * vz[i];
+
+			// integration: Euler forward
+			px[i] += fly * vx[i] * dt;
+			py[i] += fly * vy[i] * dt;
+			pz[i] += fly * vz[i] * dt;
+			vx[i] = fly * (vx[i] + dvx * dt);
+			vy[i] = fly * (vy[i] + dvy * dt);
+			vz[i] = fly * (vz[i] + dvz * dt);
+
+			const float qw_new = a + fly * dqw * dt;
+			const float qx_new = b + fly * dqx * dt;
+			const float qy_new = c + fly * dqy * dt;
+			const float qz_new = d + fly * dqz * dt;
+			const float q_norm_inv = 1.f / sqrtf(qw_new * qw_new + qx_new * qx_new + qy_new * qy_new + qz_new * qz_new);
+			qw[i] = qw_new * q_norm_inv;
+			qx[i] = qx_new * q_norm_inv;
+			qy[i] = qy_new * q_norm_inv;
+			qz[i] = qz_new * q_norm_inv;
+
+			wx[i] = fly * (wx[i] + dwx * dt);
+			wy[i] = fly * (wy[i] + dwy * dt);
+			wz[i] = fly * (wz[i] + dwz * dt);
+
+			grounded[i] = 1.f - fly;
+		}
+	}
+}
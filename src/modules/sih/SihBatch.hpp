@@ -0,0 +1,116 @@
+/****************************************************************************
+*
+*   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+* 3. Neither the name PX4 nor the names of its contributors may be
+*    used to endorse or promote products derived from this software
+*    without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+* ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+****************************************************************************/
+
+/**
+ * @file SihBatch.hpp
+ * Rigid body dynamics of the SIH quadrotor for many vehicles at once.
+ *
+ * The states are stored as structure of arrays (one array per state component), and a step updates all
+ * vehicles in fixed size blocks with a branch-free loop body, so that the compiler can vectorize it.
+ */
+
+#pragma once
+
+#include <matrix/matrix/math.hpp>
+
+class SihBatch
+{
+public:
+	static constexpr int NB_MOTORS = 4;
+
+	/** airframe parameters, shared by all vehicles */
+	struct Params {
+		float mass;
+		float t_max;		///< max thrust per motor [N]
+		float q_max;		///< max torque per motor [Nm]
+		float l_roll;		///< roll arm [m]
+		float l_pitch;		///< pitch arm [m]
+		float kdv;		///< linear damping [N/(m/s)]
+		float kdw;		///< angular damping [Nm/(rad/s)]
+		matrix::Matrix3f I;	///< inertia matrix
+		matrix::Matrix3f Im1;	///< inverse of the inertia matrix
+	};
+
+	SihBatch() = default;
+	~SihBatch();
+
+	SihBatch(const SihBatch &) = delete;
+	SihBatch &operator=(const SihBatch &) = delete;
+
+	/**
+	 * Allocate the states of num_vehicles vehicles and reset them
+	 * @return false on allocation failure
+	 */
+	bool init(int num_vehicles);
+
+	int num_vehicles() const { return _num_vehicles; }
+
+	void set_params(const Params &params) { _params = params; }
+
+	/** put all vehicles at rest on the ground, at the origin and level */
+	void reset();
+
+	/** set the normalized motor signals [0, 1] of a vehicle */
+	void set_motors(int vehicle, const float u[NB_MOTORS]);
+
+	/** integrate all vehicles one step (Euler forward) */
+	void step(float dt);
+
+	matrix::Vector3f position(int i) const { return matrix::Vector3f(_x[PX][i], _x[PY][i], _x[PZ][i]); }
+	matrix::Vector3f velocity(int i) const { return matrix::Vector3f(_x[VX][i], _x[VY][i], _x[VZ][i]); }
+	matrix::Vector3f acceleration(int i) const { return matrix::Vector3f(_x[AX][i], _x[AY][i], _x[AZ][i]); }
+	matrix::Quatf attitude(int i) const { return matrix::Quatf(_x[QW][i], _x[QX][i], _x[QY][i], _x[QZ][i]); }
+	matrix::Vector3f angular_velocity(int i) const { return matrix::Vector3f(_x[WX][i], _x[WY][i], _x[WZ][i]); }
+	bool grounded(int i) const { return _x[GROUNDED][i] > 0.5f; }
+
+private:
+	enum Array {
+		PX, PY, PZ,		///< inertial position [m]
+		VX, VY, VZ,		///< inertial velocity [m/s]
+		AX, AY, AZ,		///< inertial acceleration (velocity differential) [m/s^2]
+		QW, QX, QY, QZ,		///< attitude quaternion (body to inertial)
+		WX, WY, WZ,		///< body rates [rad/s]
+		U0, U1, U2, U3,		///< motor signals
+		GROUNDED,		///< 1 if on the ground, 0 otherwise
+		NUM_ARRAYS
+	};
+
+	static constexpr int BLOCK_SIZE = 8;	///< vehicles per inner loop (the arrays are padded to a multiple)
+
+	Params _params{};
+
+	int _num_vehicles{0};
+	int _num_padded{0};
+	float *_buffer{nullptr};
+	float *_x[NUM_ARRAYS] {};
+};
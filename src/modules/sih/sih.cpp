@@ -58,9 +58,97 @@ using namespace matrix;
 
 int Sih::custom_command(int argc, char *argv[])
 {
+	if (!strcmp(argv[0], "bench")) {
+		int num_vehicles = 100;
+		int num_steps = 10000;
+		int myoptind = 1;
+		int ch;
+		const char *myoptarg = nullptr;
+
+		while ((ch = px4_getopt(argc, argv, "n:s:", &myoptind, &myoptarg)) != EOF) {
+			switch (ch) {
+			case 'n':
+				num_vehicles = atoi(myoptarg);
+				break;
+
+			case 's':
+				num_steps = atoi(myoptarg);
+				break;
+
+			default:
+				return print_usage("unrecognized flag");
+			}
+		}
+
+		if (num_vehicles <= 0 || num_steps <= 0) {
+			return print_usage("invalid number of vehicles or steps");
+		}
+
+		return bench(num_vehicles, num_steps);
+	}
+
 	return print_usage("unknown command");
 }
 
+int Sih::bench(int num_vehicles, int num_steps)
+{
+	SihBatch batch;
+
+	if (!batch.init(num_vehicles)) {
+		PX4_ERR("alloc failed");
+		return PX4_ERROR;
+	}
+
+	// the bench runs in the shell, independently of a running instance: read the airframe from the parameters
+	const auto param = [](const char *name) {
+		float value = 0.f;
+		param_get(param_find(name), &value);
+		return value;
+	};
+
+	SihBatch::Params params{};
+	params.mass = param("SIH_MASS");
+	params.t_max = param("SIH_T_MAX");
+	params.q_max = param("SIH_Q_MAX");
+	params.l_roll = param("SIH_L_ROLL");
+	params.l_pitch = param("SIH_L_PITCH");
+	params.kdv = param("SIH_KDV");
+	params.kdw = param("SIH_KDW");
+	params.I = diag(Vector3f(param("SIH_IXX"), param("SIH_IYY"), param("SIH_IZZ")));
+	params.I(0, 1) = params.I(1, 0) = param("SIH_IXY");
+	params.I(0, 2) = params.I(2, 0) = param("SIH_IXZ");
+	params.I(1, 2) = params.I(2, 1) = param("SIH_IYZ");
+	params.Im1 = inv(params.I);
+	batch.set_params(params);
+
+	// spread the vehicles around hover, so that they take off, tilt and land at different times
+	const float u_hover = params.mass * CONSTANTS_ONE_G / (NB_MOTORS * params.t_max);
+
+	for (int i = 0; i < num_vehicles; i++) {
+		const float u_i = u_hover * (0.9f + 0.2f * i / num_vehicles);
+		const float u[SihBatch::NB_MOTORS] {u_i, u_i * 1.01f, u_i, u_i * 0.99f};
+		batch.set_motors(i, u);
+	}
+
+	const float dt = LOOP_INTERVAL * 1e-6f;
+
+	struct timespec ts;
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	const hrt_abstime start = ts_to_abstime(&ts);
+
+	for (int step = 0; step < num_steps; step++) {
+		batch.step(dt);
+	}
+
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	const hrt_abstime elapsed = math::max(ts_to_abstime(&ts) - start, (hrt_abstime)1);
+
+	const double vehicle_steps = (double)num_vehicles * num_steps;
+	PX4_INFO("%i vehicles, %i steps: %.3f s, %.1f ns per vehicle step, %.0fx realtime", num_vehicles, num_steps,
+		 elapsed * 1e-6, elapsed * 1e3 / vehicle_steps, (double)num_steps * LOOP_INTERVAL / elapsed);
+	return PX4_OK;
+}
+
 
 int Sih::task_spawn(int argc, char *argv[])
 {
@@ -99,6 +187,11 @@ Sih::Sih() :
 
 void Sih::run()
 {
+	if (!_batch.init(1)) {
+		PX4_ERR("alloc failed");
+		return;
+	}
+
 	// initialize parameters
 	parameters_update_poll();
 
@@ -110,6 +203,27 @@ void Sih::run()
 	_gps_time = task_start;
 	_serial_time = task_start;
 
+#if defined(ENABLE_LOCKSTEP_SCHEDULER)
+	// with lockstep the simulator drives the time, as fast as the other lockstep components (e.g. ekf2) allow
+	hrt_abstime now = task_start;
+
+	while (!should_exit()) {
+		now += LOOP_INTERVAL;
+
+		struct timespec ts;
+		abstime_to_ts(&ts, now);
+		px4_clock_settime(CLOCK_MONOTONIC, &ts);
+
+		perf_begin(_loop_perf);
+
+		inner_loop();   // main execution function
+
+		perf_end(_loop_perf);
+
+		px4_lockstep_wait_for_components();
+	}
+
+#else
 	px4_sem_init(&_data_semaphore, 0, 0);
 
 	hrt_call_every(&_timer_call, LOOP_INTERVAL, LOOP_INTERVAL, timer_callback, &_data_semaphore);
@@ -131,6 +245,7 @@ void Sih::run()
 
 	hrt_cancel(&_timer_call);   // close the periodic timer interruption
 	px4_sem_destroy(&_data_semaphore);
+#endif
 }
 
 // timer_callback() is used as a real time callback to post the semaphore
@@ -148,8 +263,6 @@ void Sih::inner_loop()
 
 	read_motors();
 
-	generate_force_and_torques();
-
 	equations_of_motion();
 
 	reconstruct_sensors_signals();
@@ -202,8 +315,6 @@ void Sih::parameters_updated()
 
 	_MASS = _sih_mass.get();
 
-	_W_I = Vector3f(0.0f, 0.0f, _MASS * CONSTANTS_ONE_G);
-
 	_I = diag(Vector3f(_sih_ixx.get(), _sih_iyy.get(), _sih_izz.get()));
 	_I(0, 1) = _I(1, 0) = _sih_ixy.get();
 	_I(0, 2) = _I(2, 0) = _sih_ixz.get();
@@ -211,6 +322,18 @@ void Sih::parameters_updated()
 
 	_Im1 = inv(_I);
 
+	SihBatch::Params batch_params{};
+	batch_params.mass = _MASS;
+	batch_params.t_max = _T_MAX;
+	batch_params.q_max = _Q_MAX;
+	batch_params.l_roll = _L_ROLL;
+	batch_params.l_pitch = _L_PITCH;
+	batch_params.kdv = _KDV;
+	batch_params.kdw = _KDW;
+	batch_params.I = _I;
+	batch_params.Im1 = _Im1;
+	_batch.set_params(batch_params);
+
 	_mu_I = Vector3f(_sih_mu_x.get(), _sih_mu_y.get(), _sih_mu_z.get());
 }
 
@@ -223,6 +346,7 @@ void Sih::init_variables()
 	_v_I = Vector3f(0.0f, 0.0f, 0.0f);
 	_q = Quatf(1.0f, 0.0f, 0.0f, 0.0f);
 	_w_B = Vector3f(0.0f, 0.0f, 0.0f);
+	_batch.reset();
 
 	_u[0] = _u[1] = _u[2] = _u[3] = 0.0f;
 }
@@ -253,52 +377,20 @@ void Sih::read_motors()
 	}
 }
 
-// generate the motors thrust and torque in the body frame
-void Sih::generate_force_and_torques()
-{
-	_T_B = Vector3f(0.0f, 0.0f, -_T_MAX * (+_u[0] + _u[1] + _u[2] + _u[3]));
-	_Mt_B = Vector3f(_L_ROLL * _T_MAX * (-_u[0] + _u[1] + _u[2] - _u[3]),
-			 _L_PITCH * _T_MAX * (+_u[0] - _u[1] + _u[2] - _u[3]),
-			 _Q_MAX * (+_u[0] + _u[1] - _u[2] - _u[3]));
-
-	_Fa_I = -_KDV * _v_I;   // first order drag to slow down the aircraft
-	_Ma_B = -_KDW * _w_B;   // first order angular damper
-}
-
 // apply the equations of motion of a rigid body and integrate one step
 void Sih::equations_of_motion()
 {
-	_C_IB = matrix::Dcm<float>(_q); // body to inertial transformation
-
-	// Equations of motion of a rigid body
-	_p_I_dot = _v_I;                        // position differential
-	_v_I_dot = (_W_I + _Fa_I + _C_IB * _T_B) / _MASS;   // conservation of linear momentum
-	_q_dot = _q.derivative1(_w_B);              // attitude differential
-	_w_B_dot = _Im1 * (_Mt_B + _Ma_B - _w_B.cross(_I * _w_B)); // conservation of angular momentum
-
-	// fake ground, avoid free fall
-	if (_p_I(2) > 0.0f && (_v_I_dot(2) > 0.0f || _v_I(2) > 0.0f)) {
-		if (!_grounded) {    // if we just hit the floor
-			// for the accelerometer, compute the acceleration that will stop the vehicle in one time step
-			_v_I_dot = -_v_I / _dt;
+	_batch.set_motors(0, _u);
+	_batch.step(_dt);
 
-		} else {
-			_v_I_dot.setZero();
-		}
-
-		_v_I.setZero();
-		_w_B.setZero();
-		_grounded = true;
+	_p_I = _batch.position(0);
+	_v_I = _batch.velocity(0);
+	_v_I_dot = _batch.acceleration(0);
+	_q = _batch.attitude(0);
+	_w_B = _batch.angular_velocity(0);
+	_grounded = _batch.grounded(0);
 
-	} else {
-		// integration: Euler forward
-		_p_I = _p_I + _p_I_dot * _dt;
-		_v_I = _v_I + _v_I_dot * _dt;
-		_q = _q + _q_dot * _dt; // as given in attitude_estimator_q_main.cpp
-		_q.normalize();
-		_w_B = _w_B + _w_B_dot * _dt;
-		_grounded = false;
-	}
+	_C_IB = matrix::Dcm<float>(_q); // body to inertial transformation
 }
 
 // reconstruct the noisy sensor signals
@@ -454,9 +546,15 @@ This simulator publishes the sensors signals corrupted with realistic noise
 in order to incorporate the state estimator in the loop.
 
 ### Implementation
-The simulator implements the equations of motion using matrix algebra.
+The simulator implements the equations of motion of a rigid body (SihBatch).
+The states are stored as structure of arrays, so that the same step can integrate
+many vehicles at once in vectorized loops (see the bench command).
 Quaternion representation is used for the attitude.
 Forward Euler is used for integration.
+
+With the lockstep scheduler (SITL), the simulator drives the time itself and runs
+as fast as the other lockstep components allow. It then replaces the simulator module
+(e.g. make px4_sitl none_sihsim_quadx).
 Most of the variables are declared global in the .hpp file to avoid stack overflow.
 
 
@@ -464,6 +562,9 @@ Most of the variables are declared global in the .hpp file to avoid stack overfl
 
     PRINT_MODULE_USAGE_NAME("sih", "simulation");
     PRINT_MODULE_USAGE_COMMAND("start");
+    PRINT_MODULE_USAGE_COMMAND_DESCR("bench", "Measure the physics step throughput for many vehicles");
+    PRINT_MODULE_USAGE_PARAM_INT('n', 100, 1, 100000, "Number of vehicles", true);
+    PRINT_MODULE_USAGE_PARAM_INT('s', 10000, 1, 10000000, "Number of steps", true);
     PRINT_MODULE_USAGE_DEFAULT_COMMANDS();
 
     return 0;
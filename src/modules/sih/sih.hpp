@@ -37,6 +37,8 @@
 #include <px4_platform_common/module_params.h>
 #include <px4_platform_common/posix.h>
 
+#include "SihBatch.hpp"
+
 #include <matrix/matrix/math.hpp>   // matrix, vectors, dcm, quaterions
 #include <conversion/rotation.h>    // math::radians,
 #include <ecl/geo/geo.h>            // to get the physical constants
@@ -97,6 +99,9 @@ private:
 	void parameters_update_poll();
 	void parameters_updated();
 
+	/** step num_vehicles vehicles num_steps times in the calling thread, and print the throughput */
+	static int bench(int num_vehicles, int num_steps);
+
 	// simulated sensor instances
 	PX4Accelerometer _px4_accel{1310988}; // 1310988: DRV_IMU_DEVTYPE_SIM, BUS: 1, ADDR: 1, TYPE: SIMULATION
 	PX4Gyroscope     _px4_gyro{1310988};  // 1310988: DRV_IMU_DEVTYPE_SIM, BUS: 1, ADDR: 1, TYPE: SIMULATION
@@ -132,7 +137,6 @@ private:
 	void init_variables();
 	void init_sensors();
 	void read_motors();
-	void generate_force_and_torques();
 	void equations_of_motion();
 	void reconstruct_sensors_signals();
 	void send_IMU();
@@ -153,20 +157,15 @@ private:
 	float       _dt;            // sampling time [s]
 	bool        _grounded{true};// whether the vehicle is on the ground
 
-	matrix::Vector3f    _T_B;           // thrust force in body frame [N]
-	matrix::Vector3f    _Fa_I;          // aerodynamic force in inertial frame [N]
-	matrix::Vector3f    _Mt_B;          // thruster moments in the body frame [Nm]
-	matrix::Vector3f    _Ma_B;          // aerodynamic moments in the body frame [Nm]
+	SihBatch    _batch;         // rigid body dynamics (a batch of a single vehicle)
+
 	matrix::Vector3f    _p_I;           // inertial position [m]
 	matrix::Vector3f    _v_I;           // inertial velocity [m/s]
 	matrix::Vector3f    _v_B;           // body frame velocity [m/s]
-	matrix::Vector3f    _p_I_dot;       // inertial position differential
 	matrix::Vector3f    _v_I_dot;       // inertial velocity differential
 	matrix::Quatf       _q;             // quaternion attitude
 	matrix::Dcmf        _C_IB;          // body to inertial transformation
 	matrix::Vector3f    _w_B;           // body rates in body frame [rad/s]
-	matrix::Quatf       _q_dot;         // quaternion differential
-	matrix::Vector3f    _w_B_dot;       // body rates differential
 	float       _u[NB_MOTORS];  // thruster signals
 
 
@@ -184,7 +183,6 @@ private:
 	// parameters
 	float _MASS, _T_MAX, _Q_MAX, _L_ROLL, _L_PITCH, _KDV, _KDW, _H0;
 	double _LAT0, _LON0, _COS_LAT0;
-	matrix::Vector3f _W_I;  // weight of the vehicle in inertial frame [N]
 	matrix::Matrix3f _I;    // vehicle inertia matrix
 	matrix::Matrix3f _Im1;  // inverse of the intertia matrix
 	matrix::Vector3f _mu_I; // NED magnetic field in inertial frame [G]
@@ -0,0 +1,193 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <gtest/gtest.h>
+
+#include <pthread.h>
+
+#include "simulator_shm.h"
+
+using Ring = SimulatorShm::Ring;
+static constexpr uint32_t RING_SIZE = SimulatorShm::RING_SIZE;
+
+class SimulatorShmTest : public ::testing::Test
+{
+public:
+	void SetUp() override { _ring = new Ring{}; }
+	void TearDown() override { delete _ring; }
+
+	static mavlink_message_t message(uint32_t i)
+	{
+		mavlink_message_t msg{};
+		msg.seq = i & 0xff;
+		msg.msgid = i & 0xffffff;
+		return msg;
+	}
+
+	static bool pushIndex(Ring &ring, uint32_t i, int timeout_ms = 0)
+	{
+		return SimulatorShm::push(ring, message(i), timeout_ms);
+	}
+
+	static bool popIndex(Ring &ring, uint32_t &i, int timeout_ms = 0)
+	{
+		mavlink_message_t msg{};
+
+		if (SimulatorShm::pop(ring, msg, timeout_ms)) {
+			i = msg.msgid;
+			return true;
+		}
+
+		return false;
+	}
+
+	Ring *_ring{nullptr};
+};
+
+TEST_F(SimulatorShmTest, empty)
+{
+	uint32_t i = 0;
+	EXPECT_FALSE(popIndex(*_ring, i));
+
+	// a timeout of 10 ms must not return early
+	EXPECT_FALSE(popIndex(*_ring, i, 10));
+
+	EXPECT_TRUE(pushIndex(*_ring, 42));
+	EXPECT_TRUE(popIndex(*_ring, i));
+	EXPECT_EQ(i, 42u);
+	EXPECT_FALSE(popIndex(*_ring, i));
+}
+
+TEST_F(SimulatorShmTest, full)
+{
+	for (uint32_t n = 0; n < RING_SIZE; n++) {
+		EXPECT_TRUE(pushIndex(*_ring, n));
+	}
+
+	// no space left, the writer times out without overwriting anything
+	EXPECT_FALSE(pushIndex(*_ring, RING_SIZE));
+	EXPECT_FALSE(pushIndex(*_ring, RING_SIZE, 10));
+
+	uint32_t i = 0;
+	EXPECT_TRUE(popIndex(*_ring, i));
+	EXPECT_EQ(i, 0u);
+
+	// one slot free again
+	EXPECT_TRUE(pushIndex(*_ring, RING_SIZE));
+	EXPECT_FALSE(pushIndex(*_ring, RING_SIZE + 1));
+
+	for (uint32_t n = 1; n <= RING_SIZE; n++) {
+		EXPECT_TRUE(popIndex(*_ring, i));
+		EXPECT_EQ(i, n);
+	}
+
+	EXPECT_FALSE(popIndex(*_ring, i));
+}
+
+TEST_F(SimulatorShmTest, wrapAround)
+{
+	// start close to the overflow of the sequence numbers
+	_ring->head.store(UINT32_MAX - RING_SIZE / 2);
+	_ring->tail.store(UINT32_MAX - RING_SIZE / 2);
+
+	uint32_t next_push = 0;
+	uint32_t next_pop = 0;
+
+	// fill and drain by different amounts, so that the indices wrap at different positions in the ring
+	for (int round = 0; round < 10; round++) {
+		const uint32_t fill = (round % 2) ? RING_SIZE : RING_SIZE / 2 + round;
+
+		for (uint32_t n = 0; n < fill; n++) {
+			ASSERT_TRUE(pushIndex(*_ring, next_push++));
+		}
+
+		if (fill == RING_SIZE) {
+			EXPECT_FALSE(pushIndex(*_ring, next_push));
+		}
+
+		for (uint32_t n = 0; n < fill; n++) {
+			uint32_t i = 0;
+			ASSERT_TRUE(popIndex(*_ring, i));
+			EXPECT_EQ(i, next_pop++);
+		}
+
+		uint32_t i = 0;
+		EXPECT_FALSE(popIndex(*_ring, i));
+	}
+
+	// the sequence numbers overflowed
+	EXPECT_LT(_ring->head.load(), RING_SIZE * 10);
+	EXPECT_EQ(_ring->head.load(), _ring->tail.load());
+}
+
+static constexpr uint32_t NUM_MESSAGES = 100000;
+
+static void *producer(void *arg)
+{
+	Ring *ring = static_cast<Ring *>(arg);
+
+	for (uint32_t n = 0; n < NUM_MESSAGES; n++) {
+		if (!SimulatorShm::push(*ring, SimulatorShmTest::message(n), 1000)) {
+			return (void *)1;
+		}
+	}
+
+	return nullptr;
+}
+
+TEST_F(SimulatorShmTest, producerConsumer)
+{
+	// the reader and the writer block on each other (empty and full ring)
+	pthread_t thread;
+	ASSERT_EQ(pthread_create(&thread, nullptr, producer, _ring), 0);
+
+	uint32_t received = 0;
+
+	for (uint32_t n = 0; n < NUM_MESSAGES; n++) {
+		uint32_t i = 0;
+
+		if (!popIndex(*_ring, i, 1000)) {
+			break;
+		}
+
+		EXPECT_EQ(i, n);
+		received++;
+	}
+
+	void *ret = nullptr;
+	pthread_join(thread, &ret);
+
+	EXPECT_EQ(ret, nullptr);
+	EXPECT_EQ(received, NUM_MESSAGES);
+}
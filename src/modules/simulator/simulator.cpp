@@ -79,6 +79,10 @@ int Simulator::start(int argc, char *argv[])
 			_instance->set_port(atoi(argv[3]));
 		}
 
+		if (argc == 4 && strcmp(argv[2], "-m") == 0) {
+			_instance->set_shm_name(argv[3]);
+		}
+
 		_instance->run();
 
 		return 0;
@@ -91,10 +95,11 @@ int Simulator::start(int argc, char *argv[])
 
 static void usage()
 {
-	PX4_INFO("Usage: simulator {start -[spt] [-u udp_port / -c tcp_port] |stop|status}");
+	PX4_INFO("Usage: simulator {start -[spt] [-u udp_port / -c tcp_port / -m shm_name] |stop|status}");
 	PX4_INFO("Start simulator:     simulator start");
 	PX4_INFO("Connect using UDP: simulator start -u udp_port");
 	PX4_INFO("Connect using TCP: simulator start -c tcp_port");
+	PX4_INFO("Connect using shared memory (local simulator): simulator start -m shm_name");
 }
 
 __BEGIN_DECLS
@@ -149,6 +154,10 @@ int simulator_main(int argc, char *argv[])
 
 		} else {
 			PX4_INFO("running");
+
+			if (Simulator::getInstance()) {
+				Simulator::getInstance()->print_status();
+			}
 		}
 
 	} else {
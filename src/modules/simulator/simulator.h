@@ -76,6 +76,8 @@
 
 #include <random>
 
+#include "simulator_shm.h"
+
 #include <v2.0/common/mavlink.h>
 #include <v2.0/mavlink_types.h>
 
@@ -124,6 +126,11 @@ public:
 	void set_ip(InternetProtocol ip) { _ip = ip; }
 	void set_port(unsigned port) { _port = port; }
 
+	/** use the shared memory transport instead of UDP/TCP */
+	void set_shm_name(const char *name) { strncpy(_shm_name, name, sizeof(_shm_name) - 1); }
+
+	void print_status();
+
 #if defined(ENABLE_LOCKSTEP_SCHEDULER)
 	bool has_initialized() { return _has_initialized.load(); }
 #endif
@@ -138,6 +145,7 @@ private:
 		// free perf counters
 		perf_free(_perf_sim_delay);
 		perf_free(_perf_sim_interval);
+		perf_free(_perf_step_latency);
 
 		for (size_t i = 0; i < sizeof(_dist_pubs) / sizeof(_dist_pubs[0]); i++) {
 			delete _dist_pubs[i];
@@ -183,6 +191,12 @@ private:
 	perf_counter_t _perf_sim_delay{perf_alloc(PC_ELAPSED, MODULE_NAME": network delay")};
 	perf_counter_t _perf_sim_interval{perf_alloc(PC_INTERVAL, MODULE_NAME": network interval")};
 
+	// lockstep step statistics in wall clock time: from receiving HIL_SENSOR to sending the resulting controls
+	perf_counter_t _perf_step_latency{perf_alloc(PC_ELAPSED, MODULE_NAME": step latency")};
+	px4::atomic<uint64_t> _step_start_wall{0};
+	hrt_abstime _stats_start_wall{0};
+	hrt_abstime _stats_start_sim{0};
+
 	// uORB publisher handlers
 	uORB::Publication<differential_pressure_s>	_differential_pressure_pub{ORB_ID(differential_pressure)};
 	uORB::PublicationMulti<optical_flow_s>		_flow_pub{ORB_ID(optical_flow)};
@@ -201,6 +215,9 @@ private:
 
 	InternetProtocol _ip{InternetProtocol::UDP};
 
+	SimulatorShm _shm;
+	char _shm_name[32] {};
+
 	double _realtime_factor{1.0};		///< How fast the simulation runs in comparison to real system time
 
 	hrt_abstime _last_sim_timestamp{0};
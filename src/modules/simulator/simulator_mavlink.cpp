@@ -76,6 +76,14 @@ const unsigned mode_flag_custom = 1;
 
 using namespace time_literals;
 
+/** wall clock time (not affected by lockstep) [us] */
+static hrt_abstime wall_time_us()
+{
+	struct timespec ts;
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts_to_abstime(&ts);
+}
+
 mavlink_hil_actuator_controls_t Simulator::actuator_controls_from_outputs()
 {
 	mavlink_hil_actuator_controls_t msg{};
@@ -196,6 +204,13 @@ void Simulator::send_controls()
 		PX4_DEBUG("sending controls t=%ld (%ld)", _actuator_outputs.timestamp, hil_act_control.time_usec);
 
 		send_mavlink_message(message);
+
+		const hrt_abstime step_start = _step_start_wall.load();
+
+		if (step_start != 0) {
+			perf_set_elapsed(_perf_step_latency, wall_time_us() - step_start);
+			_step_start_wall.store(0);
+		}
 	}
 }
 
@@ -381,12 +396,20 @@ void Simulator::handle_message_hil_sensor(const mavlink_message_t *msg)
 	mavlink_hil_sensor_t imu;
 	mavlink_msg_hil_sensor_decode(msg, &imu);
 
+	const hrt_abstime now_wall = wall_time_us();
+	_step_start_wall.store(now_wall);
+
 	struct timespec ts;
 	abstime_to_ts(&ts, imu.time_usec);
 	px4_clock_settime(CLOCK_MONOTONIC, &ts);
 
 	hrt_abstime now_us = hrt_absolute_time();
 
+	if (_stats_start_wall == 0) {
+		_stats_start_wall = now_wall;
+		_stats_start_sim = now_us;
+	}
+
 #if 0
 	// This is just for to debug missing HIL_SENSOR messages.
 	static hrt_abstime last_time = 0;
@@ -576,6 +599,14 @@ void Simulator::handle_message_vision_position_estimate(const mavlink_message_t
 
 void Simulator::send_mavlink_message(const mavlink_message_t &aMsg)
 {
+	if (_shm_name[0] != '\0') {
+		if (!_shm.send(aMsg)) {
+			PX4_WARN("Failed sending mavlink message: shared memory ring full");
+		}
+
+		return;
+	}
+
 	uint8_t  buf[MAVLINK_MAX_PACKET_LEN];
 	uint16_t bufLen = 0;
 
@@ -648,6 +679,27 @@ void Simulator::send()
 	}
 }
 
+void Simulator::print_status()
+{
+	if (_shm_name[0] != '\0') {
+		PX4_INFO("transport: shared memory %s", _shm_name);
+
+	} else {
+		PX4_INFO("transport: %s port %u", _ip == InternetProtocol::UDP ? "UDP" : "TCP", _port);
+	}
+
+	if (_stats_start_wall != 0) {
+		const hrt_abstime wall_elapsed = wall_time_us() - _stats_start_wall;
+		const hrt_abstime sim_elapsed = hrt_absolute_time() - _stats_start_sim;
+
+		if (wall_elapsed > 0) {
+			PX4_INFO("real-time factor: %.2f", (double)sim_elapsed / wall_elapsed);
+		}
+	}
+
+	perf_print_counter(_perf_step_latency);
+}
+
 void Simulator::request_hil_state_quaternion()
 {
 	mavlink_command_long_t cmd_long = {};
@@ -682,7 +734,25 @@ void Simulator::run()
 	_myaddr.sin_addr.s_addr = htonl(INADDR_ANY);
 	_myaddr.sin_port = htons(_port);
 
-	if (_ip == InternetProtocol::UDP) {
+	if (_shm_name[0] != '\0') {
+
+		if (!_shm.create(_shm_name)) {
+			return;
+		}
+
+		PX4_INFO("Waiting for simulator to connect on shared memory %s", _shm_name);
+
+		mavlink_message_t msg;
+
+		// Once we receive something, we're most probably good and can carry on.
+		while (!_shm.receive(msg, 1000)) {
+		}
+
+		PX4_INFO("Simulator connected on shared memory %s.", _shm_name);
+
+		handle_message(&msg);
+
+	} else if (_ip == InternetProtocol::UDP) {
 
 		if ((_fd = socket(AF_INET, SOCK_DGRAM, 0)) < 0) {
 			PX4_ERR("Creating UDP socket failed: %s", strerror(errno));
@@ -766,8 +836,12 @@ void Simulator::run()
 	fds[0].events = POLLIN;
 
 #ifdef ENABLE_UART_RC_INPUT
-	// setup serial connection to autopilot (used to get manual controls)
-	int serial_fd = openUart(PIXHAWK_DEVICE, PIXHAWK_DEVICE_BAUD);
+	// setup serial connection to autopilot (used to get manual controls), not used with shared memory
+	int serial_fd = -1;
+
+	if (_shm_name[0] == '\0') {
+		serial_fd = openUart(PIXHAWK_DEVICE, PIXHAWK_DEVICE_BAUD);
+	}
 
 	char serial_buf[1024];
 
@@ -799,6 +873,17 @@ void Simulator::run()
 
 	while (true) {
 
+		if (_shm_name[0] != '\0') {
+			// messages arrive already parsed, no RC input over UART
+			mavlink_message_t msg;
+
+			if (_shm.receive(msg, 1000)) {
+				handle_message(&msg);
+			}
+
+			continue;
+		}
+
 		// wait for new mavlink messages to arrive
 		int pret = ::poll(&fds[0], fd_count, 1000);
 
@@ -0,0 +1,231 @@
+/****************************************************************************
+*
+*   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+* 3. Neither the name PX4 nor the names of its contributors may be
+*    used to endorse or promote products derived from this software
+*    without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+* ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+****************************************************************************/
+
+
+/**
+ * @file simulator_shm.cpp
+ *
+ * Shared memory transport to a local simulator.
+ */
+
+#include "simulator_shm.h"
+
+#include <px4_platform_common/log.h>
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#if defined(__PX4_LINUX)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+static_assert(sizeof(px4::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain uint32_t");
+static_assert((SimulatorShm::RING_SIZE & (SimulatorShm::RING_SIZE - 1)) == 0, "ring size must be a power of 2");
+
+SimulatorShm::~SimulatorShm()
+{
+	if (_layout) {
+		munmap(_layout, sizeof(Layout));
+		shm_unlink(_name);
+	}
+
+	pthread_mutex_destroy(&_send_mutex);
+}
+
+bool SimulatorShm::create(const char *name)
+{
+	strncpy(_name, name, sizeof(_name) - 1);
+
+	// remove a stale object of a previous run, the simulator must not attach to it
+	shm_unlink(_name);
+
+	int fd = shm_open(_name, O_CREAT | O_RDWR, 0666);
+
+	if (fd < 0) {
+		PX4_ERR("shm_open %s failed: %s", _name, strerror(errno));
+		return false;
+	}
+
+	if (ftruncate(fd, sizeof(Layout)) != 0) {
+		PX4_ERR("ftruncate %s failed: %s", _name, strerror(errno));
+		::close(fd);
+		shm_unlink(_name);
+		return false;
+	}
+
+	void *ptr = mmap(nullptr, sizeof(Layout), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	::close(fd);
+
+	if (ptr == MAP_FAILED) {
+		PX4_ERR("mmap %s failed: %s", _name, strerror(errno));
+		shm_unlink(_name);
+		return false;
+	}
+
+	// the object is zero-initialized by ftruncate, which is a valid empty state for both rings
+	_layout = static_cast<Layout *>(ptr);
+	_layout->version = VERSION;
+	_layout->ring_size = RING_SIZE;
+	_layout->message_size = sizeof(mavlink_message_t);
+
+	// publish the magic last, the simulator must not use the rings before
+	__atomic_store_n(&_layout->magic, MAGIC, __ATOMIC_SEQ_CST);
+
+	return true;
+}
+
+bool SimulatorShm::send(const mavlink_message_t &msg, int timeout_ms)
+{
+	if (!_layout) {
+		return false;
+	}
+
+	// the ring has a single producer, but the sender thread and the receiving thread both send
+	pthread_mutex_lock(&_send_mutex);
+	const bool ret = push(_layout->to_simulator, msg, timeout_ms);
+	pthread_mutex_unlock(&_send_mutex);
+
+	return ret;
+}
+
+bool SimulatorShm::receive(mavlink_message_t &msg, int timeout_ms)
+{
+	return _layout && pop(_layout->to_px4, msg, timeout_ms);
+}
+
+bool SimulatorShm::push(Ring &ring, const mavlink_message_t &msg, int timeout_ms)
+{
+	const uint32_t head = ring.head.load();
+
+	if (head - ring.tail.load() >= RING_SIZE) {
+		const uint64_t deadline = wall_time_ms() + timeout_ms;
+		ring.writer_waiting.store(1);
+
+		// check again after announcing the wait, the reader might have advanced in between
+		uint32_t tail;
+
+		while (head - (tail = ring.tail.load()) >= RING_SIZE) {
+			const uint64_t now = wall_time_ms();
+
+			if (now >= deadline) {
+				ring.writer_waiting.store(0);
+				return false;
+			}
+
+			wait(ring.tail, tail, deadline - now);
+		}
+
+		ring.writer_waiting.store(0);
+	}
+
+	ring.messages[head % RING_SIZE] = msg;
+	ring.head.store(head + 1);
+
+	if (ring.reader_waiting.load()) {
+		wake(ring.head);
+	}
+
+	return true;
+}
+
+bool SimulatorShm::pop(Ring &ring, mavlink_message_t &msg, int timeout_ms)
+{
+	const uint32_t tail = ring.tail.load();
+
+	if (ring.head.load() == tail) {
+		const uint64_t deadline = wall_time_ms() + timeout_ms;
+		ring.reader_waiting.store(1);
+
+		// check again after announcing the wait, the writer might have advanced in between
+		while (ring.head.load() == tail) {
+			const uint64_t now = wall_time_ms();
+
+			if (now >= deadline) {
+				ring.reader_waiting.store(0);
+				return false;
+			}
+
+			wait(ring.head, tail, deadline - now);
+		}
+
+		ring.reader_waiting.store(0);
+	}
+
+	msg = ring.messages[tail % RING_SIZE];
+	ring.tail.store(tail + 1);
+
+	if (ring.writer_waiting.load()) {
+		wake(ring.tail);
+	}
+
+	return true;
+}
+
+uint64_t SimulatorShm::wall_time_ms()
+{
+	// not affected by lockstep
+	struct timespec ts;
+	system_clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+void SimulatorShm::wait(px4::atomic<uint32_t> &word, uint32_t value, uint64_t timeout_ms)
+{
+#if defined(__PX4_LINUX)
+	struct timespec timeout;
+	timeout.tv_sec = timeout_ms / 1000;
+	timeout.tv_nsec = (timeout_ms % 1000) * 1000000;
+
+	// returns right away if the word changed already, the caller checks the ring again in any case
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT, value, &timeout, nullptr, 0);
+#else
+	// no futex: poll with a short sleep
+	if (word.load() == value) {
+		system_usleep(100);
+	}
+
+#endif
+}
+
+void SimulatorShm::wake(px4::atomic<uint32_t> &word)
+{
+#if defined(__PX4_LINUX)
+	syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAKE, 1, nullptr, nullptr, 0);
+#else
+	(void)word;
+#endif
+}
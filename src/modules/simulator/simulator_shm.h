@@ -0,0 +1,134 @@
+/****************************************************************************
+*
+*   Copyright (c) 2021 PX4 Development Team. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions
+* are met:
+*
+* 1. Redistributions of source code must retain the above copyright
+*    notice, this list of conditions and the following disclaimer.
+* 2. Redistributions in binary form must reproduce the above copyright
+*    notice, this list of conditions and the following disclaimer in
+*    the documentation and/or other materials provided with the
+*    distribution.
+* 3. Neither the name PX4 nor the names of its contributors may be
+*    used to endorse or promote products derived from this software
+*    without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+* FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+* COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+* INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+* BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+* OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+* AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+* LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+* ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+****************************************************************************/
+
+
+/**
+ * @file simulator_shm.h
+ *
+ * Shared memory transport between the simulator module and a simulator running
+ * on the same machine. It carries the same MAVLink messages as the UDP/TCP
+ * connection (HIL_SENSOR, HIL_GPS, HIL_ACTUATOR_CONTROLS, ...), but as
+ * mavlink_message_t structs in two single-producer single-consumer rings,
+ * which avoids the serialization, the parsing and the socket round trip of
+ * every lockstep step. On the PX4 side, several threads send (e.g. heartbeat
+ * and controls), so send() serializes the producers with a mutex.
+ *
+ * The simulator module creates the shared memory object. The simulator opens
+ * it, checks magic and version, and from then on writes into to_px4 and reads
+ * from to_simulator. A side that finds a ring empty (reader) or full (writer)
+ * sets the corresponding waiting flag and sleeps on the sequence number with
+ * a futex, so that the other side only needs a system call when someone
+ * actually sleeps.
+ */
+
+#pragma once
+
+#include <px4_platform_common/atomic.h>
+
+#include <pthread.h>
+#include <stdint.h>
+
+#include <v2.0/mavlink_types.h>
+
+class SimulatorShm
+{
+public:
+	static constexpr uint32_t MAGIC = 0x50583453; // "PX4S"
+	static constexpr uint32_t VERSION = 1;
+	static constexpr uint32_t RING_SIZE = 64; // number of messages, power of 2
+
+	struct Ring {
+		px4::atomic<uint32_t> head;		///< write sequence (futex word of a waiting reader)
+		px4::atomic<uint32_t> tail;		///< read sequence (futex word of a waiting writer)
+		px4::atomic<uint32_t> reader_waiting;
+		px4::atomic<uint32_t> writer_waiting;
+		mavlink_message_t messages[RING_SIZE];
+	};
+
+	struct Layout {
+		uint32_t magic;
+		uint32_t version;
+		uint32_t ring_size;
+		uint32_t message_size;		///< sizeof(mavlink_message_t), to detect mismatching MAVLink headers
+		Ring to_px4;			///< written by the simulator
+		Ring to_simulator;		///< written by PX4
+	};
+
+	SimulatorShm() = default;
+	~SimulatorShm();
+
+	SimulatorShm(const SimulatorShm &) = delete;
+	SimulatorShm &operator=(const SimulatorShm &) = delete;
+
+	/**
+	 * Create (or re-create) the shared memory object and initialize it
+	 * @param name shared memory object name, e.g. "/px4_sim_0"
+	 * @return true on success
+	 */
+	bool create(const char *name);
+
+	/**
+	 * Send a message to the simulator. Blocks while the ring is full.
+	 * thread-safe
+	 * @return false if the ring stayed full for timeout_ms
+	 */
+	bool send(const mavlink_message_t &msg, int timeout_ms = 1000);
+
+	/**
+	 * Receive a message from the simulator
+	 * @return false on timeout
+	 */
+	bool receive(mavlink_message_t &msg, int timeout_ms);
+
+	/**
+	 * Write a message into a ring (single producer). Blocks while the ring is full.
+	 * @return false if the ring stayed full for timeout_ms
+	 */
+	static bool push(Ring &ring, const mavlink_message_t &msg, int timeout_ms);
+
+	/**
+	 * Read a message from a ring (single consumer). Blocks while the ring is empty.
+	 * @return false if the ring stayed empty for timeout_ms
+	 */
+	static bool pop(Ring &ring, mavlink_message_t &msg, int timeout_ms);
+
+private:
+	static uint64_t wall_time_ms();
+	static void wait(px4::atomic<uint32_t> &word, uint32_t value, uint64_t timeout_ms);
+	static void wake(px4::atomic<uint32_t> &word);
+
+	Layout *_layout{nullptr};
+	char _name[32] {};
+
+	pthread_mutex_t _send_mutex = PTHREAD_MUTEX_INITIALIZER;
+};
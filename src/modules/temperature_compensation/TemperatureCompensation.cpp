@@ -53,11 +53,16 @@ int TemperatureCompensation::initialize_parameter_handles(ParameterHandles &para
 	int ret = PX4_ERROR;
 
 	/* rate gyro calibration parameters */
-	parameter_handles.gyro_tc_enable = param_find("TC_G_ENABLE");
+	if (parameter_handles.gyro_tc_enable == PARAM_INVALID) {
+		parameter_handles.gyro_tc_enable = param_find("TC_G_ENABLE");
+	}
+
 	int32_t gyro_tc_enabled = 0;
 	ret = param_get(parameter_handles.gyro_tc_enable, &gyro_tc_enabled);
 
-	if (ret == PX4_OK && gyro_tc_enabled) {
+	if (ret == PX4_OK && gyro_tc_enabled && !parameter_handles.gyro_cal_handles_found) {
+		parameter_handles.gyro_cal_handles_found = true;
+
 		for (unsigned j = 0; j < GYRO_COUNT_MAX; j++) {
 			sprintf(nbuf, "TC_G%d_ID", j);
 			parameter_handles.gyro_cal_handles[j].ID = param_find(nbuf);
@@ -83,11 +88,16 @@ int TemperatureCompensation::initialize_parameter_handles(ParameterHandles &para
 	}
 
 	/* accelerometer calibration parameters */
-	parameter_handles.accel_tc_enable = param_find("TC_A_ENABLE");
+	if (parameter_handles.accel_tc_enable == PARAM_INVALID) {
+		parameter_handles.accel_tc_enable = param_find("TC_A_ENABLE");
+	}
+
 	int32_t accel_tc_enabled = 0;
 	ret = param_get(parameter_handles.accel_tc_enable, &accel_tc_enabled);
 
-	if (ret == PX4_OK && accel_tc_enabled) {
+	if (ret == PX4_OK && accel_tc_enabled && !parameter_handles.accel_cal_handles_found) {
+		parameter_handles.accel_cal_handles_found = true;
+
 		for (unsigned j = 0; j < ACCEL_COUNT_MAX; j++) {
 			sprintf(nbuf, "TC_A%d_ID", j);
 			parameter_handles.accel_cal_handles[j].ID = param_find(nbuf);
@@ -113,11 +123,16 @@ int TemperatureCompensation::initialize_parameter_handles(ParameterHandles &para
 	}
 
 	/* barometer calibration parameters */
-	parameter_handles.baro_tc_enable = param_find("TC_B_ENABLE");
+	if (parameter_handles.baro_tc_enable == PARAM_INVALID) {
+		parameter_handles.baro_tc_enable = param_find("TC_B_ENABLE");
+	}
+
 	int32_t baro_tc_enabled = 0;
 	ret = param_get(parameter_handles.baro_tc_enable, &baro_tc_enabled);
 
-	if (ret == PX4_OK && baro_tc_enabled) {
+	if (ret == PX4_OK && baro_tc_enabled && !parameter_handles.baro_cal_handles_found) {
+		parameter_handles.baro_cal_handles_found = true;
+
 		for (unsigned j = 0; j < BARO_COUNT_MAX; j++) {
 			sprintf(nbuf, "TC_B%d_ID", j);
 			parameter_handles.baro_cal_handles[j].ID = param_find(nbuf);
@@ -147,7 +162,7 @@ int TemperatureCompensation::initialize_parameter_handles(ParameterHandles &para
 
 int TemperatureCompensation::parameters_update()
 {
-	ParameterHandles parameter_handles;
+	ParameterHandles &parameter_handles = _parameter_handles;
 	int ret = initialize_parameter_handles(parameter_handles);
 
 	if (ret != 0) {
@@ -159,25 +174,31 @@ int TemperatureCompensation::parameters_update()
 
 	if (_parameters.gyro_tc_enable == 1) {
 		for (unsigned j = 0; j < GYRO_COUNT_MAX; j++) {
-			if (param_get(parameter_handles.gyro_cal_handles[j].ID, &(_parameters.gyro_cal_data[j].ID)) == PX4_OK) {
-				param_get(parameter_handles.gyro_cal_handles[j].ref_temp, &(_parameters.gyro_cal_data[j].ref_temp));
-				param_get(parameter_handles.gyro_cal_handles[j].min_temp, &(_parameters.gyro_cal_data[j].min_temp));
-				param_get(parameter_handles.gyro_cal_handles[j].max_temp, &(_parameters.gyro_cal_data[j].max_temp));
+			SensorCalData3D cal_data{};
+
+			if (param_get(parameter_handles.gyro_cal_handles[j].ID, &cal_data.ID) == PX4_OK) {
+				param_get(parameter_handles.gyro_cal_handles[j].ref_temp, &cal_data.ref_temp);
+				param_get(parameter_handles.gyro_cal_handles[j].min_temp, &cal_data.min_temp);
+				param_get(parameter_handles.gyro_cal_handles[j].max_temp, &cal_data.max_temp);
 
 				for (unsigned int i = 0; i < 3; i++) {
-					param_get(parameter_handles.gyro_cal_handles[j].x3[i], &(_parameters.gyro_cal_data[j].x3[i]));
-					param_get(parameter_handles.gyro_cal_handles[j].x2[i], &(_parameters.gyro_cal_data[j].x2[i]));
-					param_get(parameter_handles.gyro_cal_handles[j].x1[i], &(_parameters.gyro_cal_data[j].x1[i]));
-					param_get(parameter_handles.gyro_cal_handles[j].x0[i], &(_parameters.gyro_cal_data[j].x0[i]));
+					param_get(parameter_handles.gyro_cal_handles[j].x3[i], &cal_data.x3[i]);
+					param_get(parameter_handles.gyro_cal_handles[j].x2[i], &cal_data.x2[i]);
+					param_get(parameter_handles.gyro_cal_handles[j].x1[i], &cal_data.x1[i]);
+					param_get(parameter_handles.gyro_cal_handles[j].x0[i], &cal_data.x0[i]);
 				}
 
 			} else {
-				// Set all cal values to zero
-				memset(&_parameters.gyro_cal_data[j], 0, sizeof(_parameters.gyro_cal_data[j]));
-
+				// keep all cal values at zero
 				PX4_WARN("FAIL GYRO %d CAL PARAM LOAD - USING DEFAULTS", j);
 				ret = PX4_ERROR;
 			}
+
+			// the lookup table only needs to be regenerated if the calibration changed
+			if ((memcmp(&cal_data, &_parameters.gyro_cal_data[j], sizeof(cal_data)) != 0) || !_gyro_tables[j].valid()) {
+				_parameters.gyro_cal_data[j] = cal_data;
+				update_table(cal_data, _gyro_tables[j]);
+			}
 		}
 	}
 
@@ -186,25 +207,31 @@ int TemperatureCompensation::parameters_update()
 
 	if (_parameters.accel_tc_enable == 1) {
 		for (unsigned j = 0; j < ACCEL_COUNT_MAX; j++) {
-			if (param_get(parameter_handles.accel_cal_handles[j].ID, &(_parameters.accel_cal_data[j].ID)) == PX4_OK) {
-				param_get(parameter_handles.accel_cal_handles[j].ref_temp, &(_parameters.accel_cal_data[j].ref_temp));
-				param_get(parameter_handles.accel_cal_handles[j].min_temp, &(_parameters.accel_cal_data[j].min_temp));
-				param_get(parameter_handles.accel_cal_handles[j].max_temp, &(_parameters.accel_cal_data[j].max_temp));
+			SensorCalData3D cal_data{};
+
+			if (param_get(parameter_handles.accel_cal_handles[j].ID, &cal_data.ID) == PX4_OK) {
+				param_get(parameter_handles.accel_cal_handles[j].ref_temp, &cal_data.ref_temp);
+				param_get(parameter_handles.accel_cal_handles[j].min_temp, &cal_data.min_temp);
+				param_get(parameter_handles.accel_cal_handles[j].max_temp, &cal_data.max_temp);
 
 				for (unsigned int i = 0; i < 3; i++) {
-					param_get(parameter_handles.accel_cal_handles[j].x3[i], &(_parameters.accel_cal_data[j].x3[i]));
-					param_get(parameter_handles.accel_cal_handles[j].x2[i], &(_parameters.accel_cal_data[j].x2[i]));
-					param_get(parameter_handles.accel_cal_handles[j].x1[i], &(_parameters.accel_cal_data[j].x1[i]));
-					param_get(parameter_handles.accel_cal_handles[j].x0[i], &(_parameters.accel_cal_data[j].x0[i]));
+					param_get(parameter_handles.accel_cal_handles[j].x3[i], &cal_data.x3[i]);
+					param_get(parameter_handles.accel_cal_handles[j].x2[i], &cal_data.x2[i]);
+					param_get(parameter_handles.accel_cal_handles[j].x1[i], &cal_data.x1[i]);
+					param_get(parameter_handles.accel_cal_handles[j].x0[i], &cal_data.x0[i]);
 				}
 
 			} else {
-				// Set all cal values to zero
-				memset(&_parameters.accel_cal_data[j], 0, sizeof(_parameters.accel_cal_data[j]));
-
+				// keep all cal values at zero
 				PX4_WARN("FAIL ACCEL %d CAL PARAM LOAD - USING DEFAULTS", j);
 				ret = PX4_ERROR;
 			}
+
+			// the lookup table only needs to be regenerated if the calibration changed
+			if ((memcmp(&cal_data, &_parameters.accel_cal_data[j], sizeof(cal_data)) != 0) || !_accel_tables[j].valid()) {
+				_parameters.accel_cal_data[j] = cal_data;
+				update_table(cal_data, _accel_tables[j]);
+			}
 		}
 	}
 
@@ -213,24 +240,30 @@ int TemperatureCompensation::parameters_update()
 
 	if (_parameters.baro_tc_enable == 1) {
 		for (unsigned j = 0; j < BARO_COUNT_MAX; j++) {
-			if (param_get(parameter_handles.baro_cal_handles[j].ID, &(_parameters.baro_cal_data[j].ID)) == PX4_OK) {
-				param_get(parameter_handles.baro_cal_handles[j].ref_temp, &(_parameters.baro_cal_data[j].ref_temp));
-				param_get(parameter_handles.baro_cal_handles[j].min_temp, &(_parameters.baro_cal_data[j].min_temp));
-				param_get(parameter_handles.baro_cal_handles[j].max_temp, &(_parameters.baro_cal_data[j].max_temp));
-				param_get(parameter_handles.baro_cal_handles[j].x5, &(_parameters.baro_cal_data[j].x5));
-				param_get(parameter_handles.baro_cal_handles[j].x4, &(_parameters.baro_cal_data[j].x4));
-				param_get(parameter_handles.baro_cal_handles[j].x3, &(_parameters.baro_cal_data[j].x3));
-				param_get(parameter_handles.baro_cal_handles[j].x2, &(_parameters.baro_cal_data[j].x2));
-				param_get(parameter_handles.baro_cal_handles[j].x1, &(_parameters.baro_cal_data[j].x1));
-				param_get(parameter_handles.baro_cal_handles[j].x0, &(_parameters.baro_cal_data[j].x0));
+			SensorCalData1D cal_data{};
+
+			if (param_get(parameter_handles.baro_cal_handles[j].ID, &cal_data.ID) == PX4_OK) {
+				param_get(parameter_handles.baro_cal_handles[j].ref_temp, &cal_data.ref_temp);
+				param_get(parameter_handles.baro_cal_handles[j].min_temp, &cal_data.min_temp);
+				param_get(parameter_handles.baro_cal_handles[j].max_temp, &cal_data.max_temp);
+				param_get(parameter_handles.baro_cal_handles[j].x5, &cal_data.x5);
+				param_get(parameter_handles.baro_cal_handles[j].x4, &cal_data.x4);
+				param_get(parameter_handles.baro_cal_handles[j].x3, &cal_data.x3);
+				param_get(parameter_handles.baro_cal_handles[j].x2, &cal_data.x2);
+				param_get(parameter_handles.baro_cal_handles[j].x1, &cal_data.x1);
+				param_get(parameter_handles.baro_cal_handles[j].x0, &cal_data.x0);
 
 			} else {
-				// Set all cal values to zero
-				memset(&_parameters.baro_cal_data[j], 0, sizeof(_parameters.baro_cal_data[j]));
-
+				// keep all cal values at zero
 				PX4_WARN("FAIL BARO %d CAL PARAM LOAD - USING DEFAULTS", j);
 				ret = PX4_ERROR;
 			}
+
+			// the lookup table only needs to be regenerated if the calibration changed
+			if ((memcmp(&cal_data, &_parameters.baro_cal_data[j], sizeof(cal_data)) != 0) || !_baro_tables[j].valid()) {
+				_parameters.baro_cal_data[j] = cal_data;
+				update_table(cal_data, _baro_tables[j]);
+			}
 		}
 	}
 
@@ -244,7 +277,7 @@ int TemperatureCompensation::parameters_update()
 	return ret;
 }
 
-bool TemperatureCompensation::calc_thermal_offsets_1D(SensorCalData1D &coef, float measured_temp, float &offset)
+bool TemperatureCompensation::calc_thermal_offsets_1D(const SensorCalData1D &coef, float measured_temp, float &offset)
 {
 	bool ret = true;
 
@@ -311,6 +344,35 @@ bool TemperatureCompensation::calc_thermal_offsets_3D(const SensorCalData3D &coe
 	return ret;
 }
 
+template<typename COEF, typename TABLE>
+void TemperatureCompensation::update_table(const COEF &coef, TABLE &table)
+{
+	table.generate(coef.min_temp, coef.max_temp, [&coef](float temperature, float offset[]) {
+		calc_thermal_offsets(coef, temperature, offset);
+	});
+}
+
+template<typename COEF, typename TABLE>
+const float *TemperatureCompensation::lookup_offsets(const COEF &coef, const TABLE &table, PerSensorData &sensor_data,
+		int topic_instance, float temperature)
+{
+	float *offsets = sensor_data.offsets[topic_instance];
+
+	// skip the calculation if the temperature barely changed (NAN after a reset)
+	if (!(fabsf(temperature - sensor_data.lookup_temperature[topic_instance]) < LOOKUP_TEMPERATURE_THRESHOLD)) {
+		if (table.valid()) {
+			table.lookup(temperature, offsets);
+
+		} else {
+			calc_thermal_offsets(coef, temperature, offsets);
+		}
+
+		sensor_data.lookup_temperature[topic_instance] = temperature;
+	}
+
+	return offsets;
+}
+
 int TemperatureCompensation::set_sensor_id_gyro(uint32_t device_id, int topic_instance)
 {
 	if (_parameters.gyro_tc_enable != 1) {
@@ -344,7 +406,13 @@ int TemperatureCompensation::set_sensor_id(uint32_t device_id, int topic_instanc
 {
 	for (int i = 0; i < sensor_count_max; ++i) {
 		if (device_id == (uint32_t)sensor_cal_data[i].ID) {
-			sensor_data.device_mapping[topic_instance] = i;
+			if (sensor_data.device_mapping[topic_instance] != i) {
+				// the cached offsets belong to the previous device, recalculate and publish them again
+				sensor_data.device_mapping[topic_instance] = i;
+				sensor_data.last_temperature[topic_instance] = -100.0f;
+				sensor_data.lookup_temperature[topic_instance] = NAN;
+			}
+
 			return i;
 		}
 	}
@@ -367,7 +435,8 @@ int TemperatureCompensation::update_offsets_gyro(int topic_instance, float tempe
 	}
 
 	// Calculate and update the offsets
-	calc_thermal_offsets_3D(_parameters.gyro_cal_data[mapping], temperature, offsets);
+	memcpy(offsets, lookup_offsets(_parameters.gyro_cal_data[mapping], _gyro_tables[mapping], _gyro_data, topic_instance,
+				       temperature), 3 * sizeof(float));
 
 	// Check if temperature delta is large enough to warrant a new publication
 	if (fabsf(temperature - _gyro_data.last_temperature[topic_instance]) > 1.0f) {
@@ -393,7 +462,8 @@ int TemperatureCompensation::update_offsets_accel(int topic_instance, float temp
 	}
 
 	// Calculate and update the offsets
-	calc_thermal_offsets_3D(_parameters.accel_cal_data[mapping], temperature, offsets);
+	memcpy(offsets, lookup_offsets(_parameters.accel_cal_data[mapping], _accel_tables[mapping], _accel_data, topic_instance,
+				       temperature), 3 * sizeof(float));
 
 	// Check if temperature delta is large enough to warrant a new publication
 	if (fabsf(temperature - _accel_data.last_temperature[topic_instance]) > 1.0f) {
@@ -419,7 +489,8 @@ int TemperatureCompensation::update_offsets_baro(int topic_instance, float tempe
 	}
 
 	// Calculate and update the offsets
-	calc_thermal_offsets_1D(_parameters.baro_cal_data[mapping], temperature, *offsets);
+	*offsets = lookup_offsets(_parameters.baro_cal_data[mapping], _baro_tables[mapping], _baro_data, topic_instance,
+				  temperature)[0];
 
 	// Check if temperature delta is large enough to warrant a new publication
 	if (fabsf(temperature - _baro_data.last_temperature[topic_instance]) > 1.0f) {
@@ -440,7 +511,8 @@ void TemperatureCompensation::print_status()
 			uint8_t mapping = _gyro_data.device_mapping[i];
 
 			if (_gyro_data.device_mapping[i] != 255) {
-				PX4_INFO("  using device ID %i for topic instance %i", _parameters.gyro_cal_data[mapping].ID, i);
+				PX4_INFO("  using device ID %i for topic instance %i%s", _parameters.gyro_cal_data[mapping].ID, i,
+					 _gyro_tables[mapping].valid() ? " (lookup table)" : "");
 			}
 		}
 	}
@@ -452,7 +524,8 @@ void TemperatureCompensation::print_status()
 			uint8_t mapping = _accel_data.device_mapping[i];
 
 			if (_accel_data.device_mapping[i] != 255) {
-				PX4_INFO("  using device ID %i for topic instance %i", _parameters.accel_cal_data[mapping].ID, i);
+				PX4_INFO("  using device ID %i for topic instance %i%s", _parameters.accel_cal_data[mapping].ID, i,
+					 _accel_tables[mapping].valid() ? " (lookup table)" : "");
 			}
 		}
 	}
@@ -464,7 +537,8 @@ void TemperatureCompensation::print_status()
 			uint8_t mapping = _baro_data.device_mapping[i];
 
 			if (_baro_data.device_mapping[i] != 255) {
-				PX4_INFO("  using device ID %i for topic instance %i", _parameters.baro_cal_data[mapping].ID, i);
+				PX4_INFO("  using device ID %i for topic instance %i%s", _parameters.baro_cal_data[mapping].ID, i,
+					 _baro_tables[mapping].valid() ? " (lookup table)" : "");
 			}
 		}
 	}
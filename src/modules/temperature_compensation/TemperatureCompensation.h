@@ -46,6 +46,8 @@
 #include <mathlib/mathlib.h>
 #include <matrix/math.hpp>
 
+#include "TemperatureCompensationTable.h"
+
 namespace temperature_compensation
 {
 
@@ -63,6 +65,8 @@ static constexpr uint8_t SENSOR_COUNT_MAX = 4;
 /**
  ** class TemperatureCompensation
  * Applies temperature compensation to sensor data. Loads the parameters from PX4 param storage.
+ * The offsets are published on sensor_correction. FIFO consumers (VehicleAngularVelocity, VehicleIMU)
+ * apply them once per filtered or integrated output, not to every raw FIFO sample.
  */
 class TemperatureCompensation
 {
@@ -97,6 +101,9 @@ public:
 	void print_status();
 private:
 
+	/* Offsets are only recalculated if the temperature changed by more than this (deg C) */
+	static constexpr float LOOKUP_TEMPERATURE_THRESHOLD = 0.05f;
+
 	/* Struct containing parameters used by the single axis 5th order temperature compensation algorithm
 
 	Input:
@@ -198,11 +205,16 @@ private:
 
 		param_t baro_tc_enable{PARAM_INVALID};
 		SensorCalHandles1D baro_cal_handles[BARO_COUNT_MAX] {};
+
+		// the TC_* handles are only looked up once a compensation gets enabled
+		bool gyro_cal_handles_found{false};
+		bool accel_cal_handles_found{false};
+		bool baro_cal_handles_found{false};
 	};
 
 
 	/**
-	 * initialize ParameterHandles struct
+	 * initialize ParameterHandles struct. Handles already found are kept.
 	 * @return 0 on succes, <0 on error
 	 */
 	static int initialize_parameter_handles(ParameterHandles &parameter_handles);
@@ -225,7 +237,7 @@ private:
 	Boolean true if the measured temperature is inside the valid range for the compensation
 
 	*/
-	bool calc_thermal_offsets_1D(SensorCalData1D &coef, float measured_temp, float &offset);
+	static bool calc_thermal_offsets_1D(const SensorCalData1D &coef, float measured_temp, float &offset);
 
 	/**
 
@@ -244,10 +256,36 @@ private:
 	Boolean true if the measured temperature is inside the valid range for the compensation
 
 	*/
-	bool calc_thermal_offsets_3D(const SensorCalData3D &coef, float measured_temp, float offset[]);
+	static bool calc_thermal_offsets_3D(const SensorCalData3D &coef, float measured_temp, float offset[]);
+
 
+	static bool calc_thermal_offsets(const SensorCalData1D &coef, float measured_temp, float offset[])
+	{
+		return calc_thermal_offsets_1D(coef, measured_temp, offset[0]);
+	}
+
+	static bool calc_thermal_offsets(const SensorCalData3D &coef, float measured_temp, float offset[])
+	{
+		return calc_thermal_offsets_3D(coef, measured_temp, offset);
+	}
+
+	using Table1D = TemperatureCompensationTable<1>;
+	using Table3D = TemperatureCompensationTable<3>;
+
+	/**
+	 * Regenerate a lookup table from the calibration coefficients.
+	 * The table stays invalid if the calibration range is empty, the polynomial is used directly in that case.
+	 */
+	template<typename COEF, typename TABLE>
+	static void update_table(const COEF &coef, TABLE &table);
 
 	Parameters _parameters;
+	ParameterHandles _parameter_handles;
+
+	// offset lookup tables, generated from _parameters
+	Table3D _gyro_tables[GYRO_COUNT_MAX];
+	Table3D _accel_tables[ACCEL_COUNT_MAX];
+	Table1D _baro_tables[BARO_COUNT_MAX];
 
 
 	struct PerSensorData {
@@ -257,6 +295,7 @@ private:
 			for (int i = 0; i < SENSOR_COUNT_MAX; ++i) {
 				device_mapping[i] = 255;
 				last_temperature[i] = -100.0f;
+				lookup_temperature[i] = NAN;
 			}
 		}
 
@@ -264,17 +303,29 @@ private:
 		{
 			for (int i = 0; i < SENSOR_COUNT_MAX; ++i) {
 				last_temperature[i] = -100.0f;
+				lookup_temperature[i] = NAN;
 			}
 		}
 
 		uint8_t device_mapping[SENSOR_COUNT_MAX] {}; /// map a topic instance to the parameters index
 		float last_temperature[SENSOR_COUNT_MAX] {};
+		float lookup_temperature[SENSOR_COUNT_MAX] {}; /// temperature the cached offsets were calculated for
+		float offsets[SENSOR_COUNT_MAX][3] {}; /// cached offsets (baro: only the first element is used)
 	};
 
 	PerSensorData _gyro_data;
 	PerSensorData _accel_data;
 	PerSensorData _baro_data;
 
+	/**
+	 * Get the offsets of a topic instance (from the table or the polynomial).
+	 * The cached offsets are used if the temperature did not change by more than LOOKUP_TEMPERATURE_THRESHOLD.
+	 * @return cached offsets of the topic instance
+	 */
+	template<typename COEF, typename TABLE>
+	static const float *lookup_offsets(const COEF &coef, const TABLE &table, PerSensorData &sensor_data,
+					   int topic_instance, float temperature);
+
 	template<typename T>
 	static inline int set_sensor_id(uint32_t device_id, int topic_instance, PerSensorData &sensor_data,
 					const T *sensor_cal_data, uint8_t sensor_count_max);
@@ -0,0 +1,141 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file TemperatureCompensationTable.h
+ *
+ * Lookup table of thermal offsets with linear interpolation, generated from the calibration polynomials.
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace temperature_compensation
+{
+
+/**
+ * Thermal offsets of AXES axes, sampled at SIZE equally spaced temperatures over the calibration range.
+ */
+template<int AXES, int SIZE = 33>
+class TemperatureCompensationTable
+{
+public:
+	static_assert(AXES > 0, "invalid number of axes");
+	static_assert(SIZE >= 2, "at least 2 table entries required");
+
+	/**
+	 * (Re)generate the table.
+	 * @param min_temp minimum temperature with valid compensation data
+	 * @param max_temp maximum temperature with valid compensation data
+	 * @param calc_offsets callable (float temperature, float offset[AXES]) evaluating the calibration polynomial
+	 * @return true if the table is valid (the temperature range is not empty)
+	 */
+	template<typename F>
+	bool generate(float min_temp, float max_temp, F calc_offsets)
+	{
+		_valid = false;
+
+		if (!(max_temp > min_temp)) {
+			return false;
+		}
+
+		const float step = (max_temp - min_temp) / (SIZE - 1);
+
+		for (int i = 0; i < SIZE - 1; i++) {
+			calc_offsets(min_temp + i * step, _offsets[i]);
+		}
+
+		// evaluate the last entry exactly at max_temp, not subject to rounding of the step
+		calc_offsets(max_temp, _offsets[SIZE - 1]);
+
+		_min_temp = min_temp;
+		_max_temp = max_temp;
+		_inv_step = 1.f / step;
+		_valid = true;
+
+		return true;
+	}
+
+	void reset() { _valid = false; }
+
+	bool valid() const { return _valid; }
+
+	/**
+	 * Interpolate the offsets for a temperature.
+	 * If the temperature is outside the calibration range, it is clipped to the range (NAN is clipped to the minimum).
+	 * @param offset returns the offsets (length = AXES)
+	 * @return true if the temperature is inside the valid range for the compensation
+	 */
+	bool lookup(float temperature, float offset[AXES]) const
+	{
+		bool ret = true;
+		float index = (temperature - _min_temp) * _inv_step;
+
+		if (temperature > _max_temp) {
+			index = SIZE - 1;
+			ret = false;
+
+		} else if (!(temperature >= _min_temp)) {
+			index = 0.f;
+			ret = false;
+		}
+
+		// the last interval includes max_temp
+		int i = static_cast<int>(index);
+
+		if (i > SIZE - 2) {
+			i = SIZE - 2;
+		}
+
+		const float fraction = index - i;
+
+		for (int axis = 0; axis < AXES; axis++) {
+			offset[axis] = _offsets[i][axis] + fraction * (_offsets[i + 1][axis] - _offsets[i][axis]);
+		}
+
+		return ret;
+	}
+
+private:
+	float _offsets[SIZE][AXES] {};
+
+	float _min_temp{0.f};
+	float _max_temp{0.f};
+	float _inv_step{0.f};
+
+	bool _valid{false};
+};
+
+} // namespace temperature_compensation
@@ -0,0 +1,119 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+#include <gtest/gtest.h>
+#include <math.h>
+
+#include "TemperatureCompensationTable.h"
+
+using namespace temperature_compensation;
+
+// 3rd order polynomials, same form as the gyro and accel calibration
+static void cubic(float temperature, float offset[3])
+{
+	const float dt = temperature - 25.f;
+	offset[0] = 0.01f + 3e-7f * dt * dt * dt;
+	offset[1] = -2e-3f * dt;
+	offset[2] = 2e-5f * dt * dt;
+}
+
+TEST(TemperatureCompensationTableTest, InvalidRange)
+{
+	TemperatureCompensationTable<3> table;
+	EXPECT_FALSE(table.valid());
+
+	EXPECT_FALSE(table.generate(20.f, 20.f, cubic));
+	EXPECT_FALSE(table.valid());
+
+	EXPECT_FALSE(table.generate(30.f, 20.f, cubic));
+	EXPECT_FALSE(table.valid());
+
+	EXPECT_FALSE(table.generate(NAN, 20.f, cubic));
+	EXPECT_FALSE(table.valid());
+
+	EXPECT_TRUE(table.generate(-10.f, 70.f, cubic));
+	EXPECT_TRUE(table.valid());
+
+	table.reset();
+	EXPECT_FALSE(table.valid());
+}
+
+TEST(TemperatureCompensationTableTest, Interpolation)
+{
+	TemperatureCompensationTable<3> table;
+	ASSERT_TRUE(table.generate(-10.f, 70.f, cubic));
+
+	for (float temperature = -10.f; temperature <= 70.f; temperature += 0.1f) {
+		float expected[3];
+		cubic(temperature, expected);
+
+		float offset[3];
+		EXPECT_TRUE(table.lookup(temperature, offset));
+
+		for (int axis = 0; axis < 3; axis++) {
+			EXPECT_NEAR(offset[axis], expected[axis], 1e-4f) << "temperature " << temperature << " axis " << axis;
+		}
+	}
+
+	// table entries are exact
+	float expected[3];
+	float offset[3];
+
+	cubic(-10.f, expected);
+	table.lookup(-10.f, offset);
+	EXPECT_FLOAT_EQ(offset[1], expected[1]);
+
+	cubic(70.f, expected);
+	table.lookup(70.f, offset);
+	EXPECT_FLOAT_EQ(offset[1], expected[1]);
+}
+
+TEST(TemperatureCompensationTableTest, Clipping)
+{
+	TemperatureCompensationTable<1> table;
+	ASSERT_TRUE(table.generate(0.f, 50.f, [](float temperature, float offset[1]) { offset[0] = temperature; }));
+
+	float offset[1];
+	EXPECT_FALSE(table.lookup(-5.f, offset));
+	EXPECT_FLOAT_EQ(offset[0], 0.f);
+
+	EXPECT_FALSE(table.lookup(80.f, offset));
+	EXPECT_FLOAT_EQ(offset[0], 50.f);
+
+	EXPECT_TRUE(table.lookup(12.3f, offset));
+	EXPECT_NEAR(offset[0], 12.3f, 1e-5f);
+
+	EXPECT_FALSE(table.lookup(NAN, offset));
+	EXPECT_FLOAT_EQ(offset[0], 0.f);
+}
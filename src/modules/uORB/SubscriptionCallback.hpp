@@ -166,6 +166,7 @@ public:
 		if ((_required_updates == 0)
 		    || (_subscription.get_node()->updates_available(_subscription.get_last_generation()) >= _required_updates)) {
 			if (updated()) {
+				perf_trace(PERF_TRACE_ORB_CALLBACK, (uint16_t)_subscription._orb_id, _work_item->TraceId());
 				_work_item->ScheduleNow();
 			}
 		}
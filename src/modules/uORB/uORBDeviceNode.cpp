@@ -38,6 +38,8 @@
 
 #include "SubscriptionCallback.hpp"
 
+#include <lib/perf/perf_trace.h>
+
 #ifdef ORB_COMMUNICATOR
 #include "uORBCommunicator.hpp"
 #endif /* ORB_COMMUNICATOR */
@@ -253,6 +255,8 @@ uORB::DeviceNode::write(cdev::file_t *filp, const char *buffer, size_t buflen)
 
 	memcpy(_data + (_meta->o_size * (generation % _queue_size)), buffer, _meta->o_size);
 
+	perf_trace(PERF_TRACE_ORB_PUBLISH, _meta->o_id, _instance);
+
 	// callbacks
 	for (auto item : _callbacks) {
 		item->call();
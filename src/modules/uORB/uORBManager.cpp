@@ -86,21 +86,35 @@ uORB::Manager::Manager()
 
 uORB::Manager::~Manager()
 {
-	delete _device_master;
+	for (auto &device_master : _device_master) {
+		delete device_master.load();
+	}
 }
 
 uORB::DeviceMaster *uORB::Manager::get_device_master()
 {
-	if (!_device_master) {
-		_device_master = new DeviceMaster();
+	px4::atomic<DeviceMaster *> &device_master_slot = _device_master[px4::vehicle_context()];
+	DeviceMaster *device_master = device_master_slot.load();
+
+	if (!device_master) {
+		device_master = new DeviceMaster();
 
-		if (_device_master == nullptr) {
+		if (device_master == nullptr) {
 			PX4_ERR("Failed to allocate DeviceMaster");
 			errno = ENOMEM;
+			return nullptr;
+		}
+
+		DeviceMaster *expected = nullptr;
+
+		// another thread of the same vehicle context might have been faster
+		if (!device_master_slot.compare_exchange(&expected, device_master)) {
+			delete device_master;
+			device_master = expected;
 		}
 	}
 
-	return _device_master;
+	return device_master;
 }
 
 int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
@@ -112,8 +126,10 @@ int uORB::Manager::orb_exists(const struct orb_metadata *meta, int instance)
 		return ret;
 	}
 
-	if (get_device_master()) {
-		uORB::DeviceNode *node = _device_master->getDeviceNode(meta, instance);
+	DeviceMaster *device_master = get_device_master();
+
+	if (device_master) {
+		uORB::DeviceNode *node = device_master->getDeviceNode(meta, instance);
 
 		if (node != nullptr) {
 			if (node->is_advertised()) {
@@ -359,8 +375,10 @@ int uORB::Manager::node_open(const struct orb_metadata *meta, bool advertiser, i
 
 		ret = PX4_ERROR;
 
-		if (get_device_master()) {
-			ret = _device_master->advertise(meta, advertiser, instance);
+		DeviceMaster *device_master = get_device_master();
+
+		if (device_master) {
+			ret = device_master->advertise(meta, advertiser, instance);
 		}
 
 		/* it's OK if it already exists */
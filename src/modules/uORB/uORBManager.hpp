@@ -39,6 +39,9 @@
 
 #include <stdint.h>
 
+#include <px4_platform_common/atomic.h>
+#include <px4_platform_common/vehicle_context.h>
+
 #ifdef __PX4_NUTTX
 #include "ORBSet.hpp"
 #else
@@ -89,9 +92,9 @@ public:
 	static uORB::Manager *get_instance() { return _Instance; }
 
 	/**
-	 * Get the DeviceMaster. If it does not exist,
+	 * Get the DeviceMaster of the calling thread's vehicle context (see
+	 * px4_platform_common/vehicle_context.h). If it does not exist,
 	 * it will be created and initialized.
-	 * Note: the first call to this is not thread-safe.
 	 * @return nullptr if initialization failed (and errno will be set)
 	 */
 	uORB::DeviceMaster *get_device_master();
@@ -379,7 +382,7 @@ private: // data members
 	ORBSet _remote_topics;
 #endif /* ORB_COMMUNICATOR */
 
-	DeviceMaster *_device_master{nullptr};
+	px4::atomic<DeviceMaster *> _device_master[PX4_VEHICLE_CONTEXTS_MAX] {};
 
 private: //class methods
 	Manager();
@@ -35,6 +35,21 @@
 #include <stdio.h>
 #include <errno.h>
 
+#include <px4_platform_common/vehicle_context.h>
+
+// topics of vehicle context 0 keep their usual path (/obj/<name><instance>),
+// the other contexts get their own directory (/obj/v<context>/<name><instance>)
+static unsigned node_mkpath_prefix(char *buf)
+{
+	const uint8_t context = px4::vehicle_context();
+
+	if (context == 0) {
+		return snprintf(buf, uORB::orb_maxpath, "/%s/", "obj");
+	}
+
+	return snprintf(buf, uORB::orb_maxpath, "/%s/v%u/", "obj", context);
+}
+
 int uORB::Utils::node_mkpath(char *buf, const struct orb_metadata *meta, int *instance)
 {
 	unsigned len;
@@ -45,7 +60,8 @@ int uORB::Utils::node_mkpath(char *buf, const struct orb_metadata *meta, int *in
 		index = *instance;
 	}
 
-	len = snprintf(buf, orb_maxpath, "/%s/%s%d", "obj", meta->o_name, index);
+	len = node_mkpath_prefix(buf);
+	len += snprintf(buf + len, orb_maxpath - len, "%s%d", meta->o_name, index);
 
 	if (len >= orb_maxpath) {
 		return -ENAMETOOLONG;
@@ -62,7 +78,8 @@ int uORB::Utils::node_mkpath(char *buf, const char *orbMsgName)
 
 	unsigned index = 0;
 
-	len = snprintf(buf, orb_maxpath, "/%s/%s%d", "obj", orbMsgName, index);
+	len = node_mkpath_prefix(buf);
+	len += snprintf(buf + len, orb_maxpath - len, "%s%d", orbMsgName, index);
 
 	if (len >= orb_maxpath) {
 		return -ENAMETOOLONG;
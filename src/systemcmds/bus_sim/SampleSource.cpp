@@ -0,0 +1,180 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SampleSource.cpp
+ */
+
+#include "SampleSource.hpp"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <math.h>
+
+#include <lib/ecl/geo/geo.h>
+#include <px4_platform_common/defines.h>
+#include <px4_platform_common/log.h>
+
+namespace bus_sim
+{
+
+SyntheticSampleSource::SyntheticSampleSource(float vibration_hz, float accel_amplitude, float gyro_amplitude,
+		float accel_noise, float gyro_noise) :
+	_vibration_hz(vibration_hz),
+	_accel_amplitude(accel_amplitude),
+	_gyro_amplitude(gyro_amplitude),
+	_accel_noise(accel_noise),
+	_gyro_noise(gyro_noise)
+{
+}
+
+float SyntheticSampleSource::noise()
+{
+	// xorshift32, sum of 4 uniform samples as approximation of a normal distribution (unit variance)
+	float sum = 0.f;
+
+	for (int i = 0; i < 4; i++) {
+		_random_state ^= _random_state << 13;
+		_random_state ^= _random_state >> 17;
+		_random_state ^= _random_state << 5;
+		sum += (float)_random_state / (float)UINT32_MAX - 0.5f;
+	}
+
+	return sum * 1.7320508f; // sqrt(12 / 4)
+}
+
+void SyntheticSampleSource::next(float dt, ImuSample &sample)
+{
+	_phase += M_TWOPI_F * _vibration_hz * dt;
+
+	if (_phase > M_TWOPI_F) {
+		_phase = fmodf(_phase, M_TWOPI_F);
+	}
+
+	for (int i = 0; i < 3; i++) {
+		// shift the phase per axis, so the axes are not identical
+		const float vibration = sinf(_phase + i);
+
+		sample.accel[i] = _accel_amplitude * vibration + _accel_noise * noise();
+		sample.gyro[i] = _gyro_amplitude * vibration + _gyro_noise * noise();
+	}
+
+	// at rest with +z up
+	sample.accel[2] += CONSTANTS_ONE_G;
+	sample.temperature = 40.f;
+}
+
+void SyntheticSampleSource::print_status()
+{
+	PX4_INFO("synthetic: %.1f Hz vibration (accel %.2f m/s^2, gyro %.3f rad/s), noise accel %.3f m/s^2, gyro %.4f rad/s",
+		 (double)_vibration_hz, (double)_accel_amplitude, (double)_gyro_amplitude, (double)_accel_noise, (double)_gyro_noise);
+}
+
+RecordedSampleSource::~RecordedSampleSource()
+{
+	delete[] _samples;
+}
+
+int RecordedSampleSource::load(const char *path)
+{
+	FILE *file = fopen(path, "r");
+
+	if (file == nullptr) {
+		PX4_ERR("failed to open %s (%i)", path, errno);
+		return -errno;
+	}
+
+	// first pass: count the lines, second pass: parse them
+	char line[256];
+	uint32_t lines = 0;
+
+	while (fgets(line, sizeof(line), file)) {
+		lines++;
+	}
+
+	delete[] _samples;
+	_samples = new ImuSample[lines];
+	_num_samples = 0;
+	_index = 0;
+	_repetitions = 0;
+
+	if (_samples == nullptr) {
+		fclose(file);
+		return -ENOMEM;
+	}
+
+	rewind(file);
+
+	while (fgets(line, sizeof(line), file) && _num_samples < lines) {
+		if (line[0] == '#') {
+			continue;
+		}
+
+		ImuSample &s = _samples[_num_samples];
+		s.temperature = 25.f;
+
+		if (sscanf(line, "%f,%f,%f,%f,%f,%f,%f", &s.accel[0], &s.accel[1], &s.accel[2],
+			   &s.gyro[0], &s.gyro[1], &s.gyro[2], &s.temperature) >= 6) {
+			_num_samples++;
+		}
+	}
+
+	fclose(file);
+
+	if (_num_samples == 0) {
+		PX4_ERR("no samples in %s", path);
+		return -EINVAL;
+	}
+
+	return _num_samples;
+}
+
+void RecordedSampleSource::next(float dt, ImuSample &sample)
+{
+	sample = _samples[_index];
+
+	if (++_index >= _num_samples) {
+		_index = 0;
+		_repetitions++;
+	}
+}
+
+void RecordedSampleSource::print_status()
+{
+	PX4_INFO("recorded: %u samples, at %u (%u repetitions)", _num_samples, _index, _repetitions);
+}
+
+} // namespace bus_sim
@@ -0,0 +1,125 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SampleSource.hpp
+ *
+ * Sample streams feeding the emulated IMUs: a synthetic one (gravity, vibration and noise)
+ * and a recorded one (replayed from a CSV file).
+ */
+
+#pragma once
+
+#include <stdint.h>
+
+namespace bus_sim
+{
+
+/**
+ * IMU sample in the sensor frame.
+ */
+struct ImuSample {
+	float accel[3];		///< m/s^2
+	float gyro[3];		///< rad/s
+	float temperature;	///< degrees Celsius
+};
+
+class SampleSource
+{
+public:
+	virtual ~SampleSource() = default;
+
+	/**
+	 * Get the next sample.
+	 * @param dt time since the previous sample (s)
+	 */
+	virtual void next(float dt, ImuSample &sample) = 0;
+
+	virtual void print_status() {}
+};
+
+/**
+ * Gravity on the z axis with a sinusoidal vibration and white noise on all axes.
+ * The noise is generated from a fixed seed, so the stream is reproducible.
+ */
+class SyntheticSampleSource : public SampleSource
+{
+public:
+	SyntheticSampleSource(float vibration_hz, float accel_amplitude, float gyro_amplitude, float accel_noise,
+			      float gyro_noise);
+
+	void next(float dt, ImuSample &sample) override;
+	void print_status() override;
+
+private:
+	float noise();
+
+	const float _vibration_hz;
+	const float _accel_amplitude;
+	const float _gyro_amplitude;
+	const float _accel_noise;
+	const float _gyro_noise;
+
+	float _phase{0.f};
+	uint32_t _random_state{0x12345678};
+};
+
+/**
+ * Replays samples from a CSV file with one sample per line:
+ * accel x,y,z (m/s^2), gyro x,y,z (rad/s) and an optional temperature (C).
+ * Lines starting with '#' are ignored. Every line is one sample at the ODR of the emulated device,
+ * and the recording is repeated when the end is reached.
+ */
+class RecordedSampleSource : public SampleSource
+{
+public:
+	RecordedSampleSource() = default;
+	~RecordedSampleSource() override;
+
+	/**
+	 * @return number of samples loaded, or < 0 on error
+	 */
+	int load(const char *path);
+
+	void next(float dt, ImuSample &sample) override;
+	void print_status() override;
+
+private:
+	ImuSample *_samples{nullptr};
+	uint32_t _num_samples{0};
+	uint32_t _index{0};
+	uint32_t _repetitions{0};
+};
+
+} // namespace bus_sim
@@ -0,0 +1,403 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SimulatedICM42688P.cpp
+ */
+
+#include "SimulatedICM42688P.hpp"
+
+#include <math.h>
+#include <string.h>
+
+#include <lib/ecl/geo/geo.h>
+#include <lib/mathlib/mathlib.h>
+#include <px4_platform_common/log.h>
+
+using namespace InvenSense_ICM42688P;
+
+namespace bus_sim
+{
+
+static constexpr uint8_t INT_CONFIG1_RESET = 0x10;
+static constexpr uint8_t INT_SOURCE0_RESET = 0x10;
+static constexpr uint8_t ODR_1kHz = 0x06;
+static constexpr uint8_t FIFO_MODE_MASK = Bit7 | Bit6;
+
+// header of packet 3 with accel, gyro and ODR timestamp
+static constexpr uint8_t FIFO_HEADER = FIFO::HEADER_ACCEL | FIFO::HEADER_GYRO | Bit3;
+
+static int16_t saturate(float value)
+{
+	return math::constrainFloatToInt16(roundf(value));
+}
+
+SimulatedICM42688P::SimulatedICM42688P(int bus, uint8_t chip_select, SampleSource *source) :
+	SimulatedDevice(device::Device::DeviceBusType_SPI, bus, chip_select),
+	_source(source)
+{
+	reset();
+}
+
+void SimulatedICM42688P::reset()
+{
+	memset(_registers, 0, sizeof(_registers));
+	_bank = 0;
+
+	bank0(Register::BANK_0::GYRO_CONFIG0) = ODR_1kHz;
+	bank0(Register::BANK_0::ACCEL_CONFIG0) = ODR_1kHz;
+	bank0(Register::BANK_0::INT_CONFIG1) = INT_CONFIG1_RESET;
+	bank0(Register::BANK_0::INT_SOURCE0) = INT_SOURCE0_RESET;
+	bank0(Register::BANK_0::WHO_AM_I) = WHOAMI;
+	bank0(Register::BANK_0::INT_STATUS) = INT_STATUS_BIT::RESET_DONE_INT;
+
+	_fifo_head = 0;
+	_fifo_count = 0;
+	_fifo_count_latched = 0;
+	_sample_odr = 0.f;
+}
+
+float SimulatedICM42688P::gyro_odr() const
+{
+	// 3:0 GYRO_ODR (Hz), 0 for reserved values
+	static constexpr float odr[16] {0.f, 32000.f, 16000.f, 8000.f, 4000.f, 2000.f, 1000.f, 200.f, 100.f, 50.f, 25.f, 12.5f, 0.f, 0.f, 0.f, 500.f};
+
+	return odr[_registers[0][static_cast<uint8_t>(Register::BANK_0::GYRO_CONFIG0)] & 0x0F];
+}
+
+float SimulatedICM42688P::accel_range() const
+{
+	// 7:5 ACCEL_FS_SEL: 16g >> FS_SEL
+	const uint8_t fs_sel = (_registers[0][static_cast<uint8_t>(Register::BANK_0::ACCEL_CONFIG0)] >> 5) & 0x03;
+	return 16.f / (1 << fs_sel);
+}
+
+float SimulatedICM42688P::gyro_range() const
+{
+	// 7:5 GYRO_FS_SEL: 2000 dps >> FS_SEL
+	const uint8_t fs_sel = (_registers[0][static_cast<uint8_t>(Register::BANK_0::GYRO_CONFIG0)] >> 5) & 0x07;
+	return 2000.f / (1 << fs_sel);
+}
+
+bool SimulatedICM42688P::sensors_enabled() const
+{
+	const uint8_t low_noise = PWR_MGMT0_BIT::GYRO_MODE_LOW_NOISE | PWR_MGMT0_BIT::ACCEL_MODE_LOW_NOISE;
+	return (_registers[0][static_cast<uint8_t>(Register::BANK_0::PWR_MGMT0)] & low_noise) == low_noise;
+}
+
+bool SimulatedICM42688P::fifo_enabled() const
+{
+	const uint8_t fifo_config1 = _registers[0][static_cast<uint8_t>(Register::BANK_0::FIFO_CONFIG1)];
+
+	return (_registers[0][static_cast<uint8_t>(Register::BANK_0::FIFO_CONFIG)] & FIFO_MODE_MASK)
+	       && (fifo_config1 & FIFO_CONFIG1_BIT::FIFO_ACCEL_EN)
+	       && (fifo_config1 & FIFO_CONFIG1_BIT::FIFO_GYRO_EN);
+}
+
+void SimulatedICM42688P::update(const hrt_abstime &now)
+{
+	const float odr = sensors_enabled() ? gyro_odr() : 0.f;
+
+	if (odr != _sample_odr) {
+		// (re)start sampling
+		_sample_odr = odr;
+		_sample_start = now;
+		_sample_count = 0;
+		return;
+	}
+
+	if (odr <= 0.f) {
+		return;
+	}
+
+	const uint64_t samples_expected = (uint64_t)((double)(now - _sample_start) * odr * 1e-6);
+	uint64_t samples = samples_expected - _sample_count;
+
+	// more than a full FIFO would be dropped anyway, but the sample stream continues
+	const uint64_t samples_max = FIFO_SIZE / sizeof(FIFO::DATA) + 1;
+
+	if (samples > samples_max) {
+		_samples_dropped += samples - samples_max;
+		samples = samples_max;
+	}
+
+	const float dt = 1.f / odr;
+	ImuSample sample{};
+
+	for (uint64_t i = 0; i < samples; i++) {
+		_source->next(dt, sample);
+
+		// ODR timestamp (1 us resolution)
+		const uint16_t timestamp = _sample_start + (uint64_t)((_sample_count + i + 1) * 1e6 / odr);
+		push_sample(sample, timestamp);
+	}
+
+	_sample_count = samples_expected;
+	_samples_generated += samples;
+}
+
+void SimulatedICM42688P::push_sample(const ImuSample &sample, uint16_t timestamp)
+{
+	uint8_t &int_status = bank0(Register::BANK_0::INT_STATUS);
+
+	// data registers: only the temperature is read by the driver
+	const int16_t temperature = saturate((sample.temperature - TEMPERATURE_OFFSET) * TEMPERATURE_SENSITIVITY);
+	bank0(Register::BANK_0::TEMP_DATA1) = (uint16_t)temperature >> 8;
+	bank0(Register::BANK_0::TEMP_DATA0) = (uint16_t)temperature & 0xFF;
+	int_status |= INT_STATUS_BIT::DATA_RDY_INT;
+
+	if (!fifo_enabled()) {
+		return;
+	}
+
+	if (_fifo_count + sizeof(FIFO::DATA) > FIFO_SIZE) {
+		// STOP-on-FULL: new samples are discarded
+		if (!(int_status & INT_STATUS_BIT::FIFO_FULL_INT)) {
+			_fifo_overflows++;
+		}
+
+		int_status |= INT_STATUS_BIT::FIFO_FULL_INT;
+		_samples_dropped++;
+		return;
+	}
+
+	const float accel_scale = 32768.f / (accel_range() * CONSTANTS_ONE_G); // LSB/(m/s^2)
+	const float gyro_scale = 32768.f / math::radians(gyro_range()); // LSB/(rad/s)
+
+	const int16_t accel[3] {
+		saturate(sample.accel[0] * accel_scale),
+		saturate(sample.accel[1] * accel_scale),
+		saturate(sample.accel[2] * accel_scale),
+	};
+
+	const int16_t gyro[3] {
+		saturate(sample.gyro[0] * gyro_scale),
+		saturate(sample.gyro[1] * gyro_scale),
+		saturate(sample.gyro[2] * gyro_scale),
+	};
+
+	// 8 bit FIFO temperature: T = FIFO_TEMP_DATA / 2.07 + 25
+	const float temperature_fifo = math::constrain((sample.temperature - TEMPERATURE_OFFSET) * 2.07f, -128.f, 127.f);
+
+	// FIFO data is big endian
+	const uint8_t packet[sizeof(FIFO::DATA)] {
+		FIFO_HEADER,
+		(uint8_t)((uint16_t)accel[0] >> 8), (uint8_t)accel[0],
+		(uint8_t)((uint16_t)accel[1] >> 8), (uint8_t)accel[1],
+		(uint8_t)((uint16_t)accel[2] >> 8), (uint8_t)accel[2],
+		(uint8_t)((uint16_t)gyro[0] >> 8), (uint8_t)gyro[0],
+		(uint8_t)((uint16_t)gyro[1] >> 8), (uint8_t)gyro[1],
+		(uint8_t)((uint16_t)gyro[2] >> 8), (uint8_t)gyro[2],
+		(uint8_t)(int8_t)lroundf(temperature_fifo),
+		(uint8_t)(timestamp & 0xFF),
+		(uint8_t)(timestamp >> 8),
+	};
+
+	for (size_t i = 0; i < sizeof(packet); i++) {
+		_fifo[(_fifo_head + _fifo_count) % FIFO_SIZE] = packet[i];
+		_fifo_count++;
+	}
+
+	// FIFO_WM[11:0] in bytes, FIFO_CONFIG1 FIFO_WM_GT_TH: interrupt if the count is greater or equal
+	const uint16_t watermark = ((bank0(Register::BANK_0::FIFO_CONFIG3) & 0x0F) << 8) | bank0(Register::BANK_0::FIFO_CONFIG2);
+
+	if ((watermark > 0) && (_fifo_count >= watermark)) {
+		int_status |= INT_STATUS_BIT::FIFO_THS_INT;
+	}
+}
+
+void SimulatedICM42688P::fifo_flush()
+{
+	_samples_flushed += _fifo_count / sizeof(FIFO::DATA);
+	_fifo_head = 0;
+	_fifo_count = 0;
+	bank0(Register::BANK_0::INT_STATUS) &= ~(INT_STATUS_BIT::FIFO_FULL_INT | INT_STATUS_BIT::FIFO_THS_INT);
+}
+
+uint8_t SimulatedICM42688P::read_register(uint8_t reg)
+{
+	if (reg == static_cast<uint8_t>(Register::BANK_0::REG_BANK_SEL)) {
+		return _bank;
+	}
+
+	if (_bank != 0) {
+		return _registers[_bank][reg];
+	}
+
+	switch (static_cast<Register::BANK_0>(reg)) {
+	case Register::BANK_0::INT_STATUS: {
+			// clear on read
+			const uint8_t value = bank0(Register::BANK_0::INT_STATUS);
+			bank0(Register::BANK_0::INT_STATUS) = 0;
+			return value;
+		}
+
+	case Register::BANK_0::FIFO_COUNTH:
+		// reading FIFO_COUNTH latches FIFO_COUNTL
+		_fifo_count_latched = _fifo_count;
+		return _fifo_count_latched >> 8;
+
+	case Register::BANK_0::FIFO_COUNTL:
+		return _fifo_count_latched & 0xFF;
+
+	case Register::BANK_0::FIFO_DATA:
+		if (_fifo_count > 0) {
+			const uint8_t value = _fifo[_fifo_head];
+			_fifo_head = (_fifo_head + 1) % FIFO_SIZE;
+			_fifo_count--;
+
+			if (_fifo_count + sizeof(FIFO::DATA) <= FIFO_SIZE) {
+				bank0(Register::BANK_0::INT_STATUS) &= ~INT_STATUS_BIT::FIFO_FULL_INT;
+			}
+
+			return value;
+		}
+
+		// empty FIFO
+		return FIFO::HEADER_MSG;
+
+	default:
+		break;
+	}
+
+	return _registers[0][reg];
+}
+
+void SimulatedICM42688P::write_register(uint8_t reg, uint8_t value)
+{
+	if (reg == static_cast<uint8_t>(Register::BANK_0::REG_BANK_SEL)) {
+		// BANK_SEL[2:0]
+		_bank = math::min(value & 0x07, NUM_BANKS - 1);
+		return;
+	}
+
+	if (_bank != 0) {
+		_registers[_bank][reg] = value;
+		return;
+	}
+
+	switch (static_cast<Register::BANK_0>(reg)) {
+	case Register::BANK_0::DEVICE_CONFIG:
+		if (value & DEVICE_CONFIG_BIT::SOFT_RESET_CONFIG) {
+			reset();
+			_resets++;
+
+		} else {
+			bank0(Register::BANK_0::DEVICE_CONFIG) = value;
+		}
+
+		break;
+
+	case Register::BANK_0::SIGNAL_PATH_RESET:
+		if (value & (SIGNAL_PATH_RESET_BIT::FIFO_FLUSH | SIGNAL_PATH_RESET_BIT::ABORT_AND_RESET)) {
+			fifo_flush();
+		}
+
+		// self-clearing
+		bank0(Register::BANK_0::SIGNAL_PATH_RESET) = value & ~(SIGNAL_PATH_RESET_BIT::FIFO_FLUSH |
+				SIGNAL_PATH_RESET_BIT::ABORT_AND_RESET);
+		break;
+
+	case Register::BANK_0::WHO_AM_I:
+	case Register::BANK_0::INT_STATUS:
+	case Register::BANK_0::FIFO_COUNTH:
+	case Register::BANK_0::FIFO_COUNTL:
+	case Register::BANK_0::FIFO_DATA:
+	case Register::BANK_0::TEMP_DATA1:
+	case Register::BANK_0::TEMP_DATA0:
+		// read-only
+		break;
+
+	default:
+		_registers[0][reg] = value;
+		break;
+	}
+}
+
+int SimulatedICM42688P::spi_transfer(const uint8_t *send, uint8_t *recv, unsigned len)
+{
+	if (len == 0) {
+		return PX4_OK;
+	}
+
+	update(hrt_absolute_time());
+
+	// first byte: register address and read flag, then the register is auto-incremented (except for FIFO_DATA)
+	const uint8_t cmd = send ? send[0] : 0;
+	const bool read = cmd & DIR_READ;
+	uint8_t reg = cmd & ~DIR_READ;
+
+	if (recv) {
+		recv[0] = 0;
+	}
+
+	for (unsigned i = 1; i < len; i++) {
+		// send and recv might be the same buffer
+		const uint8_t value_in = send ? send[i] : 0;
+		uint8_t value_out = 0;
+
+		if (read) {
+			value_out = read_register(reg);
+
+		} else {
+			write_register(reg, value_in);
+		}
+
+		if (recv) {
+			recv[i] = value_out;
+		}
+
+		if (reg != static_cast<uint8_t>(Register::BANK_0::FIFO_DATA) || _bank != 0) {
+			reg++;
+		}
+	}
+
+	return PX4_OK;
+}
+
+void SimulatedICM42688P::print_status()
+{
+	SimulatedDevice::print_status();
+
+	lock();
+	PX4_INFO("ICM42688P: ODR %.0f Hz, FIFO %u/%u bytes, %u resets", (double)_sample_odr, _fifo_count, (unsigned)FIFO_SIZE,
+		 _resets);
+	PX4_INFO("samples: %llu generated, %llu dropped, %llu flushed, %u FIFO overflows",
+		 (unsigned long long)_samples_generated, (unsigned long long)_samples_dropped,
+		 (unsigned long long)_samples_flushed, _fifo_overflows);
+	_source->print_status();
+	unlock();
+}
+
+} // namespace bus_sim
@@ -0,0 +1,111 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SimulatedICM42688P.hpp
+ *
+ * Register-level model of the InvenSense ICM-42688-P (SPI): register banks, soft reset,
+ * interrupt status, FIFO (stop-on-full mode, packet 3) and temperature.
+ * Samples are generated at the configured gyro ODR based on hrt_absolute_time(), so the
+ * FIFO fills up in (simulated) real time.
+ */
+
+#pragma once
+
+#include "SampleSource.hpp"
+
+#include <drivers/drv_hrt.h>
+#include <drivers/imu/invensense/icm42688p/InvenSense_ICM42688P_registers.hpp>
+#include <lib/drivers/device/posix/SimulatedDevice.hpp>
+
+namespace bus_sim
+{
+
+class SimulatedICM42688P : public device::SimulatedDevice
+{
+public:
+	SimulatedICM42688P(int bus, uint8_t chip_select, SampleSource *source);
+	~SimulatedICM42688P() override = default;
+
+	int spi_transfer(const uint8_t *send, uint8_t *recv, unsigned len) override;
+
+	void print_status() override;
+
+private:
+	static constexpr int NUM_BANKS = 5;
+	static constexpr size_t FIFO_SIZE = InvenSense_ICM42688P::FIFO::SIZE;
+
+	void reset();
+
+	/**
+	 * Generate all samples up to now and push them into the FIFO.
+	 */
+	void update(const hrt_abstime &now);
+	void push_sample(const ImuSample &sample, uint16_t timestamp);
+	void fifo_flush();
+
+	uint8_t read_register(uint8_t reg);
+	void write_register(uint8_t reg, uint8_t value);
+
+	uint8_t &bank0(InvenSense_ICM42688P::Register::BANK_0 reg) { return _registers[0][static_cast<uint8_t>(reg)]; }
+
+	float gyro_odr() const;
+	float accel_range() const; ///< g
+	float gyro_range() const; ///< deg/s
+	bool sensors_enabled() const;
+	bool fifo_enabled() const;
+
+	SampleSource *const _source;
+
+	uint8_t _registers[NUM_BANKS][256] {};
+	uint8_t _bank{0};
+
+	uint8_t _fifo[FIFO_SIZE] {};
+	uint16_t _fifo_head{0}; ///< next byte to read
+	uint16_t _fifo_count{0}; ///< number of bytes in the FIFO
+	uint16_t _fifo_count_latched{0};
+
+	// sample generation
+	hrt_abstime _sample_start{0};
+	uint64_t _sample_count{0}; ///< samples generated since _sample_start
+	float _sample_odr{0.f};
+
+	uint64_t _samples_generated{0};
+	uint64_t _samples_dropped{0}; ///< FIFO full
+	uint64_t _samples_flushed{0};
+	uint32_t _fifo_overflows{0};
+	uint32_t _resets{0};
+};
+
+} // namespace bus_sim
@@ -0,0 +1,150 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file SimulatedICM42688PTest.cpp
+ *
+ * Runs the unmodified ICM-42688-P driver against the emulated device and checks what it publishes.
+ */
+
+#include <gtest/gtest.h>
+
+#include "SampleSource.hpp"
+#include "SimulatedICM42688P.hpp"
+
+#include <drivers/drv_hrt.h>
+#include <drivers/drv_sensor.h>
+#include <lib/drivers/device/Device.hpp>
+#include <lib/ecl/geo/geo.h>
+#include <px4_platform_common/px4_work_queue/WorkQueueManager.hpp>
+#include <px4_platform_common/time.h>
+#include <px4_platform_common/workqueue.h>
+#include <uORB/Subscription.hpp>
+#include <uORB/topics/sensor_accel.h>
+#include <uORB/topics/sensor_gyro_fifo.h>
+
+#include "hrt_work.h"
+
+extern "C" int icm42688p_main(int argc, char *argv[]);
+
+using namespace bus_sim;
+using namespace time_literals;
+
+// constant and different on every axis, so the axis mapping of the driver can be checked
+class ConstantSampleSource : public SampleSource
+{
+public:
+	void next(float dt, ImuSample &sample) override
+	{
+		sample.accel[0] = 1.f;
+		sample.accel[1] = 2.f;
+		sample.accel[2] = CONSTANTS_ONE_G;
+		sample.gyro[0] = 0.1f;
+		sample.gyro[1] = 0.2f;
+		sample.gyro[2] = 0.3f;
+		sample.temperature = 30.f;
+	}
+};
+
+static int run_driver(const char *verb)
+{
+	char *argv[] {(char *)"icm42688p", (char *)"-s", (char *)"-b", (char *)"1", (char *)verb, nullptr};
+	return icm42688p_main(5, argv);
+}
+
+TEST(SimulatedICM42688PTest, DriverPublishesEmulatedSamples)
+{
+	// the parts of px4::init_once() the driver needs: work queues and hrt callouts
+	work_queues_init();
+	hrt_work_queue_init();
+	hrt_init();
+	ASSERT_EQ(px4::WorkQueueManagerStart(), PX4_OK);
+
+	// the driver keeps a reference to the device, so it has to outlive it
+	static ConstantSampleSource source;
+	static SimulatedICM42688P device(1, 0, &source);
+	ASSERT_EQ(device.register_device(), PX4_OK);
+
+	uORB::Subscription accel_sub{ORB_ID(sensor_accel)};
+	uORB::Subscription gyro_fifo_sub{ORB_ID(sensor_gyro_fifo)};
+
+	// WHEN: the driver is started on the bus of the emulated device
+	ASSERT_EQ(run_driver("start"), PX4_OK);
+
+	// THEN: it publishes the emulated samples in the NED frame, with continuous FIFO timestamps
+	int accel_count = 0;
+	int gyro_fifo_count = 0;
+	hrt_abstime last_timestamp_sample = 0;
+	const hrt_abstime timeout = hrt_absolute_time() + 3_s;
+
+	while ((accel_count < 50 || gyro_fifo_count < 50) && hrt_absolute_time() < timeout) {
+		px4_usleep(1000);
+
+		sensor_accel_s accel;
+
+		if (accel_sub.update(&accel)) {
+			device::Device::DeviceId device_id{};
+			device_id.devid = accel.device_id;
+			EXPECT_EQ(device_id.devid_s.devtype, DRV_IMU_DEVTYPE_ICM42688P);
+
+			EXPECT_NEAR(accel.x, 1.f, 0.05f);
+			EXPECT_NEAR(accel.y, -2.f, 0.05f);
+			EXPECT_NEAR(accel.z, -CONSTANTS_ONE_G, 0.05f);
+			accel_count++;
+		}
+
+		sensor_gyro_fifo_s gyro_fifo;
+
+		if (gyro_fifo_sub.update(&gyro_fifo)) {
+			ASSERT_GT(gyro_fifo.samples, 0);
+			EXPECT_FLOAT_EQ(gyro_fifo.dt, 125.f); // 8 kHz ODR
+
+			for (int i = 0; i < gyro_fifo.samples; i++) {
+				EXPECT_NEAR(gyro_fifo.x[i] * gyro_fifo.scale, 0.1f, 0.005f);
+				EXPECT_NEAR(gyro_fifo.y[i] * gyro_fifo.scale, -0.2f, 0.005f);
+				EXPECT_NEAR(gyro_fifo.z[i] * gyro_fifo.scale, -0.3f, 0.005f);
+			}
+
+			EXPECT_GT(gyro_fifo.timestamp_sample, last_timestamp_sample);
+			last_timestamp_sample = gyro_fifo.timestamp_sample;
+			gyro_fifo_count++;
+		}
+	}
+
+	EXPECT_GE(accel_count, 50);
+	EXPECT_GE(gyro_fifo_count, 50);
+
+	EXPECT_EQ(run_driver("stop"), PX4_OK);
+	px4::WorkQueueManagerStop();
+}
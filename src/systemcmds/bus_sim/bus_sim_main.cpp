@@ -0,0 +1,237 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+
+/**
+ * @file bus_sim_main.cpp
+ *
+ * Command to add emulated SPI devices, which unmodified drivers can then use on Linux.
+ */
+
+#include "SampleSource.hpp"
+#include "SimulatedICM42688P.hpp"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <px4_platform_common/getopt.h>
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/module.h>
+
+using namespace bus_sim;
+
+static constexpr int MAX_DEVICES = 4;
+
+// devices cannot be removed, as the drivers keep a reference
+static device::SimulatedDevice *devices[MAX_DEVICES] {};
+static SampleSource *sources[MAX_DEVICES] {};
+static int num_devices = 0;
+
+static void usage();
+
+extern "C" __EXPORT int bus_sim_main(int argc, char *argv[]);
+
+static int start(const char *type, int bus, int chip_select, const char *file, float vibration_hz,
+		 uint32_t overhead_us, uint32_t frequency)
+{
+	if (num_devices >= MAX_DEVICES) {
+		PX4_ERR("too many devices");
+		return PX4_ERROR;
+	}
+
+	if (strcmp(type, "icm42688p") != 0) {
+		PX4_ERR("unknown device type %s", type);
+		return PX4_ERROR;
+	}
+
+	SampleSource *source = nullptr;
+
+	if (file) {
+		RecordedSampleSource *recorded = new RecordedSampleSource();
+
+		if (recorded == nullptr) {
+			return -ENOMEM;
+		}
+
+		const int ret = recorded->load(file);
+
+		if (ret < 0) {
+			delete recorded;
+			return ret;
+		}
+
+		source = recorded;
+
+	} else {
+		// vibration of a small multicopter, noise similar to the ICM-42688-P datasheet at 8 kHz
+		source = new SyntheticSampleSource(vibration_hz, 2.f, 0.05f, 0.03f, 0.003f);
+
+		if (source == nullptr) {
+			return -ENOMEM;
+		}
+	}
+
+	SimulatedICM42688P *device = new SimulatedICM42688P(bus, chip_select, source);
+
+	if (device == nullptr) {
+		delete source;
+		return -ENOMEM;
+	}
+
+	device->set_transfer_latency(overhead_us, frequency);
+
+	const int ret = device->register_device();
+
+	if (ret != PX4_OK) {
+		PX4_ERR("SPI bus %i, CS %i not available (%i)", bus, chip_select, ret);
+		delete device;
+		delete source;
+		return ret;
+	}
+
+	devices[num_devices] = device;
+	sources[num_devices] = source;
+	num_devices++;
+
+	PX4_INFO("%s on SPI bus %i, CS %i", type, bus, chip_select);
+
+	return PX4_OK;
+}
+
+int bus_sim_main(int argc, char *argv[])
+{
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	const char *type = "icm42688p";
+	const char *file = nullptr;
+	int bus = 1;
+	int chip_select = 0;
+	float vibration_hz = 180.f;
+	uint32_t overhead_us = 0;
+	uint32_t frequency = 0;
+
+	while ((ch = px4_getopt(argc, argv, "t:b:c:f:v:l:F:", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 't':
+			type = myoptarg;
+			break;
+
+		case 'b':
+			bus = strtol(myoptarg, nullptr, 0);
+			break;
+
+		case 'c':
+			chip_select = strtol(myoptarg, nullptr, 0);
+			break;
+
+		case 'f':
+			file = myoptarg;
+			break;
+
+		case 'v':
+			vibration_hz = strtof(myoptarg, nullptr);
+			break;
+
+		case 'l':
+			overhead_us = strtoul(myoptarg, nullptr, 0);
+			break;
+
+		case 'F':
+			frequency = strtoul(myoptarg, nullptr, 0);
+			break;
+
+		default:
+			usage();
+			return -1;
+		}
+	}
+
+	if (myoptind >= argc) {
+		usage();
+		return 1;
+	}
+
+	if (!strcmp(argv[myoptind], "start")) {
+		return start(type, bus, chip_select, file, vibration_hz, overhead_us, frequency);
+
+	} else if (!strcmp(argv[myoptind], "status")) {
+		if (num_devices == 0) {
+			PX4_INFO("no devices");
+		}
+
+		for (int i = 0; i < num_devices; i++) {
+			devices[i]->print_status();
+		}
+
+		return 0;
+	}
+
+	usage();
+	return 1;
+}
+
+static void usage()
+{
+	PRINT_MODULE_DESCRIPTION(
+		R"DESCR_STR(
+### Description
+Emulates sensors at register level on a SPI bus, so that unmodified drivers can be run and benchmarked
+on Linux (e.g. in SITL). The emulated device model implements the register map and FIFO of the sensor,
+and generates samples at the configured output data rate, either synthetic (gravity, vibration and noise)
+or replayed from a CSV file (accel x,y,z in m/s^2, gyro x,y,z in rad/s, optional temperature, one line per sample).
+
+Transfers are handled in the calling thread, which sleeps for the configured latency.
+They show up in 'perf trace' like real bus transfers.
+
+The SPI bus and chip-select need to be in the board configuration, so the driver can find it (SITL: bus 1, CS 0),
+and the driver needs to be part of the build (SITL on Linux includes icm42688p).
+
+### Examples
+Start an emulated ICM-42688-P with 20 us transfer overhead and a 24 MHz bus clock, then the driver:
+$ bus_sim -l 20 -F 24000000 start
+$ icm42688p -s -b 1 start
+)DESCR_STR");
+
+	PRINT_MODULE_USAGE_NAME("bus_sim", "system");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("start", "Add an emulated device");
+	PRINT_MODULE_USAGE_PARAM_STRING('t', "icm42688p", "icm42688p", "Device type", true);
+	PRINT_MODULE_USAGE_PARAM_INT('b', 1, 0, 16, "SPI bus", true);
+	PRINT_MODULE_USAGE_PARAM_INT('c', 0, 0, 15, "Chip-select index", true);
+	PRINT_MODULE_USAGE_PARAM_STRING('f', nullptr, "<file>", "Replay samples from a CSV file", true);
+	PRINT_MODULE_USAGE_PARAM_FLOAT('v', 180.f, 0.f, 1000.f, "Vibration frequency of the synthetic samples (Hz)", true);
+	PRINT_MODULE_USAGE_PARAM_INT('l', 0, 0, 100000, "Transfer overhead (us)", true);
+	PRINT_MODULE_USAGE_PARAM_INT('F', 0, 0, 100000000, "Bus clock for the transfer time (Hz), 0 to disable", true);
+	PRINT_MODULE_USAGE_COMMAND_DESCR("status", "Print the status of all emulated devices");
+}
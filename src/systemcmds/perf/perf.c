@@ -38,9 +38,12 @@
 #include <unistd.h>
 #include <stdio.h>
 #include <string.h>
+#include <errno.h>
 
 #include <perf/perf_counter.h>
 
+#include "trace.h"
+
 __EXPORT int perf_main(int argc, char *argv[]);
 
 
@@ -51,6 +54,11 @@ static void print_usage(void)
 	PRINT_MODULE_USAGE_NAME_SIMPLE("perf", "command");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("reset", "Reset all counters");
 	PRINT_MODULE_USAGE_COMMAND_DESCR("latency", "Print HRT timer latency histogram");
+	PRINT_MODULE_USAGE_COMMAND_DESCR("trace", "Record a timeline of work item runs, uORB publications and bus transfers");
+	PRINT_MODULE_USAGE_ARG("start|stop|status|dump", "Start/stop recording, show status, or export the records", false);
+	PRINT_MODULE_USAGE_PARAM_STRING('f', "trace.json", NULL, "Write a Chrome trace (JSON) file (dump, default on POSIX)",
+					true);
+	PRINT_MODULE_USAGE_PARAM_FLAG('l', "Publish the records for the logger (dump, default on NuttX)", true);
 
 	PRINT_MODULE_USAGE_PARAM_COMMENT("Prints all performance counters if no arguments given");
 }
@@ -67,6 +75,13 @@ int perf_main(int argc, char *argv[])
 			perf_print_latency(1 /* stdout */);
 			fflush(stdout);
 			return 0;
+
+		} else if (strcmp(argv[1], "trace") == 0) {
+			int ret = perf_trace_command(argc - 1, argv + 1);
+
+			if (ret != -EINVAL) {
+				return ret;
+			}
 		}
 
 		print_usage();
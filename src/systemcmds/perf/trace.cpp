@@ -0,0 +1,419 @@
+/****************************************************************************
+ *
+ *   Copyright (c) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file trace.cpp
+ * 'perf trace': control event tracing and export the recorded timeline.
+ *
+ * The timeline is either written as Chrome trace (JSON) file, which can be opened with
+ * chrome://tracing or https://ui.perfetto.dev, or published as perf_trace messages so that
+ * the logger writes it to the ULog file.
+ */
+
+#include "trace.h"
+
+#include <errno.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <drivers/drv_hrt.h>
+#include <lib/drivers/device/Device.hpp>
+#include <perf/perf_trace.h>
+#include <px4_platform_common/getopt.h>
+#include <px4_platform_common/log.h>
+#include <px4_platform_common/posix.h>
+#include <uORB/Publication.hpp>
+#include <uORB/topics/perf_trace.h>
+#include <uORB/topics/uORBTopics.hpp>
+
+using namespace time_literals;
+
+/**
+ * Reads the records of all buffers, merged into a single stream ordered by time.
+ */
+class TraceReader
+{
+public:
+	TraceReader() :
+		_num_buffers(perf_trace_num_buffers()),
+		_cursors(new unsigned[_num_buffers] {})
+	{
+	}
+
+	~TraceReader() { delete[] _cursors; }
+
+	bool valid() const { return _cursors != nullptr; }
+
+	/** @return next record or nullptr when all are read */
+	const perf_trace_record_s *next()
+	{
+		const perf_trace_record_s *oldest = nullptr;
+		unsigned oldest_buffer = 0;
+
+		for (unsigned i = 0; i < _num_buffers; i++) {
+			const perf_trace_record_s *record = perf_trace_get(i, _cursors[i]);
+
+			if (record && (!oldest || record->timestamp < oldest->timestamp)) {
+				oldest = record;
+				oldest_buffer = i;
+			}
+		}
+
+		if (oldest) {
+			_cursors[oldest_buffer]++;
+		}
+
+		return oldest;
+	}
+
+private:
+	const unsigned _num_buffers;
+	unsigned *_cursors;
+};
+
+static const char *topic_name(uint16_t id)
+{
+	if (id < ORB_TOPICS_COUNT) {
+		return get_orb_meta((ORB_ID)id)->o_name;
+	}
+
+	return "unknown";
+}
+
+static const char *trace_name(uint16_t id)
+{
+	const char *name = perf_trace_name(id);
+	return name ? name : "unknown";
+}
+
+static unsigned trace_num_names()
+{
+	unsigned num_names = 0;
+
+	while (perf_trace_name(num_names) != nullptr) {
+		num_names++;
+	}
+
+	return num_names;
+}
+
+static const char *bus_name(uint16_t bus_type)
+{
+	return device::Device::get_device_bus_string((device::Device::DeviceBusType)bus_type);
+}
+
+static int dump_json(const char *path)
+{
+	FILE *fp = fopen(path, "w");
+
+	if (fp == nullptr) {
+		PX4_ERR("failed to open %s (%i)", path, errno);
+		return PX4_ERROR;
+	}
+
+	TraceReader reader;
+
+	// pending callback flow per work item: connects a callback with the next run of the item it scheduled
+	const unsigned num_names = trace_num_names();
+	uint32_t *flows = new uint32_t[num_names] {};
+
+	if (!reader.valid() || (num_names > 0 && flows == nullptr)) {
+		fclose(fp);
+		delete[] flows;
+		PX4_ERR("alloc failed");
+		return PX4_ERROR;
+	}
+
+	fprintf(fp, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+	fprintf(fp, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":0,\"tid\":0,\"args\":{\"name\":\"px4\"}}");
+
+	for (unsigned i = 0; i < perf_trace_num_buffers(); i++) {
+		const char *thread_name = perf_trace_buffer_name(i);
+
+		if (thread_name && thread_name[0] != '\0') {
+			fprintf(fp, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":%u,\"args\":{\"name\":\"%s\"}}",
+				i, thread_name);
+		}
+	}
+
+	uint32_t next_flow = 1;
+	unsigned num_records = 0;
+	const perf_trace_record_s *record;
+
+	while ((record = reader.next()) != nullptr) {
+		const unsigned tid = record->thread;
+		const uint64_t ts = record->timestamp;
+
+		switch (record->event) {
+		case PERF_TRACE_WORK_ITEM_BEGIN:
+			fprintf(fp, ",\n{\"name\":\"%s\",\"cat\":\"wq\",\"ph\":\"B\",\"ts\":%" PRIu64 ",\"pid\":0,\"tid\":%u}",
+				trace_name(record->id), ts, tid);
+
+			if (record->id < num_names && flows[record->id] != 0) {
+				fprintf(fp, ",\n{\"name\":\"callback\",\"cat\":\"orb\",\"ph\":\"f\",\"bp\":\"e\",\"id\":%" PRIu32
+					",\"ts\":%" PRIu64 ",\"pid\":0,\"tid\":%u}", flows[record->id], ts, tid);
+				flows[record->id] = 0;
+			}
+
+			break;
+
+		case PERF_TRACE_WORK_ITEM_END:
+			fprintf(fp, ",\n{\"ph\":\"E\",\"ts\":%" PRIu64 ",\"pid\":0,\"tid\":%u}", ts, tid);
+			break;
+
+		case PERF_TRACE_ORB_PUBLISH:
+			fprintf(fp, ",\n{\"name\":\"publish %s\",\"cat\":\"orb\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRIu64
+				",\"pid\":0,\"tid\":%u,\"args\":{\"instance\":%" PRIu32 "}}", topic_name(record->id), ts, tid, record->arg);
+			break;
+
+		case PERF_TRACE_ORB_CALLBACK:
+			fprintf(fp, ",\n{\"name\":\"callback %s\",\"cat\":\"orb\",\"ph\":\"i\",\"s\":\"t\",\"ts\":%" PRIu64
+				",\"pid\":0,\"tid\":%u,\"args\":{\"item\":\"%s\"}}", topic_name(record->id), ts, tid, trace_name(record->arg));
+
+			// an item scheduled several times before it runs gets a single flow from the first callback
+			if (record->arg < num_names && flows[record->arg] == 0) {
+				flows[record->arg] = next_flow++;
+				fprintf(fp, ",\n{\"name\":\"callback\",\"cat\":\"orb\",\"ph\":\"s\",\"id\":%" PRIu32
+					",\"ts\":%" PRIu64 ",\"pid\":0,\"tid\":%u}", flows[record->arg], ts, tid);
+			}
+
+			break;
+
+		case PERF_TRACE_TRANSFER_BEGIN:
+			fprintf(fp, ",\n{\"name\":\"%s transfer\",\"cat\":\"bus\",\"ph\":\"B\",\"ts\":%" PRIu64
+				",\"pid\":0,\"tid\":%u,\"args\":{\"device_id\":\"0x%06" PRIx32 "\"}}", bus_name(record->id), ts, tid, record->arg);
+			break;
+
+		case PERF_TRACE_TRANSFER_END:
+			fprintf(fp, ",\n{\"ph\":\"E\",\"ts\":%" PRIu64 ",\"pid\":0,\"tid\":%u}", ts, tid);
+			break;
+		}
+
+		num_records++;
+	}
+
+	fprintf(fp, "\n]}\n");
+	fclose(fp);
+	delete[] flows;
+
+	PX4_INFO("wrote %u records to %s", num_records, path);
+	return PX4_OK;
+}
+
+static int dump_log()
+{
+	uORB::Publication<perf_trace_s> perf_trace_pub{ORB_ID(perf_trace)};
+	unsigned num_published = 0;
+
+	// the logger reads one message per topic and iteration: do not overrun the queue
+	auto publish = [&](perf_trace_s & msg) {
+		msg.timestamp = hrt_absolute_time();
+		perf_trace_pub.publish(msg);
+
+		if (++num_published % (perf_trace_s::ORB_QUEUE_LENGTH / 4) == 0) {
+			px4_usleep(10_ms);
+		}
+	};
+
+	auto publish_name = [&](uint8_t type, uint16_t id, const char *name) {
+		perf_trace_s msg{};
+		msg.name_type = type;
+		msg.name_id = id;
+		strncpy(msg.name, name, sizeof(msg.name) - 1);
+		publish(msg);
+	};
+
+	// names: only the topics that appear in the trace
+	const unsigned num_names = trace_num_names();
+
+	for (unsigned i = 0; i < num_names; i++) {
+		publish_name(perf_trace_s::NAME_TRACE_ID, i, trace_name(i));
+	}
+
+	for (unsigned i = 0; i < perf_trace_num_buffers(); i++) {
+		const char *thread_name = perf_trace_buffer_name(i);
+
+		if (thread_name && thread_name[0] != '\0') {
+			publish_name(perf_trace_s::NAME_THREAD, i, thread_name);
+		}
+	}
+
+	uint8_t topics_used[(ORB_TOPICS_COUNT + 7) / 8] {};
+	unsigned num_records = 0;
+
+	{
+		TraceReader reader;
+		const perf_trace_record_s *record;
+
+		while (reader.valid() && (record = reader.next()) != nullptr) {
+			if ((record->event == PERF_TRACE_ORB_PUBLISH || record->event == PERF_TRACE_ORB_CALLBACK)
+			    && record->id < ORB_TOPICS_COUNT) {
+				topics_used[record->id / 8] |= 1 << (record->id % 8);
+			}
+		}
+	}
+
+	for (unsigned i = 0; i < ORB_TOPICS_COUNT; i++) {
+		if (topics_used[i / 8] & (1 << (i % 8))) {
+			publish_name(perf_trace_s::NAME_ORB_ID, i, topic_name(i));
+		}
+	}
+
+	TraceReader reader;
+
+	if (!reader.valid()) {
+		PX4_ERR("alloc failed");
+		return PX4_ERROR;
+	}
+
+	perf_trace_s msg{};
+	const perf_trace_record_s *record;
+
+	while ((record = reader.next()) != nullptr) {
+		const unsigned i = msg.num_records++;
+		msg.record_timestamp[i] = record->timestamp;
+		msg.record_arg[i] = record->arg;
+		msg.record_id[i] = record->id;
+		msg.record_event[i] = record->event;
+		msg.record_thread[i] = record->thread;
+		num_records++;
+
+		if (msg.num_records == perf_trace_s::MAX_RECORDS) {
+			publish(msg);
+			msg = perf_trace_s{};
+		}
+	}
+
+	if (msg.num_records > 0) {
+		publish(msg);
+	}
+
+	PX4_INFO("published %u records (the logger must be running to store them)", num_records);
+	return PX4_OK;
+}
+
+static void print_status()
+{
+	unsigned num_records = 0;
+
+	for (unsigned i = 0; i < perf_trace_num_buffers(); i++) {
+		unsigned index = 0;
+
+		while (perf_trace_get(i, index) != nullptr) {
+			index++;
+		}
+
+		num_records += index;
+	}
+
+	PX4_INFO("tracing %s, %u buffers, %u records, %" PRIu32 " dropped", perf_trace_enabled ? "enabled" : "disabled",
+		 perf_trace_num_buffers(), num_records, perf_trace_num_dropped());
+}
+
+int perf_trace_command(int argc, char *argv[])
+{
+	const char *file = nullptr;
+	bool log = false;
+
+	int myoptind = 1;
+	int ch;
+	const char *myoptarg = nullptr;
+
+	while ((ch = px4_getopt(argc, argv, "f:l", &myoptind, &myoptarg)) != EOF) {
+		switch (ch) {
+		case 'f':
+			file = myoptarg;
+			break;
+
+		case 'l':
+			log = true;
+			break;
+
+		default:
+			return -EINVAL;
+		}
+	}
+
+	if (myoptind >= argc) {
+		return -EINVAL;
+	}
+
+	const char *command = argv[myoptind];
+
+	if (strcmp(command, "start") == 0) {
+		if (perf_trace_start() != 0) {
+			PX4_ERR("failed to start tracing (out of memory)");
+			return PX4_ERROR;
+		}
+
+		return PX4_OK;
+
+	} else if (strcmp(command, "stop") == 0) {
+		perf_trace_stop();
+		return PX4_OK;
+
+	} else if (strcmp(command, "status") == 0) {
+		print_status();
+		return PX4_OK;
+
+	} else if (strcmp(command, "dump") == 0) {
+		// stop to get a consistent snapshot
+		const bool enabled = perf_trace_enabled;
+		perf_trace_stop();
+
+		int ret;
+
+		if (log) {
+			ret = dump_log();
+
+		} else if (file) {
+			ret = dump_json(file);
+
+		} else {
+#if defined(__PX4_NUTTX)
+			ret = dump_log();
+#else
+			ret = dump_json("trace.json");
+#endif
+		}
+
+		if (enabled) {
+			PX4_INFO("tracing stopped");
+		}
+
+		return ret;
+	}
+
+	return -EINVAL;
+}
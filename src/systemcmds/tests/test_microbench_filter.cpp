@@ -0,0 +1,257 @@
+/****************************************************************************
+ *
+ *  Copyright (C) 2020 PX4 Development Team. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions
+ * are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ * 2. Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ * 3. Neither the name PX4 nor the names of its contributors may be
+ *    used to endorse or promote products derived from this software
+ *    without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS
+ * FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE
+ * COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,
+ * BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS
+ * OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED
+ * AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT
+ * LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN
+ * ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ *
+ ****************************************************************************/
+
+/**
+ * @file test_microbench_filter.cpp
+ * Tests for the microbench filter library.
+ */
+
+#include <unit_test.h>
+
+#include <time.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <drivers/drv_hrt.h>
+#include <perf/perf_counter.h>
+#include <px4_platform_common/px4_config.h>
+#include <px4_platform_common/micro_hal.h>
+
+#include <lib/mathlib/math/filter/BiquadFilterBank.hpp>
+#include <lib/mathlib/math/filter/LowPassFilter2p.hpp>
+#include <lib/mathlib/math/filter/LowPassFilter2pVector3f.hpp>
+#include <lib/mathlib/math/filter/NotchFilter.hpp>
+#include <matrix/math.hpp>
+
+namespace MicroBenchFilter
+{
+
+#ifdef __PX4_NUTTX
+#include <nuttx/irq.h>
+static irqstate_t flags;
+#endif
+
+void lock()
+{
+#ifdef __PX4_NUTTX
+	flags = px4_enter_critical_section();
+#endif
+}
+
+void unlock()
+{
+#ifdef __PX4_NUTTX
+	px4_leave_critical_section(flags);
+#endif
+}
+
+#define PERF(name, op, count) do { \
+		px4_usleep(1000); \
+		reset(); \
+		perf_counter_t p = perf_alloc(PC_ELAPSED, name); \
+		for (int i = 0; i < count; i++) { \
+			px4_usleep(1); \
+			lock(); \
+			perf_begin(p); \
+			op; \
+			perf_end(p); \
+			unlock(); \
+			reset(); \
+		} \
+		perf_print_counter(p); \
+		perf_free(p); \
+	} while (0)
+
+static constexpr float SAMPLE_FREQ = 8000.f; // typical gyro FIFO rate
+static constexpr int NUM_SAMPLES = 32; // sensor_gyro_fifo length
+
+class MicroBenchFilter : public UnitTest
+{
+public:
+	virtual bool run_tests();
+
+private:
+	bool time_lowpass();
+	bool time_notch_lowpass();
+	bool time_notch_notch_lowpass();
+
+	void reset();
+
+	// scalar filters (one object per axis and stage)
+	void lowpass_scalar();
+	void notch_lowpass_scalar();
+	void notch_notch_lowpass_scalar();
+
+	// Vector3f filters (one object per stage)
+	void lowpass_vector3f();
+	void notch_lowpass_vector3f();
+	void notch_notch_lowpass_vector3f();
+
+	float samples[NUM_SAMPLES][3];
+
+	math::LowPassFilter2p lp[3] {{SAMPLE_FREQ, 100.f}, {SAMPLE_FREQ, 100.f}, {SAMPLE_FREQ, 100.f}};
+	math::NotchFilter<float> notch_a[3] {};
+	math::NotchFilter<float> notch_b[3] {};
+
+	math::LowPassFilter2pVector3f lp_vector3f{SAMPLE_FREQ, 100.f};
+	math::NotchFilter<matrix::Vector3f> notch_a_vector3f{};
+	math::NotchFilter<matrix::Vector3f> notch_b_vector3f{};
+
+	math::BiquadFilterBank<3, 1> bank_lowpass;
+	math::BiquadFilterBank<3, 2> bank_notch_lowpass;
+	math::BiquadFilterBank<3, 3> bank_notch_notch_lowpass;
+};
+
+bool MicroBenchFilter::run_tests()
+{
+	for (int axis = 0; axis < 3; axis++) {
+		notch_a[axis].setParameters(SAMPLE_FREQ, 120.f, 20.f);
+		notch_b[axis].setParameters(SAMPLE_FREQ, 240.f, 20.f);
+	}
+
+	notch_a_vector3f.setParameters(SAMPLE_FREQ, 120.f, 20.f);
+	notch_b_vector3f.setParameters(SAMPLE_FREQ, 240.f, 20.f);
+
+	bank_lowpass.setLowPass(0, SAMPLE_FREQ, 100.f);
+
+	bank_notch_lowpass.setNotch(0, SAMPLE_FREQ, 120.f, 20.f);
+	bank_notch_lowpass.setLowPass(1, SAMPLE_FREQ, 100.f);
+
+	bank_notch_notch_lowpass.setNotch(0, SAMPLE_FREQ, 120.f, 20.f);
+	bank_notch_notch_lowpass.setNotch(1, SAMPLE_FREQ, 240.f, 20.f);
+	bank_notch_notch_lowpass.setLowPass(2, SAMPLE_FREQ, 100.f);
+
+	ut_run_test(time_lowpass);
+	ut_run_test(time_notch_lowpass);
+	ut_run_test(time_notch_notch_lowpass);
+
+	return (_tests_failed == 0);
+}
+
+template<typename T>
+T random(T min, T max)
+{
+	const T scale = rand() / (T) RAND_MAX; /* [0, 1.0] */
+	return min + scale * (max - min);      /* [min, max] */
+}
+
+void MicroBenchFilter::reset()
+{
+	srand(time(nullptr));
+
+	// initialize with random data (angular velocity in rad/s)
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		for (int axis = 0; axis < 3; axis++) {
+			samples[n][axis] = random(-10.f, 10.f);
+		}
+	}
+}
+
+void MicroBenchFilter::lowpass_scalar()
+{
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		for (int axis = 0; axis < 3; axis++) {
+			samples[n][axis] = lp[axis].apply(samples[n][axis]);
+		}
+	}
+}
+
+void MicroBenchFilter::notch_lowpass_scalar()
+{
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		for (int axis = 0; axis < 3; axis++) {
+			samples[n][axis] = lp[axis].apply(notch_a[axis].apply(samples[n][axis]));
+		}
+	}
+}
+
+void MicroBenchFilter::notch_notch_lowpass_scalar()
+{
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		for (int axis = 0; axis < 3; axis++) {
+			samples[n][axis] = lp[axis].apply(notch_b[axis].apply(notch_a[axis].apply(samples[n][axis])));
+		}
+	}
+}
+
+void MicroBenchFilter::lowpass_vector3f()
+{
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		const matrix::Vector3f y{lp_vector3f.apply(matrix::Vector3f{samples[n]})};
+		y.copyTo(samples[n]);
+	}
+}
+
+void MicroBenchFilter::notch_lowpass_vector3f()
+{
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		const matrix::Vector3f y{lp_vector3f.apply(notch_a_vector3f.apply(matrix::Vector3f{samples[n]}))};
+		y.copyTo(samples[n]);
+	}
+}
+
+void MicroBenchFilter::notch_notch_lowpass_vector3f()
+{
+	for (int n = 0; n < NUM_SAMPLES; n++) {
+		const matrix::Vector3f y{lp_vector3f.apply(notch_b_vector3f.apply(notch_a_vector3f.apply(matrix::Vector3f{samples[n]})))};
+		y.copyTo(samples[n]);
+	}
+}
+
+ut_declare_test_c(test_microbench_filter, MicroBenchFilter)
+
+bool MicroBenchFilter::time_lowpass()
+{
+	PERF("32x3 low-pass LowPassFilter2p", lowpass_scalar(), 100);
+	PERF("32x3 low-pass LowPassFilter2pVector3f", lowpass_vector3f(), 100);
+	PERF("32x3 low-pass BiquadFilterBank", bank_lowpass.apply(samples, NUM_SAMPLES), 100);
+	return true;
+}
+
+bool MicroBenchFilter::time_notch_lowpass()
+{
+	PERF("32x3 notch + low-pass NotchFilter<float> + LowPassFilter2p", notch_lowpass_scalar(), 100);
+	PERF("32x3 notch + low-pass NotchFilter<Vector3f> + LowPassFilter2pVector3f", notch_lowpass_vector3f(), 100);
+	PERF("32x3 notch + low-pass BiquadFilterBank", bank_notch_lowpass.apply(samples, NUM_SAMPLES), 100);
+	return true;
+}
+
+bool MicroBenchFilter::time_notch_notch_lowpass()
+{
+	PERF("32x3 2 notches + low-pass NotchFilter<float> + LowPassFilter2p", notch_notch_lowpass_scalar(), 100);
+	PERF("32x3 2 notches + low-pass NotchFilter<Vector3f> + LowPassFilter2pVector3f", notch_notch_lowpass_vector3f(), 100);
+	PERF("32x3 2 notches + low-pass BiquadFilterBank", bank_notch_notch_lowpass.apply(samples, NUM_SAMPLES), 100);
+	return true;
+}
+
+} // namespace MicroBenchFilter
@@ -65,6 +65,7 @@ extern int test_List(int argc, char *argv[]);
 extern int test_mathlib(int argc, char *argv[]);
 extern int test_matrix(int argc, char *argv[]);
 extern int test_microbench_atomic(int argc, char *argv[]);
+extern int test_microbench_filter(int argc, char *argv[]);
 extern int test_microbench_hrt(int argc, char *argv[]);
 extern int test_microbench_math(int argc, char *argv[]);
 extern int test_microbench_matrix(int argc, char *argv[]);